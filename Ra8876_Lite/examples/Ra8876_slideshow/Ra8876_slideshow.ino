@@ -228,47 +228,29 @@ void    FB_refresh(void)
 
 /**
  * @brief   Fade in whatever in frame buffer to the Main Window.
+ * @note    Transition steps are drawn at vsync by the library. The area below the frame buffer (y=1440) is its work area.
  */
 void  FB_fadeIn(uint16_t msec)
 {
-  uint16_t transition_time = msec/32;
-  
-  for(uint8_t alpha=0; alpha<33; alpha++){
-  ra8876lite.vsyncWait();
-  ra8876lite.bteMemoryCopyWithOpacity(
-    0,
-    ra8876lite.getCanvasWidth(),
-    FB_StartX, FB_StartY, //s0_x, s0_y
-    0,0,0,0,
-    0,
-    ra8876lite.getCanvasWidth(),
-    0,0,                  //des_x, des_y
-    ra8876lite.getCanvasWidth(),ra8876lite.getCanvasHeight(), //copy_width,copy_height
-    32-alpha);
-    delay (transition_time);
+  TRANSITION t;
+
+  ra8876lite.transitionBegin(&t, TRANSITION_CROSSFADE, FB_StartY, msec, 2*FB_StartY);
+  while(ra8876lite.transitionUpdate(&t)){
     #ifdef ESP8266
     yield();  //this is to avoid wdt reset in ESP8266
     #endif 
   }
 }
 
+/**
+ * @brief   Fade out the Main Window to a black screen.
+ */
 void  FB_fadeOut(uint16_t msec)
 {
-  uint16_t transition_time = msec/32;
-  
-  for(uint8_t alpha=0; alpha<33; alpha++){
-  ra8876lite.vsyncWait();
-  ra8876lite.bteMemoryCopyWithOpacity(
-    0,
-    ra8876lite.getCanvasWidth(),
-    FB_StartX, FB_StartY, //s0_x, s0_y
-    0,0,0,0,
-    0,
-    ra8876lite.getCanvasWidth(),
-    0,0,                  //des_x, des_y
-    ra8876lite.getCanvasWidth(),ra8876lite.getCanvasHeight(), //copy_width,copy_height
-    alpha);
-    delay (transition_time); 
+  TRANSITION t;
+
+  ra8876lite.transitionBegin(&t, TRANSITION_FADE_OUT, FB_StartY, msec, 2*FB_StartY, color.Black);
+  while(ra8876lite.transitionUpdate(&t)){
     #ifdef ESP8266
     yield();  //this is to avoid wdt reset in ESP8266
     #endif
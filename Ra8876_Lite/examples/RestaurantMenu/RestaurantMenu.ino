@@ -137,6 +137,7 @@ const   uint32_t FB_StartY_menuP = 3*480l;    //starting position for menu in po
 
 ///@note The array - courses[] define the strings that are going to appear on the restaurant menu for each course
 const   char* courses[] = {"Appetizer", "Salad", "Main Course", "Dessert"};
+static  BFC_TEXT_LAYOUT layout;               //each string is shaped once into this layout, then rendered without measuring again
 //starting position in y-direction for the word "Menu" when the monitor configured in Landscape (width=800, height=480)
 const   uint16_t MENU_StartY_menuL  = 18;
 //starting position in y-direction for "Menu" when it is in Portrait.
@@ -487,7 +488,7 @@ void FB_fill(uint32_t lnOffset)
 bool    decodeJsonMsg(String msg)
 {
   const char *dish;
-  uint16_t cursorX, cursorY;
+  uint16_t cursorY;
   //Reserve memory space for JSON object, inside the brackets MAX_JSON_LEN is the size of the pool in bytes,
   StaticJsonBuffer<MAX_JSON_LEN> jsonBuffer;
   //Deserialize incoming character array inChar[] with inChar modified by inserting string endings \0 & translate escaped characters (e.g. \n or \t)
@@ -525,11 +526,12 @@ bool    decodeJsonMsg(String msg)
         
         for(uint8_t i=0; i<4; i++)
         {
-              cursorX = (_width-ra8876lite.getBfcStringWidth(fontCoursesFilename, courses[i]))/2;
-              ///print "Appetizer"|"Salad"|"Main Course"|"Dessert"
-              ra8876lite.putBfcString(cursorX, cursorY, fontCoursesFilename, courses[i], color.Black, color.Transparent,_rotateCcw90,0);  
+              ///print "Appetizer"|"Salad"|"Main Course"|"Dessert" centered on the screen width
+              ra8876lite.layoutBfcText(&layout, fontCoursesFilename, courses[i], _width, 0, BFC_ALIGN_CENTER);
+              ra8876lite.drawBfcLayout(&layout, 0, cursorY, color.Black, color.Transparent,_rotateCcw90,0);
               //Serial.print("CursorY is "); Serial.print(cursorY); Serial.print(" ");Serial.println(courses[i]);
-              cursorY += ra8876lite.getBfcFontHeight(fontCoursesFilename);
+              uint16_t courseHeight = layout.lineHeight;
+              cursorY += layout.numLines*courseHeight;
               
               dish = (const char*) menuJson[courses[i]];
 
@@ -538,10 +540,12 @@ bool    decodeJsonMsg(String msg)
                   int iCount=StringSplit(String(dish), '\n', sParams, 5);
                   for(uint8_t j=0; j<iCount; j++)
                   {
-                    cursorX = (_width-ra8876lite.getBfcStringWidth(fontDishFilename, '(' + String(j+1) + ") " + sParams[j]))/2; 
-                    ra8876lite.putBfcString(cursorX, cursorY, fontDishFilename, '(' + String(j+1) + ") " + sParams[j], color.Black, color.Transparent,_rotateCcw90,0);                    
+                    ///a long dish wraps to the next line instead of running off the screen
+                    ra8876lite.layoutBfcText(&layout, fontDishFilename, '(' + String(j+1) + ") " + sParams[j], _width, 0, BFC_ALIGN_CENTER);
+                    ra8876lite.drawBfcLayout(&layout, 0, cursorY, color.Black, color.Transparent,_rotateCcw90,0);                    
                     //Serial.print("CursorY is "); Serial.print(cursorY); Serial.print(" ");Serial.println(sParams[j]);
-                    (j!=iCount-1)? cursorY += ra8876lite.getBfcFontHeight(fontDishFilename):cursorY += ra8876lite.getBfcFontHeight(fontCoursesFilename);  
+                    cursorY += (layout.numLines-1)*layout.lineHeight;
+                    (j!=iCount-1)? cursorY += layout.lineHeight:cursorY += courseHeight;  
                   }
               }//if(dish)
          }//for(uint8_t i=0; i<4; i++)
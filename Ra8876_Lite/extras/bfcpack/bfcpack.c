@@ -0,0 +1,810 @@
+/**
+ * @file    bfcpack.c
+ * @license BSD license, all text above and below must be included in any redistribution
+ *
+ * Host tool to convert a BitFontCreator font (*.c file from src/bfc or *.bin file from assets) into the packed
+ * font format of src/bfc/bfcPacked.h, drawn by Ra8876_Lite::putBfcPackedString().<br>
+ * This folder is not compiled by Arduino IDE.
+ *
+ * Build (Linux, macOS, MinGW):
+ *	cc -O2 -I../../src/bfc -o bfcpack bfcpack.c ../../src/bfc/bfcPacked.c ../../src/bfc/bfcFontMgr.c
+ *
+ * Usage:
+ *	bfcpack [options] <input.c|input.bin> <output.c|output.bin>
+ *	-b <bpp>		output bits per pixel 1, 2 or 4, default is the bpp of input (8bpp input is reduced to 4).
+ *					-b 1 makes every glyph a BTE color expansion block for the fastest rendering.
+ *	-r				encode empty rows inside a glyph as runs (BFCP_FLAG_RLE_ROWS)
+ *	-s <ranges>		keep a subset of characters only, e.g. -s 0x20-0x7E,0xA3,0x20AC
+ *	-k <file>		kerning pairs, one pair per line: <left> <right> <pixels>
+ *					left/right are numbers (0x41) or quoted characters ('A'), '#' starts a comment
+ *	-d <code>		character drawn for codes not in the font, default is the first character of the first range
+ *	-n <name>		array name of a *.c output, default is the input filename without extension
+ *
+ * Example:
+ *	bfcpack -b 1 -r -s 0x20-0x7E Lucida_Sans_Unicode16h_rowrowBig.c lucida16.c
+ *	A *.c output is copied to the sketch folder and drawn with
+ *	extern const unsigned char lucida16[];
+ *	ra8876lite.putBfcPackedString(10, 10, lucida16, "Hello", color.White, color.Transparent);
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "bfcFontMgr.h"
+#include "bfcPacked.h"
+
+#define MAX_GLYPHS		65536
+#define MAX_KERNS		16384
+#define RLE_MIN_GAP		8		/* min. bytes of empty rows to start a new run, a run costs 2 bytes and one BTE setup */
+
+typedef struct
+{
+	unsigned short	code;
+	unsigned short	width;
+	unsigned char	*pixels;	/* width*height pixel values at input bpp */
+} SRC_GLYPH;
+
+typedef struct
+{
+	unsigned short	left, right;
+	short			adjust;
+} KERN_PAIR;
+
+typedef struct
+{
+	unsigned short	first, last;
+} CODE_RANGE;
+
+static SRC_GLYPH	glyphs[MAX_GLYPHS];
+static int			numGlyphs;
+static int			fontHeight, fontBaseline, fontBpp;
+static unsigned long fontType;
+static unsigned long srcBytes;
+static long			defaultCode = -1;
+
+static KERN_PAIR	kerns[MAX_KERNS];
+static int			numKerns;
+
+static CODE_RANGE	subset[256];
+static int			numSubset;
+
+/*----------------------------------------------------------------------------------------------------------*/
+/* output buffer                                                                                            */
+/*----------------------------------------------------------------------------------------------------------*/
+static unsigned char *out;
+static unsigned long outSize, outCap;
+
+static void outByte(unsigned char b)
+{
+	if(outSize == outCap)
+	{
+		outCap = outCap ? outCap*2 : 65536;
+		out = (unsigned char *)realloc(out, outCap);
+		if(out == NULL) { fprintf(stderr, "out of memory\n"); exit(1); }
+	}
+	out[outSize++] = b;
+}
+
+static void outU16(unsigned int v)	{ outByte(v & 0xFF); outByte((v>>8) & 0xFF); }
+static void outU32(unsigned long v)	{ outU16(v & 0xFFFF); outU16((v>>16) & 0xFFFF); }
+static void outAlign4(void)			{ while(outSize & 3) outByte(0); }
+
+static void putU16(unsigned long at, unsigned int v)	{ out[at] = v & 0xFF; out[at+1] = (v>>8) & 0xFF; }
+static void putU32(unsigned long at, unsigned long v)	{ putU16(at, v & 0xFFFF); putU16(at+2, (v>>16) & 0xFFFF); }
+
+/*----------------------------------------------------------------------------------------------------------*/
+/* input                                                                                                    */
+/*----------------------------------------------------------------------------------------------------------*/
+static unsigned char *readFile(const char *name, long *pSize)
+{
+	FILE *fp = fopen(name, "rb");
+	unsigned char *buf;
+	long size;
+
+	if(fp == NULL) { fprintf(stderr, "cannot open %s\n", name); exit(1); }
+	fseek(fp, 0, SEEK_END);
+	size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	buf = (unsigned char *)malloc(size + 1);
+	if(buf == NULL || fread(buf, 1, size, fp) != (size_t)size) { fprintf(stderr, "cannot read %s\n", name); exit(1); }
+	buf[size] = 0;
+	fclose(fp);
+	*pSize = size;
+	return buf;
+}
+
+static int inSubset(unsigned short code)
+{
+	int i;
+
+	if(numSubset == 0)
+		return 1;
+	for(i = 0; i < numSubset; i++)
+		if(code >= subset[i].first && code <= subset[i].last)
+			return 1;
+	return 0;
+}
+
+/* unpack one BFC glyph (big endian, row based, row preferred, unpacked) into one byte per pixel */
+static void addGlyph(unsigned short code, unsigned short width, const unsigned char *data, unsigned long dataSize)
+{
+	int bytesPerLine = (width * fontBpp + 7) / 8;
+	int x, y, bit;
+	SRC_GLYPH *g;
+
+	srcBytes += dataSize + 8;
+	if(!inSubset(code))
+		return;
+	if(numGlyphs == MAX_GLYPHS) { fprintf(stderr, "too many characters\n"); exit(1); }
+	if((unsigned long)bytesPerLine * fontHeight > dataSize)
+	{
+		fprintf(stderr, "character 0x%04X: %lu bytes of data for %dx%d pixels\n", code, dataSize, width, fontHeight);
+		exit(1);
+	}
+
+	g = &glyphs[numGlyphs++];
+	g->code = code;
+	g->width = width;
+	g->pixels = (unsigned char *)calloc((size_t)width * fontHeight + 1, 1);
+	for(y = 0; y < fontHeight; y++)
+	{
+		for(x = 0; x < width; x++)
+		{
+			unsigned char b = data[y * bytesPerLine + (x * fontBpp) / 8];
+			bit = (x * fontBpp) % 8;
+			g->pixels[y * width + x] = (unsigned char)((b << bit) & 0xFF) >> (8 - fontBpp);
+		}
+	}
+}
+
+static unsigned int rdU16(const unsigned char *p)	{ return p[0] | (p[1] << 8); }
+static unsigned long rdU32(const unsigned char *p)	{ return rdU16(p) | ((unsigned long)rdU16(p+2) << 16); }
+
+/* *.bin: BFC_BIN_FONT header, NumRanges x BFC_BIN_CHARRANGE, then BFC_BIN_CHARINFO of all characters */
+static void loadBin(const char *name)
+{
+	long size;
+	unsigned char *buf = readFile(name, &size);
+	unsigned int numRanges, r;
+	unsigned long info;
+
+	if(size < 12) { fprintf(stderr, "%s is not a font\n", name); exit(1); }
+	fontType     = rdU32(buf);
+	fontHeight   = rdU16(buf+4);
+	fontBaseline = rdU16(buf+6);
+	numRanges    = rdU16(buf+10);
+	fontBpp      = GetFontBpp(fontType);
+	info = 12 + 4UL*numRanges;
+	if(fontBpp < 0) { fprintf(stderr, "%s: unknown font type 0x%08lX\n", name, fontType); exit(1); }
+
+	for(r = 0; r < numRanges; r++)
+	{
+		unsigned int first = rdU16(buf + 12 + 4*r);
+		unsigned int last  = rdU16(buf + 14 + 4*r);
+		unsigned int ch;
+
+		if(defaultCode < 0)
+			defaultCode = first;
+		for(ch = first; ch <= last; ch++, info += 8)
+		{
+			unsigned long off;
+			if(info + 8 > (unsigned long)size) { fprintf(stderr, "%s is truncated\n", name); exit(1); }
+			off = rdU32(buf + info + 4);
+			if(off + rdU16(buf + info + 2) > (unsigned long)size) { fprintf(stderr, "%s is truncated\n", name); exit(1); }
+			addGlyph((unsigned short)ch, rdU16(buf + info), buf + off, rdU16(buf + info + 2));
+		}
+	}
+}
+
+/* tokenizer for *.c fonts: an identifier or number, or a single punctuation character, comments skipped */
+static const char *src;
+
+static int nextToken(char *tok, int size)
+{
+	int n = 0;
+
+	for(;;)
+	{
+		while(isspace((unsigned char)*src))
+			src++;
+		if(src[0] == '/' && src[1] == '*')
+		{
+			const char *end = strstr(src+2, "*/");
+			src = end ? end+2 : src+strlen(src);
+		}
+		else if(src[0] == '/' && src[1] == '/')
+		{
+			while(*src && *src != '\n')
+				src++;
+		}
+		else
+			break;
+	}
+
+	if(*src == 0)
+		return 0;
+
+	if(isalnum((unsigned char)*src) || *src == '_')
+	{
+		while((isalnum((unsigned char)*src) || *src == '_') && n < size-1)
+			tok[n++] = *src++;
+	}
+	else
+		tok[n++] = *src++;
+	tok[n] = 0;
+	return n;
+}
+
+static void expect(const char *want)
+{
+	char tok[128];
+
+	if(!nextToken(tok, sizeof(tok)) || strcmp(tok, want) != 0)
+	{
+		fprintf(stderr, "parse error: expected '%s' but found '%s'\n", want, tok);
+		exit(1);
+	}
+}
+
+static long number(void)
+{
+	char tok[128];
+
+	if(!nextToken(tok, sizeof(tok)) || !isdigit((unsigned char)tok[0]))
+	{
+		fprintf(stderr, "parse error: expected a number but found '%s'\n", tok);
+		exit(1);
+	}
+	return strtol(tok, NULL, 0);
+}
+
+typedef struct
+{
+	char			name[128];
+	unsigned char	*data;
+	long			size;
+} C_ARRAY;
+
+typedef struct
+{
+	unsigned short	width, dataSize;
+	char			name[128];
+} C_CHARINFO;
+
+typedef struct
+{
+	unsigned short	first, last;
+	long			info;		/* index in C_CHARINFO[] */
+	char			name[128];
+} C_PROP;
+
+/* *.c: UCHAR arrays of pixel data, one BFC_CHARINFO array, BFC_FONT_PROP list, BFC_FONT header */
+static void loadC(const char *name)
+{
+	long size, numArrays = 0, numInfos = 0, numProps = 0, i, j;
+	char *text = (char *)readFile(name, &size);
+	C_ARRAY *arrays = (C_ARRAY *)calloc(MAX_GLYPHS, sizeof(C_ARRAY));
+	C_CHARINFO *infos = (C_CHARINFO *)calloc(MAX_GLYPHS, sizeof(C_CHARINFO));
+	C_PROP *props = (C_PROP *)calloc(1024, sizeof(C_PROP));
+	char tok[128], firstProp[128] = "";
+
+	src = text;
+	while(nextToken(tok, sizeof(tok)))
+	{
+		if(strcmp(tok, "UCHAR") == 0 || strcmp(tok, "char") == 0)
+		{
+			C_ARRAY *a;
+			if(!nextToken(tok, sizeof(tok)) || numArrays == MAX_GLYPHS)
+				break;
+			if(*src != '[' && !isspace((unsigned char)*src))
+				continue;
+			a = &arrays[numArrays];
+			strcpy(a->name, tok);
+			while(nextToken(tok, sizeof(tok)) && strcmp(tok, "{") != 0)
+				if(strcmp(tok, ";") == 0)
+					break;
+			if(strcmp(tok, "{") != 0)
+				continue;
+			a->data = (unsigned char *)malloc(65536);
+			while(nextToken(tok, sizeof(tok)) && strcmp(tok, "}") != 0)
+				if(isdigit((unsigned char)tok[0]) && a->size < 65536)
+					a->data[a->size++] = (unsigned char)strtol(tok, NULL, 0);
+			numArrays++;
+		}
+		else if(strcmp(tok, "BFC_CHARINFO") == 0)
+		{
+			nextToken(tok, sizeof(tok));
+			while(nextToken(tok, sizeof(tok)) && strcmp(tok, "{") != 0)
+				if(strcmp(tok, ";") == 0)
+					break;
+			if(strcmp(tok, "{") != 0)
+				continue;
+			while(nextToken(tok, sizeof(tok)) && strcmp(tok, "{") == 0 && numInfos < MAX_GLYPHS)
+			{
+				C_CHARINFO *c = &infos[numInfos++];
+				c->width = (unsigned short)number();
+				expect(",");
+				c->dataSize = (unsigned short)number();
+				expect(",");
+				expect("{");
+				nextToken(c->name, sizeof(c->name));
+				expect("}");
+				expect("}");
+				nextToken(tok, sizeof(tok));	/* ',' or '}' */
+				if(strcmp(tok, "}") == 0)
+					break;
+			}
+		}
+		else if(strcmp(tok, "BFC_FONT_PROP") == 0)
+		{
+			C_PROP *p;
+			char propName[128];
+			nextToken(propName, sizeof(propName));
+			nextToken(tok, sizeof(tok));
+			if(strcmp(tok, "=") != 0 || numProps == 1024)
+				continue;	/* declaration or a cast */
+			p = &props[numProps++];
+			strcpy(p->name, propName);
+			expect("{");
+			p->first = (unsigned short)number();
+			expect(",");
+			p->last = (unsigned short)number();
+			expect(",");
+			expect("&");
+			nextToken(tok, sizeof(tok));
+			expect("[");
+			p->info = number();
+			expect("]");
+		}
+		else if(strcmp(tok, "BFC_FONT") == 0)
+		{
+			nextToken(tok, sizeof(tok));
+			nextToken(tok, sizeof(tok));
+			if(strcmp(tok, "=") != 0)
+				continue;
+			expect("{");
+			fontType = (unsigned long)number();
+			expect(",");
+			fontHeight = (int)number();
+			expect(",");
+			fontBaseline = (int)number();
+			expect(",");
+			number();
+			expect(",");
+			expect("{");
+			expect("&");
+			nextToken(firstProp, sizeof(firstProp));
+		}
+	}
+
+	fontBpp = GetFontBpp(fontType);
+	if(fontHeight == 0 || fontBpp < 0 || numProps == 0)
+	{
+		fprintf(stderr, "%s: BFC_FONT, BFC_FONT_PROP or BFC_CHARINFO not found\n", name);
+		exit(1);
+	}
+
+	for(i = 0; i < numProps; i++)
+	{
+		C_PROP *p = &props[i];
+		unsigned int ch;
+
+		if(defaultCode < 0 && strcmp(p->name, firstProp) == 0)
+			defaultCode = p->first;
+		for(ch = p->first; ch <= p->last; ch++)
+		{
+			C_CHARINFO *c;
+			long k = p->info + (ch - p->first);
+
+			if(k >= numInfos) { fprintf(stderr, "%s: %s exceeds BFC_CHARINFO array\n", name, p->name); exit(1); }
+			c = &infos[k];
+			for(j = 0; j < numArrays; j++)
+				if(strcmp(arrays[j].name, c->name) == 0)
+					break;
+			if(j == numArrays) { fprintf(stderr, "%s: array %s not found\n", name, c->name); exit(1); }
+			addGlyph((unsigned short)ch, c->width, arrays[j].data, (unsigned long)arrays[j].size);
+		}
+	}
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+/* kerning and subset                                                                                       */
+/*----------------------------------------------------------------------------------------------------------*/
+static int parseCode(const char **p, long *pCode)
+{
+	char *end;
+
+	while(isspace((unsigned char)**p))
+		(*p)++;
+	if(**p == '\'' && (*p)[1] && (*p)[2] == '\'')
+	{
+		*pCode = (unsigned char)(*p)[1];
+		*p += 3;
+		return 1;
+	}
+	*pCode = strtol(*p, &end, 0);
+	if(end == *p)
+		return 0;
+	*p = end;
+	return 1;
+}
+
+static void parseSubset(const char *arg)
+{
+	long first, last;
+
+	while(*arg)
+	{
+		if(!parseCode(&arg, &first) || numSubset == 256) { fprintf(stderr, "bad -s %s\n", arg); exit(1); }
+		last = first;
+		if(*arg == '-')
+		{
+			arg++;
+			if(!parseCode(&arg, &last)) { fprintf(stderr, "bad -s %s\n", arg); exit(1); }
+		}
+		subset[numSubset].first = (unsigned short)first;
+		subset[numSubset].last  = (unsigned short)last;
+		numSubset++;
+		if(*arg == ',')
+			arg++;
+	}
+}
+
+static void loadKerning(const char *name)
+{
+	long size, left, right, adjust;
+	char *text = (char *)readFile(name, &size);
+	const char *line = text;
+
+	while(*line)
+	{
+		const char *p = line;
+		const char *next = strchr(line, '\n');
+		next = next ? next+1 : line+strlen(line);
+
+		if(parseCode(&p, &left) && parseCode(&p, &right) && parseCode(&p, &adjust) && numKerns < MAX_KERNS)
+		{
+			kerns[numKerns].left = (unsigned short)left;
+			kerns[numKerns].right = (unsigned short)right;
+			kerns[numKerns].adjust = (short)adjust;
+			numKerns++;
+		}
+		else
+		{
+			while(p < next && isspace((unsigned char)*p))
+				p++;
+			if(p < next && *p != '#')
+				fprintf(stderr, "%s: line ignored: %.*s", name, (int)(next-line), line);
+		}
+		line = next;
+	}
+}
+
+static int findGlyph(unsigned short code)
+{
+	int i;
+
+	for(i = 0; i < numGlyphs; i++)
+		if(glyphs[i].code == code)
+			return i;
+	return -1;
+}
+
+static int cmpKern(const void *a, const void *b)
+{
+	const KERN_PAIR *ka = (const KERN_PAIR *)a, *kb = (const KERN_PAIR *)b;
+	unsigned long pa = ((unsigned long)ka->left << 16) | ka->right;
+	unsigned long pb = ((unsigned long)kb->left << 16) | kb->right;
+
+	return (pa > pb) - (pa < pb);
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+/* packing                                                                                                  */
+/*----------------------------------------------------------------------------------------------------------*/
+static int outBpp;
+
+/* value of pixel (x,y) at output bpp, rounded from input bpp */
+static unsigned char pixelAt(const SRC_GLYPH *g, int x, int y)
+{
+	unsigned int inMax = (1U << fontBpp) - 1, outMax = (1U << outBpp) - 1;
+	unsigned int v = g->pixels[y * g->width + x];
+
+	return (unsigned char)((v * outMax + inMax/2) / inMax);
+}
+
+static int rowEmpty(const SRC_GLYPH *g, int y)
+{
+	int x;
+
+	for(x = 0; x < g->width; x++)
+		if(pixelAt(g, x, y))
+			return 0;
+	return 1;
+}
+
+/* one row padded to a multiple of 8 pixels, pixels packed MSB first */
+static void outRow(const SRC_GLYPH *g, int y, int pitch)
+{
+	int i, x = 0, b;
+
+	for(i = 0; i < pitch; i++)
+	{
+		unsigned char byte = 0;
+		for(b = 8 - outBpp; b >= 0; b -= outBpp, x++)
+			if(x < g->width)
+				byte |= pixelAt(g, x, y) << b;
+		outByte(byte);
+	}
+}
+
+static void pack(int rle)
+{
+	unsigned long hashAt, glyphAt, dataAt;
+	unsigned int hashBits = 1, hashSize, i, k;
+	int g;
+
+	while((1U << hashBits) < 2U * (unsigned)numGlyphs && hashBits < 15)
+		hashBits++;
+	hashSize = 1U << hashBits;
+
+	/* header, DataSize is filled in last */
+	outU32(BFCP_MAGIC);
+	outByte(BFCP_VERSION);
+	outByte((unsigned char)outBpp);
+	outByte(rle ? BFCP_FLAG_RLE_ROWS : 0);
+	outByte((unsigned char)hashBits);
+	outU16(fontHeight);
+	outU16(fontBaseline);
+	outU16(numGlyphs);
+	outU16(numKerns);
+	g = defaultCode >= 0 ? findGlyph((unsigned short)defaultCode) : -1;
+	outU16(g >= 0 ? g : 0);
+	outU16(0);
+	outU32(0);
+
+	/* hash table with linear probing */
+	hashAt = outSize;
+	for(i = 0; i < hashSize; i++)
+		outU16(BFCP_NO_GLYPH);
+	for(g = 0; g < numGlyphs; g++)
+	{
+		unsigned int slot = BfcpHash(glyphs[g].code, (unsigned char)hashBits);
+		while(rdU16(out + hashAt + 2*slot) != BFCP_NO_GLYPH)
+			slot = (slot + 1) & (hashSize - 1);
+		putU16(hashAt + 2*slot, g);
+	}
+	outAlign4();
+
+	/* glyph table, Offset, Top, Rows and Flags are filled in with bitmap data */
+	glyphAt = outSize;
+	for(g = 0; g < numGlyphs; g++)
+	{
+		outU16(glyphs[g].code);
+		outU16(glyphs[g].width);
+		outU32(0);
+		outByte((unsigned char)(((glyphs[g].width + 7) / 8) * outBpp));
+		outByte(0);
+		outByte(0);
+		outByte(0);
+	}
+
+	for(k = 0; k < (unsigned)numKerns; k++)
+	{
+		outU16(kerns[k].left);
+		outU16(kerns[k].right);
+		outU16((unsigned short)kerns[k].adjust);
+		g = findGlyph(kerns[k].left);
+		out[glyphAt + (unsigned long)g * BFCP_GLYPH_SIZE + 11] |= BFCP_GLYPH_KERN;
+	}
+	outAlign4();
+
+	/* bitmap data: empty rows above and below are never stored, with rle empty rows inside become a skip count */
+	dataAt = outSize;
+	for(g = 0; g < numGlyphs; g++)
+	{
+		const SRC_GLYPH *pg = &glyphs[g];
+		unsigned long entry = glyphAt + (unsigned long)g * BFCP_GLYPH_SIZE;
+		int pitch = ((pg->width + 7) / 8) * outBpp;
+		int top = 0, bottom = fontHeight - 1, y;
+
+		while(top < fontHeight && rowEmpty(pg, top))
+			top++;
+		while(bottom >= top && rowEmpty(pg, bottom))
+			bottom--;
+		if(top > bottom)
+		{
+			top = 0;		/* blank glyph like space, Rows = 0 */
+			bottom = -1;
+		}
+
+		putU32(entry + 4, outSize - dataAt);
+		out[entry + 9]  = (unsigned char)top;
+		out[entry + 10] = (unsigned char)(bottom - top + 1);
+
+		if(!rle)
+		{
+			for(y = top; y <= bottom; y++)
+				outRow(pg, y, pitch);
+			continue;
+		}
+
+		y = top;
+		while(y <= bottom)
+		{
+			int skip = 0, count = 0, gap;
+
+			while(rowEmpty(pg, y))
+				y++, skip++;
+			/* extend the run over short gaps, a new run only pays off for RLE_MIN_GAP bytes of empty rows */
+			while(y + count <= bottom)
+			{
+				if(!rowEmpty(pg, y + count))
+				{
+					count++;
+					continue;
+				}
+				for(gap = 0; rowEmpty(pg, y + count + gap); gap++)
+					;
+				if(gap * pitch >= RLE_MIN_GAP || y + count + gap > bottom)
+					break;
+				count += gap;
+			}
+			if(skip > 255 || count > 255)
+			{
+				fprintf(stderr, "character 0x%04X too tall for a run\n", pg->code);
+				exit(1);
+			}
+			outByte((unsigned char)skip);
+			outByte((unsigned char)count);
+			for(; count > 0; count--, y++)
+				outRow(pg, y, pitch);
+		}
+	}
+	putU32(20, outSize - dataAt);
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+/* output                                                                                                   */
+/*----------------------------------------------------------------------------------------------------------*/
+static int endsWith(const char *s, const char *ext)
+{
+	size_t n = strlen(s), m = strlen(ext);
+	return n >= m && strcmp(s + n - m, ext) == 0;
+}
+
+static void writeC(FILE *fp, const char *arrayName, const char *inName)
+{
+	unsigned long i;
+
+	const char *base = strrchr(inName, '/');
+
+	fprintf(fp, "/*\n * Packed font converted by bfcpack from %s\n", base ? base+1 : inName);
+	fprintf(fp, " * Font height: %d, baseline: %d, bpp: %d, characters: %d, kerning pairs: %d\n",
+			fontHeight, fontBaseline, outBpp, numGlyphs, numKerns);
+	fprintf(fp, " * Format: src/bfc/bfcPacked.h\n */\n\n");
+	fprintf(fp, "extern const unsigned char %s[%lu];\n\n", arrayName, outSize);
+	fprintf(fp, "const unsigned char %s[%lu] = {", arrayName, outSize);
+	for(i = 0; i < outSize; i++)
+		fprintf(fp, "%s0x%02X%s", (i % 16) ? " " : "\n  ", out[i], (i + 1 < outSize) ? "," : "");
+	fprintf(fp, "\n};\n");
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: bfcpack [-b bpp] [-r] [-s ranges] [-k kerning.txt] [-d code] [-n name] <input.c|.bin> <output.c|.bin>\n");
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *inName = NULL, *outName = NULL, *kernName = NULL, *arrayName = NULL;
+	char nameBuf[128];
+	int rle = 0, i, k;
+	FILE *fp;
+
+	for(i = 1; i < argc; i++)
+	{
+		if(argv[i][0] == '-' && argv[i][1] && argv[i][2] == 0)
+		{
+			char opt = argv[i][1];
+			if(opt == 'r') { rle = 1; continue; }
+			if(i + 1 >= argc) usage();
+			switch(opt)
+			{
+				case 'b': outBpp = atoi(argv[++i]); break;
+				case 's': parseSubset(argv[++i]); break;
+				case 'k': kernName = argv[++i]; break;
+				case 'd': defaultCode = strtol(argv[++i], NULL, 0); break;
+				case 'n': arrayName = argv[++i]; break;
+				default: usage();
+			}
+		}
+		else if(inName == NULL)
+			inName = argv[i];
+		else if(outName == NULL)
+			outName = argv[i];
+		else
+			usage();
+	}
+	if(inName == NULL || outName == NULL)
+		usage();
+	if(outBpp != 0 && outBpp != 1 && outBpp != 2 && outBpp != 4)
+	{
+		fprintf(stderr, "-b must be 1, 2 or 4\n");
+		return 1;
+	}
+
+	if(endsWith(inName, ".bin") || endsWith(inName, ".BIN"))
+		loadBin(inName);
+	else
+		loadC(inName);
+
+	if(numGlyphs == 0 || fontHeight > 255)
+	{
+		fprintf(stderr, "%s: no characters to convert or font height above 255\n", inName);
+		return 1;
+	}
+	if(outBpp == 0 || outBpp > fontBpp)
+		outBpp = fontBpp > 4 ? 4 : fontBpp;
+	for(i = 0; i < numGlyphs; i++)
+	{
+		if(((glyphs[i].width + 7) / 8) * outBpp > 255)
+		{
+			fprintf(stderr, "character 0x%04X is too wide\n", glyphs[i].code);
+			return 1;
+		}
+	}
+
+	if(kernName)
+	{
+		loadKerning(kernName);
+		qsort(kerns, numKerns, sizeof(KERN_PAIR), cmpKern);
+		/* drop pairs of characters not in the font and duplicates */
+		for(i = 0, k = 0; i < numKerns; i++)
+		{
+			if(findGlyph(kerns[i].left) < 0 || findGlyph(kerns[i].right) < 0)
+				continue;
+			if(k > 0 && kerns[k-1].left == kerns[i].left && kerns[k-1].right == kerns[i].right)
+				continue;
+			kerns[k++] = kerns[i];
+		}
+		numKerns = k;
+	}
+
+	pack(rle);
+
+	if(endsWith(outName, ".c") || endsWith(outName, ".h"))
+	{
+		if(arrayName == NULL)
+		{
+			const char *base = strrchr(inName, '/');
+			char *dot;
+			base = base ? base+1 : inName;
+			snprintf(nameBuf, sizeof(nameBuf), "bfcp_%s", base);
+			dot = strrchr(nameBuf, '.');
+			if(dot)
+				*dot = 0;
+			for(dot = nameBuf; *dot; dot++)
+				if(!isalnum((unsigned char)*dot))
+					*dot = '_';
+			arrayName = nameBuf;
+		}
+		fp = fopen(outName, "w");
+		if(fp == NULL) { fprintf(stderr, "cannot create %s\n", outName); return 1; }
+		writeC(fp, arrayName, inName);
+	}
+	else
+	{
+		fp = fopen(outName, "wb");
+		if(fp == NULL) { fprintf(stderr, "cannot create %s\n", outName); return 1; }
+		fwrite(out, 1, outSize, fp);
+	}
+	fclose(fp);
+
+	printf("%s: %d characters, %d bpp -> %d bpp, %d kerning pairs, %lu bytes -> %lu bytes\n",
+			inName, numGlyphs, fontBpp, outBpp, numKerns, srcBytes, outSize);
+	return 0;
+}
@@ -0,0 +1,260 @@
+/**
+ * @file    edidtest.c
+ * @license BSD license, all text above and below must be included in any redistribution
+ *
+ * Host test of the EDID parser in src/edid: decodes 256-byte EDID dumps (base block + one CEA-861 extension)
+ * and checks the short video descriptors (SVD) with their native flags, HDMI vendor specific data block (VSDB)
+ * detection and the detailed timing descriptors (DTD) of both blocks.<br>
+ * This folder is not compiled by Arduino IDE.
+ *
+ * Build (Linux, macOS, MinGW):
+ *	cc -O2 -I../../src/edid -o edidtest edidtest.c ../../src/edid/edid.c -lm
+ *
+ * Usage:
+ *	edidtest					run the checks on the two dumps below, return 0 if all passed
+ *	edidtest <edid.bin> ...		also print what is decoded from captured dumps, e.g. a copy of
+ *								/sys/class/drm/card0-HDMI-A-1/edid on Linux
+ *
+ * The two dumps below follow the byte layout of a 1080p HDMI TV and of a 1366x768 DVI monitor with a CEA-861
+ * extension. Headers and checksums are valid, so they are decoded exactly like the EDID read by CH703X::readEdid().
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "edid.h"
+
+/* 1080p HDMI TV
+ * base block : DTD 1920x1080p 148.5MHz (preferred), DTD 1280x720p 74.25MHz, name "HDMI TV", range limits
+ * CEA rev 3  : underscan, basic audio, YCbCr 4:4:4/4:2:2, 1 native DTD
+ *              video block VIC 16 (native), 4, 3, 5, 31, 19, 2; audio block; speaker block; HDMI VSDB 00-0C-03 phy 1.0.0.0
+ *              DTD 1920x1080i 74.25MHz, DTD 1280x720p50 74.25MHz
+ */
+static const unsigned char edid_hdmi_tv[256] =
+{
+	0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x52, 0x99, 0x80, 0x10, 0x45, 0x23, 0x01, 0x00,
+	0x14, 0x1c, 0x01, 0x03, 0x80, 0x66, 0x39, 0x78, 0x0a, 0xee, 0x91, 0xa3, 0x54, 0x4c, 0x99, 0x26,
+	0x0f, 0x50, 0x54, 0x21, 0x08, 0x00, 0x81, 0xc0, 0x81, 0x80, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02, 0x3a, 0x80, 0x18, 0x71, 0x38, 0x2d, 0x40, 0x58, 0x2c,
+	0x45, 0x00, 0xfa, 0x3d, 0x32, 0x00, 0x00, 0x1e, 0x01, 0x1d, 0x00, 0x72, 0x51, 0xd0, 0x1e, 0x20,
+	0x6e, 0x28, 0x55, 0x00, 0xfa, 0x3d, 0x32, 0x00, 0x00, 0x1e, 0x00, 0x00, 0x00, 0xfc, 0x00, 0x48,
+	0x44, 0x4d, 0x49, 0x20, 0x54, 0x56, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x00, 0x00, 0x00, 0xfd,
+	0x00, 0x17, 0x3d, 0x0f, 0x44, 0x0f, 0x00, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x01, 0xf7,
+	0x02, 0x03, 0x1a, 0xf1, 0x47, 0x90, 0x04, 0x03, 0x05, 0x1f, 0x13, 0x02, 0x23, 0x09, 0x07, 0x07,
+	0x83, 0x01, 0x00, 0x00, 0x65, 0x03, 0x0c, 0x00, 0x10, 0x00, 0x01, 0x1d, 0x80, 0x18, 0x71, 0x1c,
+	0x16, 0x20, 0x58, 0x2c, 0x25, 0x00, 0xfa, 0x3d, 0x32, 0x00, 0x00, 0x9e, 0x01, 0x1d, 0x00, 0xbc,
+	0x52, 0xd0, 0x1e, 0x20, 0xb8, 0x28, 0x55, 0x40, 0xfa, 0x3d, 0x32, 0x00, 0x00, 0x1e, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x38,
+};
+
+/* 1366x768 DVI monitor
+ * base block : DTD 1366x768p 85.5MHz (preferred), DTD 1280x720p 74.25MHz, name "DVI 1366", range limits
+ * CEA rev 3  : no audio, 1 native DTD
+ *              video block VIC 4 (native), 16, 97 (not in cea_vic_timing()), 1, 193 (bit 7 set but not a native flag);
+ *              no HDMI VSDB
+ *              DTD 1280x720p 74.25MHz
+ */
+static const unsigned char edid_dvi_monitor[256] =
+{
+	0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x52, 0x99, 0x68, 0x07, 0x90, 0x78, 0x06, 0x00,
+	0x07, 0x19, 0x01, 0x03, 0x80, 0x29, 0x17, 0x78, 0x0a, 0xee, 0x91, 0xa3, 0x54, 0x4c, 0x99, 0x26,
+	0x0f, 0x50, 0x54, 0x21, 0x08, 0x00, 0x81, 0xc0, 0x81, 0x80, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x66, 0x21, 0x56, 0xaa, 0x51, 0x00, 0x1e, 0x30, 0x46, 0x8f,
+	0x33, 0x00, 0x9a, 0xe6, 0x10, 0x00, 0x00, 0x1e, 0x01, 0x1d, 0x00, 0x72, 0x51, 0xd0, 0x1e, 0x20,
+	0x6e, 0x28, 0x55, 0x00, 0xfa, 0x3d, 0x32, 0x00, 0x00, 0x1e, 0x00, 0x00, 0x00, 0xfc, 0x00, 0x44,
+	0x56, 0x49, 0x20, 0x31, 0x33, 0x36, 0x36, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x00, 0x00, 0x00, 0xfd,
+	0x00, 0x17, 0x3d, 0x0f, 0x44, 0x0f, 0x00, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x01, 0x79,
+	0x02, 0x03, 0x0a, 0x01, 0x45, 0x84, 0x10, 0x61, 0x01, 0xc1, 0x01, 0x1d, 0x00, 0x72, 0x51, 0xd0,
+	0x1e, 0x20, 0x6e, 0x28, 0x55, 0x00, 0xfa, 0x3d, 0x32, 0x00, 0x00, 0x1e, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x93,
+};
+
+static int failures = 0;
+
+#define CHECK(cond)	do { if(!(cond)) { printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); failures++; } } while(0)
+
+static void checkDtd(const DetailedTiming *d, int pclk, int w, int h, int interlaced)
+{
+	CHECK(d->pixel_clock == pclk);
+	CHECK(d->h_addr == w);
+	CHECK(d->v_addr == h);
+	CHECK(d->interlaced == interlaced);
+}
+
+static void printEdid(const char *name, const unsigned char *edid, int size)
+{
+	MonitorInfo *info = decode_edid(edid);
+	CeaInfo cea;
+	int i;
+
+	printf("%s:\n", name);
+	if(info==NULL)
+	{
+		printf("  bad EDID header\n");
+		return;
+	}
+	printf("  %s 0x%04x \"%s\", checksum %s, %d extension(s)\n", info->manufacturer_code, info->product_code,
+		info->dsc_product_name, info->checksum? "bad" : "ok", edid[0x7E]);
+	for(i=0; i<info->n_detailed_timings; i++)
+		printf("  DTD  %dx%d%s %d.%02dMHz\n", info->detailed_timings[i].h_addr, info->detailed_timings[i].v_addr,
+			info->detailed_timings[i].interlaced? "i" : "p", info->detailed_timings[i].pixel_clock/1000000,
+			(info->detailed_timings[i].pixel_clock/10000)%100);
+	free(info);
+
+	if(size < 256 || edid[0x7E]==0)
+		return;
+	if(!decode_cea_extension(edid+128, &cea))
+	{
+		printf("  extension is not CEA-861 or its checksum is bad\n");
+		return;
+	}
+	printf("  CEA rev %d, %s, %d native DTD(s)\n", cea.revision, cea.hdmi? "HDMI" : "DVI", cea.n_native_dtds);
+	for(i=0; i<cea.n_svd; i++)
+	{
+		DetailedTiming t;
+		if(cea_vic_timing(cea.svd[i], &t))
+			printf("  SVD  VIC %d%s %dx%d%s\n", cea.svd[i], cea.svd_native[i]? " native" : "", t.h_addr,
+				t.interlaced? t.v_addr*2 : t.v_addr, t.interlaced? "i" : "p");
+		else
+			printf("  SVD  VIC %d%s (unknown)\n", cea.svd[i], cea.svd_native[i]? " native" : "");
+	}
+	for(i=0; i<cea.n_detailed_timings; i++)
+		printf("  DTD  %dx%d%s %d.%02dMHz\n", cea.detailed_timings[i].h_addr, cea.detailed_timings[i].v_addr,
+			cea.detailed_timings[i].interlaced? "i" : "p", cea.detailed_timings[i].pixel_clock/1000000,
+			(cea.detailed_timings[i].pixel_clock/10000)%100);
+}
+
+static void testHdmiTv(void)
+{
+	static const unsigned char vic[] = {16, 4, 3, 5, 31, 19, 2};
+	MonitorInfo *info = decode_edid(edid_hdmi_tv);
+	CeaInfo cea;
+	int i;
+
+	printf("edid_hdmi_tv\n");
+	CHECK(info != NULL);
+	if(info==NULL)
+		return;
+	CHECK(info->checksum == 0);				/* byte sum of the base block */
+	CHECK(strcmp(info->manufacturer_code, "TTY")==0);
+	CHECK(strcmp(info->dsc_product_name, "HDMI TV")==0);
+	CHECK(info->n_detailed_timings == 2);
+	checkDtd(&info->detailed_timings[0], 148500000, 1920, 1080, 0);
+	checkDtd(&info->detailed_timings[1],  74250000, 1280,  720, 0);
+	free(info);
+
+	CHECK(decode_cea_extension(edid_hdmi_tv+128, &cea));
+	CHECK(cea.revision == 3);
+	CHECK(cea.underscan && cea.basic_audio && cea.ycbcr444 && cea.ycbcr422);
+	CHECK(cea.n_native_dtds == 1);
+	CHECK(cea.hdmi);
+	CHECK(cea.n_svd == (int)sizeof(vic));
+	for(i=0; i<cea.n_svd && i<(int)sizeof(vic); i++)
+	{
+		CHECK(cea.svd[i] == vic[i]);
+		CHECK(cea.svd_native[i] == (i==0));
+	}
+	CHECK(cea.n_detailed_timings == 2);
+	/* v_addr is per field for an interlaced DTD */
+	checkDtd(&cea.detailed_timings[0], 74250000, 1920, 540, 1);
+	checkDtd(&cea.detailed_timings[1], 74250000, 1280, 720, 0);
+	CHECK(cea.detailed_timings[1].h_blank == 700);
+	CHECK(cea.detailed_timings[1].h_front_porch == 440);
+}
+
+static void testDviMonitor(void)
+{
+	static const unsigned char vic[] = {4, 16, 97, 1, 193};
+	MonitorInfo *info = decode_edid(edid_dvi_monitor);
+	CeaInfo cea;
+	DetailedTiming t;
+	int i;
+
+	printf("edid_dvi_monitor\n");
+	CHECK(info != NULL);
+	if(info==NULL)
+		return;
+	CHECK(info->checksum == 0);				/* byte sum of the base block */
+	CHECK(strcmp(info->dsc_product_name, "DVI 1366")==0);
+	CHECK(info->n_detailed_timings == 2);
+	checkDtd(&info->detailed_timings[0], 85500000, 1366, 768, 0);
+	CHECK(info->detailed_timings[0].h_blank == 426);
+	CHECK(info->detailed_timings[0].h_sync == 143);
+	CHECK(info->detailed_timings[0].v_front_porch == 3);
+	free(info);
+
+	CHECK(decode_cea_extension(edid_dvi_monitor+128, &cea));
+	CHECK(cea.revision == 3);
+	CHECK(!cea.basic_audio);
+	CHECK(!cea.hdmi);
+	CHECK(cea.n_svd == (int)sizeof(vic));
+	for(i=0; i<cea.n_svd && i<(int)sizeof(vic); i++)
+	{
+		CHECK(cea.svd[i] == vic[i]);
+		CHECK(cea.svd_native[i] == (i==0));
+	}
+	CHECK(cea_vic_timing(cea.svd[0], &t));
+	checkDtd(&t, 74250000, 1280, 720, 0);
+	CHECK(!cea_vic_timing(cea.svd[2], &t));
+	CHECK(cea.n_detailed_timings == 1);
+	checkDtd(&cea.detailed_timings[0], 74250000, 1280, 720, 0);
+}
+
+static void testBadBlocks(void)
+{
+	unsigned char edid[256];
+	CeaInfo cea;
+
+	printf("bad blocks\n");
+	memcpy(edid, edid_hdmi_tv, sizeof(edid));
+	edid[128+0x10] ^= 0x01;						/* one bit flipped in the CEA block */
+	CHECK(!decode_cea_extension(edid+128, &cea));
+
+	memcpy(edid, edid_hdmi_tv, sizeof(edid));
+	edid[128] = 0x10;							/* VTB extension tag */
+	edid[255] -= 0x10 - 0x02;
+	CHECK(!decode_cea_extension(edid+128, &cea));
+
+	memcpy(edid, edid_hdmi_tv, sizeof(edid));
+	edid[1] = 0x00;								/* broken header */
+	CHECK(decode_edid(edid) == NULL);
+}
+
+int main(int argc, char *argv[])
+{
+	int i;
+
+	testHdmiTv();
+	testDviMonitor();
+	testBadBlocks();
+	printf("%s, %d check(s) failed\n", failures? "FAILED" : "passed", failures);
+
+	for(i=1; i<argc; i++)
+	{
+		unsigned char edid[256];
+		int size;
+		FILE *fp = fopen(argv[i], "rb");
+
+		if(fp==NULL)
+		{
+			printf("%s: cannot open\n", argv[i]);
+			continue;
+		}
+		memset(edid, 0, sizeof(edid));
+		size = (int)fread(edid, 1, sizeof(edid), fp);
+		fclose(fp);
+		if(size < 128)
+			printf("%s: %d bytes, an EDID block is 128 bytes\n", argv[i], size);
+		else
+			printEdid(argv[i], edid, size);
+	}
+	return failures? 1 : 0;
+}
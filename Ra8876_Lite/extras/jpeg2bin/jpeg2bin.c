@@ -0,0 +1,151 @@
+/**
+ * @file    jpeg2bin.c
+ * @license BSD license, all text above and below must be included in any redistribution
+ *
+ * Host tool to decode a baseline JPEG file with the decoder of the library (src/jpeg/jpegDec.c), the same code
+ * run by Ra8876_Lite::putJpeg() on the MCU.<br>
+ * The output is a RAiO *.bin picture for putPicture()/canvasWrite(), or a *.ppm file to check the decoder on a PC.
+ * The file is read through the read callback and a strip buffer of one MCU row, as it is on the MCU.<br>
+ * This folder is not compiled by Arduino IDE.
+ *
+ * Build (Linux, macOS, MinGW):
+ *	cc -O2 -I../../src/jpeg -o jpeg2bin jpeg2bin.c ../../src/jpeg/jpegDec.c
+ *
+ * Usage:
+ *	jpeg2bin [options] <input.jpg> <output.bin|output.ppm>
+ *	-s <scale>		0, 1, 2 or 3 to scale the picture by 1/1, 1/2, 1/4 or 1/8, default is 0
+ *	-b <bytes>		bytes per pixel 1, 2 or 3 of a *.bin output (RGB332, RGB565, BGR888), default is 2
+ *
+ * Example:
+ *	jpeg2bin -s 1 ../../assets/kiss.jpg kiss_half.ppm
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "jpegDec.h"
+
+static JPEG_DEC		dec;
+static unsigned char *image;		/* whole picture at the output format */
+static int			outW, outH, outBytes;
+static unsigned long numStrips;
+
+/*----------------------------------------------------------------------------------------------------------*/
+/* decoder callbacks                                                                                        */
+/*----------------------------------------------------------------------------------------------------------*/
+static int readFile(void *user, uint8_t *buf, int size)
+{
+	return (int)fread(buf, 1, size, (FILE *)user);
+}
+
+static int drawStrip(void *user, uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint8_t *pixels)
+{
+	int row;
+
+	(void)user;
+	for(row = 0; row < h; row++)
+		memcpy(image + ((unsigned long)(y + row) * outW + x) * outBytes, pixels + (unsigned long)row * w * outBytes, (size_t)w * outBytes);
+	numStrips++;
+	return 0;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+/* output                                                                                                   */
+/*----------------------------------------------------------------------------------------------------------*/
+static int endsWith(const char *s, const char *ext)
+{
+	size_t n = strlen(s), m = strlen(ext);
+	return n >= m && strcmp(s + n - m, ext) == 0;
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: jpeg2bin [-s scale] [-b bytes_per_pixel] <input.jpg> <output.bin|.ppm>\n");
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *inName = NULL, *outName = NULL;
+	int scale = 0, bytes = 2, ppm, ret, i;
+	unsigned long stripSize;
+	unsigned char *strip;
+	FILE *fp;
+
+	for(i = 1; i < argc; i++)
+	{
+		if(argv[i][0] == '-' && argv[i][1] && argv[i][2] == 0)
+		{
+			char opt = argv[i][1];
+			if(i + 1 >= argc) usage();
+			switch(opt)
+			{
+				case 's': scale = atoi(argv[++i]); break;
+				case 'b': bytes = atoi(argv[++i]); break;
+				default: usage();
+			}
+		}
+		else if(inName == NULL)
+			inName = argv[i];
+		else if(outName == NULL)
+			outName = argv[i];
+		else
+			usage();
+	}
+	if(inName == NULL || outName == NULL)
+		usage();
+	if(scale < 0 || scale > 3 || bytes < 1 || bytes > 3)
+	{
+		fprintf(stderr, "-s must be 0 to 3 and -b 1 to 3\n");
+		return 1;
+	}
+	ppm = endsWith(outName, ".ppm") || endsWith(outName, ".PPM");
+	outBytes = ppm ? JPEG_OUT_RGB888 : bytes;
+
+	fp = fopen(inName, "rb");
+	if(fp == NULL) { fprintf(stderr, "cannot open %s\n", inName); return 1; }
+	ret = JpegOpen(&dec, NULL, 0, readFile, fp);
+	if(ret == JPEG_ERR_UNSUPPORTED)
+	{
+		fprintf(stderr, "%s: not a baseline JPEG, convert it with jpegtran -optimize first\n", inName);
+		return 1;
+	}
+	if(ret != JPEG_OK)
+	{
+		fprintf(stderr, "%s: not a JPEG file\n", inName);
+		return 1;
+	}
+
+	outW = JPEG_SCALED(dec.width, scale);
+	outH = JPEG_SCALED(dec.height, scale);
+	image = (unsigned char *)calloc((size_t)outW * outH, outBytes);
+	stripSize = (unsigned long)dec.mcusX * ((8*dec.hmax) >> scale) * ((8*dec.vmax) >> scale) * outBytes;
+	strip = (unsigned char *)malloc(stripSize);
+	if(image == NULL || strip == NULL) { fprintf(stderr, "out of memory\n"); return 1; }
+
+	ret = JpegDecode(&dec, scale, outBytes, strip, stripSize, drawStrip, NULL);
+	fclose(fp);
+	if(ret != JPEG_OK)
+		fprintf(stderr, "%s: corrupted data, decoding stopped (%d)\n", inName, ret);
+
+	fp = fopen(outName, "wb");
+	if(fp == NULL) { fprintf(stderr, "cannot create %s\n", outName); return 1; }
+	if(ppm)
+	{
+		fprintf(fp, "P6\n%d %d\n255\n", outW, outH);
+		for(i = 0; i < outW * outH; i++)
+		{
+			fputc(image[3*i+2], fp);
+			fputc(image[3*i+1], fp);
+			fputc(image[3*i], fp);
+		}
+	}
+	else
+		fwrite(image, outBytes, (size_t)outW * outH, fp);
+	fclose(fp);
+
+	printf("%s: %dx%d, %d component(s), MCU %dx%d, restart interval %d -> %dx%d, %lu strips of %lu bytes\n",
+			inName, dec.width, dec.height, dec.numComp, 8*dec.hmax, 8*dec.vmax, dec.restartInterval,
+			outW, outH, numStrips, stripSize);
+	return ret == JPEG_OK ? 0 : 1;
+}
@@ -0,0 +1,294 @@
+/**
+ * @file    rlepack.c
+ * @license BSD license, all text above and below must be included in any redistribution
+ *
+ * Host tool to convert a RAiO *.bin picture (e.g. assets/menuL.bin) into the run-length compressed image format
+ * of src/rle/rleImage.h, drawn by Ra8876_Lite::putRlePicture().<br>
+ * This folder is not compiled by Arduino IDE.
+ *
+ * Build (Linux, macOS, MinGW):
+ *	cc -O2 -I../../src/rle -o rlepack rlepack.c ../../src/rle/rleImage.c
+ *
+ * Usage:
+ *	rlepack [options] <input.bin> <output.c|output.rle>
+ *	-w <width>		picture width in pixels, required as a *.bin file has no header
+ *	-b <bytes>		bytes per pixel 1, 2 or 3 of the *.bin file, default is 2 (RGB565)
+ *	-m <pixels>		shortest run to code as a run packet, default 3. Runs shorter than this are kept in literals.
+ *	-n <name>		array name of a *.c output, default is rle_ followed by the input filename without extension
+ *
+ * Example:
+ *	rlepack -w 800 menuL.bin menuL.rle
+ *	Copy menuL.rle to SD card and draw it with
+ *	ra8876lite.putRlePicture(0, 0, "menuL.rle");
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "rleImage.h"
+
+static unsigned char *pixels;
+static long			pixelBytes;
+static int			width, height, bpp = 2, minRun = 3;
+
+/* statistics of the drawing cost, with the same fill rule as Ra8876_Lite::rle_Draw() */
+static unsigned long numRuns, numLiterals, numFills, filledPixels;
+
+/*----------------------------------------------------------------------------------------------------------*/
+/* output buffer                                                                                            */
+/*----------------------------------------------------------------------------------------------------------*/
+static unsigned char *out;
+static unsigned long outSize, outCap;
+
+static void outByte(unsigned char b)
+{
+	if(outSize == outCap)
+	{
+		outCap = outCap ? outCap*2 : 65536;
+		out = (unsigned char *)realloc(out, outCap);
+		if(out == NULL) { fprintf(stderr, "out of memory\n"); exit(1); }
+	}
+	out[outSize++] = b;
+}
+
+static void outU16(unsigned int v)	{ outByte(v & 0xFF); outByte((v>>8) & 0xFF); }
+static void outU32(unsigned long v)	{ outU16(v & 0xFFFF); outU16((v>>16) & 0xFFFF); }
+
+static void putU32(unsigned long at, unsigned long v)
+{
+	out[at] = v & 0xFF; out[at+1] = (v>>8) & 0xFF; out[at+2] = (v>>16) & 0xFF; out[at+3] = (v>>24) & 0xFF;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+/* input                                                                                                    */
+/*----------------------------------------------------------------------------------------------------------*/
+static unsigned char *readFile(const char *name, long *pSize)
+{
+	FILE *fp = fopen(name, "rb");
+	unsigned char *buf;
+	long size;
+
+	if(fp == NULL) { fprintf(stderr, "cannot open %s\n", name); exit(1); }
+	fseek(fp, 0, SEEK_END);
+	size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	buf = (unsigned char *)malloc(size + 1);
+	if(buf == NULL || fread(buf, 1, size, fp) != (size_t)size) { fprintf(stderr, "cannot read %s\n", name); exit(1); }
+	fclose(fp);
+	*pSize = size;
+	return buf;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+/* encoder                                                                                                  */
+/*----------------------------------------------------------------------------------------------------------*/
+static const unsigned char *pixelAt(unsigned long i)
+{
+	return pixels + i * bpp;
+}
+
+static int samePixel(unsigned long a, unsigned long b)
+{
+	return memcmp(pixelAt(a), pixelAt(b), bpp) == 0;
+}
+
+static void outHeader(int run, unsigned long count)
+{
+	if(count <= RLEI_COUNT_MASK)
+		outByte((run ? RLEI_RUN : 0) | count);
+	else
+	{
+		outByte(run ? RLEI_RUN : 0);
+		outU16(count);
+	}
+}
+
+static void outLiteral(unsigned long from, unsigned long count)
+{
+	unsigned long n, k;
+
+	while(count)
+	{
+		n = count > RLEI_COUNT_MAX ? RLEI_COUNT_MAX : count;
+		outHeader(0, n);
+		for(k = 0; k < n * bpp; k++)
+			outByte(pixelAt(from)[k]);
+		from += n;
+		count -= n;
+		numLiterals++;
+	}
+}
+
+static void outRun(unsigned long from, unsigned long count)
+{
+	unsigned long n;
+	int k;
+
+	while(count)
+	{
+		n = count > RLEI_COUNT_MAX ? RLEI_COUNT_MAX : count;
+		outHeader(1, n);
+		for(k = 0; k < bpp; k++)
+			outByte(pixelAt(from)[k]);
+		if(n * bpp >= RLEI_FILL_MIN_BYTES)
+		{
+			numFills++;
+			filledPixels += n;
+		}
+		numRuns++;
+		count -= n;
+	}
+}
+
+/*
+ * Greedy encoder: a run of minRun or more equal pixels becomes a run packet, everything in between is one literal.
+ * Packets run across row ends so that a plain background of many rows is a single BTE fill.
+ */
+static void encode(void)
+{
+	unsigned long total = (unsigned long)width * height;
+	unsigned long i = 0, litStart = 0, j;
+
+	outU32(RLEI_MAGIC);
+	outByte(RLEI_VERSION);
+	outByte(bpp);
+	outByte(0);
+	outByte(0);
+	outU16(width);
+	outU16(height);
+	outU32(0);	/* DataSize, patched below */
+
+	while(i < total)
+	{
+		for(j = i + 1; j < total && samePixel(i, j); j++)
+			;
+		if(j - i >= (unsigned long)minRun)
+		{
+			outLiteral(litStart, i - litStart);
+			outRun(i, j - i);
+			litStart = j;
+		}
+		i = j;
+	}
+	outLiteral(litStart, total - litStart);
+
+	putU32(12, outSize - RLEI_HEADER_SIZE);
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+/* output                                                                                                   */
+/*----------------------------------------------------------------------------------------------------------*/
+static int endsWith(const char *s, const char *ext)
+{
+	size_t n = strlen(s), m = strlen(ext);
+	return n >= m && strcmp(s + n - m, ext) == 0;
+}
+
+static void writeC(FILE *fp, const char *arrayName, const char *inName)
+{
+	unsigned long i;
+
+	const char *base = strrchr(inName, '/');
+
+	fprintf(fp, "/*\n * Run-length compressed image converted by rlepack from %s\n", base ? base+1 : inName);
+	fprintf(fp, " * Width: %d, height: %d, bytes per pixel: %d\n", width, height, bpp);
+	fprintf(fp, " * Format: src/rle/rleImage.h\n */\n\n");
+	fprintf(fp, "extern const unsigned char %s[%lu];\n\n", arrayName, outSize);
+	fprintf(fp, "const unsigned char %s[%lu] = {", arrayName, outSize);
+	for(i = 0; i < outSize; i++)
+		fprintf(fp, "%s0x%02X%s", (i % 16) ? " " : "\n  ", out[i], (i + 1 < outSize) ? "," : "");
+	fprintf(fp, "\n};\n");
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: rlepack -w width [-b bytes_per_pixel] [-m min_run] [-n name] <input.bin> <output.c|.bin|.rle>\n");
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *inName = NULL, *outName = NULL, *arrayName = NULL;
+	char nameBuf[128];
+	int i;
+	FILE *fp;
+
+	for(i = 1; i < argc; i++)
+	{
+		if(argv[i][0] == '-' && argv[i][1] && argv[i][2] == 0)
+		{
+			char opt = argv[i][1];
+			if(i + 1 >= argc) usage();
+			switch(opt)
+			{
+				case 'w': width = atoi(argv[++i]); break;
+				case 'b': bpp = atoi(argv[++i]); break;
+				case 'm': minRun = atoi(argv[++i]); break;
+				case 'n': arrayName = argv[++i]; break;
+				default: usage();
+			}
+		}
+		else if(inName == NULL)
+			inName = argv[i];
+		else if(outName == NULL)
+			outName = argv[i];
+		else
+			usage();
+	}
+	if(inName == NULL || outName == NULL || width <= 0)
+		usage();
+	if(bpp < 1 || bpp > 3)
+	{
+		fprintf(stderr, "-b must be 1, 2 or 3\n");
+		return 1;
+	}
+	if(minRun < 2)
+		minRun = 2;
+
+	pixels = readFile(inName, &pixelBytes);
+	height = pixelBytes / ((long)width * bpp);
+	if(width > 0xFFFF || height == 0 || height > 0xFFFF)
+	{
+		fprintf(stderr, "%s: %ld bytes is not a picture of width %d at %d bytes per pixel\n", inName, pixelBytes, width, bpp);
+		return 1;
+	}
+	if(pixelBytes % ((long)width * bpp))
+		fprintf(stderr, "%s: %ld trailing bytes ignored\n", inName, pixelBytes % ((long)width * bpp));
+
+	encode();
+
+	if(endsWith(outName, ".c") || endsWith(outName, ".h"))
+	{
+		if(arrayName == NULL)
+		{
+			const char *base = strrchr(inName, '/');
+			char *dot;
+			base = base ? base+1 : inName;
+			snprintf(nameBuf, sizeof(nameBuf), "rle_%s", base);
+			dot = strrchr(nameBuf, '.');
+			if(dot)
+				*dot = 0;
+			for(dot = nameBuf; *dot; dot++)
+				if(!isalnum((unsigned char)*dot))
+					*dot = '_';
+			arrayName = nameBuf;
+		}
+		fp = fopen(outName, "w");
+		if(fp == NULL) { fprintf(stderr, "cannot create %s\n", outName); return 1; }
+		writeC(fp, arrayName, inName);
+	}
+	else
+	{
+		fp = fopen(outName, "wb");
+		if(fp == NULL) { fprintf(stderr, "cannot create %s\n", outName); return 1; }
+		fwrite(out, 1, outSize, fp);
+	}
+	fclose(fp);
+
+	printf("%s: %dx%d, %d bytes per pixel, %lu bytes -> %lu bytes (%lu%%), %lu runs, %lu literals\n",
+			inName, width, height, bpp, (unsigned long)width * height * bpp, outSize,
+			outSize * 100 / ((unsigned long)width * height * bpp), numRuns, numLiterals);
+	printf("%lu BTE fills cover %lu of %lu pixels\n", numFills, filledPixels, (unsigned long)width * height);
+	return 0;
+}
@@ -195,6 +195,68 @@ BITMAP* load_binary_xflash(int picture_width, int picture_height, long src_addr)
 	return pBitmap;
 }
 
+/**
+ * @brief	Create a BITMAP and decode a baseline JPEG image from MCU's Flash into it.
+ * @param	*data is a pointer to the JPEG file embedded in MCU's Flash.
+ * @param	size is the file size in bytes.
+ * @param	scale is 0, 1, 2 or 3 to load the picture at 1/1, 1/2, 1/4 or 1/8 of its size.
+ * @return	Returns a pointer to the created BITMAP, or NULL if the data is not a baseline JPEG or the BITMAP could not be created.
+ *			Remember to free this BITMAP later to avoid memory leaks.
+ * @note	Width and height are read from the JPEG header, the BITMAP is JPEG_SCALED() of them.
+ */
+BITMAP* load_jpeg(const void *data, long size, int scale)
+{
+	uint16_t width, height;
+	
+	if(!ra8876lite.getJpegSize((const uint8_t *)data, size, &width, &height)) return NULL;
+	
+	BITMAP* pBitmap = new BITMAP(JPEG_SCALED(width, scale), JPEG_SCALED(height, scale));
+	if(!pBitmap) return NULL;	//failed to allocate memory from heap or SDRAM
+	
+	ra8876lite.bteJpeg(pBitmap->getAddress(), pBitmap->getWidth(), 0, 0, (const uint8_t *)data, size, scale);
+	
+	return pBitmap;
+}
+
+/**
+ * @brief	Create a BITMAP and decode a baseline JPEG file from SD card into it.
+ * @param	*pFilename is a pointer to the filename.
+ * @param	scale is 0, 1, 2 or 3 to load the picture at 1/1, 1/2, 1/4 or 1/8 of its size.
+ * @return	Returns a pointer to the created BITMAP, or NULL if the file is not a baseline JPEG or the BITMAP could not be created.
+ *			Remember to free this BITMAP later to avoid memory leaks.
+ * @note	Unlike load_binary_sd(), width and height are read from the file.
+ */
+#if defined (LOAD_SD_LIBRARY)
+BITMAP* load_jpeg_sd(const char *pFilename, int scale)
+{
+	uint16_t width, height;
+	
+	if(!ra8876lite.getJpegSize(pFilename, &width, &height)) return NULL;
+	
+	BITMAP* pBitmap = new BITMAP(JPEG_SCALED(width, scale), JPEG_SCALED(height, scale));
+	if(!pBitmap) return NULL;	//failed to allocate memory from heap or SDRAM
+	
+	ra8876lite.bteJpeg(pBitmap->getAddress(), pBitmap->getWidth(), 0, 0, pFilename, scale);
+	
+	return pBitmap;
+}
+
+/**
+ * @brief	Save a BITMAP to SD card as a BMP file.
+ * @param	*pFilename is a pointer to the filename, an existing file is replaced.
+ * @param	*bitmap is a pointer to the BITMAP to save, e.g. screen.
+ * @return	Returns zero on success, non-zero on error.
+ * @note	Comply with legacy Allegro 4.4.x without the palette argument. The BMP keeps the global color depth,
+ *			see Ra8876_Lite::captureBmp(). Use Ra8876_Lite::captureScreen() for the main window as shown on the display.
+ */
+int save_bitmap(const char *pFilename, BITMAP *bitmap)
+{
+	if(!bitmap) return -1;
+	
+	return ra8876lite.captureBmp(pFilename, bitmap->getAddress(), bitmap->getWidth(), 0, 0, bitmap->getWidth(), bitmap->getHeight())? 0 : -1;
+}
+#endif
+
 /**
  * @brief	Destroy a BITMAP from heap and RA8876's SDRAM.
  * @param	*bitmap is a pointer to the BITMAP to be destroyed.
@@ -364,4 +426,73 @@ void clear_to_color(BITMAP *bitmap, int color)
 	ra8876lite.bteSolidFill(bitmap->getAddress(),0,0,VIRTUAL_W,bte_height,color_to_clear);
 }
 
+/**
+ * @brief	Writes the string s onto the bitmap at position x, y, using the specified font, foreground color and background color.
+ * @param	*bmp points to the BITMAP to draw on, which can be the screen or any BITMAP created off-screen.
+ * @param	*f is a pointer to BFC_FONT in MCU's Flash
+ * @param	*s is a UTF-8 string
+ * @param	x, y are the top left corner of the string, they may be negative
+ * @param	color is the text color in integer (not sf::Color object)
+ * @param	bg is the background color in integer. A color with zero alpha (e.g. 0) keeps the BITMAP underneath.
+ * @note	Text is clipped to the clip rectangle of the BITMAP. Each character is sent by BTE in one window, 
+ *			refer to Ra8876_Lite::bteBfcString(). Allegro uses bg = -1 for transparent text, which is opaque white 
+ *			in the 32-bit RGBA integers of this library, so a transparent background is given by alpha = 0 instead.<br>
+ *			Example to compose a HUD off-screen and show it with a single blit:<br>
+ *			BITMAP *hud = create_bitmap(200, 40);
+ *			clear_to_color(hud, 0);
+ *			textout_ex(hud, &fontLucida_Sans_Unicode16h_rowrowBig, "Score 1200", 4, 4, 0xFFFFFFFF, 0);
+ *			blit(hud, screen, 0, 0, 10, 10, 200, 40);
+ */
+void textout_ex(BITMAP *bmp, const BFC_FONT *f, const char *s, int x, int y, int color, int bg)
+{
+	if(bmp==NULL || f==NULL || s==NULL) return;
+	
+	uint16_t cl,cr,ct,cb;
+	bmp->getClipRect(&cl, &ct, &cr, &cb);
+	
+	Color _color((Uint32)color);
+	Color _bg((Uint32)bg);
+	
+	if(_bg.a==0)
+		_bg = Color::Transparent;
+	
+	ra8876lite.bteBfcString(bmp->getAddress(), bmp->getWidth(), (int16_t)x, (int16_t)y, cl, ct, cr, cb, f, s, _color, _bg);
+}
+
+/**
+ * @brief	Like textout_ex(), but interprets the x coordinate as the centre rather than the left edge of the string.
+ */
+void textout_centre_ex(BITMAP *bmp, const BFC_FONT *f, const char *s, int x, int y, int color, int bg)
+{
+	textout_ex(bmp, f, s, x - text_length(f, s)/2, y, color, bg);
+}
+
+/**
+ * @brief	Like textout_ex(), but interprets the x coordinate as the right rather than the left edge of the string.
+ */
+void textout_right_ex(BITMAP *bmp, const BFC_FONT *f, const char *s, int x, int y, int color, int bg)
+{
+	textout_ex(bmp, f, s, x - text_length(f, s), y, color, bg);
+}
 
+/**
+ * @brief	Returns the length (in pixels) of a string in the specified font.
+ * @param	*f is a pointer to BFC_FONT in MCU's Flash
+ * @param	*str is a UTF-8 string
+ */
+int text_length(const BFC_FONT *f, const char *str)
+{
+	if(f==NULL || str==NULL) return 0;
+	
+	return (int)ra8876lite.getBfcStringWidth(f, str);
+}
+
+/**
+ * @brief	Returns the height (in pixels) of the specified font.
+ */
+int text_height(const BFC_FONT *f)
+{
+	if(f==NULL) return 0;
+	
+	return (int)ra8876lite.getBfcFontHeight(f);
+}
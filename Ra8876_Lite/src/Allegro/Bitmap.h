@@ -43,6 +43,11 @@ BITMAP*	load_flash(int width, int height, const void *flash);
 BITMAP* load_binary_sd(int width, int height, const char *pFilename);
 #endif
 BITMAP* load_binary_xflash(int picture_width, int picture_height, long src_addr);
+BITMAP* load_jpeg(const void *data, long size, int scale);
+#if defined (LOAD_SD_LIBRARY)
+BITMAP* load_jpeg_sd(const char *pFilename, int scale);
+int		save_bitmap(const char *pFilename, BITMAP *bitmap);
+#endif
 
 void 	destroy_bitmap(BITMAP *bitmap);
 void 	set_clip_state(BITMAP *bitmap, int state);
@@ -56,6 +61,10 @@ void	clear_bitmap(BITMAP *bitmap);
 void	clear_to_color(BITMAP *bitmap, int color);
 
 void	textout_ex(BITMAP *bmp, const BFC_FONT *f, const char *s, int x, int y, int color, int bg);
+void	textout_centre_ex(BITMAP *bmp, const BFC_FONT *f, const char *s, int x, int y, int color, int bg);
+void	textout_right_ex(BITMAP *bmp, const BFC_FONT *f, const char *s, int x, int y, int color, int bg);
+int		text_length(const BFC_FONT *f, const char *str);
+int		text_height(const BFC_FONT *f);
 #ifdef __cplusplus
 }
 #endif	
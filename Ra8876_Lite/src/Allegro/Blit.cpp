@@ -6,6 +6,9 @@
 
 #include "Blit.h"
 
+///@note	true after set_alpha_blender(): alpha_blit() and draw_trans_sprite() take the alpha of each source pixel
+static bool alpha_blender = false;
+
 /**
  * @brief	Copies a rectangular area of the source BITMAP to the destination BITMAP.
  * @param	*source points to the source BITMAP.
@@ -83,6 +86,8 @@ void masked_blit(BITMAP *source, BITMAP *dest, int source_x, int source_y, int d
  * @param	dest_x and dest_y are the corresponding position in the destination BITMAP.
  * @param	width & height indicate the dimension of the source BITMAP to be copied.
  * @param	alpha is the opacity level in 33 steps from 0 - 32 with opaque color level = 0
+ * @note	After set_alpha_blender() the source is an ARGB4444 BITMAP (ARGB2222 at 8BPP) with its own alpha channel
+ *			and alpha is not used. Either way it is a single BTE operation.
  */
 void alpha_blit(BITMAP *source, BITMAP *dest, int source_x, int source_y, int dest_x, int dest_y, int width, int height, char alpha)
 {
@@ -108,10 +113,40 @@ void alpha_blit(BITMAP *source, BITMAP *dest, int source_x, int source_y, int de
 	dest->getWidth(),
 	dest_x, dest_y,
 	width, height,
-	alpha
+	alpha,
+	alpha_blender
 	);	
 }
 
+/**
+ * @brief	Select per pixel alpha for alpha_blit() and draw_trans_sprite(), the source BITMAP holds ARGB4444 pixels.
+ * @note	An ARGB4444 picture is loaded like any other 16-bit picture, e.g. by load_flash(), two bytes per pixel
+ *			G[7:4]B[7:4] then A[7:4]R[7:4]. Transparent pixels have alpha 0, no MASK_COLOR is needed.
+ *			Comply with legacy Allegro 4.4.x, where it selects the alpha channel of 32-bit RGBA sprites.
+ */
+void set_alpha_blender(void)
+{
+	alpha_blender = true;
+}
+
+/**
+ * @brief	Return true if per pixel alpha is selected by set_alpha_blender(), false after set_trans_blender().
+ */
+bool get_alpha_blender(void)
+{
+	return alpha_blender;
+}
+
+/**
+ * @brief	Back to one alpha level for the whole source, given by the alpha argument of alpha_blit() and draw_trans_sprite().
+ * @note	r, g, b and a are kept for compliance with legacy Allegro 4.4.x and not used.
+ */
+void set_trans_blender(int r, int g, int b, int a)
+{
+	(void)r; (void)g; (void)b; (void)a;
+	alpha_blender = false;
+}
+
 
 
 
@@ -23,6 +23,9 @@ extern "C" {
 void blit(BITMAP *source, BITMAP *dest, int source_x, int source_y, int dest_x, int dest_y, int width, int height);
 void masked_blit(BITMAP *source, BITMAP *dest, int source_x, int source_y, int dest_x, int dest_y, int width, int height);
 void alpha_blit(BITMAP *source, BITMAP *dest, int source_x, int source_y, int dest_x, int dest_y, int width, int height, char alpha);
+void set_alpha_blender(void);
+bool get_alpha_blender(void);
+void set_trans_blender(int r, int g, int b, int a);
 #ifdef __cplusplus
 }
 #endif	
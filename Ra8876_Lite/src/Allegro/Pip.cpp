@@ -0,0 +1,78 @@
+/**
+ * @brief	Picture-in-picture windows showing a BITMAP over the screen
+ * @note	Each function writes its change at the next vsync by Ra8876_Lite::pipUpdate().
+ *			Call Ra8876_Lite::pipMove() etc. followed by one pipUpdate() to change both windows in the same frame.
+ */
+
+#include "Pip.h"
+
+/**
+ * @brief	Shows a BITMAP in a picture-in-picture window on the screen.
+ * @param	pip is PIP1 or PIP2. PIP1 is shown on top of PIP2 where they overlap.
+ * @param	*bmp is the BITMAP to show, its width must be a multiple of 4.
+ * @param	x, y are the top left corner of the window on the screen, x in multiple of 4.
+ * @return	Returns zero on success, -1 for a wrong pip, a BITMAP width not in multiple of 4 or a color depth a PIP window cannot show.
+ * @note	The window takes the size of the BITMAP. Drawing on the BITMAP afterwards updates the window directly.
+ *			The BITMAP must not be destroyed before hide_pip() is called.
+ */
+int show_pip(int pip, BITMAP *bmp, int x, int y)
+{
+	if(bmp==NULL || (bmp->getWidth()&3)) return -1;
+	
+	if(!ra8876lite.pipCreate(pip, bmp->getAddress(), bmp->getWidth(), x, y, bmp->getWidth(), bmp->getHeight(), ra8876lite.getColorMode()))
+		return -1;
+	
+	ra8876lite.pipUpdate();
+	return 0;
+}
+
+/**
+ * @brief	Moves a picture-in-picture window to (x,y) on the screen, neither the screen nor the BITMAP is redrawn.
+ * @param	pip is PIP1 or PIP2.
+ * @param	x, y are the top left corner of the window on the screen, x in multiple of 4.
+ */
+void move_pip(int pip, int x, int y)
+{
+	ra8876lite.pipMove(pip, x, y);
+	ra8876lite.pipUpdate();
+}
+
+/**
+ * @brief	Shows an area of the BITMAP in a picture-in-picture window, e.g. to scroll a ticker or pan a map.
+ * @param	pip is PIP1 or PIP2.
+ * @param	source_x, source_y are the top left corner of the area in the BITMAP, source_x in multiple of 4.
+ * @param	width, height are the size of the area and so of the window, width in multiple of 4.
+ */
+void scroll_pip(int pip, int source_x, int source_y, int width, int height)
+{
+	const PIP_WINDOW *w = ra8876lite.getPip(pip);
+	
+	ra8876lite.pipSource(pip, w->addr, w->image_width, source_x, source_y);
+	ra8876lite.pipResize(pip, width, height);
+	ra8876lite.pipUpdate();
+}
+
+/**
+ * @brief	Points a picture-in-picture window to another BITMAP of the same width, e.g. the back buffer of a video tile.
+ * @param	pip is PIP1 or PIP2.
+ * @param	*bmp is the BITMAP to show. Position, size and the area shown are kept.
+ */
+void set_pip_bitmap(int pip, BITMAP *bmp)
+{
+	if(bmp==NULL) return;
+	
+	const PIP_WINDOW *w = ra8876lite.getPip(pip);
+	
+	ra8876lite.pipSource(pip, bmp->getAddress(), bmp->getWidth(), w->src_x, w->src_y);
+	ra8876lite.pipUpdate();
+}
+
+/**
+ * @brief	Hides a picture-in-picture window, the screen below shows again without a redraw.
+ * @param	pip is PIP1 or PIP2.
+ */
+void hide_pip(int pip)
+{
+	ra8876lite.pipEnable(pip, false);
+	ra8876lite.pipUpdate();
+}
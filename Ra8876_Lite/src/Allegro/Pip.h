@@ -0,0 +1,32 @@
+/**
+ * @brief	Picture-in-picture windows showing a BITMAP over the screen
+ * @note	RA8876 shows up to two PIP windows (PIP1 on top of PIP2) straight from their BITMAPs in SDRAM.
+ *			Moving a window or changing its content takes a few register writes at vsync instead of an
+ *			erase and redraw on the screen BITMAP. VSYNC interrupt has to be enabled by 
+ *			ra8876lite.irqEventSet(RA8876_VSYNC_IRQ_ENABLE, 1) for the changes to be synced to the frame.
+ *			Not part of legacy Allegro 4.4.x
+ */
+
+#ifndef _PIP_H
+#define _PIP_H
+
+#include "Bitmap.h"
+
+class BITMAP;
+
+/* Starts C function definitions when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int		show_pip(int pip, BITMAP *bmp, int x, int y);
+void	move_pip(int pip, int x, int y);
+void	scroll_pip(int pip, int source_x, int source_y, int width, int height);
+void	set_pip_bitmap(int pip, BITMAP *bmp);
+void	hide_pip(int pip);
+#ifdef __cplusplus
+}
+#endif	
+/* Ends C function definitions when using C++ */
+
+#endif	//#define _PIP_H
@@ -88,7 +88,10 @@ void draw_sprite(BITMAP *bg, SPRITE *sprite, int x, int y)
  *			copy the sprite to a background instead of masked_blit(). MASK_COLOR is also supported.
  * @note	If vsync() is not used it is advised to create a background BIMTAP with all graphics copied
  *			to it. After rendering is finished, a single instruction to move the whole background to
- *			screen to avoid flickering.
+ *			screen to avoid flickering.<br>
+ *			After set_alpha_blender() the frames are ARGB4444 and carry their own alpha, the frame is blended
+ *			straight from the sprite sheet by one BTE operation and alpha is not used. Otherwise the frame is
+ *			masked against the background first, which takes four BTE operations and a temporary BITMAP.
  */
 void draw_trans_sprite(BITMAP *bg, SPRITE *sprite, int x, int y, char alpha)
 {
@@ -98,6 +101,16 @@ void draw_trans_sprite(BITMAP *bg, SPRITE *sprite, int x, int y, char alpha)
 	blit(bg, sprite->bgsave, x, y, 0, 0, sprite->getWidth(), sprite->getHeight());
 
 	int column = (sprite->frames -> getWidth())/sprite->getWidth();
+
+	if(get_alpha_blender())
+	{
+		int frame_x = (sprite->getCurFrame() % column) * sprite->getWidth();
+		int frame_y = (sprite->getCurFrame() / column) * sprite->getHeight();
+		alpha_blit(sprite->frames, bg, frame_x, frame_y, x, y, sprite->getWidth(), sprite->getHeight(), alpha);
+		sprite->updatePosition(x,y);
+		return;
+	}
+
 	BITMAP *frame = grabframe(sprite->frames, sprite->getWidth(),sprite->getHeight(),0,0,column,sprite->getCurFrame());
 
 	if(frame!=NULL)
@@ -9,6 +9,8 @@
 BITMAP *screen = NULL;
 Memory *mmu = new Memory();
 static int color_depth = 16;
+static DetailedTiming gfx_native;	//native timing of the monitor for GFX_AUTO_EDID
+static uint8_t gfx_monitor = DVI;
 
  /****************************************************************************/
  /* C functions (inspired by Allegro 4.4.2 API) */
@@ -55,149 +57,247 @@ void set_color_depth(int depth)
 }
 
 /**
- * @brief	This function initializes RA8876 and CH7035B and set RA8876 in graphics mode.
- * @param	card is a parameter selected from the enum GFX_VIDEO_MODE defined in allegro.h.
- * @param	v_w is the virtual screen width equivalent to Canvas width of RA8876.
- * @param	v_h is the virtual screen height equivalent to Canvas height of RA8876.
- * @return	'0' on success
- *			'-1' on failure
- * @note	The color depth of the graphic mode has to be specified before calling this function 
- *			with set_color_depth(); otherwise, the default 16 bit-per-pixel color will be applied.
- *			The input resolution of the RGB signal generated by RA8876 is specified by the prefix 
- *			GFX_ZZZ with _ZZZ as the video format e.g. VGA(640x480), WVGA(800x480), etc. 
- *			Video frames will be multiplied by a scaling engine of CH7035B HDMI encoder for higher
- *			resolution that fits a HDTV/LCD monitor. Output HDMI resolution is specified by the suffixes 
- *			_YYY in GFX_ZZZ_YYY.<br>
- *
- *			Example to use:<br>
- *			set_color_depth(8);									//set a color depth 8bpp
- *			set_gfx_mode(GFX_FWVGA_HD720p_HDMI, 848, 480);		//RA8876 generates 848x480 FWVGA @60Hz
- *																//CH7035B upscale it to 1280x720p @60Hz HDMI interface
- *																//set canvas size 848x480 for the input (not output)
- 
- *			set_color_depth(16);									//set a color depth 16bpp
- *			set_gfx_mode(GFX_HD720p_HD1080i_HDMI, 1280*2, 720*2);	//RA8876 generates 1280x720 @60Hz (720p) HDMI interface
- *																	//CH7035B upscale it to 1080i interlaced HDMI 
- *																	//v_w & v_h set to 1280*2 & 720*2 for screen scrolling & panning
- *
+ * @brief	RGB video timing generated by RA8876 for a graphic mode.
+ * @return	false if card is not in enum GFX_VIDEO_MODE, or no native timing for GFX_AUTO_EDID
+ * @note	GFX_AUTO_EDID reads EDID for the native timing and selects the RGB video of least bandwidth
+ *			not smaller than v_w x v_h, or the largest one with the aspect ratio of the monitor.<br>
+ *			If no RGB video fits the native timing, the best mode of EDID and its CEA-861 extension is used instead.
  */
-int set_gfx_mode(int card, int v_w, int v_h)
+static bool gfx_VideoIn(int card, int v_w, int v_h, LCDParam *video_in)
 {
-	LCDParam video_in;
-	COLOR_MODE _mode;
-	sf::Color color;
+	LCDParam native;
+	const LCDParam *source;
 	
 	switch (card)
 	{
 		case GFX_AUTO_DETECT:	//use 9904 bootROM for 1280x720 @60Hz input
 			break;
+		case GFX_AUTO_EDID:
+			HDMI_Tx.begin();
+			if(!HDMI_Tx.nativeTiming(&gfx_native, &gfx_monitor)) return false;
+			CH703X::timingFromEdid(&gfx_native, &native);
+			source = CH703X::selectSource(&native, v_w, v_h, SPLL_FREQ_MAX);
+			if(!source && !HDMI_Tx.bestMode(SPLL_FREQ_MAX, &source, &gfx_native, &gfx_monitor)) return false;
+			CH703X::timingFromEdid(&gfx_native, &native);
+			*video_in = *source;
+		#ifdef DEBUG_LLD_RA8876
+			printf("Native %dx%d, %s selected\n", native.width, native.height, source->name);
+		#endif
+			break;
 		case GFX_VGA_SVGA_DVI:
-			video_in = CEA_640x480p_60Hz;	
+			*video_in = CEA_640x480p_60Hz;	
 			break;
 		case GFX_WVGA_WXGA_DVI:
-			video_in = WVGA_800x480_60Hz;
+			*video_in = WVGA_800x480_60Hz;
 			break;	
 		case GFX_SVGA_XGA_DVI:
 		case GFX_SVGA_SXGA_DVI:
 		case GFX_SVGA_UXGA_DVI:
-			video_in = SVGA_800x600_60Hz;
+			*video_in = SVGA_800x600_60Hz;
 			break;		
 		case GFX_FWVGA_HD720p_HDMI:
-			video_in = FWVGA_848x480_60Hz;
+			*video_in = FWVGA_848x480_60Hz;
 			break;
 		case GFX_HD480p_HD720p_HDMI:
 		case GFX_HD480p_HD720p_DVI:
-			video_in = CEA_720x480p_60Hz;
+			*video_in = CEA_720x480p_60Hz;
 			break;
 		case GFX_HD576p_SXGA_HDMI:
-			video_in = CEA_720x576p_50Hz;
+			*video_in = CEA_720x576p_50Hz;
 			break;
 		case GFX_HD720p_HD1080i_HDMI:
 		case GFX_HD720p_HD1080p_HDMI:
 		case GFX_HD720p_HD1080p_DVI:
-			video_in = CEA_1280x720p_60Hz;
+			*video_in = CEA_1280x720p_60Hz;
 			break;
 		case GFX_WQVGA_HD480p_HDMI:
 		case GFX_WQVGA_HD720p_HDMI:
 		case GFX_WQVGA_HD1080p_HDMI:
-			video_in = WQVGA_480x272_60Hz;
+			*video_in = WQVGA_480x272_60Hz;
 			break;
 		default:
-			printf("Incorrect 'card' argument in set_gfx_mode() call.\n");
-			return -1;
+			return false;
 	}
-	
-	bool _success = 0;
-	
-	if(card!=GFX_AUTO_DETECT)
-		_success = ra8876lite.begin(&video_in);
-	else
-		_success = ra8876lite.begin();	//use 9904 bootROM for 1280x720 @60Hz input, output 1080p 60Hz
-	
-	if(!_success) return -1;
-	
-	if(color_depth==24)
-		_mode = COLOR_24BPP_RGB888;
-	else if(color_depth==8)
-		_mode = COLOR_8BPP_RGB332;
-	else
-		_mode = COLOR_16BPP_RGB565;
-		
-	ra8876lite.canvasImageBuffer(v_w, v_h, ACTIVE_WINDOW_STARTX, ACTIVE_WINDOW_STARTY, _mode, CANVAS_OFFSET);
-	ra8876lite.displayMainWindow();
-	ra8876lite.canvasClear(color.Black);
-	ra8876lite.graphicMode(true);
-	ra8876lite.displayOn(true);	
-	
-	HDMI_Tx.begin();
+	return true;
+}
+
+/**
+ * @brief	CH7035B register table for a graphic mode, NULL for GFX_AUTO_DETECT.
+ */
+static const uint8_t (*gfx_VideoInOutMap(int card))[2]
+{
 	switch(card)
 	{
 		case GFX_VGA_SVGA_DVI:
-		HDMI_Tx.init(VIDEO_in_640x480_out_DVI_800x600_60Hz);
-		break;
+		return VIDEO_in_640x480_out_DVI_800x600_60Hz;
 		case GFX_WVGA_WXGA_DVI:
-		HDMI_Tx.init(VIDEO_in_800x480_out_DVI_1280x768_60Hz);
-		break;
+		return VIDEO_in_800x480_out_DVI_1280x768_60Hz;
 		case GFX_SVGA_XGA_DVI:
-		HDMI_Tx.init(VIDEO_in_800x600_out_DVI_1024x768_60Hz);
-		break;
+		return VIDEO_in_800x600_out_DVI_1024x768_60Hz;
 		case GFX_SVGA_SXGA_DVI:
-		HDMI_Tx.init(VIDEO_in_800x600_out_DVI_1280x960_60Hz);
-		break;
+		return VIDEO_in_800x600_out_DVI_1280x960_60Hz;
 		case GFX_SVGA_UXGA_DVI:
-		HDMI_Tx.init(VIDEO_in_800x600_out_DVI_1600x1200_60Hz);
-		break;
+		return VIDEO_in_800x600_out_DVI_1600x1200_60Hz;
 		case GFX_HD480p_HD720p_DVI:
-		HDMI_Tx.init(VIDEO_in_720x480_out_DVI_720p_60Hz);
-		break;
+		return VIDEO_in_720x480_out_DVI_720p_60Hz;
 		case GFX_HD720p_HD1080p_DVI:
-		HDMI_Tx.init(VIDEO_in_1280x720_out_DVI_1080p_60Hz);
-		break;
+		return VIDEO_in_1280x720_out_DVI_1080p_60Hz;
 		
 		case GFX_FWVGA_HD720p_HDMI:
-		HDMI_Tx.init(VIDEO_in_848x480_out_HDMI_720p_60Hz);
-		break;
+		return VIDEO_in_848x480_out_HDMI_720p_60Hz;
 		case GFX_HD480p_HD720p_HDMI:
-		HDMI_Tx.init(VIDEO_in_720x480_out_HDMI_720p_60Hz);
-		break;
+		return VIDEO_in_720x480_out_HDMI_720p_60Hz;
 		case GFX_HD576p_SXGA_HDMI:
-		HDMI_Tx.init(VIDEO_in_720x576_out_DVI_1280x1024_60Hz);
-		break;
+		return VIDEO_in_720x576_out_DVI_1280x1024_60Hz;
 		case GFX_HD720p_HD1080i_HDMI:
-		HDMI_Tx.init(VIDEO_in_1280x720_out_HDMI_1080i_60Hz);
-		break;
+		return VIDEO_in_1280x720_out_HDMI_1080i_60Hz;
 		case GFX_HD720p_HD1080p_HDMI:
-		HDMI_Tx.init(VIDEO_in_1280x720_out_HDMI_1080p_60Hz);
-		break;
+		return VIDEO_in_1280x720_out_HDMI_1080p_60Hz;
 		case GFX_WQVGA_HD480p_HDMI:
-		HDMI_Tx.init(VIDEO_in_480x272_out_HDMI_480p_60Hz);
-		break;
+		return VIDEO_in_480x272_out_HDMI_480p_60Hz;
 		case GFX_WQVGA_HD720p_HDMI:
-		HDMI_Tx.init(VIDEO_in_480x272_out_HDMI_720p_60Hz);
-		break;
+		return VIDEO_in_480x272_out_HDMI_720p_60Hz;
 		case GFX_WQVGA_HD1080p_HDMI:
-		HDMI_Tx.init(VIDEO_in_480x272_out_HDMI_1080p_60Hz);
-		break;
+		return VIDEO_in_480x272_out_HDMI_1080p_60Hz;
+		default:
+		return NULL;
 	}
-		return 0;
+}
+
+/**
+ * @brief	Initialize CH7035B with the register table of a graphic mode, or the native timing for GFX_AUTO_EDID.
+ */
+static bool gfx_HdmiInit(int card, const LCDParam *video_in)
+{
+	if(card==GFX_AUTO_EDID)
+		return HDMI_Tx.init(video_in, &gfx_native, gfx_monitor);
+	if(gfx_VideoInOutMap(card))
+		return HDMI_Tx.init(gfx_VideoInOutMap(card));
+	return true;
+}
+
+/**
+ * @brief	Color mode of RA8876 from the color depth set by set_color_depth().
+ */
+static COLOR_MODE gfx_ColorMode(void)
+{
+	if(color_depth==24)
+		return COLOR_24BPP_RGB888;
+	else if(color_depth==8)
+		return COLOR_8BPP_RGB332;
+	else
+		return COLOR_16BPP_RGB565;
+}
+
+/**
+ * @brief	This function initializes RA8876 and CH7035B and set RA8876 in graphics mode.
+ * @param	card is a parameter selected from the enum GFX_VIDEO_MODE defined in allegro.h.
+ * @param	v_w is the virtual screen width equivalent to Canvas width of RA8876.
+ * @param	v_h is the virtual screen height equivalent to Canvas height of RA8876.
+ * @return	'0' on success
+ *			'-1' on failure
+ * @note	The color depth of the graphic mode has to be specified before calling this function 
+ *			with set_color_depth(); otherwise, the default 16 bit-per-pixel color will be applied.
+ *			The input resolution of the RGB signal generated by RA8876 is specified by the prefix 
+ *			GFX_ZZZ with _ZZZ as the video format e.g. VGA(640x480), WVGA(800x480), etc. 
+ *			Video frames will be multiplied by a scaling engine of CH7035B HDMI encoder for higher
+ *			resolution that fits a HDTV/LCD monitor. Output HDMI resolution is specified by the suffixes 
+ *			_YYY in GFX_ZZZ_YYY.<br>
+ *
+ *			Example to use:<br>
+ *			set_color_depth(8);									//set a color depth 8bpp
+ *			set_gfx_mode(GFX_FWVGA_HD720p_HDMI, 848, 480);		//RA8876 generates 848x480 FWVGA @60Hz
+ *																//CH7035B upscale it to 1280x720p @60Hz HDMI interface
+ *																//set canvas size 848x480 for the input (not output)
+ 
+ *			set_color_depth(16);									//set a color depth 16bpp
+ *			set_gfx_mode(GFX_HD720p_HD1080i_HDMI, 1280*2, 720*2);	//RA8876 generates 1280x720 @60Hz (720p) HDMI interface
+ *																	//CH7035B upscale it to 1080i interlaced HDMI 
+ *																	//v_w & v_h set to 1280*2 & 720*2 for screen scrolling & panning
+ *
+ *			set_gfx_mode(GFX_AUTO_EDID, 800, 480);		//RA8876 generates the video of least bandwidth not smaller than 800x480
+ *														//CH7035B upscale it to the native resolution of the monitor from EDID
+ *
+ */
+int set_gfx_mode(int card, int v_w, int v_h)
+{
+	LCDParam video_in = CEA_1280x720p_60Hz;	//GFX_AUTO_DETECT uses 9904 bootROM for 1280x720 @60Hz input, output 1080p 60Hz
+	sf::Color color;
+	
+	if(!gfx_VideoIn(card, v_w, v_h, &video_in))
+	{
+		printf("Incorrect 'card' argument in set_gfx_mode() call.\n");
+		return -1;
+	}
+	
+	if(!ra8876lite.begin(&video_in)) return -1;
+		
+	ra8876lite.canvasImageBuffer(v_w, v_h, ACTIVE_WINDOW_STARTX, ACTIVE_WINDOW_STARTY, gfx_ColorMode(), CANVAS_OFFSET);
+	ra8876lite.displayMainWindow();
+	ra8876lite.canvasClear(color.Black);
+	ra8876lite.graphicMode(true);
+	ra8876lite.displayOn(true);	
+	
+	HDMI_Tx.begin();
+	if(!gfx_HdmiInit(card, &video_in) && card==GFX_AUTO_EDID) return -1;
+	
+	return 0;
+}
+
+/**
+ * @brief	This function switches to another graphic mode after set_gfx_mode() without resetting RA8876.
+ * @param	card, v_w and v_h are the same as in set_gfx_mode().
+ * @return	'0' on success
+ *			'-1' on failure, or if the new canvas does not fit the memory of the BITMAPs
+ * @note	RA8876 display timing, canvas size and the CH7035B register table are changed in place with
+ *			Ra8876_Lite::reconfigure(). SDRAM is neither initialized nor cleared, so BITMAPs are kept and nothing
+ *			has to be loaded again from SD card. For that the canvas at CANVAS_OFFSET has to stay inside the memory
+ *			of *screen allocated by allegro_init():<br>
+ *			(1) v_w has to be the canvas width in use, since the memory allocator and the line offsets of BITMAPs
+ *			are worked out from it.<br>
+ *			(2) v_h may not be larger than the canvas height in use, and the color depth is not changed.<br>
+ *			*screen is created again for the new height in the same memory. Falls back to set_gfx_mode() if no
+ *			graphic mode is set yet.<br>
+ *
+ *			Example to use:<br>
+ *			set_gfx_mode(GFX_HD720p_HD1080p_HDMI, 1280, 720);		//first mode with a full initialization
+ *			reconfigure_gfx_mode(GFX_HD480p_HD720p_HDMI, 1280, 480);	//switch in milliseconds, BITMAPs kept
+ */
+int reconfigure_gfx_mode(int card, int v_w, int v_h)
+{
+	LCDParam video_in = CEA_1280x720p_60Hz;
+	
+	if(!ra8876lite.initialised()) return set_gfx_mode(card, v_w, v_h);
+	
+	//the canvas is the memory of *screen at CANVAS_OFFSET, BITMAPs are allocated after it
+	uint16_t screen_h = screen ? screen->getHeight() : ra8876lite.getCanvasHeight();
+	if(v_w != VIRTUAL_W || v_h > screen_h || color_depth/8 != ra8876lite.getColorDepth())
+	{
+		printf("reconfigure_gfx_mode(): canvas %dx%d does not fit the screen BITMAP.\n", v_w, v_h);
+		return -1;
+	}
+	
+	if(!gfx_VideoIn(card, v_w, v_h, &video_in))
+	{
+		printf("Incorrect 'card' argument in reconfigure_gfx_mode() call.\n");
+		return -1;
+	}
+	
+	if(!ra8876lite.reconfigure(&video_in)) return -1;
+	
+	if(screen && v_h != screen_h)
+	{
+		//free then allocate again, the first fit is the same memory at CANVAS_OFFSET
+		destroy_bitmap(screen);
+		screen = create_bitmap(v_w, v_h);
+		if(screen==NULL || screen->getAddress()!=CANVAS_OFFSET) return -1;
+	}
+	
+	ra8876lite.canvasImageBuffer(v_w, v_h, ACTIVE_WINDOW_STARTX, ACTIVE_WINDOW_STARTY, gfx_ColorMode(), CANVAS_OFFSET);
+	ra8876lite.displayMainWindow();
+	
+	if(!gfx_HdmiInit(card, &video_in))
+		return -1;
+	
+	return 0;
 }
@@ -13,6 +13,7 @@
 #include "Bitmap.h"
 #include "Blit.h"
 #include "Sprite.h"
+#include "Pip.h"
 
 /**
  * @brief 	Video generated by RA8876. Monitors with DVI input accept only constant GFX_xxx_DVI as parameter.<br>
@@ -36,7 +37,9 @@ enum GFX_VIDEO_MODE{			//RA8876  -> CH7035B
 		
 		GFX_WQVGA_HD480p_HDMI,	//480x272 -> CEA 720x480p HDMI
 		GFX_WQVGA_HD720p_HDMI,	//480x272 -> CEA 1280x720p HDMI 
-		GFX_WQVGA_HD1080p_HDMI	//480x272 -> CEA 1920x1080p HDMI
+		GFX_WQVGA_HD1080p_HDMI,	//480x272 -> CEA 1920x1080p HDMI
+		
+		GFX_AUTO_EDID			//least bandwidth source for v_w x v_h -> native timing of the monitor read from EDID
 };
 
 /**
@@ -70,6 +73,7 @@ int 	allegro_init(void);
 void	allegro_exit(void);
 void 	set_color_depth(int depth);
 int 	set_gfx_mode(int card, int v_w, int v_h);
+int 	reconfigure_gfx_mode(int card, int v_w, int v_h);
 #ifdef __cplusplus
 }
 #endif	
@@ -30,6 +30,7 @@ void CH703X::hal_hwSetup()
 
 	_i2c->begin();
 	//pinMode(CH703X_IRQ, INPUT_PULLUP);	
+	shadowInvalidate();
 }
 
 /**
@@ -47,6 +48,36 @@ void CH703X::hal_writeRegister(uint8_t index, uint8_t val)
     _i2c->write(index);
     _i2c->write(val);
     _i2c->endTransmission();
+    shadowWrite(index, val);
+}
+
+/**
+* @brief	HAL level burst write to consecutive registers of a slave device @ CH703X_SLAVE_ADDR.
+*         Register index auto-increments after each byte, so a single transfer sets index, index+1, ...
+*			    Example :
+*			    //write 0x23, 0x20 to registers 0x0B and 0x0C
+*			    const uint8_t val[] = {0x23, 0x20};
+*			    hal_writeRegisters(0x0B, val, 2);
+* @param	index is the first register address
+* @param	*val points to the values to write
+* @param	count is the number of registers to write, sent CH703X_I2C_BURST_MAX at a time to fit the Wire buffer
+*/
+void CH703X::hal_writeRegisters(uint8_t index, const uint8_t *val, uint8_t count)
+{
+    while(count)
+    {
+      uint8_t n = (count>CH703X_I2C_BURST_MAX)? CH703X_I2C_BURST_MAX : count;
+      _i2c->beginTransmission(CH703X_SLAVE_ADDR);
+      _i2c->write(index);
+      for(uint8_t k=0; k<n; k++)
+      {
+        _i2c->write(*val);
+        shadowWrite(index+k, *val++);
+      }
+      _i2c->endTransmission();
+      index += n;
+      count -= n;
+    }
 }
 
 /**
@@ -56,23 +87,58 @@ void CH703X::hal_writeRegister(uint8_t index, uint8_t val)
 *			    uint8_t test_value = hal_readRegister(0x03);	
 
 * @param	index is the register address to read
-* @return value to read from register at index
+* @return value to read from register at index, 0 with _i2cTimeout set if no byte comes in CH703X_I2C_TIMEOUT_MS
+* @note   Always read from CH703X, use it for status registers. readRegister() may return the shadow value instead.
 */
 uint8_t CH703X::hal_readRegister(uint8_t index)
 {
+	uint32_t t0;
+
 	_i2c->beginTransmission(CH703X_SLAVE_ADDR);
 	_i2c->write(index);
 	_i2c->endTransmission(false);	///STOP condition is not sent after the base address
 	_i2c->requestFrom(CH703X_SLAVE_ADDR, 1);
 
+	t0 = millis();
 	while(_i2c->available()<1)
-		;
+	{
+		if((millis()-t0) > CH703X_I2C_TIMEOUT_MS)
+		{
+			_i2cTimeout = true;
+			return 0;
+		}
+	}
 	
     uint8_t val = _i2c->read();    
 
     return val;
 }
 
+/**
+* @brief	HAL level burst read from consecutive registers of a slave device @ CH703X_SLAVE_ADDR.
+* @param	index is the first register address
+* @param	*val points to the buffer for count values
+* @param	count is the number of registers to read, requested CH703X_I2C_BURST_MAX at a time
+* @return true if all bytes are received, false if the slave returns less than requested
+*/
+bool CH703X::hal_readRegisters(uint8_t index, uint8_t *val, uint8_t count)
+{
+	while(count)
+	{
+		uint8_t n = (count>CH703X_I2C_BURST_MAX)? CH703X_I2C_BURST_MAX : count;
+		_i2c->beginTransmission(CH703X_SLAVE_ADDR);
+		_i2c->write(index);
+		_i2c->endTransmission(false);	///STOP condition is not sent after the base address
+		if(_i2c->requestFrom(CH703X_SLAVE_ADDR, (int)n) < n)
+			return false;
+		for(uint8_t k=0; k<n; k++)
+			*val++ = _i2c->read();
+		index += n;
+		count -= n;
+	}
+	return true;
+}
+
  /**
  *	@brief	HAL level software delay
  *	@param	ms is the delay in millisec
@@ -85,9 +151,12 @@ uint8_t CH703X::hal_readRegister(uint8_t index)
 /**
  * @brief Set register page to access. There are 4 pages: 1,2,3,&4
  * @param page is the page number
+ * @note  No I2C transfer if page is in use already.
  */
 void CH703X::setRegisterPage(uint8_t page)
 {
+  if(page==_page)
+    return;
   if      (page==1)
     hal_writeRegister(0x03, 0);
   else if (page==2)
@@ -98,6 +167,37 @@ void CH703X::setRegisterPage(uint8_t page)
     hal_writeRegister(0x03, 4); 
 }
 
+/**
+ * @brief Keep a value written to CH703X in the shadow of the page in use, or the page number if it is register 0x03.
+ * @param index is the register address
+ * @param val is the value written
+ * @note  A write to R4_52h resets the IB registers to their default values as resetIB() does, e.g. by
+ *        {0x52,0x01},{0x52,0x03} in every table of videoInOutMap.h, so all shadow values are dropped and the page kept.
+ */
+void CH703X::shadowWrite(uint8_t index, uint8_t val)
+{
+  if(index==0x03)
+  {
+    _page = (val==0)? 1 : (val==1)? 2 : (val==3 || val==4)? val : 0;
+    return;
+  }
+  if(_page==0 || index>=0x80)
+    return;
+  if(_page==4 && index==0x52)
+    memset(_shadowValid, 0, sizeof(_shadowValid));
+  _shadow[_page-1][index] = val;
+  _shadowValid[_page-1][index>>3] |= (1<<(index&7));
+}
+
+/**
+ * @brief Forget the page in use and all shadow values, e.g. after CH703X is reset.
+ */
+void CH703X::shadowInvalidate(void)
+{
+  _page = 0;
+  memset(_shadowValid, 0, sizeof(_shadowValid));
+}
+
 /**
 * @brief Write to the register a value <val> on page <page>
 * @param page is the page (1,2,3,4) to write
@@ -116,13 +216,34 @@ void CH703X::writeRegister(uint8_t page, uint8_t index, uint8_t val)
 * @param	index is the register address
 * @param	val is the pointer to an array holding the value read.
 * @param	count is the number of byte to read
+* @note   Registers written before are returned from the shadow with no I2C read. Others are read in one burst
+*         and kept in the shadow, so do not use it for status registers that CH703X changes by itself.
+*         A read that times out sets _i2cTimeout and is not kept in the shadow.
 */
 void CH703X::readRegister(uint8_t page, uint8_t index, uint8_t *val, uint8_t count)
 {
-	setRegisterPage(page);
+	uint8_t i;
+
+	for(i=0; i<count; i++)
+	{
+		uint8_t r = index+i;
+		if(page<1 || page>4 || r>=0x80 || !(_shadowValid[page-1][r>>3] & (1<<(r&7)))) break;
+		val[i] = _shadow[page-1][r];
+	}
+	if(i==count)
+		return;
 
-	for(uint8_t i=0; i<count; i++)
-		*val++ = hal_readRegister(index+i);
+	setRegisterPage(page);
+	_i2cTimeout = false;
+	if(!hal_readRegisters(index, val, count))
+	{
+		for(i=0; i<count; i++)
+			val[i] = hal_readRegister(index+i);
+	}
+	if(_i2cTimeout)		//do not keep the zeros of a timeout in the shadow
+		return;
+	for(i=0; i<count; i++)
+		shadowWrite(index+i, val[i]);
 }
 
 const char* CH703X::yesno (int v)
@@ -145,6 +266,7 @@ void CH703X::resetIB(void)
   hal_writeRegister(0x52, 0xC3);  //reset IB and hold data path
   hal_writeRegister(0x52, 0xC1);
   hal_writeRegister(0x52, 0xC3);
+  shadowInvalidate();             //control registers back to default values
 
   setRegisterPage(1);
   hal_writeRegister(0x1C, 0x69);  //MCU clock to 27MHz
@@ -170,88 +292,184 @@ void CH703X::resetDB(void)
 }
 
 /**
-* @brief Initialize CH703x and power it up with video in & out parameters 
-* @param lcdParamInOut[][2] is a 2-D array generated by an offline tool provided by Chrontel
+* @brief  FNV-1a checksum of the entries of a register table up to the 0x7F end mark, the key of the scaler increments cache.
 */
-bool CH703X::init(const uint8_t lcdParamInOut[][2])
+static uint32_t tableChecksum(const uint8_t lcdParamInOut[][2])
 {
-  uint32_t i, val_t=0;
-  uint32_t hinc_reg, hinca_reg, hincb_reg;
-  uint32_t vinc_reg, vinca_reg, vincb_reg;
-  uint32_t hdinc_reg, hdinca_reg, hdincb_reg;
+  uint32_t sum = 2166136261UL;
+  uint32_t i = 0;
 
-  //get the size of register table
-  while(lcdParamInOut[val_t++][0]!=0x7F)
-  ;
-  //printf("Table size = %d\n", val_t);
+  do
+  {
+    sum = (sum ^ lcdParamInOut[i][0]) * 16777619UL;
+    sum = (sum ^ lcdParamInOut[i][1]) * 16777619UL;
+  } while(lcdParamInOut[i++][0]!=0x7F);
+  return sum;
+}
+
+/**
+* @brief  Scaler increments HINC, VINC and HDINC for a register table, page 4 registers 0x36 to 0x3E.
+* @param  lcdParamInOut[][2] is the register table just written, its entries are the key of the cache. NULL for timing
+*         set in run time, which is neither looked up nor kept.
+* @param  downSample is true if down sample is enabled, R1_25h[6], when HDINC is required too
+* @param  *inc points to 9 bytes for the increments in register order from 0x36
+* @return number of registers to write from 0x36, i.e. 6 or 9 with HDINC; 0 on error
+* @note   HINCA/HINCB, VINCA/VINCB and HDINCA/HDINCB are worked out by CH703X from the table, not held in it,
+*         so they are read back once in a single burst. The increments are kept for the last CH703X_INC_CACHE_SIZE
+*         tables so switching between them again has no read back at all. All values are 11-bit so x*2^20 fits in 32 bits.
+*/
+uint8_t CH703X::scalerIncrements(const uint8_t lcdParamInOut[][2], bool downSample, uint8_t *inc)
+{
+  uint8_t r[12], k;
+  uint32_t hinca_reg, hincb_reg, vinca_reg, vincb_reg, hdinca_reg, hdincb_reg;
+  uint32_t hinc_reg, vinc_reg, hdinc_reg;
+  uint32_t sum = lcdParamInOut ? tableChecksum(lcdParamInOut) : 0;
 
-  //1. write register table
-  for(i=0; i<val_t; ++i)
+  for(k=0; lcdParamInOut && k<CH703X_INC_CACHE_SIZE; k++)
   {
-    hal_writeRegister(lcdParamInOut[i][0], lcdParamInOut[i][1]);
-    //printf("Register writing: %x, value: %x\n", lcdParamInOut[i][0],lcdParamInOut[i][1]);
+    if(_incCache[k].count==(downSample? 9 : 6) && _incCache[k].sum==sum)
+    {
+      memcpy(inc, _incCache[k].inc, _incCache[k].count);
+      return _incCache[k].count;
+    }
   }
 
-  hal_writeRegister(0x03, 0x01);  //page 2
-  hal_writeRegister(0x4F, 0xC0);  //match I2S_LENGTH[1:0] of 0b00
-  
-  //2. calculate online parameters
-  hal_writeRegister(0x03, 0x00);  //page 1 
-  i = hal_readRegister(0x25);
-  hal_writeRegister(0x03, 4);     //page 4
-  //HINCA:
-  val_t = hal_readRegister(0x2A);
-  hinca_reg = (val_t << 3) | (hal_readRegister(0x2B) & 0x07);
-  //HINCB:
-  val_t = hal_readRegister(0x2C);
-  hincb_reg = (val_t << 3) | (hal_readRegister(0x2D) & 0x07);
-  //VINCA:
-  val_t = hal_readRegister(0x2E);
-  vinca_reg = (val_t << 3) | (hal_readRegister(0x2F) & 0x07);
-  //VINCB:
-  val_t = hal_readRegister(0x30);
-  vincb_reg = (val_t << 3) | (hal_readRegister(0x31) & 0x07);
-  //HDINCA:
-  val_t = hal_readRegister(0x32);
-  hdinca_reg = (val_t << 3) | (hal_readRegister(0x33) & 0x07);
-  //HDINCB:
-  val_t = hal_readRegister(0x34);
-  hdincb_reg = (val_t << 3) | (hal_readRegister(0x35) & 0x07);
+  setRegisterPage(4);
+  if(!hal_readRegisters(0x2A, r, 12))
+  {
+    printf("Err: scaler read back failed\n");
+    return 0;
+  }
+  hinca_reg  = ((uint32_t)r[0]  << 3) | (r[1]  & 0x07);  //HINCA
+  hincb_reg  = ((uint32_t)r[2]  << 3) | (r[3]  & 0x07);  //HINCB
+  vinca_reg  = ((uint32_t)r[4]  << 3) | (r[5]  & 0x07);  //VINCA
+  vincb_reg  = ((uint32_t)r[6]  << 3) | (r[7]  & 0x07);  //VINCB
+  hdinca_reg = ((uint32_t)r[8]  << 3) | (r[9]  & 0x07);  //HDINCA
+  hdincb_reg = ((uint32_t)r[10] << 3) | (r[11] & 0x07);  //HDINCB
+
+  if(hincb_reg == 0 || vincb_reg == 0)
+  {
+    printf("Err: hincb_reg==0 or vincb_reg==0\n");
+    return 0;
+  }
+  if(hinca_reg > hincb_reg)
+  {
+    printf("Err: hinca_reg > hincb_reg\n");
+    return 0;
+  }
+  hinc_reg = (hinca_reg << 20) / hincb_reg;
+  vinc_reg = (vinca_reg << 20) / vincb_reg;
+  inc[0] = (hinc_reg >> 16) & 0xFF;
+  inc[1] = (hinc_reg >>  8) & 0xFF;
+  inc[2] = (hinc_reg >>  0) & 0xFF;
+  inc[3] = (vinc_reg >> 16) & 0xFF;
+  inc[4] = (vinc_reg >>  8) & 0xFF;
+  inc[5] = (vinc_reg >>  0) & 0xFF;
+  k = 6;
   //no calculate hdinc if down sample disabled
-  if(i & (1 << 6))
+  if(downSample)
   {
     if(hdincb_reg == 0)
     {
       printf("Err: hdincb_reg==0\n");
-      return false;
+      return 0;
     }
-    hdinc_reg = (uint32_t)(((uint64_t)hdinca_reg) * (1 << 20) / hdincb_reg);
-    hal_writeRegister(0x3C, (hdinc_reg >> 16) & 0xFF);
-    hal_writeRegister(0x3D, (hdinc_reg >>  8) & 0xFF);
-    hal_writeRegister(0x3E, (hdinc_reg >>  0) & 0xFF);
+    hdinc_reg = (hdinca_reg << 20) / hdincb_reg;
+    inc[6] = (hdinc_reg >> 16) & 0xFF;
+    inc[7] = (hdinc_reg >>  8) & 0xFF;
+    inc[8] = (hdinc_reg >>  0) & 0xFF;
+    k = 9;
   }
-  if(hincb_reg == 0 || vincb_reg == 0)
+
+  if(lcdParamInOut)
   {
-    printf("Err: hincb_reg==0 or vincb_reg==0\n");
-    return false;
+    _incCache[_incNext].sum = sum;
+    _incCache[_incNext].count = k;
+    memcpy(_incCache[_incNext].inc, inc, k);
+    _incNext = (_incNext+1)%CH703X_INC_CACHE_SIZE;
   }
-  if(hinca_reg > hincb_reg)
+  return k;
+}
+
+/**
+* @brief  Write a register table generated by the offline tool, a run of consecutive indices on the same page in one burst.
+* @param  lcdParamInOut[][2] is the register table
+* @param  *r1_25h returns R1_25h from the table for the down sample bit, -1 if it is not in the table
+* @param  *incFound returns true if the table holds the scaler increments from "i2c,inc"
+*/
+void CH703X::writeTable(const uint8_t lcdParamInOut[][2], int16_t *r1_25h, bool *incFound)
+{
+  uint32_t i, val_t=0;
+  uint8_t run, burst[CH703X_I2C_BURST_MAX];
+  uint8_t page = 1;
+
+  *r1_25h = -1;
+  *incFound = false;
+
+  //get the size of register table
+  while(lcdParamInOut[val_t++][0]!=0x7F)
+  ;
+  //printf("Table size = %d\n", val_t);
+
+  //the page register 0x03 is always written alone so a burst never crosses a page.
+  for(i=0; i<val_t; i+=run)
   {
-    printf("Err: hinca_reg > hincb_reg\n");
-    return false;
+    burst[0] = lcdParamInOut[i][1];
+    run = 1;
+    if(lcdParamInOut[i][0]==0x03)
+    {
+      page = (lcdParamInOut[i][1]==0)? 1 : (lcdParamInOut[i][1]==1)? 2 : lcdParamInOut[i][1];
+    }
+    else
+    {
+      while((i+run)<val_t && run<CH703X_I2C_BURST_MAX &&
+            lcdParamInOut[i+run][0]!=0x03 && lcdParamInOut[i+run][0]==(uint8_t)(lcdParamInOut[i][0]+run))
+      {
+        burst[run] = lcdParamInOut[i+run][1];
+        run++;
+      }
+    }
+    for(uint8_t k=0; k<run; k++)  //registers kept for startScaler()
+    {
+      uint8_t index = lcdParamInOut[i][0]+k;
+      if(page==1 && index==0x25) *r1_25h = burst[k];
+      if(page==4 && index==0x36) *incFound = true;
+    }
+    hal_writeRegisters(lcdParamInOut[i][0], burst, run);
+    //printf("Register writing: %x, count: %d\n", lcdParamInOut[i][0], run);
+  }
+}
+
+/**
+* @brief  Set the scaler increments and start CH703X running after its registers are written.
+* @param  lcdParamInOut[][2] is the register table written, key of the increment cache. NULL for timing set in run time.
+* @param  r1_25h is R1_25h written, -1 to read it back
+* @param  incFound is true if the scaler increments are written already
+*/
+bool CH703X::startScaler(const uint8_t lcdParamInOut[][2], int16_t r1_25h, bool incFound)
+{
+  uint8_t inc[9], count, val_t;
+
+  setRegisterPage(2);
+  hal_writeRegister(0x4F, 0xC0);  //match I2S_LENGTH[1:0] of 0b00
+  
+  //scaler increments, skipped if the table already has them from "i2c,inc"
+  if(!incFound)
+  {
+    if(r1_25h<0)
+    {
+      readRegister(1, 0x25, &val_t, 1);
+      r1_25h = val_t;
+    }
+    count = scalerIncrements(lcdParamInOut, r1_25h & (1 << 6), inc);
+    if(!count) return false;
+    setRegisterPage(4);
+    hal_writeRegisters(0x36, inc, count);
   }
-  hinc_reg = (uint32_t)((uint64_t)hinca_reg * (1 << 20) / hincb_reg);
-  vinc_reg = (uint32_t)((uint64_t)vinca_reg * (1 << 20) / vincb_reg);
-  hal_writeRegister(0x36, (hinc_reg >> 16) & 0xFF);
-  hal_writeRegister(0x37, (hinc_reg >>  8) & 0xFF);
-  hal_writeRegister(0x38, (hinc_reg >>  0) & 0xFF);
-  hal_writeRegister(0x39, (vinc_reg >> 16) & 0xFF);
-  hal_writeRegister(0x3A, (vinc_reg >>  8) & 0xFF);
-  hal_writeRegister(0x3B, (vinc_reg >>  0) & 0xFF);
-
-  //3. Start to running:
-  hal_writeRegister(0x03, 0x00);
-  val_t = hal_readRegister(0x0A);         //Power state register 4
+
+  //Start to running:
+  readRegister(1, 0x0A, &val_t, 1);       //Power state register 4
+  setRegisterPage(1);
   hal_writeRegister(0x0A, val_t | 0x80);  //MEMINIT bit set 1->0 to end SDRAM init end
   hal_writeRegister(0x0A, val_t & 0x7F);  //MEMINIT = R1_0Ah[7]
   val_t = hal_readRegister(0x0A);
@@ -262,33 +480,404 @@ bool CH703X::init(const uint8_t lcdParamInOut[][2])
   printf("CH703X start running from here...\n");
   return true;
 }
+
+/**
+* @brief Initialize CH703x and power it up with video in & out parameters 
+* @param lcdParamInOut[][2] is a 2-D array generated by an offline tool provided by Chrontel
+*/
+bool CH703X::init(const uint8_t lcdParamInOut[][2])
+{
+  int16_t r1_25h;
+  bool incFound;
+
+  writeTable(lcdParamInOut, &r1_25h, &incFound);
+  if(!startScaler(lcdParamInOut, r1_25h, incFound))
+    return false;
+
+  _last.table = lcdParamInOut;
+  _last.fromEdid = false;
+  _lastValid = true;
+  return true;
+}
     
+///@note Register tables of videoInOutMap.h with the timing they are made for, base of init() with timing in run time
+typedef struct {
+  const uint8_t (*table)[2];
+  const LCDParam *videoIn;
+  uint16_t width, height;   //output active resolution, frame lines if interlaced
+  uint32_t pclk;            //output pixel clock in kHz, page 4 registers 0x10 to 0x12
+  uint8_t  monitorType;     //DVI or HDMI_A
+  bool     interlaced;
+} CH703X_TABLE_INFO;
+
+static const CH703X_TABLE_INFO tableInfo[] =
+{
+  {VIDEO_in_640x480_out_DVI_800x600_60Hz,   &CEA_640x480p_60Hz,   800,  600,  40000, DVI, false},
+  {VIDEO_in_800x600_out_DVI_1024x768_60Hz,  &SVGA_800x600_60Hz,   1024, 768,  65000, DVI, false},
+  {VIDEO_in_800x480_out_DVI_1280x768_60Hz,  &WVGA_800x480_60Hz,   1280, 768,  79500, DVI, false},
+  {VIDEO_in_1280x720_out_DVI_1280x768_60Hz, &CEA_1280x720p_60Hz,  1280, 768,  68250, DVI, false},
+  {VIDEO_in_800x600_out_DVI_1280x960_60Hz,  &SVGA_800x600_60Hz,   1280, 960,  108000, DVI, false},
+  {VIDEO_in_720x576_out_DVI_1280x1024_60Hz, &CEA_720x576p_50Hz,   1280, 1024, 108000, DVI, false},
+  {VIDEO_in_1280x720_out_DVI_1280x1024_60Hz,&CEA_1280x720p_60Hz,  1280, 1024, 108000, DVI, false},
+  {VIDEO_in_800x600_out_DVI_1600x1200_60Hz, &SVGA_800x600_60Hz,   1600, 1200, 162000, DVI, false},
+  {VIDEO_in_1280x720_out_DVI_1600x1200_60Hz,&CEA_1280x720p_60Hz,  1600, 1200, 162000, DVI, false},
+  {VIDEO_in_720x480_out_DVI_720p_60Hz,      &CEA_720x480p_60Hz,   1280, 720,  74250, DVI, false},
+  {VIDEO_in_1280x720_out_DVI_1080p_60Hz,    &CEA_1280x720p_60Hz,  1920, 1080, 148500, DVI, false},
+  {VIDEO_in_480x272_out_HDMI_480p_60Hz,     &WQVGA_480x272_60Hz,  720,  480,  27027, HDMI_A, false},
+  {VIDEO_in_720x480_out_HDMI_720p_60Hz,     &CEA_720x480p_60Hz,   1280, 720,  74250, HDMI_A, false},
+  {VIDEO_in_848x480_out_HDMI_720p_60Hz,     &FWVGA_848x480_60Hz,  1280, 720,  74250, HDMI_A, false},
+  {VIDEO_in_640x480_out_HDMI_720p_60Hz,     &CEA_640x480p_60Hz,   1280, 720,  74250, HDMI_A, false},
+  {VIDEO_in_480x272_out_HDMI_720p_60Hz,     &WQVGA_480x272_60Hz,  1280, 720,  74250, HDMI_A, false},
+  {VIDEO_in_1280x720_out_HDMI_1080i_60Hz,   &CEA_1280x720p_60Hz,  1920, 1080, 74250, HDMI_A, true},
+  {VIDEO_in_1280x720_out_HDMI_1080p_60Hz,   &CEA_1280x720p_60Hz,  1920, 1080, 148500, HDMI_A, false},
+  {VIDEO_in_640x480_out_HDMI_1080p_60Hz,    &CEA_640x480p_60Hz,   1920, 1080, 148500, HDMI_A, false},
+  {VIDEO_in_480x272_out_HDMI_1080p_60Hz,    &WQVGA_480x272_60Hz,  1920, 1080, 148500, HDMI_A, false},
+};
+
+/**
+* @brief  Register table to start from for an output pixel clock in kHz, NULL if none is made for it.
+* @note   Same output pixel clock (within 0.5%), then the same monitor type, output resolution and the closest input.
+*/
+static const CH703X_TABLE_INFO *baseTable(const LCDParam *videoIn, const LCDParam *videoOut, uint32_t pclkOut, bool interlaced, bool hdmi)
+{
+  const CH703X_TABLE_INFO *base = NULL;
+  uint32_t score, best = 0xFFFFFFFF;
+
+  for(uint8_t i=0; i<sizeof(tableInfo)/sizeof(tableInfo[0]); i++)
+  {
+    const CH703X_TABLE_INFO *t = &tableInfo[i];
+    uint32_t diff = (t->pclk > pclkOut)? (t->pclk - pclkOut) : (pclkOut - t->pclk);
+
+    if(diff*200 > pclkOut) continue;                      //PLL & serializer made for another clock
+    if(!hdmi && t->monitorType!=DVI) continue;            //no HDMI data island to a DVI monitor
+    score  = (t->monitorType==DVI && hdmi)? 0x40000 : 0;  //DVI table to HDMI works without audio
+    score += (t->width!=videoOut->width || t->height!=videoOut->height || t->interlaced!=interlaced)? 0x20000 : 0;
+    score += abs((int)t->videoIn->width - (int)videoIn->width) + abs((int)t->videoIn->height - (int)videoIn->height);
+    if(score < best) {best = score; base = t;}
+  }
+  return base;
+}
+
+/**
+* @brief  true if w1 x h1 has the aspect ratio of w2 x h2 within 5%, square pixels on both.
+*/
+static bool sameAspect(uint16_t w1, uint16_t h1, uint16_t w2, uint16_t h2)
+{
+  uint32_t a = (uint32_t)w1*h2, b = (uint32_t)h1*w2;
+  return ((a>b)? (a-b) : (b-a))*20 <= b;
+}
+
+///@note RGB timing RA8876 can generate for CH703X to scale up, candidates of selectSource()
+static const LCDParam *const sourceList[] =
+{
+  &WQVGA_480x272_60Hz, &CEA_640x480p_60Hz, &CEA_720x480p_60Hz, &CEA_720x576p_50Hz, &WVGA_800x480_60Hz,
+  &FWVGA_848x480_60Hz, &SVGA_800x600_60Hz, &VESA_1024x768_60Hz, &VESA_1366x768_60Hz, &CEA_1280x720p_60Hz,
+};
+
+/**
+* @brief  Value of a register in a register table, read from CH703X if the table does not set it.
+*/
+uint8_t CH703X::tableRegister(const uint8_t lcdParamInOut[][2], uint8_t page, uint8_t index)
+{
+  uint8_t p = 1, i, val;
+  int16_t found = -1;
+
+  for(i=0; lcdParamInOut[i][0]!=0x7F; i++)
+  {
+    if(lcdParamInOut[i][0]==0x03)
+      p = (lcdParamInOut[i][1]==0)? 1 : (lcdParamInOut[i][1]==1)? 2 : lcdParamInOut[i][1];
+    else if(p==page && lcdParamInOut[i][0]==index)
+      found = lcdParamInOut[i][1];
+  }
+  if(found>=0) return (uint8_t)found;
+
+  readRegister(page, index, &val, 1);
+  return val;
+}
+
+/**
+* @brief  Write the register table made for the output pixel clock, then input & output timing of CH703X in run time.
+* @param  *videoIn is the RGB timing generated by RA8876.
+* @param  *videoOut is the timing to the monitor. pclk of videoOut is not used.
+* @param  pclkOut is the output pixel clock in kHz.
+* @param  interlaced is true for an interlaced output, with videoOut in frame lines.
+* @param  monitorType is DVI or HDMI_A.
+* @note   Base table is found by baseTable(). Clock, SDRAM and serializer registers are kept from it. Page 1 registers
+*         0x0B to 0x2A hold the input and output timing, page 4 registers 0x10 to 0x12 the output pixel clock.
+*/
+bool CH703X::initTiming(const LCDParam *videoIn, const LCDParam *videoOut, uint32_t pclkOut, bool interlaced, uint8_t monitorType)
+{
+  const CH703X_TABLE_INFO *base;
+  uint8_t  r[12];
+  bool hdmi = (monitorType==HDMI_A || monitorType==HDMI_B);
+
+  if(videoOut->width < videoIn->width || videoOut->height < videoIn->height)
+  {
+    printf("Err: video out %dx%d smaller than video in %dx%d\n", videoOut->width, videoOut->height, videoIn->width, videoIn->height);
+    return false;
+  }
+
+  base = baseTable(videoIn, videoOut, pclkOut, interlaced, hdmi);
+  if(!base)
+  {
+    printf("Err: no register table in videoInOutMap.h for output pixel clock %lukHz\n", (unsigned long)pclkOut);
+    return false;
+  }
+
+  int16_t r1_25h;
+  bool incFound;
+  writeTable(base->table, &r1_25h, &incFound);
+
+  uint16_t hti = videoIn->width + videoIn->hblank, vti = videoIn->height + videoIn->vblank;
+  uint16_t hto = videoOut->width + videoOut->hblank, vto = videoOut->height + videoOut->vblank;
+  uint32_t pclkIn = ClockPixelKHz(videoIn->pclk);
+
+  uint8_t r1_19h = tableRegister(base->table, 1, 0x19);
+  uint8_t r1_1Eh = tableRegister(base->table, 1, 0x1E);
+  uint8_t r1_40h = tableRegister(base->table, 1, 0x40);
+  uint8_t r4_10h = tableRegister(base->table, 4, 0x10);
+  r1_25h = tableRegister(base->table, 1, 0x25);
+
+  //input timing HTI, HAI, HOI, HWI, VTI, VAI, VOI, VWI
+  r[0]  = ((hti>>8)&0x0F)<<3 | ((videoIn->width>>8)&0x07);
+  r[1]  = (uint8_t)videoIn->width;
+  r[2]  = (uint8_t)hti;
+  r[3]  = ((videoIn->hpulse>>8)&0x07)<<3 | ((videoIn->hfporch>>8)&0x07);
+  r[4]  = (uint8_t)videoIn->hfporch;
+  r[5]  = (uint8_t)videoIn->hpulse;
+  r[6]  = ((vti>>8)&0x07)<<3 | ((videoIn->height>>8)&0x07);
+  r[7]  = (uint8_t)videoIn->height;
+  r[8]  = (uint8_t)vti;
+  r[9]  = ((videoIn->vpulse>>8)&0x07)<<3 | ((videoIn->vfporch>>8)&0x07);
+  r[10] = (uint8_t)videoIn->vfporch;
+  r[11] = (uint8_t)videoIn->vpulse;
+  setRegisterPage(1);
+  hal_writeRegisters(0x0B, r, 12);
+
+  //input sync polarity and GCLKFREQ[17:0]
+  r[0] = (r1_19h & 0xC4) | (videoIn->hsyncPolarity<<5) | (videoIn->vsyncPolarity<<4) | ((!videoIn->dePolarity)<<3) | ((pclkIn>>16)&0x03);
+  r[1] = (uint8_t)(pclkIn>>8);
+  r[2] = (uint8_t)pclkIn;
+  hal_writeRegisters(0x19, r, 3);
+  hal_writeRegister(0x1E, interlaced? (r1_1Eh|0x20) : (r1_1Eh&~0x20));  //INTLC
+
+  //output timing HTO, HAO, HOO, HWO, VTO, VAO, VOO, VWO
+  r[0]  = ((hto>>8)&0x0F)<<3 | ((videoOut->width>>8)&0x07);
+  r[1]  = (uint8_t)videoOut->width;
+  r[2]  = (uint8_t)hto;
+  r[3]  = ((videoOut->hpulse>>8)&0x07)<<3 | ((videoOut->hfporch>>8)&0x07);
+  r[4]  = (uint8_t)videoOut->hfporch;
+  r[5]  = (uint8_t)videoOut->hpulse;
+  r[6]  = (r1_25h & 0xC0) | ((vto>>8)&0x07)<<3 | ((videoOut->height>>8)&0x07);  //down sample bit kept
+  r[7]  = (uint8_t)videoOut->height;
+  r[8]  = (uint8_t)vto;
+  r[9]  = ((videoOut->vpulse>>8)&0x07)<<3 | ((videoOut->vfporch>>8)&0x07);
+  r[10] = (uint8_t)videoOut->vfporch;
+  r[11] = (uint8_t)videoOut->vpulse;
+  hal_writeRegisters(0x1F, r, 12);
+  r1_25h = r[6];
+
+  //CEA-861 VIC of the table is kept only for the same output format, no VIC otherwise
+  if(hdmi && (base->width!=videoOut->width || base->height!=videoOut->height || base->interlaced!=interlaced))
+    hal_writeRegister(0x40, 0);
+  else
+    hal_writeRegister(0x40, r1_40h);
+
+  //output pixel clock
+  r[0] = (r4_10h & 0xFC) | ((pclkOut>>16)&0x03);
+  r[1] = (uint8_t)(pclkOut>>8);
+  r[2] = (uint8_t)pclkOut;
+  setRegisterPage(4);
+  hal_writeRegisters(0x10, r, 3);
+
+  if(!startScaler(NULL, r1_25h, false))    //increments worked out again for the new timing
+    return false;
+
+  _last.table = NULL;
+  _last.videoIn = *videoIn;
+  _last.videoOut = *videoOut;
+  _last.pclkOut = pclkOut;
+  _last.interlaced = interlaced;
+  _last.monitorType = monitorType;
+  _last.fromEdid = false;
+  _lastValid = true;
+  return true;
+}
+
 /**
 * @brief  Initialize CH703x and power it up with video in & out timing parameters in run time.
 * @param  *videoIn is a pointer to video in from the RGB source.
 * @param  *videoOut is a pointer to video out generated by CH703x.
-* @param  monitorType indicates if it is a VGA, HDTV, HDMI, or DVI output.
-* @note	  This one not working yet. Please use bool init(const uint8_t lcdParamInOut[][2]) instead
+* @param  monitorType is DVI or HDMI_A of enum Interface in edid.h
+* @note   Example to use:<br>
+*         const LCDParam *src = CH703X::selectSource(&VESA_1024x768_60Hz);
+*         ra8876lite.begin(src);
+*         HDMI_Tx.init(src, &VESA_1024x768_60Hz, DVI);
 */
-/*
 bool CH703X::init(const LCDParam *videoIn, const LCDParam *videoOut, uint8_t monitorType)
 {
-	setInputHorizontalTotal(videoIn->width + videoIn->hblank);
-	setInputHsyncActiveWidth(videoIn->width);
-	setInputHsyncFrontPorch(videoIn->hfporch);
-	setInputHsyncPulseWidth(videoIn->hpulse);
+  return initTiming(videoIn, videoOut, ClockPixelKHz(videoOut->pclk), false, monitorType);
+}
 
-	setInputVerticalTotal(videoIn->height + videoIn->vblank);
-	setInputVsyncActiveHeight(videoIn->height);
-	setInputVsyncFrontPorch(videoIn->vfporch);
-	setInputVsyncPulseWidth(videoIn->vpulse);
+/**
+* @brief  Initialize CH703x with the output timing from an EDID detailed timing, e.g. the native mode of a monitor.
+* @note   Example to use:<br>
+*         MonitorInfo *info = decode_edid(edid);
+*         LCDParam native;
+*         CH703X::timingFromEdid(&info->detailed_timings[0], &native);
+*         const LCDParam *src = CH703X::selectSource(&native, 800, 480);
+*         ra8876lite.begin(src);
+*         HDMI_Tx.init(src, &info->detailed_timings[0], DVI);
+*         free(info);
+*/
+bool CH703X::init(const LCDParam *videoIn, const DetailedTiming *videoOut, uint8_t monitorType)
+{
+  LCDParam out;
 
-	setInputPclkFrequency((videoIn->pclk)*1000);
-	setInputSyncPolarity(videoIn->hsyncPolarity, videoIn->vsyncPolarity, videoIn->dePolarity);
+  timingFromEdid(videoOut, &out);
+  if(!initTiming(videoIn, &out, videoOut->pixel_clock/1000, videoOut->interlaced, monitorType))
+    return false;
 
-	return true;
+  _last.edidOut = *videoOut;
+  _last.fromEdid = true;
+  return true;
+}
+
+/**
+* @brief  Convert an EDID detailed timing to LCDParam, pixel clock rounded to MHz. Interlaced timing is in frame lines.
+*/
+void CH703X::timingFromEdid(const DetailedTiming *dt, LCDParam *lcd)
+{
+  uint8_t field = dt->interlaced? 2 : 1;
+
+  lcd->name = "EDID detailed timing";
+  lcd->width = dt->h_addr;
+  lcd->height = dt->v_addr*field;
+  lcd->hblank = dt->h_blank;
+  lcd->hfporch = dt->h_front_porch;
+  lcd->hpulse = dt->h_sync;
+  lcd->vblank = dt->v_blank*field + (field-1);  //e.g. 22 lines per field to 45 lines of 1080i
+  lcd->vfporch = dt->v_front_porch*field;
+  lcd->vpulse = dt->v_sync*field;
+  lcd->pclk = (dt->pixel_clock + 500000)/1000000;
+  lcd->vsyncPolarity = dt->digital_sync? !dt->digital.negative_vsync : 0;
+  lcd->hsyncPolarity = dt->digital_sync? !dt->digital.negative_hsync : 0;
+  lcd->pclkPolarity = 0;
+  lcd->dePolarity = 0;
+}
+
+/**
+* @brief  Select the RGB timing for RA8876 that feeds CH703X for a monitor timing with the least SDRAM bandwidth.
+* @note   RA8876 reads its display SDRAM at pixel clock rate, so the lowest pixel clock leaves the most bandwidth
+*         for BTE and MCU writes. Pixels are square on both sides, e.g. 720x576 is taken as 5:4 for a 1280x1024 monitor.
+*/
+const LCDParam *CH703X::selectSource(const LCDParam *videoOut, uint16_t minWidth, uint16_t minHeight, uint16_t maxPclk)
+{
+  const LCDParam *sel = NULL;
+  uint32_t score, best = 0xFFFFFFFF;
+
+  for(uint8_t i=0; i<sizeof(sourceList)/sizeof(sourceList[0]); i++)
+  {
+    const LCDParam *s = sourceList[i];
+    if(s->width > videoOut->width || s->height > videoOut->height) continue;  //up scaling only
+    if(s->pclk > maxPclk) continue;
+
+    bool aspect = sameAspect(s->width, s->height, videoOut->width, videoOut->height);
+    bool big = s->width>=minWidth && s->height>=minHeight;
+
+    score  = aspect? 0 : 0x80000000;
+    score += big? ClockPixelKHz(s->pclk) : 0x40000000 - (uint32_t)s->width*s->height;
+    if(score < best) {best = score; sel = s;}
+  }
+  return sel;
 }
+
+/**
+* @brief  Score the monitor timings of EDID for the combination of RA8876 source and CH703X output of highest throughput.
+* @note   A monitor timing is a candidate only if a register table is made for its pixel clock, see baseTable().
 */
+bool CH703X::selectMode(const MonitorInfo *info, const CeaInfo *cea, uint16_t maxPclk, const LCDParam **source, DetailedTiming *videoOut)
+{
+  bool hdmi = cea && cea->hdmi;
+  uint32_t best = 0, bestOut = 0;
+  uint8_t nBase = info? info->n_detailed_timings : 0;
+  uint8_t nCea = cea? cea->n_detailed_timings : 0;
+  uint8_t nSvd = cea? cea->n_svd : 0;
+
+  *source = NULL;
+  for(uint8_t i=0; i<nBase+nCea+nSvd; i++)
+  {
+    DetailedTiming dt;
+    bool native;
+    LCDParam out;
+
+    if(i<nBase)
+    {
+      dt = info->detailed_timings[i];
+      native = (i==0);                      //preferred timing
+    }
+    else if(i<nBase+nCea)
+    {
+      dt = cea->detailed_timings[i-nBase];
+      native = (i-nBase) < cea->n_native_dtds;
+    }
+    else
+    {
+      if(!cea_vic_timing(cea->svd[i-nBase-nCea], &dt)) continue;
+      native = cea->svd_native[i-nBase-nCea];
+    }
+
+    timingFromEdid(&dt, &out);
+    const LCDParam *s = selectSource(&out, 0xFFFF, 0xFFFF, maxPclk);  //largest source that fits
+    if(!s) continue;
+    if(!baseTable(s, &out, dt.pixel_clock/1000, dt.interlaced, hdmi)) continue;
+
+    uint32_t score = (sameAspect(s->width, s->height, out.width, out.height)? 0x80000000 : 0) + ClockPixelKHz(s->pclk);
+    uint32_t scoreOut = (native? 0x80000000 : 0) + dt.pixel_clock/1000;
+    if(score > best || (score==best && scoreOut > bestOut))
+    {
+      best = score;
+      bestOut = scoreOut;
+      *source = s;
+      *videoOut = dt;
+    }
+  }
+  return *source!=NULL;
+}
+
+/**
+* @brief  Read EDID with its CEA-861 extension and select the mode with selectMode().
+*/
+bool CH703X::bestMode(uint16_t maxPclk, const LCDParam **source, DetailedTiming *videoOut, uint8_t *monitorType)
+{
+  CeaInfo cea;
+  bool hasCea, found;
+
+  if(_edidState!=EDID_DONE && !readEdid())
+  {
+    printf("Read EDID failed.\n");
+    return false;
+  }
+
+  MonitorInfo *info = decode_edid(edidBuf);
+  if(!info)
+  {
+    printf("Is not a valid EDID information.\n");
+    return false;
+  }
+  hasCea = _edidExt && decode_cea_extension(edidExt, &cea);
+
+  found = selectMode(info, hasCea? &cea : NULL, maxPclk, source, videoOut);
+  *monitorType = (hasCea && cea.hdmi)? HDMI_A : DVI;
+  free(info);
+
+  if(found)
+    printf("Mode selected: %dx%d%s %lukHz from %s\n", videoOut->h_addr, videoOut->v_addr, videoOut->interlaced? "i" : "p",
+           (unsigned long)(videoOut->pixel_clock/1000), (*source)->name);
+  else
+    printf("No mode of the monitor can be made.\n");
+  return found;
+}
 
 /**
 *
@@ -313,6 +902,7 @@ void CH703X::begin(void)
     *           This is to switch on color color test in CH7035B.<br>
     *           i2c,r,2,0x10,1      //i2c read from page 2 at register address 0x10 a single byte.<br>
     *           i2c,edid            //read EDID of a monitor.<br>
+    *           i2c,inc             //print scaler increments in use as register table entries.<br>
     */
 void CH703X::parser(char *msg)
 {
@@ -338,6 +928,10 @@ void CH703X::parser(char *msg)
       dump_monitor_info();
       return;
     }
+    else if (!strncmp(token, "inc", sizeof("inc")-1)){
+      printIncrements();
+      return;
+    }
     else if (!strncmp(token,"i2sEnable", sizeof("i2sEnable")-1)){
       CH703X::setI2SAudio(0,0,1);
       return;
@@ -374,7 +968,8 @@ void CH703X::parser(char *msg)
       if(n==0) {printf("Invalid command Ch703x.cpp : Err[7].\n"); return;}
       if(n>32) n = 32;
       uint8_t temp[32];
-      readRegister(_page, _index, temp, n);
+      setRegisterPage(_page);
+      for(uint8_t i=0; i<n; i++) temp[i] = hal_readRegister(_index+i);  //from CH703X, not the shadow
       printf("Read from CH7035B @ page=%d, index=%2Xh, value=", _page, _index);
       for(uint8_t i=0; i<n; i++)
       {
@@ -386,48 +981,242 @@ void CH703X::parser(char *msg)
 }
 
 /**
-* @brief  Read EDID from a HDMI sink device.
+* @brief  Print the scaler increments in use as register table entries.
+* @note   Paste the lines into a table of videoInOutMap.h before its last entry { 0x7F, ... },
+*         then init() writes them with the table and skips the read back and calculation.
+*/
+void CH703X::printIncrements(void)
+{
+  uint8_t inc[9];
+  readRegister(4, 0x36, inc, 9);
+  printf("\t{ 0x03, 0x04 },\n");
+  for(uint8_t i=0; i<9; i++)
+    printf("\t{ 0x%02X, 0x%02X },\n", 0x36+i, inc[i]);
+}
+
+/**
+* @brief  Read EDID from a HDMI sink device, with the first extension block if the base block says there is one.
 * @return true if EDID read OK
 *         false if no EDID can be read
+* @note   The extension, normally CEA-861 of a HDTV, goes to edidExt[] with _edidExt set.
 */
 bool CH703X::readEdid(void)
 {
-  const char es_map[16] = { 0x26,0x27,0x42,0x43,0x44,0x45,0x46,0x51};
+  int8_t ret;
+
+  edidStart();
+  while((ret = edidPoll())==0)
+    ;
+  return ret>0;
+}
+
+/**
+* @brief  Start reading EDID in the background, one step at a time by edidPoll().
+*/
+void CH703X::edidStart(void)
+{
+  _edidExt = false;
+  _edidBlock = 0;
+  _edidChunk = 0;
+  _edidState = EDID_REQUEST;
+}
 
-  uint8_t i, j, ie;
-  uint32_t timeout = 10000;
+/**
+* @brief  Run one step of EDID read started by edidStart(), 8 bytes at a time through the DDC master of CH703X.
+* @return 1 if EDID is read, 0 if still busy, -1 if failed or not started
+* @note   A step is a few register accesses and never waits on DDC. A chunk of 8 bytes not ready in
+*         CH703X_DDC_TIMEOUT_MS fails the read, except in the extension block where the base block is kept.
+*/
+int8_t CH703X::edidPoll(void)
+{
+  const char es_map[16] = { 0x26,0x27,0x42,0x43,0x44,0x45,0x46,0x51};
+  uint8_t *buf = _edidBlock? edidExt : edidBuf;
 
-  for(i=0,j=0; i<16; i++,j+=8) 
+  switch(_edidState)
   {
-    setRegisterPage(1);
-    hal_writeRegister(0x50, i);
-    hal_writeRegister(0x4F, 0x41);
-    while(timeout!=0)
-    {
+    case EDID_REQUEST:
       setRegisterPage(1);
-      if((0x01&hal_readRegister(0x4F))==0x01)
-      { 
-        uint8_t reg = hal_readRegister(0x50);
-        if(!(0x80&reg)){
-          setRegisterPage(2);
-          for(ie=0; ie<8; ie++) edidBuf[j+ie] = hal_readRegister(es_map[ie]);
+      hal_writeRegister(0x50, _edidBlock*16+_edidChunk);
+      hal_writeRegister(0x4F, 0x41);
+      _edidStart = millis();
+      _edidState = EDID_WAIT;
+      return 0;
+
+    case EDID_WAIT:
+      _i2cTimeout = false;
+      setRegisterPage(1);
+      if((0x01&hal_readRegister(0x4F))==0x01 && !(0x80&hal_readRegister(0x50)) && !_i2cTimeout)
+      {
+        setRegisterPage(2);
+        for(uint8_t ie=0; ie<8; ie++) buf[_edidChunk*8+ie] = hal_readRegister(es_map[ie]);
+        if(_i2cTimeout)
           break;
+        _edidState = EDID_REQUEST;
+        if(++_edidChunk<16)
+          return 0;
+
+        //end of a block, go on with the extension if the base block flags one
+        if(_edidBlock==0 && edidBuf[0x7E]!=0)
+        {
+          _edidBlock = 1;
+          _edidChunk = 0;
+          return 0;
         }
+        _edidExt = (_edidBlock==1);
+        _edidState = EDID_DONE;
+        return 1;
       }
-      timeout--;
-    }
+      if(!_i2cTimeout && (millis()-_edidStart) <= CH703X_DDC_TIMEOUT_MS)
+        return 0;
+      break;
+
+    case EDID_DONE:
+      return 1;
+
+    default:
+      return -1;
   }
-/*
-  printf("EDID raw data: " );
-  for(i=0; i<128; i++){
-    printf("0x%x ", edidBuf[i]);
+
+  //DDC or I2C timeout
+  if(_edidBlock==1)
+  {
+    _edidState = EDID_DONE;   //base block kept with no extension
+    return 1;
   }
-  printf("\n");
+  _edidState = EDID_FAILED;
+  return -1;
+}
+
+/**
+* @brief  Start hot plug detection by hotplugPoll().
+* @param  irqPin is CH703X_IRQ to poll HPD only while the pin is low, -1 to poll every CH703X_HPD_POLL_MS
 */
-  if(timeout==0)
+void CH703X::hotplugBegin(int8_t irqPin)
+{
+  _irqPin = irqPin;
+  if(_irqPin>=0)
+    pinMode(_irqPin, INPUT_PULLUP);
+  _hpd = hotplugDetected();
+  _hpdCount = 0;
+  _hpdTime = millis();
+}
+
+/**
+* @brief  Read the hot plug detect status.
+* @return true if a monitor is attached and powered
+*/
+bool CH703X::hotplugDetected(void)
+{
+  setRegisterPage(CH703X_HPD_PAGE);
+  return (hal_readRegister(CH703X_HPD_INDEX) & CH703X_HPD_MASK)!=0;   //status, never from the shadow
+}
+
+/**
+* @brief  Set the last mode of init() again.
+*/
+bool CH703X::resume(void)
+{
+  if(!_lastValid)
     return false;
-  else
-    return true;
+  if(_last.table)
+    return init(_last.table);
+  if(_last.fromEdid)
+    return init(&_last.videoIn, &_last.edidOut, _last.monitorType);
+  return initTiming(&_last.videoIn, &_last.videoOut, _last.pclkOut, _last.interlaced, _last.monitorType);
+}
+
+/**
+* @brief  Check HPD and bring the monitor back when it is plugged in or switched on again.
+* @note   A plug in resumes the last mode within a poll, EDID is then read one step per call.
+*/
+int8_t CH703X::hotplugPoll(void)
+{
+  if(_hpdEdid)
+  {
+    int8_t ret = edidPoll();
+    if(ret==0)
+      return CH703X_HPD_NONE;
+    _hpdEdid = false;
+
+    //output timing follows the native timing of a new monitor, only if the last mode is from EDID
+    DetailedTiming native;
+    uint8_t monitorType;
+    if(ret<0 || !_lastValid || !_last.fromEdid || !nativeTiming(&native, &monitorType))
+      return CH703X_HPD_NONE;
+    if(native.h_addr==_last.edidOut.h_addr && native.v_addr==_last.edidOut.v_addr && native.interlaced==_last.edidOut.interlaced &&
+       native.pixel_clock==_last.edidOut.pixel_clock && monitorType==_last.monitorType)
+      return CH703X_HPD_NONE;
+
+    LCDParam videoIn = _last.videoIn;
+    if(init(&videoIn, &native, monitorType))
+      return CH703X_HPD_MODE_CHANGED;
+    resume();   //no table for the new timing, keep the last one
+    return CH703X_HPD_NONE;
+  }
+
+  //reads are CH703X_HPD_POLL_MS apart, with CH703X_IRQ only while it is low or a change is debounced.
+  //The interrupt is not enabled nor cleared in CH703X, so a pin that stays low costs no more than polling.
+  if((millis()-_hpdTime) < CH703X_HPD_POLL_MS)
+    return CH703X_HPD_NONE;
+  if(_irqPin>=0 && _hpdCount==0 && digitalRead(_irqPin)==HIGH)
+    return CH703X_HPD_NONE;
+  _hpdTime = millis();
+
+  int8_t hpd = hotplugDetected();
+  if(_hpd<0)
+    _hpd = hpd;         //hotplugBegin() not called, take the first read as it is
+  if(hpd==_hpd)
+  {
+    _hpdCount = 0;
+    return CH703X_HPD_NONE;
+  }
+  if(++_hpdCount < CH703X_HPD_DEBOUNCE)
+    return CH703X_HPD_NONE;
+
+  _hpdCount = 0;
+  _hpd = hpd;
+  if(!hpd)
+  {
+    _edidState = EDID_IDLE;   //EDID of the monitor gone is read again
+    return CH703X_HPD_UNPLUGGED;
+  }
+
+  resume();
+  edidStart();
+  _hpdEdid = true;
+  return CH703X_HPD_RESUMED;
+}
+
+/**
+* @brief  Read EDID and get the native timing of the monitor, which is the first detailed timing.
+* @param  *native returns the timing
+* @param  *monitorType returns HDMI_A if EDID has the HDMI vendor specific data block or says the interface is HDMI,
+*         DVI otherwise
+* @return false if no EDID can be read or it has no detailed timing
+*/
+bool CH703X::nativeTiming(DetailedTiming *native, uint8_t *monitorType)
+{
+  if(_edidState!=EDID_DONE && !readEdid())
+  {
+    printf("Read EDID failed.\n");
+    return false;
+  }
+
+  MonitorInfo *info = decode_edid(edidBuf);
+  if(!info || info->n_detailed_timings==0)
+  {
+    printf("No detailed timing in EDID.\n");
+    free(info);
+    return false;
+  }
+
+  CeaInfo cea;
+  bool hdmi = _edidExt && decode_cea_extension(edidExt, &cea) && cea.hdmi;
+
+  *native = info->detailed_timings[0];
+  *monitorType = (hdmi || (info->is_digital && (info->digital.interface==HDMI_A || info->digital.interface==HDMI_B)))? HDMI_A : DVI;
+  free(info);
+  return true;
 }
 
 /**
@@ -711,8 +1500,8 @@ void CH703X::setInputHorizontalTotal(uint16_t hti)
   hti_hibyte&=0x0F;
   REG_R1_0Bh |=(hti_hibyte<<3);
   //setRegisterPage(1);
-  hal_writeRegister(0x0B, REG_R1_0Bh);		//HTI[11:8] 
-  hal_writeRegister(0x0D, (uint8_t)hti);	//HTI[7:0]
+  writeRegister(1, 0x0B, REG_R1_0Bh);		//HTI[11:8] 
+  writeRegister(1, 0x0D, (uint8_t)hti);	//HTI[7:0]
 }
 
 /**
@@ -728,8 +1517,8 @@ void CH703X::setInputHsyncFrontPorch(uint16_t hoi)
   hoi_hibyte&=0x07;							//0b111 restriction
   REG_R1_0Eh|=hoi_hibyte;
   //setRegisterPage(1);
-  hal_writeRegister(0x0E, REG_R1_0Eh);		//HOI[10:8]
-  hal_writeRegister(0x0F, (uint8_t)hoi);	//HOI[7:0]
+  writeRegister(1, 0x0E, REG_R1_0Eh);		//HOI[10:8]
+  writeRegister(1, 0x0F, (uint8_t)hoi);	//HOI[7:0]
 }
 
 /**
@@ -745,8 +1534,8 @@ void CH703X::setInputHsyncActiveWidth(uint16_t hai)
   hai_hibyte&=0x07;							//0b111 restriction
   REG_R1_0Bh|=hai_hibyte;
   //setRegisterPage(1);
-  hal_writeRegister(0x0B, REG_R1_0Bh);		//HAI[10:8]
-  hal_writeRegister(0x0C, (uint8_t)hai);	//HAI[7:0]  
+  writeRegister(1, 0x0B, REG_R1_0Bh);		//HAI[10:8]
+  writeRegister(1, 0x0C, (uint8_t)hai);	//HAI[7:0]  
 }
 
 /**
@@ -762,8 +1551,8 @@ void CH703X::setInputHsyncPulseWidth(uint16_t hwi)
   hwi_hibyte&=0x07;
   REG_R1_0Eh |=(hwi_hibyte<<3);
   //setRegisterPage(1);
-  hal_writeRegister(0x0E, REG_R1_0Eh);		//HWI[10:8]
-  hal_writeRegister(0x10, (uint8_t)hwi);	//HWI[7:0]  
+  writeRegister(1, 0x0E, REG_R1_0Eh);		//HWI[10:8]
+  writeRegister(1, 0x10, (uint8_t)hwi);	//HWI[7:0]  
 }
 
 /**
@@ -779,8 +1568,8 @@ void CH703X::setInputVerticalTotal(uint16_t vti)
 	vti_hibyte &= 0x07;
 	REG_R1_11h |= (vti_hibyte << 3);
 	//setRegisterPage(1);
-	hal_writeRegister(0x11, REG_R1_11h);	//VTI[10:8]
-	hal_writeRegister(0x13, (uint8_t)vti);	//VTI[7:0]
+	writeRegister(1, 0x11, REG_R1_11h);	//VTI[10:8]
+	writeRegister(1, 0x13, (uint8_t)vti);	//VTI[7:0]
 }
 
 /**
@@ -796,8 +1585,8 @@ void CH703X::setInputVsyncActiveHeight(uint16_t vai)
   vai_hibyte &= 0x07;
   REG_R1_11h|=vai_hibyte;
   //setRegisterPage(1);
-  hal_writeRegister(0x11, REG_R1_11h);   //VAI[10:8]
-  hal_writeRegister(0x12, (uint8_t)vai); //VAI[7:0]
+  writeRegister(1, 0x11, REG_R1_11h);   //VAI[10:8]
+  writeRegister(1, 0x12, (uint8_t)vai); //VAI[7:0]
 }
 
 /**
@@ -813,8 +1602,8 @@ void CH703X::setInputVsyncFrontPorch(uint16_t voi)
 	voi_hibyte &= 0x07;	
 	REG_R1_14h |= voi_hibyte;
 	//setRegisterPage(1);
-	hal_writeRegister(0x14, REG_R1_14h);	//VOI[10:8]
-	hal_writeRegister(0x15, (uint8_t)voi);	//VOI[7:0]
+	writeRegister(1, 0x14, REG_R1_14h);	//VOI[10:8]
+	writeRegister(1, 0x15, (uint8_t)voi);	//VOI[7:0]
 }
 
 /**
@@ -829,8 +1618,8 @@ void CH703X::setInputVsyncPulseWidth(uint16_t vwi)
 	uint8_t vwi_hibyte = vwi >> 8;				//VWI[10:8]
 	vwi_hibyte &= 0x07;
 	REG_R1_14h |= (vwi_hibyte << 3);
-	hal_writeRegister(0x14, REG_R1_14h);		//VWI[10:8]
-	hal_writeRegister(0x16, (uint8_t)vwi);	//VWI[7:0]
+	writeRegister(1, 0x14, REG_R1_14h);		//VWI[10:8]
+	writeRegister(1, 0x16, (uint8_t)vwi);	//VWI[7:0]
 }
 
 /**
@@ -848,7 +1637,7 @@ void CH703X::setInputSyncPolarity(bool hsync, bool vsync, bool de)
   (vsync)?(REG_R1_19h|=(1<<4)):(REG_R1_19h&=~(1<<4));
   (de) ? (REG_R1_19h &= ~(1 << 3)):(REG_R1_19h |= (1 << 3));
 
-  hal_writeRegister(0x19, REG_R1_19h);
+  writeRegister(1, 0x19, REG_R1_19h);
 }
 
 /**
@@ -864,9 +1653,9 @@ void CH703X::setInputPclkFrequency(uint32_t pclk)
   pclk_bit17_16&=0x03;
   REG_R1_19h|=pclk_bit17_16;
 
-  hal_writeRegister(0x19, REG_R1_19h);
-  hal_writeRegister(0x1A, (uint8_t)(pclk>>8));
-  hal_writeRegister(0x1B, (uint8_t)pclk);
+  writeRegister(1, 0x19, REG_R1_19h);
+  writeRegister(1, 0x1A, (uint8_t)(pclk>>8));
+  writeRegister(1, 0x1B, (uint8_t)pclk);
 }
 
 /**
@@ -966,4 +1755,4 @@ void CH703X::setI2SAudio(uint8_t len, uint8_t fmt, bool en)
 }
 
 
-       
+       
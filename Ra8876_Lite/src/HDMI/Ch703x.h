@@ -42,37 +42,100 @@
 
 #include "Arduino.h"
 #include "Wire.h"
+#include "UserConfig.h"
 #include "edid/edid.h"
+#include "clock/clockPlan.h"
 #include "LcdParam.h"
 #include "videoInOutMap.h"
 #include "util/printf.h" ///by Michael McElligott
 
 
-///@note Hardware pinout
-/*
-#ifdef TEENSYDUINO
-const int CH703X_IRQ =6;	//Pin D15 for Teensy 3.2/3.5	
-#else
-const int CH703X_IRQ =5;	//Pin D5 for Due, M0/M0 PRO, Curie  
-#endif
-*/
+///@note Hardware pinout, CH703X_IRQ for hotplugBegin() is set per board in UserConfig.h
+
 const int CH703X_SLAVE_ADDR = 0x76;     //7'bit slave address of CH7035B
+const uint8_t CH703X_I2C_BURST_MAX = 16;	//max. registers written in one auto-increment I2C transfer, set 1 to write one at a time
+const uint8_t CH703X_INC_CACHE_SIZE = 4;	//number of register tables with their scaler increments kept by init()
+const uint16_t CH703X_I2C_TIMEOUT_MS = 10;	//max. wait for the bytes of a register read
+const uint16_t CH703X_DDC_TIMEOUT_MS = 20;	//max. wait for the DDC master to fetch 8 bytes of EDID, no monitor fails in this time
+
+///@note Hot plug detect status, page 3 register 0x25 bit 4 as in the CH7035/CH7036 Linux drivers
+const uint8_t CH703X_HPD_PAGE = 3;
+const uint8_t CH703X_HPD_INDEX = 0x25;
+const uint8_t CH703X_HPD_MASK = 0x10;
+const uint8_t CH703X_HPD_POLL_MS = 8;		//HPD is read at this interval by hotplugPoll(), with CH703X_IRQ only while it is low
+const uint8_t CH703X_HPD_DEBOUNCE = 2;		//same HPD read this many times in a row to take a change
+
+///@note Return codes of hotplugPoll()
+const int8_t CH703X_HPD_NONE = 0;			//no change
+const int8_t CH703X_HPD_UNPLUGGED = 1;		//monitor unplugged or switched off
+const int8_t CH703X_HPD_RESUMED = 2;		//monitor back, the last mode is set again
+const int8_t CH703X_HPD_MODE_CHANGED = 3;	//EDID of the new monitor has another native timing, CH703X output set to it
 
 class CH703X {
     private:
     void hal_hwSetup();
     void hal_delayMs(uint32_t ms);
     void hal_writeRegister(uint8_t index, uint8_t val);
+    void hal_writeRegisters(uint8_t index, const uint8_t *val, uint8_t count);
     uint8_t hal_readRegister(uint8_t index);
+    bool hal_readRegisters(uint8_t index, uint8_t *val, uint8_t count);
     void writeRegister(uint8_t page, uint8_t index, uint8_t val);
     void readRegister(uint8_t page, uint8_t index, uint8_t *val, uint8_t count);
     void setRegisterPage(uint8_t page);
+    void shadowWrite(uint8_t index, uint8_t val);
+    void shadowInvalidate(void);
     const char *yesno (int v);
+    uint8_t scalerIncrements(const uint8_t lcdParamInOut[][2], bool downSample, uint8_t *inc);
+    void writeTable(const uint8_t lcdParamInOut[][2], int16_t *r1_25h, bool *incFound);
+    bool startScaler(const uint8_t lcdParamInOut[][2], int16_t r1_25h, bool incFound);
+    uint8_t tableRegister(const uint8_t lcdParamInOut[][2], uint8_t page, uint8_t index);
+    bool initTiming(const LCDParam *videoIn, const LCDParam *videoOut, uint32_t pclkOut, bool interlaced, uint8_t monitorType);
     
     bool _initialised = false;
     TwoWire *_i2c;
+    bool _i2cTimeout = false;       ///set by hal_readRegister() if the bytes do not come in CH703X_I2C_TIMEOUT_MS
+
+    ///@note Register page in use, 1 to 4, 0 if unknown. setRegisterPage() is skipped for the same page.
+    uint8_t _page = 0;
+    ///@note Last value written to registers 0x00 to 0x7F of each page, returned by readRegister() with no I2C read
+    uint8_t _shadow[4][128];
+    uint8_t _shadowValid[4][16] = {};
+
+    ///@note Last mode set by init(), set again by resume(). table is NULL for timing set in run time.
+    struct {
+      const uint8_t (*table)[2];
+      LCDParam videoIn, videoOut;
+      uint32_t pclkOut;
+      bool interlaced, fromEdid;
+      uint8_t monitorType;
+      DetailedTiming edidOut;
+    } _last = {};
+    bool _lastValid = false;
+
+    ///@note Hot plug state of hotplugPoll()
+    int8_t _irqPin = -1;
+    int8_t _hpd = -1;               //1 attached, 0 not, -1 unknown
+    uint8_t _hpdCount = 0;
+    uint32_t _hpdTime = 0;
+    bool _hpdEdid = false;          //EDID read in progress after a plug in
+
+    ///@note State of EDID read by edidStart() & edidPoll()
+    enum {EDID_IDLE, EDID_REQUEST, EDID_WAIT, EDID_DONE, EDID_FAILED} _edidState = EDID_IDLE;
+    uint8_t _edidBlock, _edidChunk;
+    uint32_t _edidStart;
+
+    ///@note Scaler increments of the last register tables written by init(), so setting a mode again has no read back.
+    ///      Keyed by a checksum of the table entries, so a table changed in RAM or another table at the same address misses.
+    struct {
+      uint32_t sum;
+      uint8_t count;
+      uint8_t inc[9];
+    } _incCache[CH703X_INC_CACHE_SIZE] = {};
+    uint8_t _incNext = 0;
 
  	uint8_t edidBuf[128];   ///EDID buffer
+ 	uint8_t edidExt[128];   ///CEA-861 extension block of EDID, valid if _edidExt is true
+ 	bool _edidExt = false;
 
     public:
     CH703X(){};
@@ -97,7 +160,66 @@ class CH703X {
      */
     bool init(const uint8_t lcdParamInOut[][2]);
     
-    //bool init(const LCDParam *videoIn, const LCDParam *videoOut, uint8_t monitorType);
+    /**
+     * @brief Initialize CH703x with video in & out timing parameters in run time.
+     * @param *videoIn is the RGB timing generated by RA8876
+     * @param *videoOut is the timing to the monitor, e.g. its native mode
+     * @param monitorType is DVI or HDMI_A of enum Interface in edid.h
+     * @note  Clock and serializer registers are taken from the table of videoInOutMap.h made for the same output
+     *        pixel clock, timing registers are then computed from videoIn & videoOut. Returns false if no table
+     *        is made for the output pixel clock, or videoOut is smaller than videoIn (up scaling only).
+     */
+    bool init(const LCDParam *videoIn, const LCDParam *videoOut, uint8_t monitorType);
+
+    /**
+     * @brief Same as above with the output timing from an EDID detailed timing, pixel clock in kHz and interlaced modes kept.
+     */
+    bool init(const LCDParam *videoIn, const DetailedTiming *videoOut, uint8_t monitorType);
+
+    /**
+     * @brief  Convert an EDID detailed timing to LCDParam, pixel clock rounded to MHz. Interlaced timing is in frame lines.
+     */
+    static void timingFromEdid(const DetailedTiming *dt, LCDParam *lcd);
+
+    /**
+     * @brief  Select the RGB timing for RA8876 that feeds CH703X for a monitor timing with the least SDRAM bandwidth.
+     * @param  *videoOut is the timing to the monitor, e.g. its native mode from timingFromEdid()
+     * @param  minWidth & minHeight are the smallest resolution wanted, e.g. canvas size. 0 for any.
+     * @param  maxPclk is the max. pixel clock of RA8876 in MHz, e.g. SPLL_FREQ_MAX
+     * @return one of the timings in LcdParam.h that fits in videoOut with the same aspect ratio (within 5%),
+     *         is at least minWidth x minHeight and has the lowest pixel clock, hence SDRAM read bandwidth.<br>
+     *         The largest one if none is as big as minWidth x minHeight; NULL if none fits in videoOut.
+     */
+    static const LCDParam *selectSource(const LCDParam *videoOut, uint16_t minWidth = 0, uint16_t minHeight = 0, uint16_t maxPclk = 0xFFFF);
+
+    /**
+     * @brief  Score the monitor timings of EDID for the combination of RA8876 source and CH703X output of highest throughput.
+     * @param  *info is the EDID base block from decode_edid()
+     * @param  *cea is the CEA-861 extension from decode_cea_extension(), NULL if none
+     * @param  maxPclk is the max. pixel clock of RA8876 in MHz, e.g. SPLL_FREQ_MAX
+     * @param  **source returns the RGB timing for RA8876, the largest one selectSource() finds for the output
+     * @param  *videoOut returns the output timing, from a detailed timing or a short video descriptor
+     * @return false if no timing of the monitor has a register table for its pixel clock
+     * @note   Candidates are the detailed timings of both blocks and the VICs of the short video descriptors.
+     *         Scored by the same aspect ratio of source and output, then the source pixel clock, then a native
+     *         format of the monitor, then the output pixel clock. Output is HDMI if cea->hdmi, DVI otherwise.
+     *         No I2C, so it runs on a host with EDID dumps as well.
+     */
+    static bool selectMode(const MonitorInfo *info, const CeaInfo *cea, uint16_t maxPclk, const LCDParam **source, DetailedTiming *videoOut);
+
+    /**
+     * @brief  Read EDID with its CEA-861 extension and select the mode with selectMode().
+     * @param  *monitorType returns HDMI_A if the extension has the HDMI vendor specific data block, DVI otherwise
+     * @note   EDID read by edidPoll() or an earlier call is used with no DDC access.<br>
+     *         Example to use:<br>
+     *         const LCDParam *src; DetailedTiming out; uint8_t type;
+     *         if(HDMI_Tx.bestMode(SPLL_FREQ_MAX, &src, &out, &type))
+     *         {
+     *           ra8876lite.begin(src);
+     *           HDMI_Tx.init(src, &out, type);
+     *         }
+     */
+    bool bestMode(uint16_t maxPclk, const LCDParam **source, DetailedTiming *videoOut, uint8_t *monitorType);
 
     /**
     * @brief    This function allows remote procedure call to writeRegister()
@@ -117,6 +239,12 @@ class CH703X {
     */
 	void parser(char *msg);      
 
+    /**
+    * @brief  Print the scaler increments in use as register table entries, same as <i2c,inc> in Serial Monitor.
+    *         Add them to a table of videoInOutMap.h so init() streams the final register image with no read back.
+    */
+    void printIncrements(void);
+
   	/**
   	* @brief  GPIO and I2C setup. Should call this before using <i2c,edid> in Serial Monitor to read EDID
   	*/
@@ -135,12 +263,68 @@ class CH703X {
     uint8_t getRevID(void);  
 
     /**
-    * @brief  Read EDID from a HDMI sink device.
+    * @brief  Read EDID from a HDMI sink device, with the first extension block if the base block says there is one.
     * @return true if EDID read OK
     *         false if no EDID can be read
+    * @note   Blocks until done, bounded by CH703X_DDC_TIMEOUT_MS for each 8 bytes. Use edidStart() & edidPoll()
+    *         to read EDID from loop() instead.
     */
     bool readEdid(void); 
 
+    /**
+    * @brief  Start reading EDID in the background, one step at a time by edidPoll().
+    */
+    void edidStart(void);
+
+    /**
+    * @brief  Run one step of EDID read started by edidStart(), which does not wait on the DDC master.
+    * @return 1 if EDID is read into the buffers for nativeTiming() etc., 0 if still busy, -1 if failed or not started
+    * @note   Example to use in loop():<br>
+    *         if(HDMI_Tx.edidPoll()==1) {...}
+    */
+    int8_t edidPoll(void);
+
+    /**
+    * @brief  Start hot plug detection by hotplugPoll().
+    * @param  irqPin is CH703X_IRQ to poll HPD only while the pin is low, -1 to poll every CH703X_HPD_POLL_MS
+    */
+    void hotplugBegin(int8_t irqPin = -1);
+
+    /**
+    * @brief  Check HPD and bring the monitor back when it is plugged in or switched on again. Call it from loop().
+    * @return CH703X_HPD_NONE, CH703X_HPD_UNPLUGGED, CH703X_HPD_RESUMED or CH703X_HPD_MODE_CHANGED
+    * @note   On plug in the last mode is set again by resume() at once, then EDID is read in the background by
+    *         edidPoll(). If the last mode came from EDID and the new monitor has another native timing, the output
+    *         is set to it with the same RGB input. RA8876 is not touched, so SDRAM and the application state are kept.
+    *         Example to use:<br>
+    *         HDMI_Tx.hotplugBegin(CH703X_IRQ);  //in setup()
+    *         if(HDMI_Tx.hotplugPoll()==CH703X_HPD_MODE_CHANGED) {...}  //in loop()
+    */
+    int8_t hotplugPoll(void);
+
+    /**
+    * @brief  Read the hot plug detect status.
+    * @return true if a monitor is attached and powered
+    */
+    bool hotplugDetected(void);
+
+    /**
+    * @brief  Set the last mode of init() again, e.g. after the monitor is switched off and on.
+    * @return false if init() has not been called or fails
+    * @note   Scaler increments of a register table are cached, so no read back is made for it.
+    */
+    bool resume(void);
+
+    /**
+    * @brief  Read EDID and get the native timing of the monitor, which is the first detailed timing.
+    * @param  *native returns the timing
+    * @param  *monitorType returns HDMI_A if EDID has the HDMI vendor specific data block or says the interface is HDMI,
+    *         DVI otherwise
+    * @return false if no EDID can be read or it has no detailed timing
+    * @note   EDID read by edidPoll() or an earlier call is used with no DDC access.
+    */
+    bool nativeTiming(DetailedTiming *native, uint8_t *monitorType);
+
     /**
     * @brief Print EDID information via Serial Monitor
     * @note  Copyright 2007 Red Hat, Inc.
@@ -281,8 +281,8 @@ inline void Ra8876_Lite::hal_spi_write(const uint8_t *buf, uint32_t byte_count)
  * @brief HAL level burst data read
  * @param *buf points to 8-bit data buffer storing data return
  * @param byte_count is the byte count
- * @note  This function is never called after a comparison on the stability with lcdDataRead().
- *		  Running this function sometimes return false values.
+ * @note  Running this function on a long read sometimes return false values, so it is only called by mem_ReadBurst()
+ *		  for a burst no longer than the bytes a full Memory Read FIFO holds.
  */
 inline void Ra8876_Lite::hal_spi_read(uint8_t *buf, uint32_t byte_count)
 {
@@ -396,7 +396,23 @@ inline void Ra8876_Lite::hal_ei(void)
  * @param   sck is the serial clock pin for SPI
  */
 Ra8876_Lite::Ra8876_Lite(uint8_t xnscs, uint8_t xnreset, uint8_t mosi, uint8_t miso, uint8_t sck):
-_xnscs(xnscs), _xnreset(xnreset), _mosi(mosi), _miso(miso), _sck(sck){}
+_xnscs(xnscs), _xnreset(xnreset), _mosi(mosi), _miso(miso), _sck(sck)
+{
+	_wrFifoCredit = 0;
+	_hwTextRunFont = 0;
+	_pipPending = false;
+#if defined (LOAD_BFC_FONT)
+	_bfcIndex.pKey = 0;
+	_bfcIndex.NumRanges = 0;
+	_bfcpKey = 0;
+#if defined (LOAD_SD_LIBRARY)
+	_bfcBinIndex.pKey = 0;
+	_bfcBinIndex.NumRanges = 0;
+	_bfcBinName[0] = '\0';
+	bfc_AdvanceCacheReset();
+#endif
+#endif
+}
 
 /**
  * @brief Initialize RA8876 with either predefined LCD timing parameters(manual) or EDID information(automatic).
@@ -453,44 +469,7 @@ bool Ra8876_Lite::begin(const LCDParam *timing, MonitorInfo *edid, bool automati
     #endif
   }
 
-  if(automatic) //EDID information from monitor
-  {
-    lcd = 
-    {
-      edid->dsc_product_name,
-      (uint16_t)edid->detailed_timings[0].h_addr, (uint16_t)edid->detailed_timings[0].v_addr, //width, height
-      (uint16_t)edid->detailed_timings[0].h_blank,      //horizontal blanking
-      (uint16_t)edid->detailed_timings[0].h_front_porch,  //horizontal front porch
-      (uint16_t)edid->detailed_timings[0].h_sync,     //horizontal pulse width
-      (uint16_t)edid->detailed_timings[0].v_blank,      //vertical blanking
-      (uint16_t)edid->detailed_timings[0].v_front_porch,  //vertical front porch
-      (uint16_t)edid->detailed_timings[0].v_sync,       //vertical pulse width
-      (uint32_t)edid->detailed_timings[0].pixel_clock/1000000UL,    //pixel clock
-      !(edid->detailed_timings[0].digital.negative_vsync),  //vsync polarity
-      !(edid->detailed_timings[0].digital.negative_hsync),  //hsync polarity
-      0,      //rising edge pclk
-      0,      //+ve de
-    };   
-  }
-  else          //manual LCD timing parameters
-  {
-    lcd=
-    {
-      timing->name,
-      timing->width, timing->height,
-      timing->hblank,
-      timing->hfporch,
-      timing->hpulse,
-      timing->vblank,
-      timing->vfporch,
-      timing->vpulse,
-      timing->pclk,
-      timing->vsyncPolarity,
-      timing->hsyncPolarity,
-      timing->pclkPolarity,
-      timing->dePolarity,
-    };    
-  }
+  lcd_Load(timing, edid, automatic);
   
   if(!ra8876PllInitial(lcd.pclk))
   {
@@ -518,20 +497,7 @@ bool Ra8876_Lite::begin(const LCDParam *timing, MonitorInfo *edid, bool automati
   //REG[03h]
   lcdRegDataWrite(RA8876_ICR,RA8876_GRAPHIC_MODE<<2|RA8876_MEMORY_SELECT_IMAGE);
 
-  lcdRegDataWrite(RA8876_DPCR,(lcd.pclkPolarity<<7)|(RA8876_DISPLAY_OFF<<6)|(RA8876_OUTPUT_RGB)); //REG[12h]
-  //edid->detailed_timings[0].digital.negative_vsync = 1 if polarity is negative
-  //REG[13h] bit7 XHSYNC polarity 0: Low active, 1: High active
-  //edid->detailed_timings[0].digital.negative_hsync = 1 if polarity is negative
-  //REG[13h] bit6 XVSYNC polarity 0: Low active, 1: High active
-  //All CEA-861-D video signals are DE high active
-  lcdRegDataWrite(RA8876_PCSR, lcd.hsyncPolarity<<7|lcd.vsyncPolarity<<6|lcd.dePolarity<<5); //REG[13h]
-  lcdHorizontalWidthVerticalHeight(lcd.width, lcd.height);
-  lcdHorizontalBackPorch(lcd.hblank-lcd.hfporch-lcd.hpulse);
-  lcdHsyncStartPosition(lcd.hfporch);
-  lcdHsyncPulseWidth(lcd.hpulse);
-  lcdVerticalBackPorch(lcd.vblank-lcd.vfporch-lcd.vpulse);
-  lcdVsyncStartPosition(lcd.vfporch);
-  lcdVsyncPulseWidth(lcd.vpulse);
+  lcd_Timing(RA8876_DISPLAY_OFF);
 
   //REG[B9h]: enable XnSFCS1 (pin 38) as chip select for Serial Flash W25Q256FV and enter 4-Byte mode for it
   setSerialFlash();
@@ -557,11 +523,171 @@ bool Ra8876_Lite::begin(const LCDParam *timing, MonitorInfo *edid, bool automati
 	canvasImageWidth(lcd.width, lcd.height);
 	activeWindowWH(lcd.width,lcd.height);
 	
+	//PIP windows are disabled by the reset
+	memset(_pip, 0, sizeof(_pip));
+	_pipPending = false;
+	//so is the graphic cursor
+	memset(_cursorHot, 0, sizeof(_cursorHot));
+	_cursorIndex = 0;
+	
   _initialised = true;
   
   return _initialised;
 }
 
+/**
+ * @brief Copy LCD timing parameters to lcd, from a LCDParam structure or from the first detailed timing of EDID
+ *        RA8876 can generate.
+ * @note  Arguments as in begin(). A monitor with no such detailed timing, e.g. a HDTV preferring 1080p at 148.5MHz,
+ *        falls back to *timing.
+ */
+void Ra8876_Lite::lcd_Load(const LCDParam *timing, MonitorInfo *edid, bool automatic)
+{
+  const DetailedTiming *dt = NULL;
+
+  if(automatic && edid)
+  {
+    for(int i=0; i<edid->n_detailed_timings && !dt; i++)
+      if(edidTimingSupported(&edid->detailed_timings[i])) dt = &edid->detailed_timings[i];
+  #ifdef DEBUG_LLD_RA8876
+    if(!dt) printf("No detailed timing of EDID is supported, %s used.\n", timing? timing->name : "none");
+  #endif
+  }
+
+  if(dt) //EDID information from monitor
+  {
+    lcd = 
+    {
+      edid->dsc_product_name,
+      (uint16_t)dt->h_addr, (uint16_t)dt->v_addr, //width, height
+      (uint16_t)dt->h_blank,      //horizontal blanking
+      (uint16_t)dt->h_front_porch,  //horizontal front porch
+      (uint16_t)dt->h_sync,     //horizontal pulse width
+      (uint16_t)dt->v_blank,      //vertical blanking
+      (uint16_t)dt->v_front_porch,  //vertical front porch
+      (uint16_t)dt->v_sync,       //vertical pulse width
+      (uint32_t)dt->pixel_clock/1000000UL,    //pixel clock
+      !(dt->digital.negative_vsync),  //vsync polarity
+      !(dt->digital.negative_hsync),  //hsync polarity
+      0,      //rising edge pclk
+      0,      //+ve de
+    };   
+  }
+  else          //manual LCD timing parameters
+  {
+    lcd=
+    {
+      timing->name,
+      timing->width, timing->height,
+      timing->hblank,
+      timing->hfporch,
+      timing->hpulse,
+      timing->vblank,
+      timing->vfporch,
+      timing->vpulse,
+      timing->pclk,
+      timing->vsyncPolarity,
+      timing->hsyncPolarity,
+      timing->pclkPolarity,
+      timing->dePolarity,
+    };    
+  }
+}
+
+/**
+ * @brief Check a detailed timing of EDID against the limits of RA8876 display timing registers and SCLK PLL.
+ * @return true if RA8876 can output this timing
+ */
+bool Ra8876_Lite::edidTimingSupported(const DetailedTiming *dt)
+{
+  CLOCK_PLL pll;
+  uint32_t pclk = dt->pixel_clock/1000000UL;
+
+  if(dt->interlaced || pclk==0 || pclk>SPLL_FREQ_MAX) return false;
+  if(dt->h_addr>2048 || dt->v_addr>2048) return false;              //REG[14h], REG[1Ah]
+  if(dt->h_front_porch>256 || dt->h_sync>256 || dt->h_blank-dt->h_front_porch-dt->h_sync>256) return false; //REG[16h] to REG[18h] in 8 pixels
+  if(dt->v_front_porch>256 || dt->v_sync>128 || dt->v_blank-dt->v_front_porch-dt->v_sync>256) return false; //REG[1Ch] to REG[1Fh] in lines
+  return ra8876PclkDividers((uint16_t)pclk, &pll);
+}
+
+/**
+ * @brief Write the display timing in lcd to REG[12h] to REG[1Fh].
+ * @param on is the display on/off bit kept in REG[12h] bit6.
+ */
+void Ra8876_Lite::lcd_Timing(bool on)
+{
+  lcdRegDataWrite(RA8876_DPCR,(lcd.pclkPolarity<<7)|(on<<6)|(RA8876_OUTPUT_RGB)); //REG[12h]
+  //edid->detailed_timings[0].digital.negative_vsync = 1 if polarity is negative
+  //REG[13h] bit7 XHSYNC polarity 0: Low active, 1: High active
+  //edid->detailed_timings[0].digital.negative_hsync = 1 if polarity is negative
+  //REG[13h] bit6 XVSYNC polarity 0: Low active, 1: High active
+  //All CEA-861-D video signals are DE high active
+  lcdRegDataWrite(RA8876_PCSR, lcd.hsyncPolarity<<7|lcd.vsyncPolarity<<6|lcd.dePolarity<<5); //REG[13h]
+  lcdHorizontalWidthVerticalHeight(lcd.width, lcd.height);
+  lcdHorizontalBackPorch(lcd.hblank-lcd.hfporch-lcd.hpulse);
+  lcdHsyncStartPosition(lcd.hfporch);
+  lcdHsyncPulseWidth(lcd.hpulse);
+  lcdVerticalBackPorch(lcd.vblank-lcd.vfporch-lcd.vpulse);
+  lcdVsyncStartPosition(lcd.vfporch);
+  lcdVsyncPulseWidth(lcd.vpulse);
+}
+
+/**
+ * @brief Change display timing of an initialized RA8876 without a reset, e.g. to switch CH703X between output modes.
+ * @param *timing, *edid and automatic are the same as in begin().
+ * @return true if successful.<br>
+ *         false if RA8876 is not initialized yet, or the pixel clock is out of range.
+ * @note  Unlike begin() there is no hard reset, no SDRAM initialization and no canvas clear, so pictures, fonts
+ *        and BITMAPs already loaded to SDRAM stay where they are. SCLK PLL is only reprogrammed when the new pixel
+ *        clock needs different dividers, e.g. not at all between two CH703X tables with the same RA8876 input,
+ *        with MCLK and CCLK left running. Call canvasImageBuffer() and displayMainWindow() afterwards
+ *        if the canvas size changes.<br>
+ *        Example to use:
+ *
+ *        ra8876lite.reconfigure(&CEA_720x480p_60Hz);
+ *        ra8876lite.canvasImageBuffer(720, 480);
+ *        ra8876lite.displayMainWindow();
+ */
+bool Ra8876_Lite::reconfigure(const LCDParam *timing, MonitorInfo *edid, bool automatic)
+{
+  CLOCK_PLAN plan;
+  
+  if(!_initialised) return false;
+  
+  LCDParam last = lcd;
+  lcd_Load(timing, edid, automatic);
+  if(!ra8876ClockPlan(&plan)) {lcd = last; return false;}  //CCLK & MCLK are the same as in begin()
+  
+  uint8_t on = (lcdRegDataRead(RA8876_DPCR)>>6) & 0x01;
+  uint8_t xPLLC1 = plan.sclk.divk<<1|plan.sclk.divm;
+  
+  if(lcdRegDataRead(0x05)!=xPLLC1 || lcdRegDataRead(0x06)!=plan.sclk.divn)
+  {
+    uint8_t CCR = lcdRegDataRead(RA8876_CCR);
+    
+    lcdRegDataWrite(RA8876_CCR, CCR&0x7F);  //PLL_EN @ bit[7], to change the dividers
+    lcdRegDataWrite(0x05, xPLLC1);          //set SCLK PLL control register 1
+    lcdRegDataWrite(0x06, plan.sclk.divn);  //set SCLK PLL control register 2 
+    lcdRegDataWrite(RA8876_CCR, CCR|0x80);  //enable PLL with other bits kept
+    
+    //poll until stable instead of a fixed 20ms
+    uint8_t t;
+    for(t=0; t<20; t++)
+    {
+      hal_delayMs(1);
+      if(lcdRegDataRead(RA8876_CCR)&0x80) break;
+    }
+    if(t==20) {lcd = last; return false;}
+  }
+  
+  _clock = plan;
+  lcd_Timing(on);
+  canvasImageWidth(lcd.width, lcd.height);
+  activeWindowWH(lcd.width,lcd.height);
+  
+  return true;
+}
+
 /**
  * @brief   Register write function.
  * @param   reg is the register to write.
@@ -924,6 +1050,66 @@ bool Ra8876_Lite::checkIcReady(uint32_t timeout)
   return false;
 }
 
+/**
+* @brief  Work out the SCLK PLL dividers for a pixel clock, see ra8876PllInitial().
+* @param  pclk is the pixel clock with unit in MHz, taken as the exact CEA clock by ClockPixelKHz(), e.g. 74.25MHz for 74
+* @param  *pll returns PLLDIVK & PLLDIVM for REG[05h], PLLDIVN for REG[06h], and the pixel clock they make
+* @return true if the dividers can make it<br>
+*         false if not. Reason can be a too low pclk frequency<br>
+* @note   The pixel clock made is the closest one not above SPLL_FREQ_MAX, no longer rounded down by integer division.
+*/
+bool Ra8876_Lite::ra8876PclkDividers(uint16_t pclk, CLOCK_PLL *pll)
+{
+  if(pclk>SPLL_FREQ_MAX) {pclk=74;} //bound any pixel clock higher than SPLL_FREQ_MAX to 74MHz for low field rate 
+  
+  if(!ClockPll(OSC_FREQ*1000UL, ClockPixelKHz(pclk), ClockPixelKHz(SPLL_FREQ_MAX), pll))
+  {
+  #ifdef DEBUG_LLD_RA8876
+    printf("No PLL dividers for pixel clock. Check video source.\n");
+  #endif
+    return false;
+  }
+  return true;
+}
+
+/**
+* @brief  Plan SCLK for the timing in lcd, with the highest CCLK and MCLK and the SDRAM timing for them.
+* @param  *plan returns the clocks, see clockPlan.h
+* @return true if the pixel clock can be made and the display refresh leaves SDRAM bandwidth for drawing
+* @note   Display bandwidth is worked out for 16BPP of the default main window.
+*/
+bool Ra8876_Lite::ra8876ClockPlan(CLOCK_PLAN *plan)
+{
+  CLOCK_PLL pll;
+  CLOCK_REQUEST req =
+  {
+    OSC_FREQ*1000UL,
+    0,
+    ClockPixelKHz(SPLL_FREQ_MAX),
+    CORE_FREQ*1000UL,
+    DRAM_FREQ*1000UL,
+    lcd.width, lcd.height,
+    (uint16_t)(lcd.width+lcd.hblank), (uint16_t)(lcd.height+lcd.vblank),
+    2,
+#ifdef RA8876M
+    8192,
+#else
+    4096,
+#endif
+  };
+  
+  if(!ra8876PclkDividers(lcd.pclk, &pll))
+    return false;
+  req.pclkKHz = ClockPixelKHz(lcd.pclk>SPLL_FREQ_MAX ? 74 : lcd.pclk);  //exact clock with the bound of ra8876PclkDividers(), for pclkErrPpm
+  
+  int ret = ClockPlan(&req, plan);
+#ifdef DEBUG_LLD_RA8876
+  printf("SCLK %ldkHz, CCLK %ldkHz, MCLK %ldkHz, fill %ld, copy %ld kpixel/s\n", (long)plan->sclk.kHz, (long)plan->cclk.kHz,
+         (long)plan->mclk.kHz, (long)plan->fillKpps, (long)plan->copyKpps);
+#endif
+  return ret==CLOCK_OK;
+}
+
 /**
 * @brief  PLL initialization function.
 * @note   PLL output is calculated from this formula<br>
@@ -934,8 +1120,9 @@ bool Ra8876_Lite::checkIcReady(uint32_t timeout)
 *         PLLDIVK = 0 ~ 3<br>
 *         PLLDIVN = 1 ~ 63<br>
 *         Example, we want to output a pixel clock of 74250000Hz,<br>
-*         set PLLDIVM = 0, PLLDIVN=49, PLL = 12*(49+1)/(2^0) = 600<br>
-*         set PLLDIVK = 3, PCLK = 600/2^3 = 75MHz (~74.25MHz)<br>
+*         set PLLDIVM = 0, PLLDIVN=48, PLL = 12*(48+1)/(2^0) = 588<br>
+*         set PLLDIVK = 3, PCLK = 588/2^3 = 73.5MHz (~74.25MHz)<br>
+*         Dividers of all three clocks come from ra8876ClockPlan(), kept in _clock for getClockPlan().
 * @param  pclk is the pixel clock with unit in MHz<br>
 * @return true if successful<br>
 *         false if not successful. Reason can be a too high pclk frequency<br>
@@ -947,53 +1134,23 @@ bool Ra8876_Lite::ra8876PllInitial(uint16_t pclk)
     printf("Ra8876_Lite::ra8876PllInitial(pclk)...\n");
   #endif
   
-  uint8_t xPLLDIVN;
-  uint8_t xPLLDIVK;
+  lcd.pclk = pclk;
+  if(!ra8876ClockPlan(&_clock))
+    return false;
+  
   //disable PLL prior to parameter changes
   uint8_t CCR = lcdRegDataRead(RA8876_CCR);
 
   lcdRegDataWrite(RA8876_CCR, CCR&0x7F);  //PLL_EN @ bit[7]
 
-  if ((pclk>54)&&(pclk<=SPLL_FREQ_MAX))
-  {
-    //e.g.  VID code 35,36  2880x480 @59.940Hz pclk=108MHz  
-    //xPLLDIVM=0, xPLLDIVK=2
-    xPLLDIVK = 2;
-    //to round off to nearest 0.5, pclk*4/OSC_FREQ-1+0.5 become pclk*4/OSC_FREQ-0.5.
-    //this round 48.5 to 49 for a higher frame rate.
-    //xPLLDIVN = round((float)(pclk*4/OSC_FREQ)-0.5);
-    xPLLDIVN = (pclk*4/OSC_FREQ)-1;
-  }
-  else if ((pclk<=54) || (pclk>SPLL_FREQ_MAX))  //pixel clock > 148MHz is not supported. Bound any frequency > 148 to 74MHz
-  {
-    //e.g.  VID code 4, 1280x720 @60Hz pclk=74.250MHz (round off to 74MHz)
-    //      VID code 31, 1920x1080 @50Hz pclk=148.5MHz (round off to 148MHz)
-    //xPLLDIVM=0, xPLLDIVK=3
-    if(pclk>SPLL_FREQ_MAX) {pclk=74;} //bound any pixel clock higher than 108MHz to 74MHz for low field rate 
-    xPLLDIVK = 3;
-    //xPLLDIVN = round((float)(pclk*8/OSC_FREQ)-0.5);
-    xPLLDIVN = (pclk*8/OSC_FREQ)-1;
-  }
-/*
-  #ifdef DEBUG_LLD_RA8876
-    printf("Setting pixel clock with xPLLDIVN=%d, xPLLDIVK=%d\n", xPLLDIVN, xPLLDIVK);
-  #endif
-*/  
-  if((xPLLDIVN>63)||(xPLLDIVN==0))
-  {
-  #ifdef DEBUG_LLD_RA8876
-    printf("xPLLDIVN out of range. Check video source.\n");
-  #endif
-    return false;
-  }
-  lcdRegDataWrite(0x05, xPLLDIVK<<1); //set SCLK PLL control register 1
-  lcdRegDataWrite(0x06, xPLLDIVN);    //set SCLK PLL control register 2 
+  lcdRegDataWrite(0x05, _clock.sclk.divk<<1|_clock.sclk.divm); //set SCLK PLL control register 1
+  lcdRegDataWrite(0x06, _clock.sclk.divn);                     //set SCLK PLL control register 2 
   
-  lcdRegDataWrite(0x07,0x02);     //PLL Divided by 2
-  lcdRegDataWrite(0x08,(DRAM_FREQ*2/OSC_FREQ)-1); //DRAM_FREQ*2/OSC_FREQ=166*2/12=27
+  lcdRegDataWrite(0x07, _clock.mclk.divk<<1|_clock.mclk.divm); //MCLK, 162MHz for DRAM_FREQ=166
+  lcdRegDataWrite(0x08, _clock.mclk.divn);
   
-  lcdRegDataWrite(0x09,0x02);       //PLL Divided by 2
-  lcdRegDataWrite(0x0A,(CORE_FREQ*2/OSC_FREQ)-1); //CORE_FREQ*2/OSC_FREQ=144*2/12=24
+  lcdRegDataWrite(0x09, _clock.cclk.divk<<1|_clock.cclk.divm); //CCLK, 120MHz for CORE_FREQ=120
+  lcdRegDataWrite(0x0A, _clock.cclk.divn);
   
   lcdRegDataWrite(RA8876_CCR, RA8876_PLL_ENABLE<<7);  //enable PLL
   hal_delayMs(20);  //wait PLL stable
@@ -1018,22 +1175,16 @@ bool Ra8876_Lite::ra8876PllInitial(uint16_t pclk)
  * @brief SDRAM initialization assuming an external SDRAM WINBOND W9825G6KH-6
  * @return true if SDRAM initialization is successful<br>
  *         false if SDRAM initialization failed<br>
- * 
+ * @note  CAS latency and auto refresh period are of the MCLK made in ra8876PllInitial(), not of DRAM_FREQ.
  */
 bool Ra8876_Lite::ra8876SdramInitial(void)
 {
-uint8_t	  	CAS_Latency;
-uint16_t	Auto_Refresh;
+uint8_t	  	CAS_Latency = _clock.casLatency;
+uint16_t	Auto_Refresh = _clock.autoRefresh;
 
-if(DRAM_FREQ<=133) 
-	CAS_Latency=2;
-else
-	CAS_Latency=3;
 #ifdef RA8876M
-  Auto_Refresh=(64*DRAM_FREQ*1000L)/(8192L);
   lcdRegDataWrite(0xe0,0x28); 
 #else
-  Auto_Refresh=(64*DRAM_FREQ*1000L)/(4096L);
   lcdRegDataWrite(0xe0,0x31); 
 #endif	
   lcdRegDataWrite(0xe1,CAS_Latency);      //CAS:2=0x02锛孋AS:3=0x03
@@ -1190,6 +1341,42 @@ void Ra8876_Lite::vsyncWait(void)
 	}
 }
 
+/**
+ * @brief	Non-blocking wait for a vsync that comes after the wait is started, not one latched in the VSYNC flag before.
+ * @param	*armed is the state of the wait, 0 when no wait is in progress
+ * @param	*armedAt is millis() when the wait is started
+ * @return	true at the first call after a fresh vsync, or VSYNC_TIMEOUT_MS after the start if VSYNC interrupt is not
+ *			enabled. *armed is then cleared for the next wait. false while waiting, the first call only starts the wait.
+ * @note	The VSYNC flag stays set from the last vsync until it is reset, so the flag is reset to start a wait.
+ */
+bool Ra8876_Lite::vsync_Fresh(uint8_t *armed, uint32_t *armedAt)
+{
+	if(!*armed)
+	{
+		irqEventFlagReset(RA8876_VSYNC_EVENT);
+		*armed = 1;
+		*armedAt = millis();
+		return false;
+	}
+	if(!vsyncPoll() && millis() - *armedAt < VSYNC_TIMEOUT_MS)
+		return false;
+	*armed = 0;
+	return true;
+}
+
+/**
+ * @brief	Non-blocking check for a vsync since the last call.
+ * @return	true if a VSYNC event is pending, its flag is then reset for the next one
+ * @note	VSYNC interrupt has to be enabled by irqEventSet(RA8876_VSYNC_IRQ_ENABLE, 1).
+ */
+bool Ra8876_Lite::vsyncPoll(void)
+{
+	if((irqEventQuery()&RA8876_VSYNC_EVENT) != RA8876_VSYNC_EVENT)
+		return false;
+	irqEventFlagReset(RA8876_VSYNC_EVENT);
+	return true;
+}
+
 /**
  * @brief Set physical size of the LCD in width and height
  * @param width is the width in pixels
@@ -1353,96 +1540,474 @@ void Ra8876_Lite::displayWindowStartXY(uint16_t x0,uint16_t y0)
 }
 
 /**
- * @brief	Set Canvas addressing to Linear mode
+ * @brief	Set up a picture-in-picture window over the Main Window and show it from the next pipUpdate().
+ * @param	pip is PIP1 or PIP2. PIP1 is shown on top of PIP2 where they overlap.
+ * @param	addr is the SDRAM address of the source image in bytes, a multiple of 4.
+ * @param	image_width is the width of the source image in pixels, a multiple of 4.
+ * @param	x, y are the upper left of the window on the screen, x in multiple of 4.
+ * @param	width, height are the size of the window, width in multiple of 4. The window shows the source image from (0,0).
+ * @param	mode is COLOR_8BPP_RGB332, COLOR_16BPP_RGB565 or COLOR_24BPP_RGB888, it may differ from the Main Window.
+ * @return	true if successful, false for a wrong pip or color mode.
+ * @note	Values not in multiple of 4 are rounded down. Nothing is written to RA8876 until pipUpdate(), so several
+ *			windows can be changed in the same frame. Example to use:<br>
+ *			ra8876lite.irqEventSet(RA8876_VSYNC_IRQ_ENABLE, 1);
+ *			ra8876lite.pipCreate(PIP1, ticker_addr, 1280, 0, 640, 1280, 80);
+ *			ra8876lite.pipUpdate();
+ *			//scroll the ticker by 4 pixels a frame without drawing
+ *			ra8876lite.pipSource(PIP1, ticker_addr, 1280, x);
+ *			ra8876lite.pipUpdate();
  */
-void Ra8876_Lite::canvasLinearModeSet(void)
+bool Ra8876_Lite::pipCreate(uint8_t pip, uint32_t addr, uint16_t image_width, uint16_t x, uint16_t y, uint16_t width, uint16_t height, COLOR_MODE mode)
 {
-	uint8_t AW_COLOR = lcdRegDataRead(RA8876_AW_COLOR); //read REG[5Eh]	
-	AW_COLOR|=(RA8876_CANVAS_LINEAR_MODE<<2);
-	
-	lcdRegDataWrite(RA8876_AW_COLOR, AW_COLOR);	//set to linear mode
+	if(!pipColorMode(pip, mode)) return false;
+	pipSource(pip, addr, image_width);
+	pipMove(pip, x, y);
+	pipResize(pip, width, height);
+	_pip[pip].created = 1;
+	pipEnable(pip, true);
+	return true;
+}
+
+/**
+ * @brief	Move a picture-in-picture window on the screen at the next pipUpdate().
+ * @param	pip is PIP1 or PIP2.
+ * @param	x, y are the upper left of the window on the screen, x in multiple of 4.
+ * @note	Only REG[2Ah]-[2Dh] are written, the source image is not touched. A window moved off the right or bottom
+ *			edge of the screen is cropped, and it is hidden once it is out of the screen.
+ */
+void Ra8876_Lite::pipMove(uint8_t pip, uint16_t x, uint16_t y)
+{
+	if(pip > PIP2) return;
 	
+	_pip[pip].x = x&~3;
+	_pip[pip].y = y;
+	_pip[pip].dirty = 1;
+	pip_Pend();
 }
 
 /**
- * @brief	Set Canvas addressing to Block mode
+ * @brief	Change the size of a picture-in-picture window at the next pipUpdate().
+ * @param	pip is PIP1 or PIP2.
+ * @param	width, height are the size of the window, width in multiple of 4.
  */
-void Ra8876_Lite::canvasBlockModeSet(void)
+void Ra8876_Lite::pipResize(uint8_t pip, uint16_t width, uint16_t height)
 {
-	uint8_t AW_COLOR = lcdRegDataRead(RA8876_AW_COLOR); //read REG[5Eh]	
-	AW_COLOR&=~(RA8876_CANVAS_LINEAR_MODE<<2);
+	if(pip > PIP2) return;
 	
-	lcdRegDataWrite(RA8876_AW_COLOR, AW_COLOR);	//set to block mode
+	_pip[pip].width = width&~3;
+	_pip[pip].height = height;
+	_pip[pip].dirty = 1;
+	pip_Pend();
 }
-  
+
 /**
- * @brief This function allocates a memory space as the Canvas Window in SDRAM
- * @param width in pixels in 4 pixels resolution.
- * @param height in line numbers
- * @param x0 the Active Window start position in x-direction (default ACTIVE_WINDOW_STARTX)
- * @param y0 the Active Window start position in y-direction (default ACTIVE_WINDOW_STARTY)
- * @param mode is the color mode from enum COLOR_MODE<br>
-	COLOR_8BPP_RGB332=1<br>
-	COLOR_16BPP_RGB565=2<br>
-	COLOR_24BPP_RGB888=3<br>
-	COLOR_6BPP_ARGB2222=4<br>
-	COLOR_12BPP_ARGB4444=5<br>
+ * @brief	Change the source of a picture-in-picture window at the next pipUpdate().
+ * @param	pip is PIP1 or PIP2.
+ * @param	addr is the SDRAM address of the source image in bytes, a multiple of 4.
+ * @param	image_width is the width of the source image in pixels, a multiple of 4.
+ * @param	src_x, src_y are the upper left of the window in the source image, src_x in multiple of 4.
+ * @note	Pointing to another image flips a double buffered video tile, and moving (src_x, src_y) scrolls or pans
+ *			the window content, both without drawing.
+ */
+void Ra8876_Lite::pipSource(uint8_t pip, uint32_t addr, uint16_t image_width, uint16_t src_x, uint16_t src_y)
+{
+	if(pip > PIP2) return;
+	
+	_pip[pip].addr = addr&~3UL;
+	_pip[pip].image_width = image_width&~3;
+	_pip[pip].src_x = src_x&~3;
+	_pip[pip].src_y = src_y;
+	_pip[pip].dirty = 1;
+	pip_Pend();
+}
 
- * @param offset is the physical address in SDRAM in bytes.<br>
- * @note  If color mode=COLOR_16BPP_RGB565, offset value at pixel n = n*2bytes
+/**
+ * @brief	Change the color depth of the source image of a picture-in-picture window at the next pipUpdate().
+ * @param	pip is PIP1 or PIP2.
+ * @param	mode is COLOR_8BPP_RGB332, COLOR_16BPP_RGB565 or COLOR_24BPP_RGB888.
+ * @return	true if successful, false for a wrong pip or a color mode PIP windows do not support.
  */
-void Ra8876_Lite::canvasImageBuffer(uint16_t width, uint16_t height, uint16_t x0, uint16_t y0, COLOR_MODE mode, uint32_t offset)
+bool Ra8876_Lite::pipColorMode(uint8_t pip, COLOR_MODE mode)
 {
-  _colorMode = mode;
-  
-  uint8_t _canvasMode = RA8876_CANVAS_BLOCK_MODE;
-  
-  //REG[10h], REG[11h], REG[5Eh], REG[92h]
-  if(_colorMode==COLOR_8BPP_RGB332){
-    lcdRegDataWrite(RA8876_MPWCTR,RA8876_PIP1_WINDOW_DISABLE<<7|RA8876_PIP2_WINDOW_DISABLE<<6|
-    RA8876_SELECT_CONFIG_PIP1<<4|RA8876_IMAGE_COLOR_DEPTH_8BPP<<2|RA8876_PANEL_SYNC_MODE); //REG[10h]
-    lcdRegDataWrite(RA8876_PIPCDEP,RA8876_PIP1_COLOR_DEPTH_8BPP<<2|RA8876_PIP2_COLOR_DEPTH_8BPP); //REG[11h]
-    lcdRegDataWrite(RA8876_AW_COLOR,_canvasMode<<2|RA8876_CANVAS_COLOR_DEPTH_8BPP); //REG[5Eh]
-    lcdRegDataWrite(RA8876_BTE_COLR,RA8876_S0_COLOR_DEPTH_8BPP<<5|RA8876_S1_COLOR_DEPTH_8BPP<<2|RA8876_DESTINATION_COLOR_DEPTH_8BPP);//REG[92h]
-  }
-  else if (_colorMode==COLOR_24BPP_RGB888){
-    lcdRegDataWrite(RA8876_MPWCTR,RA8876_PIP1_WINDOW_DISABLE<<7|RA8876_PIP2_WINDOW_DISABLE<<6|
-    RA8876_SELECT_CONFIG_PIP1<<4|RA8876_IMAGE_COLOR_DEPTH_24BPP<<2|RA8876_PANEL_SYNC_MODE); //REG[10h]
-    lcdRegDataWrite(RA8876_PIPCDEP,RA8876_PIP1_COLOR_DEPTH_24BPP<<2|RA8876_PIP2_COLOR_DEPTH_24BPP); //REG[11h]
-    lcdRegDataWrite(RA8876_AW_COLOR,_canvasMode<<2|RA8876_CANVAS_COLOR_DEPTH_24BPP); //REG[5Eh]
-    lcdRegDataWrite(RA8876_BTE_COLR,RA8876_S0_COLOR_DEPTH_24BPP<<5|RA8876_S1_COLOR_DEPTH_24BPP<<2|RA8876_DESTINATION_COLOR_DEPTH_24BPP);//REG[92h]
-  }
-  else{
-    lcdRegDataWrite(RA8876_MPWCTR,RA8876_PIP1_WINDOW_DISABLE<<7|RA8876_PIP2_WINDOW_DISABLE<<6|
-    RA8876_SELECT_CONFIG_PIP1<<4|RA8876_IMAGE_COLOR_DEPTH_16BPP<<2|RA8876_PANEL_SYNC_MODE);  //REG[10h]
-    lcdRegDataWrite(RA8876_PIPCDEP,RA8876_PIP1_COLOR_DEPTH_16BPP<<2|RA8876_PIP2_COLOR_DEPTH_16BPP); //REG[11h]
-    lcdRegDataWrite(RA8876_AW_COLOR,_canvasMode<<2|RA8876_CANVAS_COLOR_DEPTH_16BPP); //REG[5Eh]
-    lcdRegDataWrite(RA8876_BTE_COLR,RA8876_S0_COLOR_DEPTH_16BPP<<5|RA8876_S1_COLOR_DEPTH_16BPP<<2|RA8876_DESTINATION_COLOR_DEPTH_16BPP);//REG[92h]
-  }   
-   
-    canvasImageStartAddress(offset);
-    if(width!=lcd.width || height!=lcd.height) {
-		canvasImageWidth(width, height);
-		activeWindowWH(width,height);
+	if(pip > PIP2) return false;
+	if(mode!=COLOR_8BPP_RGB332 && mode!=COLOR_16BPP_RGB565 && mode!=COLOR_24BPP_RGB888)
+	{
+		printf("PIP%d color mode %d not supported\n", pip+1, mode);
+		return false;
 	}
-    activeWindowXY(x0,y0);  
+	
+	_pip[pip].mode = mode;
+	_pip[pip].dirty = 1;
+	pip_Pend();
+	return true;
 }
 
 /**
- * @brief Clear the canvas area with BTE solid fill
- * @param color is an object composed of 4 components: red, green, blue, alpha 
- * @param x0 is the starting x-coordinate (default ACTIVE_WINDOW_STARTX)
- * @param y0 is the starting y-coordinate (default ACTIVE_WINDOW_STARTY)
- * @param offset is the SDRAM address in bytes (default CANVAS_OFFSET)
+ * @brief	Show or hide a picture-in-picture window at the next pipUpdate().
+ * @param	pip is PIP1 or PIP2, set up by pipCreate() before it can be shown.
+ * @param	on is true to show, false to hide. The settings of a hidden window are kept for it to be shown again.
  */
-void Ra8876_Lite::canvasClear(Color color, uint16_t x0, uint16_t y0, uint32_t lnOffset)
+void Ra8876_Lite::pipEnable(uint8_t pip, bool on)
 {
-  if((x0>_canvasWidth) || (y0>_canvasHeight)) return;
-  
-  int32_t _canvasAddress = canvasAddress_from_lnOffset(lnOffset);
-  if(_canvasAddress<0) return;
-  
-  bteSolidFill (_canvasAddress,x0,y0,_canvasWidth,_canvasHeight, color);
+	if(pip > PIP2 || !_pip[pip].created) return;
+	
+	_pip[pip].enabled = on;
+	pip_Pend();
+}
+
+/**
+ * @brief	Mark a change of PIP1 or PIP2 for the next pipUpdate().
+ * @note	The first change after an update resets the VSYNC flag, so that pipUpdate() waits for a vsync that
+ *			comes after the change and not for one latched in the flag long before.
+ */
+void Ra8876_Lite::pip_Pend(void)
+{
+	if(!_pipPending)
+		irqEventFlagReset(RA8876_VSYNC_EVENT);
+	_pipPending = true;
+}
+
+/**
+ * @brief	Write the changes of PIP1 & PIP2 to RA8876 right after a vsync, so a window never shows half moved.
+ * @param	wait is true to block for the next vsync, false to return at once if no vsync has come since the first change.
+ * @return	true if the windows on the screen are up to date, false if the changes are still pending (wait=false).
+ * @note	VSYNC interrupt has to be enabled by irqEventSet(RA8876_VSYNC_IRQ_ENABLE, 1), otherwise vsyncWait()
+ *			times out in VSYNC_TIMEOUT_MS and the changes are written anyway, and with wait=false they stay pending.
+ *			All changes since the last call take a handful of register writes, the source images are not touched.
+ */
+bool Ra8876_Lite::pipUpdate(bool wait)
+{
+	if(!_pipPending) return true;
+	
+	if(wait)
+	{
+		irqEventFlagReset(RA8876_VSYNC_EVENT);	//write right after a vsync, not in the middle of a frame
+		vsyncWait();
+	}
+	else if(!vsyncPoll())
+		return false;
+	
+	for(uint8_t i=PIP1; i<=PIP2; i++)
+	{
+		if(!_pip[i].dirty) continue;
+		pip_ControlWrite(i);	//REG[2Ah]-[3Bh] of this window selected
+		pip_WindowWrite(i);
+		_pip[i].dirty = 0;
+	}
+	pip_ControlWrite(RA8876_SELECT_CONFIG_PIP1);
+	_pipPending = false;
+	return true;
+}
+
+/**
+ * @brief	Return color depth of a color mode in REG[10h] bit[3:2] & REG[11h] format
+ */
+uint8_t Ra8876_Lite::pip_ColorDepth(COLOR_MODE mode)
+{
+	if(mode==COLOR_8BPP_RGB332)		return RA8876_IMAGE_COLOR_DEPTH_8BPP;
+	if(mode==COLOR_24BPP_RGB888)	return RA8876_IMAGE_COLOR_DEPTH_24BPP;
+	return RA8876_IMAGE_COLOR_DEPTH_16BPP;
+}
+
+/**
+ * @brief	Write REG[11h] and REG[10h] with the windows shown, the color depths and a PIP window selected
+ * @param	select is RA8876_SELECT_CONFIG_PIP1 or RA8876_SELECT_CONFIG_PIP2 for REG[2Ah]-[3Bh] to set up
+ * @note	A window not created takes the color depth of the Main Window. A window out of the screen is not shown.
+ */
+void Ra8876_Lite::pip_ControlWrite(uint8_t select)
+{
+	uint8_t on[2];
+	
+	for(uint8_t i=PIP1; i<=PIP2; i++)
+		on[i] = _pip[i].enabled && _pip[i].x < lcd.width && _pip[i].y < lcd.height && _pip[i].width && _pip[i].height;
+	
+	lcdRegDataWrite(RA8876_PIPCDEP,pip_ColorDepth(_pip[PIP1].created? _pip[PIP1].mode : _colorMode)<<2|
+	pip_ColorDepth(_pip[PIP2].created? _pip[PIP2].mode : _colorMode));	//REG[11h]
+	lcdRegDataWrite(RA8876_MPWCTR,(on[PIP1]? RA8876_PIP1_WINDOW_ENABLE:RA8876_PIP1_WINDOW_DISABLE)<<7|
+	(on[PIP2]? RA8876_PIP2_WINDOW_ENABLE:RA8876_PIP2_WINDOW_DISABLE)<<6|
+	select<<4|pip_ColorDepth(_colorMode)<<2|RA8876_PANEL_SYNC_MODE);	//REG[10h]
+}
+
+/**
+ * @brief	Write REG[2Ah]-[3Bh] of a PIP window selected by pip_ControlWrite()
+ * @note	The window is cropped to the right and bottom edges of the screen.
+ */
+void Ra8876_Lite::pip_WindowWrite(uint8_t pip)
+{
+	const PIP_WINDOW *w = &_pip[pip];
+	uint16_t width = w->width, height = w->height;
+	
+	if(w->x < lcd.width && width > lcd.width - w->x)
+		width = (lcd.width - w->x)&~3;
+	if(w->y < lcd.height && height > lcd.height - w->y)
+		height = lcd.height - w->y;
+	
+	lcdRegDataWrite(RA8876_PWDULX0,w->x);//2Ah
+	lcdRegDataWrite(RA8876_PWDULX1,w->x>>8);//2Bh
+	lcdRegDataWrite(RA8876_PWDULY0,w->y);//2Ch
+	lcdRegDataWrite(RA8876_PWDULY1,w->y>>8);//2Dh
+	lcdRegDataWrite(RA8876_PISA0,w->addr);//2Eh
+	lcdRegDataWrite(RA8876_PISA1,w->addr>>8);//2Fh
+	lcdRegDataWrite(RA8876_PISA2,w->addr>>16);//30h
+	lcdRegDataWrite(RA8876_PISA3,w->addr>>24);//31h
+	lcdRegDataWrite(RA8876_PIW0,w->image_width);//32h
+	lcdRegDataWrite(RA8876_PIW1,w->image_width>>8);//33h
+	lcdRegDataWrite(RA8876_PWIULX0,w->src_x);//34h
+	lcdRegDataWrite(RA8876_PWIULX1,w->src_x>>8);//35h
+	lcdRegDataWrite(RA8876_PWIULY0,w->src_y);//36h
+	lcdRegDataWrite(RA8876_PWIULY1,w->src_y>>8);//37h
+	lcdRegDataWrite(RA8876_PWW0,width);//38h
+	lcdRegDataWrite(RA8876_PWW1,width>>8);//39h
+	lcdRegDataWrite(RA8876_PWH0,height);//3Ah
+	lcdRegDataWrite(RA8876_PWH1,height>>8);//3Bh
+}
+
+/**
+ * @brief	Store a graphic cursor shape in the cursor RAM.
+ * @param	index is the shape from 0 to GRAPHIC_CURSOR_COUNT-1.
+ * @param	*shape is 256 bytes of 32x32 pixels in 2bpp from CURSOR_PIXEL, 8 bytes a line with the leftmost pixel
+ *			of a byte in bit[7:6].
+ * @param	hot_x, hot_y are the point of the shape cursorMove() places at (x,y), e.g. the tip of an arrow.
+ * @return	true if successful, false for a wrong index.
+ * @note	Shapes are best loaded before the cursor is enabled, since the shape shown is switched to the one
+ *			loaded for the time it takes. Example to use:<br>
+ *			ra8876lite.cursorLoad(0, arrow, 0, 0);
+ *			ra8876lite.cursorLoad(1, hand_image, hand_mask, 10, 0);
+ *			ra8876lite.cursorColor(color.Black, color.White);
+ *			ra8876lite.cursorSelect(0);
+ *			ra8876lite.cursorEnable(true);
+ *			ra8876lite.cursorMove(touch_x, touch_y);	//on each touch event, no drawing in SDRAM
+ */
+bool Ra8876_Lite::cursorLoad(uint8_t index, const uint8_t *shape, uint8_t hot_x, uint8_t hot_y)
+{
+	return cursor_Load(index, shape, 0, 0, hot_x, hot_y);
+}
+
+/**
+ * @brief	Store a graphic cursor shape from a 1bpp image and mask.
+ * @param	index is the shape from 0 to GRAPHIC_CURSOR_COUNT-1.
+ * @param	*image is 128 bytes of 32x32 pixels in 1bpp, MSB first. '1' for color1, '0' for color0 of cursorColor().
+ * @param	*mask is 128 bytes in the same format, '1' where the image is shown, '0' for a transparent pixel.
+ * @param	hot_x, hot_y are the point of the shape cursorMove() places at (x,y).
+ * @return	true if successful, false for a wrong index.
+ * @note	This is the format of X11 and Windows monochrome cursors. Refer to cursorLoad(uint8_t, const uint8_t*,
+ *			uint8_t, uint8_t) for details.
+ */
+bool Ra8876_Lite::cursorLoad(uint8_t index, const uint8_t *image, const uint8_t *mask, uint8_t hot_x, uint8_t hot_y)
+{
+	if(image==0 || mask==0) return false;
+	
+	return cursor_Load(index, 0, image, mask, hot_x, hot_y);
+}
+
+/**
+ * @brief	Write a shape to the cursor RAM, from *shape in 2bpp if it is not 0, otherwise from *image & *mask in 1bpp
+ */
+bool Ra8876_Lite::cursor_Load(uint8_t index, const uint8_t *shape, const uint8_t *image, const uint8_t *mask, uint8_t hot_x, uint8_t hot_y)
+{
+	uint8_t buf[RA8876_WR_FIFO_DEPTH];
+	uint8_t ICR, n = 0;
+	
+	if(index >= GRAPHIC_CURSOR_COUNT) return false;
+	
+	check2dBusy();
+	checkWriteFifoEmpty();
+	ICR = lcdRegDataRead(RA8876_ICR);
+	cursor_Select(index);	//the cursor RAM written is the one selected
+	lcdRegDataWrite(RA8876_ICR,(ICR&~0x03)|RA8876_MEMORY_SELECT_CURSOR_RAM);//03h
+	ramAccessPrepare();
+	
+	for(uint16_t i=0; i<(uint16_t)GRAPHIC_CURSOR_SIZE*GRAPHIC_CURSOR_SIZE/4; i++)
+	{
+		if(shape)
+			buf[n] = shape[i];
+		else
+		{
+			//4 pixels of a 2bpp byte from a nibble of the 1bpp image & mask
+			uint8_t shift = (i&1) ? 0 : 4;
+			uint8_t im = image[i/2]>>shift, mk = mask[i/2]>>shift;
+			
+			buf[n] = 0;
+			for(uint8_t b=0; b<4; b++)
+			{
+				uint8_t pixel = CURSOR_TRANSPARENT;
+				if(mk & (0x08>>b))
+					pixel = (im & (0x08>>b)) ? CURSOR_COLOR1 : CURSOR_COLOR0;
+				buf[n] |= pixel<<(6-2*b);
+			}
+		}
+		
+		if(++n == sizeof(buf))
+		{
+			checkWriteFifoEmpty();
+			hal_spi_write(buf, n);
+			n = 0;
+		}
+	}
+	
+	checkWriteFifoEmpty();
+	lcdRegDataWrite(RA8876_ICR,ICR);//03h
+	cursor_Select(_cursorIndex);
+	
+	_cursorHot[index][0] = (hot_x < GRAPHIC_CURSOR_SIZE) ? hot_x : GRAPHIC_CURSOR_SIZE-1;
+	_cursorHot[index][1] = (hot_y < GRAPHIC_CURSOR_SIZE) ? hot_y : GRAPHIC_CURSOR_SIZE-1;
+	return true;
+}
+
+/**
+ * @brief	Show another graphic cursor shape stored by cursorLoad().
+ * @param	index is the shape from 0 to GRAPHIC_CURSOR_COUNT-1.
+ * @note	The cursor stays at the same (x,y) of cursorMove() only if both shapes have the same hot spot.
+ */
+void Ra8876_Lite::cursorSelect(uint8_t index)
+{
+	if(index >= GRAPHIC_CURSOR_COUNT) return;
+	
+	_cursorIndex = index;
+	cursor_Select(index);
+}
+
+/**
+ * @brief	Write the graphic cursor selection to REG[3Ch] bit[3:2], other bits are kept
+ */
+void Ra8876_Lite::cursor_Select(uint8_t index)
+{
+	uint8_t GTCCR = lcdRegDataRead(RA8876_GTCCR);	//read REG[3Ch]
+	GTCCR = (GTCCR&~0x0C)|((RA8876_SELECT_GRAPHIC_CURSOR1+index)<<2);
+	lcdRegDataWrite(RA8876_GTCCR, GTCCR);
+}
+
+/**
+ * @brief	Set the two colors of the graphic cursor, shared by all shapes.
+ * @param	color0 is shown for CURSOR_COLOR0 pixels
+ * @param	color1 is shown for CURSOR_COLOR1 pixels
+ * @note	The cursor colors are 256 colors in RGB332, whatever the color depth of the Main Window.
+ */
+void Ra8876_Lite::cursorColor(Color color0, Color color1)
+{
+	lcdRegDataWrite(RA8876_GCC0,(color0.r&0xE0)|((color0.g&0xE0)>>3)|(color0.b>>6));//44h
+	lcdRegDataWrite(RA8876_GCC1,(color1.r&0xE0)|((color1.g&0xE0)>>3)|(color1.b>>6));//45h
+}
+
+/**
+ * @brief	Move the graphic cursor, nothing is drawn in SDRAM.
+ * @param	x, y are the screen coordinates for the hot spot of the shape shown.
+ * @note	The upper left of the shape is kept on the screen, so the hot spot cannot reach the very left and
+ *			top edges if it is not at (0,0) of the shape.
+ */
+void Ra8876_Lite::cursorMove(int16_t x, int16_t y)
+{
+	x -= _cursorHot[_cursorIndex][0];
+	y -= _cursorHot[_cursorIndex][1];
+	if(x < 0) x = 0;
+	if(y < 0) y = 0;
+	
+	lcdRegDataWrite(RA8876_GCHP0,x);//40h
+	lcdRegDataWrite(RA8876_GCHP1,x>>8);//41h
+	lcdRegDataWrite(RA8876_GCVP0,y);//42h
+	lcdRegDataWrite(RA8876_GCVP1,y>>8);//43h
+}
+
+/**
+ * @brief	Show or hide the graphic cursor.
+ * @param	on is true to show the shape selected by cursorSelect(), false to hide it.
+ */
+void Ra8876_Lite::cursorEnable(bool on)
+{
+	uint8_t GTCCR = lcdRegDataRead(RA8876_GTCCR);	//read REG[3Ch]
+	
+	if(on)
+		GTCCR |= RA8876_GRAPHIC_CURSOR_ENABLE<<4;
+	else
+		GTCCR &= ~(RA8876_GRAPHIC_CURSOR_ENABLE<<4);
+	lcdRegDataWrite(RA8876_GTCCR, GTCCR);
+}
+
+/**
+ * @brief	Set Canvas addressing to Linear mode
+ */
+void Ra8876_Lite::canvasLinearModeSet(void)
+{
+	uint8_t AW_COLOR = lcdRegDataRead(RA8876_AW_COLOR); //read REG[5Eh]	
+	AW_COLOR|=(RA8876_CANVAS_LINEAR_MODE<<2);
+	
+	lcdRegDataWrite(RA8876_AW_COLOR, AW_COLOR);	//set to linear mode
+	
+}
+
+/**
+ * @brief	Set Canvas addressing to Block mode
+ */
+void Ra8876_Lite::canvasBlockModeSet(void)
+{
+	uint8_t AW_COLOR = lcdRegDataRead(RA8876_AW_COLOR); //read REG[5Eh]	
+	AW_COLOR&=~(RA8876_CANVAS_LINEAR_MODE<<2);
+	
+	lcdRegDataWrite(RA8876_AW_COLOR, AW_COLOR);	//set to block mode
+}
+  
+/**
+ * @brief This function allocates a memory space as the Canvas Window in SDRAM
+ * @param width in pixels in 4 pixels resolution.
+ * @param height in line numbers
+ * @param x0 the Active Window start position in x-direction (default ACTIVE_WINDOW_STARTX)
+ * @param y0 the Active Window start position in y-direction (default ACTIVE_WINDOW_STARTY)
+ * @param mode is the color mode from enum COLOR_MODE<br>
+	COLOR_8BPP_RGB332=1<br>
+	COLOR_16BPP_RGB565=2<br>
+	COLOR_24BPP_RGB888=3<br>
+	COLOR_6BPP_ARGB2222=4<br>
+	COLOR_12BPP_ARGB4444=5<br>
+
+ * @param offset is the physical address in SDRAM in bytes.<br>
+ * @note  If color mode=COLOR_16BPP_RGB565, offset value at pixel n = n*2bytes
+ */
+void Ra8876_Lite::canvasImageBuffer(uint16_t width, uint16_t height, uint16_t x0, uint16_t y0, COLOR_MODE mode, uint32_t offset)
+{
+  _colorMode = mode;
+  
+  uint8_t _canvasMode = RA8876_CANVAS_BLOCK_MODE;
+  
+  //REG[10h], REG[11h], PIP windows created are kept
+  pip_ControlWrite(RA8876_SELECT_CONFIG_PIP1);
+  
+  //REG[5Eh], REG[92h]
+  if(_colorMode==COLOR_8BPP_RGB332){
+    lcdRegDataWrite(RA8876_AW_COLOR,_canvasMode<<2|RA8876_CANVAS_COLOR_DEPTH_8BPP); //REG[5Eh]
+    lcdRegDataWrite(RA8876_BTE_COLR,RA8876_S0_COLOR_DEPTH_8BPP<<5|RA8876_S1_COLOR_DEPTH_8BPP<<2|RA8876_DESTINATION_COLOR_DEPTH_8BPP);//REG[92h]
+  }
+  else if (_colorMode==COLOR_24BPP_RGB888){
+    lcdRegDataWrite(RA8876_AW_COLOR,_canvasMode<<2|RA8876_CANVAS_COLOR_DEPTH_24BPP); //REG[5Eh]
+    lcdRegDataWrite(RA8876_BTE_COLR,RA8876_S0_COLOR_DEPTH_24BPP<<5|RA8876_S1_COLOR_DEPTH_24BPP<<2|RA8876_DESTINATION_COLOR_DEPTH_24BPP);//REG[92h]
+  }
+  else{
+    lcdRegDataWrite(RA8876_AW_COLOR,_canvasMode<<2|RA8876_CANVAS_COLOR_DEPTH_16BPP); //REG[5Eh]
+    lcdRegDataWrite(RA8876_BTE_COLR,RA8876_S0_COLOR_DEPTH_16BPP<<5|RA8876_S1_COLOR_DEPTH_16BPP<<2|RA8876_DESTINATION_COLOR_DEPTH_16BPP);//REG[92h]
+  }   
+   
+    canvasImageStartAddress(offset);
+    if(width!=lcd.width || height!=lcd.height) {
+		canvasImageWidth(width, height);
+		activeWindowWH(width,height);
+	}
+    activeWindowXY(x0,y0);  
+}
+
+/**
+ * @brief Clear the canvas area with BTE solid fill
+ * @param color is an object composed of 4 components: red, green, blue, alpha 
+ * @param x0 is the starting x-coordinate (default ACTIVE_WINDOW_STARTX)
+ * @param y0 is the starting y-coordinate (default ACTIVE_WINDOW_STARTY)
+ * @param offset is the SDRAM address in bytes (default CANVAS_OFFSET)
+ */
+void Ra8876_Lite::canvasClear(Color color, uint16_t x0, uint16_t y0, uint32_t lnOffset)
+{
+  if((x0>_canvasWidth) || (y0>_canvasHeight)) return;
+  
+  int32_t _canvasAddress = canvasAddress_from_lnOffset(lnOffset);
+  if(_canvasAddress<0) return;
+  
+  bteSolidFill (_canvasAddress,x0,y0,_canvasWidth,_canvasHeight, color);
 }
 
 /**
@@ -1637,77 +2202,290 @@ void Ra8876_Lite::canvasRead (void *data, uint32_t lnOffset, size_t data_count)
 }
 
 /**
- * @brief Set canvas start address.
- * @note  This function is ignored if canvas in linear addressing mode.
- * @param addr is the address in 32-bit integer.
+ * @brief	Set the canvas to a rectangle of an image anywhere in SDRAM and start a memory read from its top left corner.
+ * @param	addr is the start address of the image in SDRAM.
+ * @param	image_width is the width of the image in pixels.
+ * @param	x, y, width, height is the rectangle to read.
+ * @note	Only the canvas width register is changed, _canvasWidth is kept for the restore by mem_ReadRestore().
  */
-void Ra8876_Lite::canvasImageStartAddress(uint32_t addr)	
+void Ra8876_Lite::mem_ReadFrame(uint32_t addr, uint16_t image_width, uint16_t x, uint16_t y, uint16_t width, uint16_t height)
 {
-  lcdRegDataWrite(RA8876_CVSSA0,addr);    //50h
-  lcdRegDataWrite(RA8876_CVSSA1,addr>>8); //51h
-  lcdRegDataWrite(RA8876_CVSSA2,addr>>16);//52h
-  lcdRegDataWrite(RA8876_CVSSA3,addr>>24);//53h  
+	canvasImageStartAddress(addr);
+	lcdRegDataWrite(RA8876_CVS_IMWTH0,image_width);     //54h
+	lcdRegDataWrite(RA8876_CVS_IMWTH1,image_width>>8);  //55h
+	activeWindowXY(x,y);
+	activeWindowWH(width,height);
+	lcdRegDataWrite(RA8876_CURH0,x); //5fh
+	lcdRegDataWrite(RA8876_CURH1,x>>8);//60h
+	lcdRegDataWrite(RA8876_CURV0,y);//61h
+	lcdRegDataWrite(RA8876_CURV1,y>>8);//62h
+	
+	ramAccessPrepare();
+	lcdDataRead();	//dummy read is required somehow
 }
 
 /**
- * @brief Set canvas image width.
- * @note  Max width is 12-bit (4096). This function is ignored if canvas in linear addressing mode.
- * @param width is pixels. It is 4 pixel resolutions.
+ * @brief	Restore canvas and active window after mem_ReadFrame().
  */
-void Ra8876_Lite::canvasImageWidth(uint16_t width, uint16_t height)	
+void Ra8876_Lite::mem_ReadRestore(void)
 {
-  _canvasWidth = width;
-  _canvasHeight = height;
-  
-  lcdRegDataWrite(RA8876_CVS_IMWTH0,width);     //54h
-  lcdRegDataWrite(RA8876_CVS_IMWTH1,width>>8);  //55h
+	lcdRegDataWrite(RA8876_CVS_IMWTH0,_canvasWidth);     //54h
+	lcdRegDataWrite(RA8876_CVS_IMWTH1,_canvasWidth>>8);  //55h
+	activeWindowXY(ACTIVE_WINDOW_STARTX,ACTIVE_WINDOW_STARTY);
+	activeWindowWH(_canvasWidth,_canvasHeight);
+	canvasImageStartAddress(CANVAS_OFFSET);
 }
 
 /**
- * @brief Set Active Window upper-left corner x,y coordinates with reference to canvas image start address.
- * @note  This function is ignored if canvas in linear addressing mode.
- * @param x0 is the upper left x-coordinate. Max 8188.
- * @param y0 is the upper left y-coordinate. Max 8191.
+ * @brief	Burst read of a memory read started by mem_ReadFrame().
+ * @param	*buf points to the buffer for byte_count bytes, in the byte order of SDRAM.
+ * @param	byte_count is the number of bytes to read.
+ * @note	Bytes are read by lcdDataRead() one at a time, as canvasRead() does. Only when the Memory Read FIFO is found
+ *			full, which means RA8876_RD_FIFO_DEPTH bytes are buffered, MEM_READ_BURST_SIZE bytes are read by hal_spi_read()
+ *			in one chip select. The status is checked once every MEM_READ_BURST_SIZE bytes.
  */
-void Ra8876_Lite::activeWindowXY(uint16_t x0,uint16_t y0)	
+void Ra8876_Lite::mem_ReadBurst(uint8_t *buf, uint32_t byte_count)
 {
-  lcdRegDataWrite(RA8876_AWUL_X0,x0);//56h
-  lcdRegDataWrite(RA8876_AWUL_X1,x0>>8);//57h 
-  lcdRegDataWrite(RA8876_AWUL_Y0,y0);//58h
-  lcdRegDataWrite(RA8876_AWUL_Y1,y0>>8);//59h 
+	while(byte_count)
+	{
+		uint32_t n = (byte_count>MEM_READ_BURST_SIZE)? MEM_READ_BURST_SIZE : byte_count;
+		
+		if(n==MEM_READ_BURST_SIZE && (lcdStatusRead()&RA8876_STSR_RD_FIFO_FULL))
+		{
+			hal_spi_read(buf, n);
+			buf += n;
+		}
+		else
+		{
+			for(uint32_t i=0; i<n; i++)
+				*buf++ = lcdDataRead();
+		}
+		byte_count -= n;
+	}
 }
 
 /**
- * @brief Set Active Window width & height.
- * @note  This function is ignored if canvas in linear addressing mode.
- * @param width in pixels. Max 8188.
- * @param height in lines. Max 8191.
+ * @brief	Burst read of a rectangle from an image anywhere in SDRAM, e.g. a BITMAP or the visible main window.
+ * @param	*data points to the buffer for width*height*getColorDepth() bytes.
+ * @param	addr is the start address of the image in SDRAM.
+ * @param	image_width is the width of the image in pixels.
+ * @param	x, y, width, height is the rectangle to read.
+ * @note	Pixels are returned in raster order as they are stored in SDRAM:<br>
+ *			RGB332 in one byte, RGB565 in two bytes little endian, RGB888 in three bytes B,G,R.
  */
-void Ra8876_Lite::activeWindowWH(uint16_t width,uint16_t height)	
+void Ra8876_Lite::canvasRead(void *data, uint32_t addr, uint16_t image_width, uint16_t x, uint16_t y, uint16_t width, uint16_t height)
 {
-  lcdRegDataWrite(RA8876_AW_WTH0,width);//5ah
-  lcdRegDataWrite(RA8876_AW_WTH1,width>>8);//5bh
-  lcdRegDataWrite(RA8876_AW_HT0,height);//5ch
-  lcdRegDataWrite(RA8876_AW_HT1,height>>8);//5dh  
+	if(!width || !height) return;
+	
+	mem_ReadFrame(addr, image_width, x, y, width, height);
+	mem_ReadBurst((uint8_t *)data, (uint32_t)width*height*getColorDepth());
+	mem_ReadRestore();
+}
+
+#if defined (LOAD_SD_LIBRARY)
+static void bmp_Put32(uint8_t *p, uint32_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v>>8);
+	p[2] = (uint8_t)(v>>16);
+	p[3] = (uint8_t)(v>>24);
+}
+
+static bool bmp_Flush(File &bmpFile, const uint8_t *buf, uint16_t *fill)
+{
+	bool ok = (bmpFile.write(buf, *fill) == *fill);
+	*fill = 0;
+	return ok;
 }
 
 /**
- * @brief Set cursor position
- * @param x,y is the coordinates
- * @param lnOffset is the canvas start address represented in line number.
- * @note  Coordinates (x,y) is relative to Canvas Start Address. User should program proper active window 
- * related parameters before configure this register. Therefore, if the Canvas Start Address has been set
- * to some non-display area in SDRAM, pixel write after setPixelCursor(x,y) will write to that non-display region.
- * Max x,y = 2^13 i.e. 8192. <br>
+ * @brief	Save a rectangle from an image anywhere in SDRAM to SD card as a BMP file.
+ * @param	*pFilename is a pointer to the filename, an existing file is replaced.
+ * @param	addr is the start address of the image in SDRAM.
+ * @param	image_width is the width of the image in pixels.
+ * @param	x, y, width, height is the rectangle to save.
+ * @return	true if the file is written, false if it cannot be created or an SD card write fails.
+ * @note	The BMP keeps the color depth of the canvas: 8-bit with an RGB332 palette, 16-bit RGB565 bitfields or 24-bit.<br>
+ *			Rows are read bottom-up by burst reads straight into a buffer of BMP_CAPTURE_BUFFER_SIZE bytes,
+ *			which goes to the file in whole buffers so every write but the last is 512-byte aligned.
+ *			Example to use:
+ *
+ *			ra8876lite.captureBmp("shot.bmp", 0, ra8876lite.getCanvasWidth(), 0, 0, 320, 240);
  */
-void Ra8876_Lite:: setPixelCursor(uint16_t x,uint16_t y,uint32_t lnOffset)
+bool Ra8876_Lite::captureBmp(const char *pFilename, uint32_t addr, uint16_t image_width, uint16_t x, uint16_t y, uint16_t width, uint16_t height)
 {
-  //uint8_t bpp = getColorDepth();
-  //if(lnOffset > (uint32_t)(MEM_SIZE_MAX/(_canvasWidth*bpp)-1)) return;
-  //canvasImageStartAddress(lnOffset*_canvasWidth*bpp);
-  
-  int32_t _canvasAddress = canvasAddress_from_lnOffset(lnOffset);
-  if(_canvasAddress<0) return;
+	static uint8_t buf[BMP_CAPTURE_BUFFER_SIZE];
+	uint16_t fill = 0;
+	bool ok = true;
+	
+	if(!width || !height || ((uint32_t)x+width)>image_width) return false;
+	
+	uint8_t  bpp = getColorDepth();
+	uint32_t rowBytes = (uint32_t)width*bpp;
+	uint8_t  pad = (4-(rowBytes&3))&3;	//rows are padded to 4 bytes
+	uint32_t offBits = 54 + ((bpp==1)? 1024 : (bpp==2)? 12 : 0);
+	uint32_t imageSize = (rowBytes+pad)*height;
+	
+	if(SD.exists(pFilename)) SD.remove(pFilename);	//FILE_WRITE appends to an existing file
+	File bmpFile = SD.open(pFilename, FILE_WRITE);
+	if(!bmpFile) {printf("captureBmp() : cannot create %s\n", pFilename); return false;}
+	
+	//BITMAPFILEHEADER and BITMAPINFOHEADER with a positive height for bottom-up rows
+	memset(buf, 0, 54);
+	buf[0] = 'B'; buf[1] = 'M';
+	bmp_Put32(&buf[2], offBits+imageSize);
+	bmp_Put32(&buf[10], offBits);
+	bmp_Put32(&buf[14], 40);
+	bmp_Put32(&buf[18], width);
+	bmp_Put32(&buf[22], height);
+	buf[26] = 1;						//planes
+	buf[28] = bpp*8;					//bits per pixel
+	buf[30] = (bpp==2)? 3 : 0;			//BI_BITFIELDS for RGB565, BI_RGB otherwise
+	bmp_Put32(&buf[34], imageSize);
+	bmp_Put32(&buf[38], 2835);			//72 dpi
+	bmp_Put32(&buf[42], 2835);
+	if(bpp==1) bmp_Put32(&buf[46], 256);
+	fill = 54;
+	
+	if(bpp==2)
+	{
+		bmp_Put32(&buf[54], 0xF800);	//red, green and blue masks
+		bmp_Put32(&buf[58], 0x07E0);
+		bmp_Put32(&buf[62], 0x001F);
+		fill += 12;
+	}
+	else if(bpp==1)
+	{
+		for(uint16_t i=0; i<256; i++)	//RGB332 palette in B,G,R,0
+		{
+			uint8_t entry[4] = {(uint8_t)((i&0x03)*85), (uint8_t)(((i>>2)&0x07)*255/7), (uint8_t)((i>>5)*255/7), 0};
+			for(uint8_t k=0; k<4 && ok; k++)
+			{
+				buf[fill++] = entry[k];
+				if(fill==BMP_CAPTURE_BUFFER_SIZE) ok = bmp_Flush(bmpFile, buf, &fill);
+			}
+		}
+	}
+	
+	for(uint16_t j=height; j-- && ok; )
+	{
+		mem_ReadFrame(addr, image_width, x, y+j, width, 1);
+		uint32_t n = rowBytes;
+		while(n && ok)
+		{
+			uint16_t k = (n < (uint32_t)(BMP_CAPTURE_BUFFER_SIZE-fill))? n : BMP_CAPTURE_BUFFER_SIZE-fill;
+			mem_ReadBurst(&buf[fill], k);
+			fill += k;
+			n -= k;
+			if(fill==BMP_CAPTURE_BUFFER_SIZE) ok = bmp_Flush(bmpFile, buf, &fill);
+		}
+		for(uint8_t p=0; p<pad && ok; p++)
+		{
+			buf[fill++] = 0;
+			if(fill==BMP_CAPTURE_BUFFER_SIZE) ok = bmp_Flush(bmpFile, buf, &fill);
+		}
+	}
+	if(ok && fill) ok = bmp_Flush(bmpFile, buf, &fill);
+	
+	bmpFile.close();
+	mem_ReadRestore();
+	
+	if(!ok) printf("captureBmp() : write error on %s\n", pFilename);
+	return ok;
+}
+
+/**
+ * @brief	Save what the main window is showing to SD card as a BMP file of lcd.width x lcd.height.
+ * @param	*pFilename is a pointer to the filename, an existing file is replaced.
+ * @return	true if the file is written.
+ * @note	Main window address, width and start position are read back from the registers,
+ *			so a page flipped by the flipbook or scrolled by a slide transition is saved as shown.<br>
+ *			PIP windows and the graphic cursor are not in the main window image and are not saved.
+ */
+bool Ra8876_Lite::captureScreen(const char *pFilename)
+{
+	uint32_t addr = (uint32_t)lcdRegDataRead(RA8876_MISA0) | (uint32_t)lcdRegDataRead(RA8876_MISA1)<<8 |
+					(uint32_t)lcdRegDataRead(RA8876_MISA2)<<16 | (uint32_t)lcdRegDataRead(RA8876_MISA3)<<24;
+	uint16_t image_width = lcdRegDataRead(RA8876_MIW0) | (uint16_t)lcdRegDataRead(RA8876_MIW1)<<8;
+	uint16_t x = lcdRegDataRead(RA8876_MWULX0) | (uint16_t)lcdRegDataRead(RA8876_MWULX1)<<8;
+	uint16_t y = lcdRegDataRead(RA8876_MWULY0) | (uint16_t)lcdRegDataRead(RA8876_MWULY1)<<8;
+	
+	return captureBmp(pFilename, addr, image_width, x, y, lcd.width, lcd.height);
+}
+#endif
+
+/**
+ * @brief Set canvas start address.
+ * @note  This function is ignored if canvas in linear addressing mode.
+ * @param addr is the address in 32-bit integer.
+ */
+void Ra8876_Lite::canvasImageStartAddress(uint32_t addr)	
+{
+  lcdRegDataWrite(RA8876_CVSSA0,addr);    //50h
+  lcdRegDataWrite(RA8876_CVSSA1,addr>>8); //51h
+  lcdRegDataWrite(RA8876_CVSSA2,addr>>16);//52h
+  lcdRegDataWrite(RA8876_CVSSA3,addr>>24);//53h  
+}
+
+/**
+ * @brief Set canvas image width.
+ * @note  Max width is 12-bit (4096). This function is ignored if canvas in linear addressing mode.
+ * @param width is pixels. It is 4 pixel resolutions.
+ */
+void Ra8876_Lite::canvasImageWidth(uint16_t width, uint16_t height)	
+{
+  _canvasWidth = width;
+  _canvasHeight = height;
+  
+  lcdRegDataWrite(RA8876_CVS_IMWTH0,width);     //54h
+  lcdRegDataWrite(RA8876_CVS_IMWTH1,width>>8);  //55h
+}
+
+/**
+ * @brief Set Active Window upper-left corner x,y coordinates with reference to canvas image start address.
+ * @note  This function is ignored if canvas in linear addressing mode.
+ * @param x0 is the upper left x-coordinate. Max 8188.
+ * @param y0 is the upper left y-coordinate. Max 8191.
+ */
+void Ra8876_Lite::activeWindowXY(uint16_t x0,uint16_t y0)	
+{
+  lcdRegDataWrite(RA8876_AWUL_X0,x0);//56h
+  lcdRegDataWrite(RA8876_AWUL_X1,x0>>8);//57h 
+  lcdRegDataWrite(RA8876_AWUL_Y0,y0);//58h
+  lcdRegDataWrite(RA8876_AWUL_Y1,y0>>8);//59h 
+}
+
+/**
+ * @brief Set Active Window width & height.
+ * @note  This function is ignored if canvas in linear addressing mode.
+ * @param width in pixels. Max 8188.
+ * @param height in lines. Max 8191.
+ */
+void Ra8876_Lite::activeWindowWH(uint16_t width,uint16_t height)	
+{
+  lcdRegDataWrite(RA8876_AW_WTH0,width);//5ah
+  lcdRegDataWrite(RA8876_AW_WTH1,width>>8);//5bh
+  lcdRegDataWrite(RA8876_AW_HT0,height);//5ch
+  lcdRegDataWrite(RA8876_AW_HT1,height>>8);//5dh  
+}
+
+/**
+ * @brief Set cursor position
+ * @param x,y is the coordinates
+ * @param lnOffset is the canvas start address represented in line number.
+ * @note  Coordinates (x,y) is relative to Canvas Start Address. User should program proper active window 
+ * related parameters before configure this register. Therefore, if the Canvas Start Address has been set
+ * to some non-display area in SDRAM, pixel write after setPixelCursor(x,y) will write to that non-display region.
+ * Max x,y = 2^13 i.e. 8192. <br>
+ */
+void Ra8876_Lite:: setPixelCursor(uint16_t x,uint16_t y,uint32_t lnOffset)
+{
+  //uint8_t bpp = getColorDepth();
+  //if(lnOffset > (uint32_t)(MEM_SIZE_MAX/(_canvasWidth*bpp)-1)) return;
+  //canvasImageStartAddress(lnOffset*_canvasWidth*bpp);
+  
+  int32_t _canvasAddress = canvasAddress_from_lnOffset(lnOffset);
+  if(_canvasAddress<0) return;
   canvasImageStartAddress(_canvasAddress);
   
   lcdRegDataWrite(RA8876_CURH0,x); //5fh
@@ -1861,6 +2639,175 @@ Color Ra8876_Lite::bfc_GetColorBasedPixel(uint8_t pixel, uint8_t bpp, Color src_
 	return des_color;
 }
 
+/**
+ * @brief	Pick a chroma key color that none of the pixel colors of a glyph can match.
+ * @param	bpp is the bit-per-pixel of the font
+ * @param	color is the font color
+ * @param	bg is the background color that antialiased pixels are blended with
+ * @return	Magenta, Cyan or Yellow, whichever is not produced by any pixel level in the current color mode
+ */
+Color Ra8876_Lite::bfc_ChromaKey(uint8_t bpp, Color color, Color bg)
+{
+	Color mask;
+	const Color keys[3] = {mask.Magenta, mask.Cyan, mask.Yellow};
+	uint16_t levels = 1<<bpp;
+	uint8_t key_bytes[3], pixel[3], pixel_bytes;
+	uint16_t v;
+	
+	for(uint8_t k=0; k<3; k++)
+	{
+		pixel_bytes = bfcp_ColorBytes(keys[k], key_bytes);
+		for(v=1; v<levels; v++)
+		{
+			bfcp_ColorBytes(bfc_GetColorBasedPixel(v, bpp, color, bg), pixel);
+			if(memcmp(key_bytes, pixel, pixel_bytes)==0)
+				break;
+		}
+		if(v == levels)
+			return keys[k];
+	}
+	
+	return keys[0];
+}
+
+/**
+ * @brief	Add the pixel of a glyph to a stream, sent to RA8876 whenever the buffer is nearly full.
+ * @param	*s is the stream, whose settings select how a level turns into bytes
+ * @param	level is the pixel value of the glyph, 0 for the background
+ * @note	RAM access has to be prepared by the caller. A packed 1bpp level takes 1 bit, others take pixel bytes
+ *			from the chroma key for level 0, from the palette, or blended from s->color and s->bg.
+ */
+void Ra8876_Lite::glyph_StreamLevel(GLYPH_STREAM *s, uint8_t level)
+{
+	if(s->expand)
+	{
+		s->bits = s->bits<<1 | level;
+		if(++s->nbits < 8)
+			return;
+		s->buf[s->n++] = s->bits;
+		s->nbits = 0;
+	}
+	else if(level == 0 && s->key)
+	{
+		memcpy(&s->buf[s->n], s->key, s->pixel_bytes);
+		s->n += s->pixel_bytes;
+	}
+	else if(s->palette)
+	{
+		memcpy(&s->buf[s->n], &s->palette[level*3], s->pixel_bytes);
+		s->n += s->pixel_bytes;
+	}
+	else
+		s->n += bfcp_ColorBytes(bfc_GetColorBasedPixel(level, s->bpp, s->color, s->bg), &s->buf[s->n]);
+	
+	if(s->n > sizeof(s->buf)-3)
+	{
+		hal_spi_write(s->buf, s->n);
+		s->n = 0;
+	}
+}
+
+/**
+ * @brief	End a row or column of a glyph stream.
+ * @param	*s is the stream
+ * @param	flush is true to send all bytes left at the end of the glyph
+ * @note	A BTE color expansion takes each line from bit 7, so the last byte of a packed line is padded.
+ */
+void Ra8876_Lite::glyph_StreamLineEnd(GLYPH_STREAM *s, bool flush)
+{
+	if(s->nbits)
+	{
+		s->buf[s->n++] = s->bits<<(8-s->nbits);
+		s->bits = 0;
+		s->nbits = 0;
+	}
+	if(flush || s->n > sizeof(s->buf)-3)
+	{
+		hal_spi_write(s->buf, s->n);
+		s->n = 0;
+	}
+}
+
+/**
+ * @brief	Draw a glyph of BitFontCreator format rotated by 90 degrees in counter clockwise direction as one block write.
+ * @param	x0, y0 are the coordinates of the glyph before rotation, transformed by rotateCcw90() as putPixel() would do
+ * @param	*pData points to row based pixel data of the glyph in MCU's memory
+ * @param	width, height are the glyph dimension in pixels before rotation
+ * @param	bpp is the bit-per-pixel of the font
+ * @param	bLittleEndian is true if the pixels of a byte are in little endian
+ * @param	color is the font color
+ * @param	bg is the background color
+ * @param	lnOffset is the Canvas Address offset in line number
+ * @note	With a solid background, Memory Access Control Register is switched to bottom->top, left->right writing
+ *			as putPicture() does. Glyph rows are then streamed in their natural order into an active window of the
+ *			rotated size and RA8876 turns each row into a column.<br>
+ *			BTE ignores the write direction of MACR. A glyph with a Transparent background is sent to a BTE MPU write
+ *			with chroma key instead, reading the glyph column by column from its right edge so that the pixels
+ *			arrive in the order of the rotated window.
+ */
+void Ra8876_Lite::bfc_DrawRotated(uint16_t x0, uint16_t y0, const uint8_t *pData, uint16_t width, uint16_t height, int bpp, bool bLittleEndian, Color color, Color bg, uint32_t lnOffset)
+{
+	uint16_t bytesPerLine = (width * bpp + 7) / 8;
+	uint16_t rx = x0+width-1, ry = y0;
+	uint16_t x, y;
+	uint8_t key_bytes[3], bit;
+	GLYPH_STREAM s;
+	Color mask;
+	
+	if(width == 0 || height == 0)
+		return;
+	
+	rotateCcw90(&rx, &ry);	//top left corner of the rotated glyph
+	s.bpp = bpp;
+	s.color = color;
+	s.bg = bg;
+	
+	if(bg != mask.Transparent)
+	{
+		uint8_t MACR = lcdRegDataRead(RA8876_MACR); //read REG[02h]
+		lcdRegDataWrite(RA8876_MACR, MACR|RA8876_WRITE_MEMORY_BTLR<<1);	///Change to bottom->top, left->right scanning
+		putPicture_set_frame(rx, ry, height, width, lnOffset);
+		
+		for(y=0; y<height; y++)
+		{
+			for(x=0; x<width; x++)
+			{
+				bit = bLittleEndian ? (8-bpp)-(x*bpp)%8 : (x*bpp)%8;
+				glyph_StreamLevel(&s, (uint8_t)(pData[y * bytesPerLine + (x * bpp) / 8]<<bit)>>(8-bpp));
+			}
+		}
+		glyph_StreamLineEnd(&s, true);
+		
+		lcdRegDataWrite(RA8876_MACR, MACR);	//restore left->right, top->bottom scanning
+		activeWindowXY(ACTIVE_WINDOW_STARTX,ACTIVE_WINDOW_STARTY);
+		activeWindowWH(_canvasWidth,_canvasHeight);
+	}
+	else
+	{
+		Color key = bfc_ChromaKey(bpp, color, bg);
+		s.pixel_bytes = bfcp_ColorBytes(key, key_bytes);
+		s.key = key_bytes;
+		
+		bte_DestinationMemoryStartAddr(canvasAddress_from_lnOffset(lnOffset));
+		bte_DestinationImageWidth(_canvasWidth);
+		bte_DestinationWindowStartXY(rx, ry);
+		bte_WindowSize(height, width);
+		setBackgroundColor(key);
+		lcdRegDataWrite(RA8876_BTE_CTRL1,RA8876_BTE_MPU_WRITE_WITH_CHROMA);//91h
+		lcdRegDataWrite(RA8876_BTE_CTRL0,RA8876_BTE_ENABLE<<4);//90h
+		ramAccessPrepare();
+		
+		for(x=width; x-- > 0;)
+		{
+			bit = bLittleEndian ? (8-bpp)-(x*bpp)%8 : (x*bpp)%8;
+			for(y=0; y<height; y++)
+				glyph_StreamLevel(&s, (uint8_t)(pData[y * bytesPerLine + (x * bpp) / 8]<<bit)>>(8-bpp));
+		}
+		glyph_StreamLineEnd(&s, true);
+		check2dBusy();
+	}
+}
+
 /*
  * @brief	This function decodes pixel data from MCU's Flash. Not prefered for small MCUs.
  */
@@ -1875,7 +2822,7 @@ int Ra8876_Lite::bfc_DrawChar_RowRowUnpacked(
 	)			
 {
 	// 1. find the character information first
-	const BFC_CHARINFO *pCharInfo = GetCharInfo(pFont, (unsigned short)ch);
+	const BFC_CHARINFO *pCharInfo = bfc_GetCharInfo(pFont, ch);
 	
 	if( pCharInfo != 0 )
 	{
@@ -1891,46 +2838,49 @@ int Ra8876_Lite::bfc_DrawChar_RowRowUnpacked(
 		uint16_t x, y, _x, _y, col;
 		unsigned char data, pixel, bit;
 		
-		// 2. draw all the pixels in this character
-		for(y=0; y<height; y++)
+		if(rotate_ccw90)
 		{
-			for(x=0; x<width; x++)
+			///Rotation by 90 degrees is done by RA8876 with a single block write per character
+			bfc_DrawRotated(x0, y0, pData, width, height, bpp, bLittleEndian, color, bg, lnOffset);
+		}
+		else
+		{
+			// 2. draw all the pixels in this character
+			for(y=0; y<height; y++)
 			{
-				col = (x * bpp) / 8;       // byte index in the line
-				data = pData[y * bytesPerLine + col];
+				for(x=0; x<width; x++)
+				{
+					col = (x * bpp) / 8;       // byte index in the line
+					data = pData[y * bytesPerLine + col];
 
-				// every BYTE (8 bits) data includes 8/bpp pixels,
-				// we need to get each pixel color index (0,1,2,3... based on bpp) from the BYTE data
-				pixel = data;
+					// every BYTE (8 bits) data includes 8/bpp pixels,
+					// we need to get each pixel color index (0,1,2,3... based on bpp) from the BYTE data
+					pixel = data;
 				
-				// bit index in the BYTE
-				// For 1-bpp: bit =  x % 8 (Big Endian),   7 -  x % 8 (Little Endian)
-				// For 2-bpp: bit = 2x % 8 (Big Endian),   6 - 2x % 8 (Little Endian)
-				// For 4-bpp: bit = 4x % 8 (Big Endian),   4 - 4x % 8 (Little Endian)
-				bit = bLittleEndian ? (8-bpp)-(x*bpp)%8 : (x*bpp)%8;
-
-				pixel = pixel<<bit;               // clear left pixels
-				pixel = pixel>>(8/bpp-1)*bpp;     // clear right pixels
+					// bit index in the BYTE
+					// For 1-bpp: bit =  x % 8 (Big Endian),   7 -  x % 8 (Little Endian)
+					// For 2-bpp: bit = 2x % 8 (Big Endian),   6 - 2x % 8 (Little Endian)
+					// For 4-bpp: bit = 4x % 8 (Big Endian),   4 - 4x % 8 (Little Endian)
+					bit = bLittleEndian ? (8-bpp)-(x*bpp)%8 : (x*bpp)%8;
+
+					pixel = pixel<<bit;               // clear left pixels
+					pixel = pixel>>(8/bpp-1)*bpp;     // clear right pixels
 				
-				Color des_color = bfc_GetColorBasedPixel(pixel, bpp, color, bg);			
+					Color des_color = bfc_GetColorBasedPixel(pixel, bpp, color, bg);			
 				
-				_x = x0+x, 
-				_y = y0+y;
+					_x = x0+x, 
+					_y = y0+y;
 					
-				///Rotation by 90 degrees requires transformation by software.
-				///Mirror image or 180 degrees rotation can be done by RA8876 hardware.
-				if(rotate_ccw90)
-					rotateCcw90(&_x, &_y);
-				
-				if(pixel) 
-				{
-					Ra8876_Lite::putPixel(_x, _y, des_color, lnOffset);
-				}
-				else
-				{
-					sf::Color _color;
-					if(bg!=_color.Transparent){
-						Ra8876_Lite::putPixel(_x, _y, bg, lnOffset);
+					if(pixel) 
+					{
+						Ra8876_Lite::putPixel(_x, _y, des_color, lnOffset);
+					}
+					else
+					{
+						sf::Color _color;
+						if(bg!=_color.Transparent){
+							Ra8876_Lite::putPixel(_x, _y, bg, lnOffset);
+						}
 					}
 				}
 			}
@@ -1945,104 +2895,298 @@ int Ra8876_Lite::bfc_DrawChar_RowRowUnpacked(
 }	
 
 /**
- * @brief	This function decodes pixel data in row-based from a *.bin file stored in SD Card. The binary file 
- *			created by BinFontCreator.
- * @note	Known bug: When this function is repeatly called, SD.open(pFilename) sometimes fail even if the file exists.
- *			It is advised to copy all font data to SDRAM prior to main loop or move binary data to external serial Flash.
+ * @brief	Return BFC_CHARINFO of a character from a C font by binary search on a range index.
+ * @param	*pFont is a pointer to BFC_FONT in MCU's Flash
+ * @param	ch is the character in Unicode
+ * @return	Pointer to BFC_CHARINFO, or 0 if pFont is not valid
+ * @note	The index is built once when a different font is passed in, so a long string costs one index build
+ *			followed by O(log n) lookups for n character ranges instead of a linked list walk per character.<br>
+ *			A font with more than BFC_INDEX_MAX_RANGES ranges falls back to GetCharInfo(). The failure is kept as
+ *			pKey = pFont with NumRanges = 0, so the index is not built again for every character of that font.
  */
-#if defined (LOAD_SD_LIBRARY)
-int Ra8876_Lite::bfc_DrawChar_RowRowUnpacked(	
-	uint16_t x0, uint16_t y0, 	//coordinates to draw a character
-	const char* pFilename, 		//filename pointer
-	uint16_t ch, 					//character to draw
-	Color color, 				//color to draw
-	Color bg, 					//background
-	bool rotate_ccw90,
-	uint32_t lnOffset
-	)
+const BFC_CHARINFO* Ra8876_Lite::bfc_GetCharInfo(const BFC_FONT *pFont, uint16_t ch)
 {
-	File fontFile = SD.open(pFilename);
-	
-	if(!fontFile) {
-		printf("No such file exist!\n");
+	if(pFont == 0)
 		return 0;
-		}
-	else
+	
+	if(_bfcIndex.pKey != pFont)
 	{
-		//printf("File open OK.\n");	
-	}		
+		if(BuildFontIndex(pFont, &_bfcIndex) < 0)
+			_bfcIndex.pKey = pFont;	//NumRanges = 0, not indexed
+	}
+	
+	if(_bfcIndex.NumRanges == 0)
+		return GetCharInfo(pFont, (unsigned short)ch);
 	
-	uint8_t buf[12];	
-	BFC_BIN_FONT bfcBinFont;
-	
-	//(1) Read 12 bytes from Bin file beginning for BFC_BIN_FONT first 
-	fontFile.read((uint8_t *)buf, 12);	
-	bfcBinFont.FontType = (uint32_t)buf[0]|(uint32_t)buf[1]<<8|(uint32_t)buf[2]<<16|(uint32_t)buf[3]<<24;
-	//printf("Bin FontType = %X\n", bfcBinFont.FontType);	
-	uint16_t height = bfcBinFont.FontHeight = (uint16_t)buf[4]|(uint16_t)buf[5]<<8;
-	//printf("Bin FontHeight = %d\n", bfcBinFont.FontHeight);	
-	bfcBinFont.Baseline = (uint16_t)buf[6]|(uint16_t)buf[7]<<8;
-	//printf("Bin Baseline = %d\n", bfcBinFont.Baseline);
-	bfcBinFont.Reversed = (uint16_t)buf[8]|(uint16_t)buf[9]<<8;
-	//printf("Bin Reversed = %d\n", bfcBinFont.Reversed);
-	bfcBinFont.NumRanges = (uint16_t)buf[10]|(uint16_t)buf[11]<<8;
-	//printf("Bin NumRanges = %d\n", bfcBinFont.NumRanges);
+	return GetCharInfoIndexed(&_bfcIndex, (unsigned short)ch);
+}
+
+#if defined (LOAD_SD_LIBRARY)
+/**
+ * @brief	Load font header and character ranges of a *.bin file into _bfcBinIndex.
+ * @param	&fontFile is an opened *.bin file
+ * @param	*pFilename is the filename of fontFile, used as the key of the index
+ * @return	true if the index is ready for bfc_BinCharInfoRead(), false if the file is not a valid font
+ * @note	Nothing is read from the file if the index has been built for the same filename before.<br>
+ *			A font with more than BFC_INDEX_MAX_RANGES ranges keeps its header only (NumRanges = 0),
+ *			then bfc_BinCharInfoRead() scans the range table from the file instead.
+ */
+bool Ra8876_Lite::bfc_BinIndexLoad(File &fontFile, const char *pFilename)
+{
+	if(_bfcBinIndex.pKey != 0 && strcmp(_bfcBinName, pFilename)==0)
+		return true;
+	
+	uint8_t buf[12];
+	uint16_t chNumRanges;
+	uint32_t infoIndex = 0;
+	
+	_bfcBinIndex.pKey = 0;
+	_bfcBinIndex.NumRanges = 0;
+	_bfcBinIndex.LastHit = 0;
+	_bfcAdvanceFont = BFC_ADVANCE_CACHE_FONTS;	//no advance width cache until the font is valid
+	
+	if(!fontFile.seek(0) || fontFile.read((uint8_t *)buf, 12)!=12)
+		return false;
+	
+	_bfcBinIndex.FontType   = (uint32_t)buf[0]|(uint32_t)buf[1]<<8|(uint32_t)buf[2]<<16|(uint32_t)buf[3]<<24;
+	_bfcBinIndex.FontHeight = (uint16_t)buf[4]|(uint16_t)buf[5]<<8;
+	_bfcBinIndex.Baseline   = (uint16_t)buf[6]|(uint16_t)buf[7]<<8;
+	chNumRanges             = (uint16_t)buf[10]|(uint16_t)buf[11]<<8;
 	
 	//NumRanges should be >= 1. This is the number of character-range.
-	if(!bfcBinFont.NumRanges) 
+	if(!chNumRanges)
+		return false;
+	
+	if(chNumRanges <= BFC_INDEX_MAX_RANGES)
 	{
-		fontFile.close();
-		return 0;	
+		for(uint16_t i=0; i<chNumRanges; i++)
+		{
+			if(fontFile.read((uint8_t *)buf, 4)!=4)
+				return false;
+			_bfcBinIndex.Ranges[i].FirstChar = (uint16_t)buf[0]|(uint16_t)buf[1]<<8;
+			_bfcBinIndex.Ranges[i].LastChar  = (uint16_t)buf[2]|(uint16_t)buf[3]<<8;
+			_bfcBinIndex.Ranges[i].u.InfoIndex = infoIndex;
+			infoIndex += (_bfcBinIndex.Ranges[i].LastChar-_bfcBinIndex.Ranges[i].FirstChar+1);
+		}
+		_bfcBinIndex.NumRanges = chNumRanges;
+		SortFontIndex(&_bfcBinIndex);
+	}
+	
+	//Cache the index only if the filename fits, otherwise it is used for this call only
+	if(strlen(pFilename) < BFC_BIN_NAME_MAX)
+	{
+		strcpy(_bfcBinName, pFilename);
+		_bfcBinIndex.pKey = _bfcBinName;
+		bfc_AdvanceCacheSelect(pFilename);
 	}
 	
-	//(2) Now we know the number of character ranges by chNumRanges below.
-	//Need to find out the location of "ch" from these character ranges.
-	uint16_t chNumRanges = bfcBinFont.NumRanges;
-	uint16_t charInfo_array_index = 0;
-	uint32_t addressOffset = (uint32_t)0x0c + (4L*(uint32_t)chNumRanges);	//this is the physical address of "ch", one NumRanges occupies 4 bytes that's why 4*chNumRanges
+	return true;
+}
 
-	BFC_BIN_CHARRANGE fontxxx_Prop[chNumRanges];
+/**
+ * @brief	Read BFC_BIN_CHARINFO of a character from a *.bin file.
+ * @param	&fontFile is an opened *.bin file with its index loaded by bfc_BinIndexLoad()
+ * @param	ch is the character in Unicode
+ * @param	*pInfo points to the structure to fill
+ * @return	true if successful
+ * @note	If "ch" is not rendered in this font, the first character in this font is used as the default one.
+ */
+bool Ra8876_Lite::bfc_BinCharInfoRead(File &fontFile, uint16_t ch, BFC_BIN_CHARINFO *pInfo)
+{
+	uint8_t buf[8];
+	uint16_t chNumRanges = _bfcBinIndex.NumRanges;
+	uint32_t infoIndex = 0;
 	
-	for(uint16_t i=0; i<chNumRanges; i++)
+	if(chNumRanges)
+	{
+		int i = FindCharRange(&_bfcBinIndex, (unsigned short)ch);
+		if(i >= 0)
+			infoIndex = _bfcBinIndex.Ranges[i].u.InfoIndex + (uint32_t)(ch-_bfcBinIndex.Ranges[i].FirstChar);
+	}
+	else
 	{
-		fontFile.read((uint8_t *)buf, 4);
-		fontxxx_Prop[i].FirstChar = (uint16_t)buf[0]|(uint16_t)buf[1]<<8;
-		fontxxx_Prop[i].LastChar  = (uint16_t)buf[2]|(uint16_t)buf[3]<<8;
+		//Too many ranges to index, scan the table of BFC_BIN_CHARRANGE from the file until ch is in range
+		if(!fontFile.seek(10) || fontFile.read((uint8_t *)buf, 2)!=2)
+			return false;
+		chNumRanges = (uint16_t)buf[0]|(uint16_t)buf[1]<<8;
 		
-		//scan it from the beginning of BFC_BIN_CHARINFO fontxxx_CharInfo[] array until ch is in range
-		if(ch >= fontxxx_Prop[i].FirstChar && ch <= fontxxx_Prop[i].LastChar)
+		uint32_t index = 0;
+		for(uint16_t i=0; i<chNumRanges; i++)
 		{
-			//the character "ch" is inside this ranage
-			addressOffset += (uint32_t)(charInfo_array_index*8L);
-			addressOffset += (uint32_t)(ch-fontxxx_Prop[i].FirstChar)*8L;
-			//printf("Address offset of char 'ch' = 0x%X\n", addressOffset);
-			//printf("ch index = %d\n", charInfo_array_index);
-			break;	//break the loop once it has been found!
-		}
-		else
-		{			
-			charInfo_array_index += (fontxxx_Prop[i].LastChar-fontxxx_Prop[i].FirstChar+1);
+			if(fontFile.read((uint8_t *)buf, 4)!=4)
+				return false;
+			uint16_t first = (uint16_t)buf[0]|(uint16_t)buf[1]<<8;
+			uint16_t last  = (uint16_t)buf[2]|(uint16_t)buf[3]<<8;
+			if(ch >= first && ch <= last)
+			{
+				infoIndex = index + (uint32_t)(ch-first);
+				break;
+			}
+			index += (last-first+1);
 		}
 	}
 	
-	//(3) The variable <addressOffset> is the physical address of BFC_BIN_CHARINFO.
-	// If it is a valid address, we may now read 8 bytes for BFC_BIN_CHARINFO structure in which
-	// the character width, data size, and physical address can be read.
-	if(!fontFile.seek(addressOffset)) //seek physical address of ch's BFC_BIN_CHARINFO
+	//physical address of BFC_BIN_CHARINFO, one NumRanges occupies 4 bytes and one BFC_BIN_CHARINFO occupies 8 bytes
+	uint32_t addressOffset = (uint32_t)0x0c + (4L*(uint32_t)chNumRanges) + 8L*infoIndex;
+	
+	if(!fontFile.seek(addressOffset) || fontFile.read((uint8_t *)buf, 8)!=8)
+		return false;
+	
+	pInfo->Width    = (uint16_t)buf[0]|(uint16_t)buf[1]<<8;
+	pInfo->DataSize = (uint16_t)buf[2]|(uint16_t)buf[3]<<8;
+	pInfo->OffData  = (uint32_t)buf[4]|(uint32_t)buf[5]<<8|(uint32_t)buf[6]<<16|(uint32_t)buf[7]<<24;
+	
+	return true;
+}
+
+/**
+ * @brief	Invalidate the advance width caches of all *.bin fonts.
+ */
+void Ra8876_Lite::bfc_AdvanceCacheReset(void)
+{
+	for(uint8_t f=0; f<BFC_ADVANCE_CACHE_FONTS; f++)
 	{
-		printf("Address of \"ch\" is not valid!\n");
-		fontFile.close();
-		return 0;
+		_bfcAdvanceName[f][0] = '\0';
+		for(uint16_t i=0; i<BFC_ADVANCE_CACHE_SIZE; i++)
+		{
+			_bfcAdvanceCache[f][i].ch = 0xFFFF;	//U+FFFF is a noncharacter
+			_bfcAdvanceCache[f][i].advance = 0;
+		}
 	}
+	_bfcAdvanceFont = BFC_ADVANCE_CACHE_FONTS;
+	_bfcAdvanceNext = 0;
+}
 
-	fontFile.read((uint8_t*)buf, 8);	//read BFC_BIN_CHARINFO at physical address of "ch"
-	
-	BFC_BIN_CHARINFO bfcBinFont_info;
+/**
+ * @brief	Select the advance width cache of a *.bin font, taking the oldest one for a font not seen before.
+ * @param	*pFilename is the filename of the font, shorter than BFC_BIN_NAME_MAX
+ * @note	Widths measured before are kept when text switches between up to BFC_ADVANCE_CACHE_FONTS fonts.
+ */
+void Ra8876_Lite::bfc_AdvanceCacheSelect(const char *pFilename)
+{
+	uint8_t f;
 	
-	uint16_t width = bfcBinFont_info.Width = (uint16_t)buf[0]|(uint16_t)buf[1]<<8;
-	//uint16_t data_size = bfcBinFont_info.DataSize = (uint16_t)buf[2]|(uint16_t)buf[3]<<8;
+	for(f=0; f<BFC_ADVANCE_CACHE_FONTS; f++)
+	{
+		if(strcmp(_bfcAdvanceName[f], pFilename)==0)
+		{
+			_bfcAdvanceFont = f;
+			return;
+		}
+	}
+	
+	f = _bfcAdvanceNext;
+	_bfcAdvanceNext = (f+1) % BFC_ADVANCE_CACHE_FONTS;
+	strcpy(_bfcAdvanceName[f], pFilename);
+	for(uint16_t i=0; i<BFC_ADVANCE_CACHE_SIZE; i++)
+		_bfcAdvanceCache[f][i].ch = 0xFFFF;
+	_bfcAdvanceFont = f;
+}
+
+/**
+ * @brief	Return advance width of a character from a *.bin file.
+ * @param	&fontFile is an opened *.bin file with its index loaded by bfc_BinIndexLoad()
+ * @param	ch is the character in Unicode
+ * @return	Character width in pixels, 0 if not valid
+ * @note	Widths are kept in a direct-mapped cache of BFC_ADVANCE_CACHE_SIZE entries for each of the last
+ *			BFC_ADVANCE_CACHE_FONTS fonts, so that measuring the same characters again does not seek and read the
+ *			SD card, even after another font has been used. A font whose filename is too long is not cached.
+ */
+uint16_t Ra8876_Lite::bfc_BinCharWidth(File &fontFile, uint16_t ch)
+{
+	BFC_GLYPH *pEntry = 0;
+	BFC_BIN_CHARINFO bfcBinFont_info;
+	
+	if(_bfcAdvanceFont < BFC_ADVANCE_CACHE_FONTS)
+	{
+		pEntry = &_bfcAdvanceCache[_bfcAdvanceFont][ch & (BFC_ADVANCE_CACHE_SIZE-1)];
+		if(pEntry->ch == ch)
+			return pEntry->advance;
+	}
+	
+	if(!bfc_BinCharInfoRead(fontFile, ch, &bfcBinFont_info))
+		return 0;
+	
+	if(pEntry)
+	{
+		pEntry->ch = ch;
+		pEntry->advance = bfcBinFont_info.Width;
+	}
+	
+	return bfcBinFont_info.Width;
+}
+#endif	//#if defined (LOAD_SD_LIBRARY)
+
+/**
+ * @brief	This function decodes pixel data in row-based from a *.bin file stored in SD Card. The binary file 
+ *			created by BinFontCreator.
+ * @note	Known bug: When this function is repeatly called, SD.open(pFilename) sometimes fail even if the file exists.
+ *			It is advised to copy all font data to SDRAM prior to main loop or move binary data to external serial Flash.
+ */
+#if defined (LOAD_SD_LIBRARY)
+int Ra8876_Lite::bfc_DrawChar_RowRowUnpacked(	
+	uint16_t x0, uint16_t y0, 	//coordinates to draw a character
+	const char* pFilename, 		//filename pointer
+	uint16_t ch, 					//character to draw
+	Color color, 				//color to draw
+	Color bg, 					//background
+	bool rotate_ccw90,
+	uint32_t lnOffset
+	)
+{
+	File fontFile = SD.open(pFilename);
+	
+	if(!fontFile) {
+		printf("No such file exist!\n");
+		return 0;
+		}
+	else
+	{
+		//printf("File open OK.\n");	
+	}		
+	
+	//(1) Font header and the table of character ranges are read once per font into _bfcBinIndex.
+	//Subsequent calls with the same filename skip this step.
+	int width = 0;
+	
+	if(bfc_BinIndexLoad(fontFile, pFilename))
+		width = bfc_DrawChar_RowRowUnpacked(x0, y0, fontFile, ch, color, bg, rotate_ccw90, lnOffset);
+	
+	//(6) Finally close the file 
+	fontFile.close();	
+	//printf("File closed.\n");	
+	return width;
+}
+
+/**
+ * @brief	This function decodes pixel data in row-based from an opened *.bin file with its index loaded by bfc_BinIndexLoad().
+ * @note	Useful to draw several characters with a single SD.open(), e.g. in drawBfcLayout().
+ */
+int Ra8876_Lite::bfc_DrawChar_RowRowUnpacked(	
+	uint16_t x0, uint16_t y0, 	//coordinates to draw a character
+	File &fontFile, 			//opened font file
+	uint16_t ch, 				//character to draw
+	Color color, 				//color to draw
+	Color bg, 					//background
+	bool rotate_ccw90,
+	uint32_t lnOffset
+	)
+{
+	uint16_t height = _bfcBinIndex.FontHeight;
+	
+	//(2) Binary search "ch" from the index to get the physical address of its BFC_BIN_CHARINFO, then
+	//(3) read 8 bytes for BFC_BIN_CHARINFO structure in which the character width, data size, and physical address can be read.
+	BFC_BIN_CHARINFO bfcBinFont_info;
+	
+	if(!bfc_BinCharInfoRead(fontFile, ch, &bfcBinFont_info))
+	{
+		printf("Address of \"ch\" is not valid!\n");
+		return 0;
+	}
+	
+	uint16_t width = bfcBinFont_info.Width;
 	//bfcBinFont_info.OffData is the physical address of pixel data
-	uint32_t data_address = bfcBinFont_info.OffData = (uint32_t)buf[4]|(uint32_t)buf[5]<<8|(uint32_t)buf[6]<<16|(uint32_t)buf[7]<<24;	
+	uint32_t data_address = bfcBinFont_info.OffData;
 	//printf("BFC_BIN_CHARINFO : width = %d, size = %d, address = 0x%X\n", bfcBinFont_info.Width, bfcBinFont_info.DataSize, bfcBinFont_info.OffData);
 	/*	
 	//This is no good for small mcu as data_size can be very big. Instead, we read pixels from SD Card one-by-one and plot them each
@@ -2066,13 +3210,44 @@ int Ra8876_Lite::bfc_DrawChar_RowRowUnpacked(
 	*/
 	//(5) Now we have everything required to render a single character from a bin file. 
 	// The final step is to draw each pixel with data fetched from SD card with fontFile.read();
-	int bpp = GetFontBpp(bfcBinFont.FontType);
+	int bpp = GetFontBpp(_bfcBinIndex.FontType);
 	uint16_t bytesPerLine = (width * bpp + 7)/8;
-	int bLittleEndian = (GetFontEndian(bfcBinFont.FontType)==1);
+	int bLittleEndian = (GetFontEndian(_bfcBinIndex.FontType)==1);
 	
 	uint16_t x, y, _x, _y, col;
 	unsigned char pixel, bit;
 	
+	if(rotate_ccw90 && bytesPerLine <= BFC_BIN_GLYPH_BUFFER_SIZE)
+	{
+		///Rotation by 90 degrees is done by RA8876 with one block write per band of rows, the glyph is read from
+		///the file with one seek in bands of BFC_BIN_GLYPH_BUFFER_SIZE bytes instead of one seek per pixel
+		static uint8_t glyph[BFC_BIN_GLYPH_BUFFER_SIZE];
+		uint16_t band = BFC_BIN_GLYPH_BUFFER_SIZE/bytesPerLine;
+		
+		if(!fontFile.seek(data_address))
+		{
+			printf("Data of \"ch\" is not valid!\n");
+			return 0;
+		}
+		for(y=0; y<height; y+=band)
+		{
+			uint16_t rows = (height-y < band) ? height-y : band;
+			uint16_t size = rows*bytesPerLine;
+			
+			if(fontFile.read(glyph, size)!=size)
+			{
+				printf("Data of \"ch\" is not valid!\n");
+				return 0;
+			}
+			bfc_DrawRotated(x0, y0+y, glyph, width, rows, bpp, bLittleEndian, color, bg, lnOffset);
+		}
+		
+		if(lnOffset!=CANVAS_OFFSET)
+			canvasImageStartAddress(CANVAS_OFFSET);
+		
+		return width;
+	}
+	
 	for(y=0; y<height; y++)
 	{
 		for(x=0; x<width; x++)
@@ -2088,8 +3263,7 @@ int Ra8876_Lite::bfc_DrawChar_RowRowUnpacked(
 			Color des_color = bfc_GetColorBasedPixel(pixel, bpp, color, bg);		
 			_x=x0+x, 
 			_y=y0+y;				
-			///Rotation by 90 degrees requires transformation by software.
-			///Mirror image or 180 degrees rotation can be done by RA8876 hardware.
+			///Rotation by software for a row wider than BFC_BIN_GLYPH_BUFFER_SIZE
 			if(rotate_ccw90)
 				rotateCcw90(&_x, &_y);
 				
@@ -2110,9 +3284,6 @@ int Ra8876_Lite::bfc_DrawChar_RowRowUnpacked(
 	if(lnOffset!=CANVAS_OFFSET)
 		canvasImageStartAddress(CANVAS_OFFSET);	
 	
-	//(6) Finally close the file 
-	fontFile.close();	
-	//printf("File closed.\n");	
 	return width;
 }
 #endif	//#if defined (LOAD_SD_LIBRARY)
@@ -2371,12 +3542,15 @@ bool rotate_ccw90)
  * @param	x0 is the x-coordinate of top left corner
  * @param	y0 is the y-coordinate of top left corner
  * @param	*pFont is a pointer to BFC_FONT in MCU's Flash
- * @param	*str is a pointer to a string of ASCII
+ * @param	*str is a pointer to a string in UTF-8. ASCII is a subset of UTF-8.
  * @param	color is the font color
  * @param	bg is the background color
  * @param	rotate_ccw90 is a boolean flag to rotate the string in counter clockwise 90 degrees
  * @return	width of string to draw
- * @note	Example to use <br>
+ * @note	Code points are decoded on the fly with utf8DecodeBmp() and go straight into glyph lookup,
+ *			no conversion to a 2-byte array is required. A byte that is not part of a valid UTF-8 sequence
+ *			is taken as an ISO 8859-1 character.<br>
+ *			Example to use <br>
  *			//...
  *			extern const BFC_FONT fontLucida_Sans_Unicode16h_rowrowBig;
  *			
@@ -2395,16 +3569,15 @@ uint32_t lnOffset)
 	int x = x0;
 	int y = y0;
 	int width = 0;
-	char ch = 0;
+	uint16_t ch = 0;
 
 	if( pFont == 0 || str == 0 )
 		return 0;
 
 	while(*str != '\0')
 	{
-		ch = *str;
+		ch = utf8DecodeBmp(&str);
 		width = putBfcChar(x, y, pFont, ch, color, bg, rotate_ccw90, lnOffset);
-		str++;
 		x += width;
 	}  
 	return (uint16_t)(x-x0);
@@ -2463,7 +3636,7 @@ uint32_t lnOffset)
  * @param	x0 is the x-coordinate of top left corner
  * @param	y0 is the y-coordinate of top left corner
  * @param	*pFilename is a pointer to the binary file name
- * @param	*str is a pointer to a string of ASCII, 1 byte font
+ * @param	*str is a pointer to a string in UTF-8, decoded on the fly with utf8DecodeBmp()
  * @param	color is the font color
  * @param	bg is the background color
  * @param	rotate_ccw90 is a boolean flag to rotate the string in counter clockwise 90 degrees
@@ -2487,16 +3660,15 @@ uint32_t lnOffset)
 	int x = x0;
 	int y = y0;
 	int width = 0;
-	char ch = 0;
+	uint16_t ch = 0;
 	
 	if( pFilename == 0 || str == 0 )
 		return 0;
 
 	while(*str != '\0')
 	{
-		ch = *str;
+		ch = utf8DecodeBmp(&str);
 		width = putBfcChar(x, y, pFilename, ch, color, bg, rotate_ccw90, lnOffset);
-		str++;
 		//width = putBfcChar(x, y, pFilename, *str++, color, bg, rotate_ccw90, lnOffset);
 		x += width;
 	}  
@@ -2551,9 +3723,9 @@ uint32_t lnOffset)
 #endif
 
 /**
- * @brief	This function returns ASCII string width in pixels
+ * @brief	This function returns UTF-8 string width in pixels
  * @param	*pFont is a pointer to BFC_FONT in MCU's Flash
- * @param	*str points to a string of ASCII
+ * @param	*str points to a string in UTF-8
  * @return	String width in pixels
  */
 uint16_t Ra8876_Lite::getBfcStringWidth(const BFC_FONT *pFont, const char *str)
@@ -2561,16 +3733,14 @@ uint16_t Ra8876_Lite::getBfcStringWidth(const BFC_FONT *pFont, const char *str)
 	uint16_t width=0;
 	
 	const BFC_CHARINFO *pCharInfo;
-	char ch=0;
+	uint16_t ch=0;
 	
 	while(*str != '\0')
 	{
-		ch = *str;
-		pCharInfo = GetCharInfo(pFont, ch);
+		ch = utf8DecodeBmp(&str);
+		pCharInfo = bfc_GetCharInfo(pFont, ch);
 		if(pCharInfo !=0)
 			width += pCharInfo->Width;
-		
-		str++;
 	}
 	
 	return width;	
@@ -2592,7 +3762,7 @@ uint16_t Ra8876_Lite::getBfcStringWidth(const BFC_FONT *pFont, const uint16_t *s
 	while(*str != '\0')
 	{
 		ch = *str;
-		pCharInfo = GetCharInfo(pFont, ch);
+		pCharInfo = bfc_GetCharInfo(pFont, ch);
 		if(pCharInfo !=0)
 			width += pCharInfo->Width;
 		
@@ -2614,6 +3784,130 @@ uint16_t Ra8876_Lite::getBfcFontHeight(const BFC_FONT *pFont)
 	return ((uint16_t)fontHeight);
 }
 
+/**
+ * @brief	Draw a UTF-8 string from a *.c font into an image anywhere in SDRAM, clipped to a rectangle.
+ * @param	des_addr is the physical address of the destination image
+ * @param	des_image_width is the width of the destination image in pixels
+ * @param	x0, y0 are the coordinates of the top left corner of the string, they may be negative or outside the clip rectangle
+ * @param	clip_x1, clip_y1 are the top left corner of the clip rectangle (inclusive)
+ * @param	clip_x2, clip_y2 are the bottom right corner of the clip rectangle (inclusive)
+ * @param	*pFont is a pointer to BFC_FONT in MCU's Flash
+ * @param	*str is a UTF-8 string
+ * @param	color is the font color
+ * @param	bg is the background color, or Transparent to keep the image underneath
+ * @return	Width of the string in pixels, clipped or not
+ * @note	Nothing is drawn with putPixel(). A solid background is filled by one BTE Solid Fill for the visible part of
+ *			the string box. Each character then goes into one BTE window trimmed to the clip rectangle:<br>
+ *			(1) 1bpp fonts are packed into a BTE MPU write with color expansion and chroma key, 1 bit per pixel.
+ *			The window width is rounded up to 8 pixels as in bfcp_DrawGlyphRotated(), the padding is dropped by chroma key.<br>
+ *			(2) Antialiased fonts are sent as pixels through a BTE MPU write with chroma key.<br>
+ *			The destination does not need to be the canvas, so text can be composed off-screen and shown with one
+ *			memory copy. Allegro textout_ex() is built on this function.
+ */
+uint16_t Ra8876_Lite::bteBfcString(uint32_t des_addr, uint16_t des_image_width, int16_t x0, int16_t y0,
+								   uint16_t clip_x1, uint16_t clip_y1, uint16_t clip_x2, uint16_t clip_y2,
+								   const BFC_FONT *pFont, const char *str, Color color, Color bg)
+{
+	int16_t x = x0;
+	int16_t top, bottom, left, right;
+	uint8_t key_bytes[3], bit;
+	GLYPH_STREAM s;
+	Color mask;
+	
+	if(pFont == 0 || str == 0)
+		return 0;
+	
+	int bpp = GetFontBpp(pFont->FontType);
+	int bLittleEndian = (GetFontEndian(pFont->FontType)==1);
+	int16_t height = pFont->FontHeight;
+	
+	//rows of the string box inside the clip rectangle, the same for all characters
+	top    = (y0 > (int16_t)clip_y1) ? y0 : (int16_t)clip_y1;
+	bottom = (y0+height-1 < (int16_t)clip_y2) ? y0+height-1 : (int16_t)clip_y2;
+	
+	if(bg != mask.Transparent && top <= bottom)
+	{
+		int16_t width = (int16_t)getBfcStringWidth(pFont, str);
+		left  = (x0 > (int16_t)clip_x1) ? x0 : (int16_t)clip_x1;
+		right = (x0+width-1 < (int16_t)clip_x2) ? x0+width-1 : (int16_t)clip_x2;
+		if(left <= right)
+		{
+			bte_DestinationMemoryStartAddr(des_addr);
+			bte_DestinationImageWidth(des_image_width);
+			bte_DestinationWindowStartXY(left, top);
+			bte_WindowSize(right-left+1, bottom-top+1);
+			setForegroundColor(bg);
+			lcdRegDataWrite(RA8876_BTE_CTRL1,RA8876_BTE_SOLID_FILL);//91h 
+			lcdRegDataWrite(RA8876_BTE_CTRL0,RA8876_BTE_ENABLE<<4);//90h
+			check2dBusy(); 
+		}
+	}
+	
+	Color key = bfc_ChromaKey(bpp, color, bg);
+	s.pixel_bytes = bfcp_ColorBytes(key, key_bytes);
+	s.key = key_bytes;
+	s.color = color;
+	s.bg = bg;
+	s.bpp = bpp;
+	s.expand = (bpp == 1);
+	setForegroundColor(color);
+	setBackgroundColor(key);
+	
+	while(*str != '\0')
+	{
+		uint16_t ch = utf8DecodeBmp(&str);
+		const BFC_CHARINFO *pCharInfo = bfc_GetCharInfo(pFont, ch);
+		
+		if(pCharInfo == 0)
+			continue;
+		
+		int16_t width = pCharInfo->Width;
+		int16_t bytesPerLine = (width * bpp + 7) / 8;
+		const uint8_t *pData = pCharInfo->p.pData8;
+		
+		left  = (x > (int16_t)clip_x1) ? x : (int16_t)clip_x1;
+		right = (x+width-1 < (int16_t)clip_x2) ? x+width-1 : (int16_t)clip_x2;
+		
+		if(left <= right && top <= bottom)
+		{
+			bte_DestinationMemoryStartAddr(des_addr);
+			bte_DestinationImageWidth(des_image_width);
+			bte_DestinationWindowStartXY(left, top);
+			if(bpp == 1)
+			{
+				//window rounded up to 8 pixels as the padded rows, the padding is dropped by chroma key
+				bte_WindowSize((right-left+1+7)&~7, bottom-top+1);
+				lcdRegDataWrite(RA8876_BTE_CTRL1,RA8876_BTE_ROP_BUS_WIDTH8<<4|RA8876_BTE_MPU_WRITE_COLOR_EXPANSION_WITH_CHROMA);//91h
+			}
+			else
+			{
+				bte_WindowSize(right-left+1, bottom-top+1);
+				lcdRegDataWrite(RA8876_BTE_CTRL1,RA8876_BTE_MPU_WRITE_WITH_CHROMA);//91h
+			}
+			lcdRegDataWrite(RA8876_BTE_CTRL0,RA8876_BTE_ENABLE<<4);//90h
+			ramAccessPrepare();
+			
+			for(int16_t y=top-y0; y<=bottom-y0; y++)
+			{
+				const uint8_t *pRow = pData + y*bytesPerLine;
+				
+				for(int16_t sx=left-x; sx<=right-x; sx++)
+				{
+					bit = bLittleEndian ? (8-bpp)-(sx*bpp)%8 : (sx*bpp)%8;
+					glyph_StreamLevel(&s, (uint8_t)(pRow[(sx*bpp)/8]<<bit)>>(8-bpp));
+				}
+				glyph_StreamLineEnd(&s, false);
+			}
+			glyph_StreamLineEnd(&s, true);
+			check2dBusy();
+		}
+		
+		x += width;
+	}
+	
+	return (uint16_t)(x-x0);
+}
+
 
 #if defined (LOAD_SD_LIBRARY)
 /**
@@ -2628,67 +3922,41 @@ uint16_t Ra8876_Lite::getBfcCharWidth(const char *pFilename, const uint16_t ch)
 	
 	if(!fontFile) return 0;
 	
-	uint8_t buf[12];
-	BFC_BIN_FONT bfcBinFont;
-	//Read header of 12 bytes from the binary file for BFC_BIN_FONT
-	fontFile.read((uint8_t *)buf, 12);	
-	uint16_t chNumRanges = bfcBinFont.NumRanges = (uint16_t)buf[10]|(uint16_t)buf[11]<<8;
-	if(!chNumRanges) return 0;	//NumRanges should be >= 1. This is the number of character-range.
-
-	uint32_t addressOffset = (uint32_t)0x0c + (4L*(uint32_t)chNumRanges);	//this is the physical address of "ch", one NumRanges occupies 4 bytes that's why 4*chNumRanges
-	uint16_t charInfo_array_index = 0;
-	BFC_BIN_CHARRANGE fontxxx_Prop[chNumRanges];
-	for(uint16_t i=0; i<chNumRanges; i++)
-	{
-		fontFile.read((uint8_t *)buf, 4);
-		fontxxx_Prop[i].FirstChar = (uint16_t)buf[0]|(uint16_t)buf[1]<<8;
-		fontxxx_Prop[i].LastChar  = (uint16_t)buf[2]|(uint16_t)buf[3]<<8;
-		
-		//scan it from the beginning of BFC_BIN_CHARINFO fontxxx_CharInfo[] array until ch is in range
-		if((unsigned short)ch >= fontxxx_Prop[i].FirstChar && (unsigned short)ch <=fontxxx_Prop[i].LastChar)
-		{
-			//the character "ch" is inside this ranage
-			addressOffset += (uint32_t)(charInfo_array_index*8L);
-			addressOffset += (uint32_t)(ch-fontxxx_Prop[i].FirstChar)*8L;
-			break;	//break the loop once it has been found!
-		}
-		else
-		{			
-			charInfo_array_index += (fontxxx_Prop[i].LastChar-fontxxx_Prop[i].FirstChar+1);
-		}
-	}
+	uint16_t width = 0;
 	
-	//seek physical address of ch's BFC_BIN_CHARINFO
-	if(!fontFile.seek(addressOffset)) 
-	{
-		//printf("Address of "ch" is not valid!\n");
-		return 0;
-	}	
-	fontFile.read((uint8_t*)buf, 8);	//read BFC_BIN_CHARINFO at physical address of "ch"
-	BFC_BIN_CHARINFO bfcBinFont_info;
+	if(bfc_BinIndexLoad(fontFile, pFilename))
+		width = bfc_BinCharWidth(fontFile, ch);
 	
-	uint16_t width = bfcBinFont_info.Width = (uint16_t)buf[0]|(uint16_t)buf[1]<<8;
+	fontFile.close();
 	return width;
 }
 
 /**
- * @brief	This function returns the length of a ASCII string from a binary file created by BFC.
+ * @brief	This function returns the length of a UTF-8 string from a binary file created by BFC.
  * @param	*pFilename points to a null terminated string for the binary file's filename.
- * @param	*str points to an ASCII constant string.
+ * @param	*str points to a UTF-8 constant string.
  * @return	width of the string
  */
 uint16_t Ra8876_Lite::getBfcStringWidth(const char *pFilename, const char *str)
 {
 	uint16_t width=0;
-	char ch=0;
+	uint16_t ch=0;
+	
+	//Open the file once for the whole string, character ranges come from the index
+	File fontFile = SD.open(pFilename);
+	
+	if(!fontFile) return 0;
 	
-	while(*str!='\0')
+	if(bfc_BinIndexLoad(fontFile, pFilename))
 	{
-		ch=*str;
-		width += getBfcCharWidth(pFilename, ch);
-		str++;
+		while(*str!='\0')
+		{
+			ch=utf8DecodeBmp(&str);
+			width += bfc_BinCharWidth(fontFile, ch);
+		}
 	}
 	
+	fontFile.close();
 	return width;	
 }
 
@@ -2703,13 +3971,22 @@ uint16_t Ra8876_Lite::getBfcStringWidth(const char *pFilename, const uint16_t *s
 	uint16_t width=0;
 	uint16_t ch=0;
 	
-	while(*str!='\0')
+	//Open the file once for the whole string, character ranges come from the index
+	File fontFile = SD.open(pFilename);
+	
+	if(!fontFile) return 0;
+	
+	if(bfc_BinIndexLoad(fontFile, pFilename))
 	{
-		ch=*str;
-		width += getBfcCharWidth(pFilename, ch);
-		str++;
+		while(*str!='\0')
+		{
+			ch=*str;
+			width += bfc_BinCharWidth(fontFile, ch);
+			str++;
+		}
 	}
 	
+	fontFile.close();
 	return width;
 }
 
@@ -2721,383 +3998,2516 @@ uint16_t Ra8876_Lite::getBfcStringWidth(const char *pFilename, const uint16_t *s
  */
 uint16_t Ra8876_Lite::getBfcFontHeight(const char *pFilename)
 {
-	uint8_t buf[12];
-	BFC_BIN_FONT bfcBinFont;
+	//No file access if the index of this font is in place
+	if(_bfcBinIndex.pKey != 0 && strcmp(_bfcBinName, pFilename)==0)
+		return _bfcBinIndex.FontHeight;
 	
 	File fontFile = SD.open(pFilename);
 	
 	if(!fontFile) return 0;
-	fontFile.read((uint8_t *)buf, 12);	
-	bfcBinFont.FontType = (uint32_t)buf[0]|(uint32_t)buf[1]<<8|(uint32_t)buf[2]<<16|(uint32_t)buf[3]<<24;	
-	uint16_t height = bfcBinFont.FontHeight = (uint16_t)buf[4]|(uint16_t)buf[5]<<8;
+	
+	uint16_t height = 0;
+	if(bfc_BinIndexLoad(fontFile, pFilename))
+		height = _bfcBinIndex.FontHeight;
 
 	fontFile.close();
 	
 	return height;
 }
 #endif	//#if defined (LOAD_SD_LIBRARY)
-#endif	//#if defined (LOAD_BFC_FONT)
 
-//**************************************************************//
-/*These 8 bits determine prescaler value for Timer 0 and 1.*/
-/*Time base is 鈥淐ore_Freq / (Prescaler + 1)鈥�*/
-//**************************************************************//
-void Ra8876_Lite::pwm_Prescaler(uint8_t prescaler)
-{
-  lcdRegDataWrite(RA8876_PSCLR,prescaler);//84h
-}
-//**************************************************************//
-//**************************************************************//
-void Ra8876_Lite::pwm_ClockMuxReg(uint8_t pwm1_clk_div, uint8_t pwm0_clk_div, uint8_t xpwm1_ctrl, uint8_t xpwm0_ctrl)
-{
-  lcdRegDataWrite(RA8876_PMUXR,pwm1_clk_div<<6|pwm0_clk_div<<4|xpwm1_ctrl<<2|xpwm0_ctrl);//85h
-}
-//**************************************************************//
-//**************************************************************//
-void Ra8876_Lite::pwm_Configuration(uint8_t pwm1_inverter,uint8_t pwm1_auto_reload,uint8_t pwm1_start,uint8_t 
-                       pwm0_dead_zone, uint8_t pwm0_inverter, uint8_t pwm0_auto_reload,uint8_t pwm0_start)
- {
-  lcdRegDataWrite(RA8876_PCFGR,pwm1_inverter<<6|pwm1_auto_reload<<5|pwm1_start<<4|pwm0_dead_zone<<3|
-                  pwm0_inverter<<2|pwm0_auto_reload<<1|pwm0_start);//86h                
- }   
-//**************************************************************//
-//**************************************************************//
-void Ra8876_Lite::pwm0_Duty(uint16_t duty)
-{
-  lcdRegDataWrite(RA8876_TCMPB0L,duty);//88h 
-  lcdRegDataWrite(RA8876_TCMPB0H,duty>>8);//89h 
-}
-//**************************************************************//
-//**************************************************************//
-void Ra8876_Lite::pwm0_ClocksPerPeriod(uint16_t clocks_per_period)
-{
-  lcdRegDataWrite(RA8876_TCNTB0L,clocks_per_period);//8ah
-  lcdRegDataWrite(RA8876_TCNTB0H,clocks_per_period>>8);//8bh
-}
-//**************************************************************//
-//**************************************************************//
-void Ra8876_Lite::pwm1_Duty(uint16_t duty)
-{
-  lcdRegDataWrite(RA8876_TCMPB1L,duty);//8ch 
-  lcdRegDataWrite(RA8876_TCMPB1H,duty>>8);//8dh
-}
-//**************************************************************//
-//**************************************************************//
-void Ra8876_Lite::pwm1_ClocksPerPeriod(uint16_t clocks_per_period)
+/**
+ * @brief	Reset a layout before shaping a new string
+ */
+void Ra8876_Lite::bfc_LayoutBegin(BFC_TEXT_LAYOUT *layout, uint16_t box_width, uint16_t box_height, BFC_ALIGN align)
 {
-  lcdRegDataWrite(RA8876_TCNTB1L,clocks_per_period);//8eh
-  lcdRegDataWrite(RA8876_TCNTB1F,clocks_per_period>>8);//8fh
+	layout->pFont = 0;
+	layout->pFilename = 0;
+	layout->boxWidth = box_width;
+	layout->boxHeight = box_height;
+	layout->fontHeight = 0;
+	layout->baseline = 0;
+	layout->lineHeight = 0;
+	layout->width = 0;
+	layout->height = 0;
+	layout->numGlyphs = 0;
+	layout->numLines = 0;
+	layout->align = (uint8_t)align;
+	layout->truncated = 0;
 }
 
 /**
- * @brief Portal for SDRAM memory write
+ * @brief	Copy characters of a string into the glyph buffer of a layout. Either str16 or str8 (UTF-8) is used.
+ * @note	Characters that do not fit in BFC_LAYOUT_MAX_GLYPHS are dropped and the layout is marked truncated.
  */
-void Ra8876_Lite:: ramAccessPrepare(void)
+void Ra8876_Lite::bfc_LayoutCopy(BFC_TEXT_LAYOUT *layout, const uint16_t *str16, const char *str8)
 {
-  lcdRegWrite(RA8876_MRWDP); //04h
+	uint16_t n = 0;
+	
+	if(str16)
+	{
+		while(*str16 != '\0' && n < BFC_LAYOUT_MAX_GLYPHS)
+			layout->glyphs[n++].ch = *str16++;
+		if(*str16 != '\0')
+			layout->truncated = 1;
+	}
+	else
+	{
+		while(*str8 != '\0' && n < BFC_LAYOUT_MAX_GLYPHS)
+			layout->glyphs[n++].ch = utf8DecodeBmp(&str8);
+		if(*str8 != '\0')
+			layout->truncated = 1;
+	}
+	
+	layout->numGlyphs = n;
 }
 
 /**
- * @brief Set foreground color
- * @param color is an object composed of 4 components: red, green, blue, alpha
- * @note  Example to use:<br>
- *        Ra8876_Lite ra8876lite;<br>
- *        Color color;<br>
- *        ra8876lite.setForegroundColor(color.Red);   //set red as the foreground color<br>
- *        delay(1000);<br>
- *        ra8876lite.setForegroundColor(color.Green); <br>
- *        delay(1000);<br>
- *        ra8876lite.setForegroundColor(color.Blue); <br>
- *        No foreground transparency is supported for RA8876 therefore alpha is always = 255<br>
- *        MSB for each component is used <br>
- *        Example, color.r[7:5] is used for component red in 8BPP<br>
- *        color.g[7:5] used for component green in 16BPP.
+ * @brief	Break measured glyphs of a layout into lines, then apply ellipsis and alignment.
+ * @param	*layout has its glyphs[] filled with characters and advance widths
+ * @param	line_height is the distance between tops of two lines, 0 to use FontHeight
+ * @param	dot_advance is the advance width of BFC_ELLIPSIS_CHAR, 0 for no ellipsis
+ * @return	Number of lines
+ * @note	A line breaks at '\n', or at the last space before the glyph that exceeds boxWidth.
+ *			A word wider than boxWidth is broken between characters.
  */
-void Ra8876_Lite::setForegroundColor(Color color)
+uint16_t Ra8876_Lite::bfc_LayoutLines(BFC_TEXT_LAYOUT *layout, uint16_t line_height, uint16_t dot_advance)
 {
-  uint8_t _mode = getColorMode();
-
-  switch(_mode)
-  {
-    case COLOR_8BPP_RGB332:   //RGB in 3:3:2
-          lcdRegDataWrite(RA8876_FGCR,(color.r&0xE0)); //d2h[7:5]
-          lcdRegDataWrite(RA8876_FGCG,(color.g&0xE0)); //d3h[7:5]
-          lcdRegDataWrite(RA8876_FGCB,(color.b&0xC0)); //d4h[7:6]
-          break;
-    case COLOR_24BPP_RGB888:  //RGB in 8:8:8
-          lcdRegDataWrite(RA8876_FGCR,color.r); //d2h[7:0]
-          lcdRegDataWrite(RA8876_FGCG,color.g); //d3h[7:0]
-          lcdRegDataWrite(RA8876_FGCB,color.b); //d4h[7:0]
-          break;
-    default:  //RGB in 5:6:5
-          lcdRegDataWrite(RA8876_FGCR,(color.r&0xF8));//d2h[7:3]
-          lcdRegDataWrite(RA8876_FGCG,(color.g&0xFC));//d3h[7:2]
-          lcdRegDataWrite(RA8876_FGCB,(color.b&0xF8));//d4h[7:3]
-  } 
+	BFC_GLYPH *g = layout->glyphs;
+	uint16_t n = layout->numGlyphs;
+	uint16_t box_w = layout->boxWidth;
+	uint16_t maxLines = BFC_LAYOUT_MAX_LINES;
+	uint16_t i = 0, l;
+	
+	layout->lineHeight = line_height ? line_height : layout->fontHeight;
+	
+	//The last line takes fontHeight only, each line above it takes lineHeight
+	if(layout->boxHeight && layout->lineHeight)
+	{
+		uint16_t fit = 0;
+		if(layout->boxHeight >= layout->fontHeight)
+			fit = 1 + (layout->boxHeight - layout->fontHeight)/layout->lineHeight;
+		if(fit < maxLines)
+			maxLines = fit;
+	}
+	
+	while(i < n && layout->numLines < maxLines)
+	{
+		uint16_t lineStart = i, lineWidth = 0;
+		uint16_t breakAt = 0, breakWidth = 0;
+		bool hasBreak = false, wrapped = false;
+		
+		while(i < n && g[i].ch != '\n')
+		{
+			if(box_w && (i > lineStart) && (lineWidth + g[i].advance > box_w))
+			{
+				wrapped = true;
+				break;
+			}
+			if(g[i].ch == ' ')
+			{
+				breakAt = i;
+				breakWidth = lineWidth;
+				hasBreak = true;
+			}
+			lineWidth += g[i].advance;
+			i++;
+		}
+		
+		uint16_t end = i, next = i;
+		if(!wrapped)
+		{
+			if(i < n) next = i + 1;	//skip '\n'
+		}
+		else if(hasBreak && breakAt > lineStart)
+		{
+			end = breakAt;
+			lineWidth = breakWidth;
+			next = breakAt + 1;
+		}
+		
+		while(end > lineStart && g[end-1].ch == ' ')	//trailing spaces do not count for alignment
+		{
+			end--;
+			lineWidth -= g[end].advance;
+		}
+		
+		BFC_LINE *ln = &layout->lines[layout->numLines++];
+		ln->first = lineStart;
+		ln->count = end - lineStart;
+		ln->width = lineWidth;
+		
+		i = next;
+		if(wrapped)
+			while(i < n && g[i].ch == ' ') i++;	//leading spaces of a wrapped line are dropped
+	}
+	
+	if(i < n)
+		layout->truncated = 1;
+	
+	//Replace the tail of the last line by "..." if the text has been truncated
+	if(layout->truncated && dot_advance && layout->numLines && (!box_w || 3*dot_advance <= box_w))
+	{
+		BFC_LINE *ln = &layout->lines[layout->numLines-1];
+		uint16_t w3 = 3*dot_advance;
+		
+		while(ln->count && 
+			 ((box_w && ln->width + w3 > box_w) || (ln->first + ln->count + 3 > BFC_LAYOUT_MAX_GLYPHS) || (g[ln->first+ln->count-1].ch == ' ')))
+		{
+			ln->count--;
+			ln->width -= g[ln->first+ln->count].advance;
+		}
+		if(ln->first + ln->count + 3 <= BFC_LAYOUT_MAX_GLYPHS)
+		{
+			for(uint8_t k=0; k<3; k++)
+			{
+				g[ln->first+ln->count].ch = BFC_ELLIPSIS_CHAR;
+				g[ln->first+ln->count].advance = dot_advance;
+				ln->count++;
+			}
+			ln->width += w3;
+		}
+	}
+	
+	if(layout->numLines)
+	{
+		BFC_LINE *ln = &layout->lines[layout->numLines-1];
+		layout->numGlyphs = ln->first + ln->count;
+	}
+	else
+		layout->numGlyphs = 0;
+	
+	//Alignment is relative to boxWidth, or to the widest line if there is no wrapping
+	for(l=0; l<layout->numLines; l++)
+		if(layout->lines[l].width > layout->width) layout->width = layout->lines[l].width;
+	
+	uint16_t ref = box_w ? box_w : layout->width;
+	for(l=0; l<layout->numLines; l++)
+	{
+		BFC_LINE *ln = &layout->lines[l];
+		int16_t space = (ln->width < ref) ? (int16_t)(ref - ln->width) : 0;
+		
+		switch(layout->align)
+		{
+			case BFC_ALIGN_CENTER:	ln->x = space/2;	break;
+			case BFC_ALIGN_RIGHT:	ln->x = space;		break;
+			default:				ln->x = 0;			break;
+		}
+		ln->y = l*layout->lineHeight;
+	}
+	
+	layout->height = layout->numLines ? (layout->numLines-1)*layout->lineHeight + layout->fontHeight : 0;
+	
+	return layout->numLines;
 }
 
 /**
- * @brief Set background color
- * @param color is an object composed of 4 components: red, green, blue, alpha
- * @note  Example to use:<br>
- *        Ra8876_Lite ra8876lite;<br>
- *        Color bg;<br>
- *        ra8876lite.setBackgroundColor(bg.Red);   //set red as the background color<br>
- *        delay(1000);<br>
- *        ra8876lite.setBackgroundColor(bg.Green); <br>
- *        delay(1000);<br>
- *        ra8876lite.setBackgroundColor(bg.Blue); <br>
- *        No background transparency is supported for RA8876 therefore alpha is always = 255<br>
- *        MSB for each component is used <br>
- *        Example, color.r[7:5] is used for component red in 8BPP<br>
- *        color.g[7:5] used for component green in 16BPP.
+ * @brief	Measure glyphs of a layout from a font in MCU's Flash, then break them into lines.
  */
-void Ra8876_Lite::setBackgroundColor(Color color)
+uint16_t Ra8876_Lite::bfc_LayoutShape(BFC_TEXT_LAYOUT *layout, const BFC_FONT *pFont, uint16_t line_height, bool ellipsis)
 {
-  uint8_t _mode = getColorMode();
-
-  switch(_mode)
-  {
-    case COLOR_8BPP_RGB332:   //RGB in 3:3:2
-          lcdRegDataWrite(RA8876_BGCR,(color.r&0xE0)); //d5h[7:5]
-          lcdRegDataWrite(RA8876_BGCG,(color.g&0xE0)); //d6h[7:5]
-          lcdRegDataWrite(RA8876_BGCB,(color.b&0xC0)); //d7h[7:6]
-          break;
-    case COLOR_24BPP_RGB888:  //RGB in 8:8:8
-          lcdRegDataWrite(RA8876_BGCR,color.r); //d5h[7:0]
-          lcdRegDataWrite(RA8876_BGCG,color.g); //d6h[7:0]
-          lcdRegDataWrite(RA8876_BGCB,color.b); //d7h[7:0]
-          break;
-    default:  //RGB in 5:6:5
-          lcdRegDataWrite(RA8876_BGCR,(color.r&0xF8));//d5h[7:3]
-          lcdRegDataWrite(RA8876_BGCG,(color.g&0xFC));//d6h[7:2]
-          lcdRegDataWrite(RA8876_BGCB,(color.b&0xF8));//d7h[7:3]
-  }    
+	const BFC_CHARINFO *pCharInfo;
+	
+	layout->pFont = pFont;
+	layout->fontHeight = pFont->FontHeight;
+	layout->baseline = pFont->Baseline;
+	
+	for(uint16_t i=0; i<layout->numGlyphs; i++)
+	{
+		pCharInfo = (layout->glyphs[i].ch=='\n') ? 0 : bfc_GetCharInfo(pFont, layout->glyphs[i].ch);
+		layout->glyphs[i].advance = pCharInfo ? pCharInfo->Width : 0;
+	}
+	
+	uint16_t dot_advance = 0;
+	if(ellipsis)
+	{
+		pCharInfo = bfc_GetCharInfo(pFont, BFC_ELLIPSIS_CHAR);
+		if(pCharInfo) dot_advance = pCharInfo->Width;
+	}
+	
+	return bfc_LayoutLines(layout, line_height, dot_advance);
 }
 
 /**
- * @brief 	Set graphic mode ON or OFF
- * @param	on is a boolean flag to set <br>
- *			'true' or '1' for Graphic Mode
- *			'false' or '0' for Text Mode
- */
- void Ra8876_Lite::graphicMode(bool on)
- {
-  if(on)
-   lcdRegDataWrite(RA8876_ICR,RA8876_GRAPHIC_MODE<<2|RA8876_MEMORY_SELECT_IMAGE);//03h  //switch to graphic mode
-  else
-   lcdRegDataWrite(RA8876_ICR,RA8876_TEXT_MODE<<2|RA8876_MEMORY_SELECT_IMAGE);//03h  //switch back to text mode
- }
-
-
- /**
- * @brief Put pixel at (x,y) with color object of components (r,g,b,a)
- * @param x,y indicate the pixel coordinates
- * @param color in r,g,b components
- * @param lnOffset is the canvas start address represented in line number
+ * @brief	Shape a Unicode string once into lines of positioned glyphs with a font in MCU's Flash.
+ * @param	*layout is the layout to fill. Declare it static or global, it is around 600 bytes.
+ * @param	*pFont is a pointer to BFC_FONT in MCU's Flash
+ * @param	*str is a pointer to an array of 2-byte characters
+ * @param	box_width is the width to wrap text, 0 for no wrapping
+ * @param	box_height is the height to fill, 0 for no limit other than BFC_LAYOUT_MAX_LINES
+ * @param	align is one of BFC_ALIGN_LEFT, BFC_ALIGN_CENTER, BFC_ALIGN_RIGHT
+ * @param	line_height is the distance between tops of two lines in pixels, 0 to use FontHeight
+ * @param	ellipsis is a flag to end the last line with "..." if the text does not fit
+ * @return	Number of lines
+ * @note	Advance widths are fetched once and kept in the layout, so drawBfcLayout() can be called
+ *			any number of times without measuring the string again.<br>
+ *			Example to use <br>
+ *			static BFC_TEXT_LAYOUT layout;
+ *			unsigned short chinese_string[]={0x4F60, 0x597D, 0x4E16, 0x754C, 0x676F, '\0'};
+ *			ra8876lite.layoutBfcText(&layout, &fontLucida_Sans_Unicode16h_rowrowBig, chinese_string, 400, 0, BFC_ALIGN_CENTER);
+ *			ra8876lite.drawBfcLayout(&layout, 200, 100, color.Black, color.Transparent);
  */
-void Ra8876_Lite::putPixel(uint16_t x, uint16_t y, Color color, uint32_t lnOffset)
+uint16_t Ra8876_Lite::layoutBfcText(
+BFC_TEXT_LAYOUT *layout, 
+const BFC_FONT *pFont, 
+const uint16_t *str, 
+uint16_t box_width, uint16_t box_height, 
+BFC_ALIGN align, 
+uint16_t line_height, 
+bool ellipsis)
 {
-	setPixelCursor(x,y,lnOffset);
-	ramAccessPrepare(); 
-  
-  switch(_colorMode)
-  {
-    case COLOR_8BPP_RGB332:
-          lcdDataWrite((color.r&0xE0) | (color.g&0xE0)>>3 | (color.b&0xC0)>>6);
-        break;
-    case COLOR_24BPP_RGB888:
-          lcdDataWrite(color.b);
-          lcdDataWrite(color.g);
-          lcdDataWrite(color.r);
-        break;
-	case COLOR_6BPP_ARGB2222:
-		  lcdDataWrite((color.a&0x06)<<5 | (color.r&0xC0)>>2 | (color.g&0xC0)>>4 | (color.b&0xC0)>>6);
-		break;
-    case COLOR_12BPP_ARGB4444:
-          lcdDataWrite((color.g&0xF0) | (color.b&0xF0)>>4);
-          lcdDataWrite((color.a&0x0F)<<4 | (color.r&0xF0)>>4);
-        break;
-    default:  //case COLOR_16BPP_RGB565:
-          lcdDataWrite((color.g&0x1C)<<3 | (color.b&0xF8)>>3);
-          lcdDataWrite((color.r&0xF8) | (color.g&0xE0)>>5);
-  }
+	if(layout == 0)
+		return 0;
+	
+	bfc_LayoutBegin(layout, box_width, box_height, align);
+	
+	if(pFont == 0 || str == 0)
+		return 0;
+	
+	bfc_LayoutCopy(layout, str, 0);
+	return bfc_LayoutShape(layout, pFont, line_height, ellipsis);
 }
 
 /**
- * @brief Set cursor position and active window before data write to SDRAM (Canvas).
- * @param x,y is the top left corner coordinates.
- * @param width, height indicate the dimension in pixels.
- * @param lnOffset indicates the Canvas Address offset in line number.
- * @note  Coordinates (x,y) are relative to the Canvas Start Address. 
- *		  This function is required before writing pixels to SDRAM.
+ * @brief	Shape a UTF-8 string once into lines of positioned glyphs with a font in MCU's Flash.
+ * @note	Refer to layoutBfcText(BFC_TEXT_LAYOUT*, const BFC_FONT*, const uint16_t*, ...) for details.
  */
-void Ra8876_Lite:: putPicture_set_frame(uint16_t x,uint16_t y,uint16_t width, uint16_t height, uint32_t lnOffset)
-{	
-	activeWindowXY(x,y);
-	activeWindowWH(width,height);
-	setPixelCursor(x,y, lnOffset);
+uint16_t Ra8876_Lite::layoutBfcText(
+BFC_TEXT_LAYOUT *layout, 
+const BFC_FONT *pFont, 
+const char *str, 
+uint16_t box_width, uint16_t box_height, 
+BFC_ALIGN align, 
+uint16_t line_height, 
+bool ellipsis)
+{
+	if(layout == 0)
+		return 0;
 	
-	ramAccessPrepare();
+	bfc_LayoutBegin(layout, box_width, box_height, align);
+	
+	if(pFont == 0 || str == 0)
+		return 0;
+	
+	bfc_LayoutCopy(layout, 0, str);
+	return bfc_LayoutShape(layout, pFont, line_height, ellipsis);
 }
 
+#if defined (LOAD_SD_LIBRARY)
 /**
- * @brief	This function converts line number to physical address for Canvas.
- * @param	lnOffset indicates line offset position.
- * @return	Canvas Address or -1 if lnOffset out-of-range.
- *			
+ * @brief	Measure glyphs of a layout from a *.bin file with a single SD.open(), then break them into lines.
  */
-int32_t Ra8876_Lite::canvasAddress_from_lnOffset(uint32_t lnOffset)
+uint16_t Ra8876_Lite::bfc_LayoutShape(BFC_TEXT_LAYOUT *layout, const char *pFilename, uint16_t line_height, bool ellipsis)
 {
-	int32_t _canvasAddress = -1;
+	File fontFile = SD.open(pFilename);
 	
-	uint8_t bpp = getColorDepth();
+	if(!fontFile)
+	{
+		printf("No such file exist!\n");
+		layout->numGlyphs = 0;
+		return 0;
+	}
 	
-	if(lnOffset <= (uint32_t)(MEM_SIZE_MAX/(_canvasWidth*bpp)-1))
+	if(!bfc_BinIndexLoad(fontFile, pFilename))
 	{
-		_canvasAddress = lnOffset*_canvasWidth*bpp;
+		fontFile.close();
+		layout->numGlyphs = 0;
+		return 0;
 	}
 	
-	return _canvasAddress;
+	layout->pFilename = pFilename;
+	layout->fontHeight = _bfcBinIndex.FontHeight;
+	layout->baseline = _bfcBinIndex.Baseline;
+	
+	for(uint16_t i=0; i<layout->numGlyphs; i++)
+		layout->glyphs[i].advance = (layout->glyphs[i].ch=='\n') ? 0 : bfc_BinCharWidth(fontFile, layout->glyphs[i].ch);
+	
+	uint16_t dot_advance = ellipsis ? bfc_BinCharWidth(fontFile, BFC_ELLIPSIS_CHAR) : 0;
+	
+	fontFile.close();
+	
+	return bfc_LayoutLines(layout, line_height, dot_advance);
 }
 
 /**
- * @brief Draw picture from a static 8-bit data array from Flash.
- * @param x,y is the top left corner coordinates. Max x,y = 8192.
- * @param width, height indicate the dimension in pixels.
- * @param *data is a void pointer to a static array of 8-bit or 16-bit data.
- * @note  Data cast please refer to the note section of function canvasWrite(args).
- * @param rotate_ccw90 is a boolean flag to rotate a single character in counter clockwise 90 degrees.
- * @param lnOffset indicates line offset position.
- * @note  Default value of lnOffset = CANVAS_OFFSET which is the starting address of the Main Display Window.
- *		  One may override this parameter with a non-display line number (e.g. lnOffset = 721) to 
- *		  write an image to some off-screen area. This can avoid a "snail-like" pixel rastering to be 
- *		  visible. This is particularly important for slow MCUs like Arduino or mbed as we are using
- * 		  only a slow SPI bus (4MHz in some case!) with these platforms. After rendering is completed,
- *		  a 2D function bteMemoryCopyWithROP(args) can be used to copy the data from non-display region
- *		  to the Main Display Window with a single instruction. 
- *		  It is also important to notice that coordinates x,y are relative to Canvas Starting Address 
- *		  thus y is relative to lnOffset. For example, setting y=10 with lnOffset = 721 will draw 
- *		  data starting from the line 731.
- *		  
+ * @brief	Shape a Unicode string once into lines of positioned glyphs with a *.bin font from SD card.
+ * @param	*pFilename is a pointer to the binary file name. The layout keeps this pointer for drawBfcLayout(),
+ *			so it must stay valid as long as the layout is in use.
+ * @note	Refer to layoutBfcText(BFC_TEXT_LAYOUT*, const BFC_FONT*, const uint16_t*, ...) for other parameters.<br>
+ *			The font file is opened once to measure the whole string, and once more in drawBfcLayout() to render it.
  */
-void Ra8876_Lite:: putPicture(	uint16_t x, uint16_t y,
-								uint16_t width, uint16_t height, 
-								const void* data, 
-								bool rotate_ccw90,
-								uint32_t lnOffset)
+uint16_t Ra8876_Lite::layoutBfcText(
+BFC_TEXT_LAYOUT *layout, 
+const char *pFilename, 
+const uint16_t *str, 
+uint16_t box_width, uint16_t box_height, 
+BFC_ALIGN align, 
+uint16_t line_height, 
+bool ellipsis)
 {
-	uint16_t _x=x, _y=y, _width=width, _height=height;
-	uint8_t MACR;
-/*	
-	int32_t _canvasAddress = canvasAddress_from_lnOffset(lnOffset);
-	if(_canvasAddress<0) return;
+	if(layout == 0)
+		return 0;
 	
-	canvasImageStartAddress(_canvasAddress);
-*/
-	///Important::need to set RA8876_MACR prior to putPicture_set_frame() otherwise it doesn't work!
-	///Change the host to Memory write direction 
-	if(rotate_ccw90){
-		_width = height; _height = width;
-		_x = y; _y = x;
-		MACR = lcdRegDataRead(RA8876_MACR); //read REG[02h]
-		lcdRegDataWrite(RA8876_MACR, MACR|0x06);  		
-	}	
-	//coordinates (x,y) is relative to the canvas address with max x,y=8192
-	putPicture_set_frame(_x,_y,_width,_height,lnOffset);
+	bfc_LayoutBegin(layout, box_width, box_height, align);
 	
-	size_t _length = (size_t)width*height*getColorDepth();	//bpp=1 for 8BPP, =2 for 16BPP, and =3 for 24BPP
-	hal_spi_write((const uint8_t*)data, _length);			//push data via SPI port with different data length for each BPP
+	if(pFilename == 0 || str == 0)
+		return 0;
+	
+	bfc_LayoutCopy(layout, str, 0);
+	return bfc_LayoutShape(layout, pFilename, line_height, ellipsis);
+}
+
+/**
+ * @brief	Shape a UTF-8 string once into lines of positioned glyphs with a *.bin font from SD card.
+ * @note	Refer to layoutBfcText(BFC_TEXT_LAYOUT*, const char*, const uint16_t*, ...) for details.
+ */
+uint16_t Ra8876_Lite::layoutBfcText(
+BFC_TEXT_LAYOUT *layout, 
+const char *pFilename, 
+const char *str, 
+uint16_t box_width, uint16_t box_height, 
+BFC_ALIGN align, 
+uint16_t line_height, 
+bool ellipsis)
+{
+	if(layout == 0)
+		return 0;
+	
+	bfc_LayoutBegin(layout, box_width, box_height, align);
+	
+	if(pFilename == 0 || str == 0)
+		return 0;
+	
+	bfc_LayoutCopy(layout, 0, str);
+	return bfc_LayoutShape(layout, pFilename, line_height, ellipsis);
+}
+#endif	//#if defined (LOAD_SD_LIBRARY)
+
+/**
+ * @brief	Render a layout shaped by layoutBfcText() in a single pass.
+ * @param	*layout is the layout to draw
+ * @param	x0 is the x-coordinate of top left corner of the layout box
+ * @param	y0 is the y-coordinate of top left corner of the layout box
+ * @param	color is the font color
+ * @param	bg is the background color. Only glyph cells are filled, not the whole box.
+ * @param	rotate_ccw90 is a boolean flag to rotate the text in counter clockwise 90 degrees
+ * @param	lnOffset is the Canvas Address offset in line number
+ * @return	Height of the text drawn in pixels
+ * @note	Glyph positions come from advance widths stored in the layout. For a *.bin font the file is opened
+ *			only once for all lines.
+ */
+uint16_t Ra8876_Lite::drawBfcLayout(
+const BFC_TEXT_LAYOUT *layout, 
+uint16_t x0, uint16_t y0, 
+Color color, 
+Color bg, 
+bool rotate_ccw90, 
+uint32_t lnOffset)
+{
+	if(layout == 0 || layout->numLines == 0)
+		return 0;
+	
+#if defined (LOAD_SD_LIBRARY)
+	File fontFile;
+	
+	if(layout->pFont == 0)
+	{
+		if(layout->pFilename == 0)
+			return 0;
+		
+		fontFile = SD.open(layout->pFilename);
+		if(!fontFile)
+		{
+			printf("No such file exist!\n");
+			return 0;
+		}
+		if(!bfc_BinIndexLoad(fontFile, layout->pFilename))
+		{
+			fontFile.close();
+			return 0;
+		}
+	}
+#else
+	if(layout->pFont == 0)
+		return 0;
+#endif
+	
+	for(uint16_t l=0; l<layout->numLines; l++)
+	{
+		const BFC_LINE *ln = &layout->lines[l];
+		uint16_t x = x0 + ln->x;
+		uint16_t y = y0 + ln->y;
+		
+		for(uint16_t i=ln->first; i<ln->first+ln->count; i++)
+		{
+			const BFC_GLYPH *g = &layout->glyphs[i];
+			
+			if(layout->pFont)
+				bfc_DrawChar_RowRowUnpacked(x, y, layout->pFont, g->ch, color, bg, rotate_ccw90, lnOffset);
+#if defined (LOAD_SD_LIBRARY)
+			else
+				bfc_DrawChar_RowRowUnpacked(x, y, fontFile, g->ch, color, bg, rotate_ccw90, lnOffset);
+#endif
+			x += g->advance;
+		}
+	}
+	
+#if defined (LOAD_SD_LIBRARY)
+	if(layout->pFont == 0)
+		fontFile.close();
+#endif
+	
+	return layout->height;
+}
+/**
+ * @brief	Decode the header of a packed font into _bfcpFont.
+ * @param	*pFont points to a packed font array converted by extras/bfcpack
+ * @return	true if successful, false if pFont is not a packed font
+ * @note	Nothing is decoded if the same font was used last time.
+ */
+bool Ra8876_Lite::bfcp_Open(const uint8_t *pFont)
+{
+	if(pFont == 0)
+		return false;
+	
+	if(_bfcpKey == pFont)
+		return true;
+	
+	_bfcpKey = 0;
+	if(BfcpOpen((const UCHAR *)pFont, &_bfcpFont) < 0)
+	{
+		printf("Not a packed font!\n");
+		return false;
+	}
+	
+	_bfcpKey = pFont;
+	return true;
+}
+
+/**
+ * @brief	Convert a color into the bytes of a pixel write in the current color mode.
+ * @param	color is the color to convert
+ * @param	*buf is a buffer of 3 bytes minimum
+ * @return	Number of bytes per pixel
+ */
+uint8_t Ra8876_Lite::bfcp_ColorBytes(Color color, uint8_t *buf)
+{
+	switch(_colorMode)
+	{
+		case COLOR_8BPP_RGB332:
+			buf[0] = (color.r&0xE0) | (color.g&0xE0)>>3 | (color.b&0xC0)>>6;
+			return 1;
+		case COLOR_24BPP_RGB888:
+			buf[0] = color.b;
+			buf[1] = color.g;
+			buf[2] = color.r;
+			return 3;
+		default:	//case COLOR_16BPP_RGB565:
+			buf[0] = (color.g&0x1C)<<3 | (color.b&0xF8)>>3;
+			buf[1] = (color.r&0xF8) | (color.g&0xE0)>>5;
+			return 2;
+	}
+}
+
+/**
+ * @brief	Send one glyph of a packed font to the canvas by BTE.
+ * @param	x is the x-coordinate of the glyph cell
+ * @param	y0 is the y-coordinate of the glyph cell top
+ * @param	*pGlyph is the glyph decoded by BfcpGetGlyph()
+ * @param	*palette holds pixel bytes of each antialiased level, 3 bytes per level. Not used by 1bpp fonts.
+ * @param	pixel_bytes is the number of bytes per pixel of the current color mode
+ * @param	lnOffset is the Canvas Address offset in line number
+ * @note	Foreground and background (chroma key) colors are set by the caller once for a string.<br>
+ *			A 1bpp glyph is already in the layout of a BTE color expansion and goes to RA8876 in one burst.
+ *			An antialiased glyph is expanded through the palette into a BTE MPU write with chroma key,
+ *			so level 0 pixels keep the canvas underneath. Empty rows are never sent.
+ */
+void Ra8876_Lite::bfcp_DrawGlyph(uint16_t x, uint16_t y0, const BFCP_GLYPH *pGlyph, const uint8_t *palette, uint8_t pixel_bytes, uint32_t lnOffset)
+{
+	uint8_t bpp = _bfcpFont.Bpp;
+	uint8_t level_mask = (1<<bpp)-1;
+	uint16_t width = (uint16_t)pGlyph->Pitch*8/bpp;
+	uint16_t y = y0 + pGlyph->Top;
+	uint16_t y_end = y + pGlyph->Rows;
+	uint16_t count = pGlyph->Rows;
+	const uint8_t *pData = pGlyph->pData;
+	uint32_t des_addr = canvasAddress_from_lnOffset(lnOffset);
+	
+	if(width == 0)
+		return;
+	
+	while(y < y_end)
+	{
+		if(_bfcpFont.Flags & BFCP_FLAG_RLE_ROWS)
+		{
+			y += pData[0];
+			count = pData[1];
+			pData += 2;
+		}
+		
+		bte_DestinationMemoryStartAddr(des_addr);
+		bte_DestinationImageWidth(_canvasWidth);
+		bte_DestinationWindowStartXY(x, y);
+		bte_WindowSize(width, count);
+		
+		uint32_t data_count = (uint32_t)pGlyph->Pitch*count;
+		
+		if(bpp == 1)
+		{
+			lcdRegDataWrite(RA8876_BTE_CTRL1,RA8876_BTE_ROP_BUS_WIDTH8<<4|RA8876_BTE_MPU_WRITE_COLOR_EXPANSION_WITH_CHROMA);//91h
+			lcdRegDataWrite(RA8876_BTE_CTRL0,RA8876_BTE_ENABLE<<4);//90h
+			ramAccessPrepare();
+			hal_spi_write(pData, data_count);
+			pData += data_count;
+		}
+		else
+		{
+			uint8_t buf[48];
+			uint8_t n = 0;
+			
+			lcdRegDataWrite(RA8876_BTE_CTRL1,RA8876_BTE_MPU_WRITE_WITH_CHROMA);//91h
+			lcdRegDataWrite(RA8876_BTE_CTRL0,RA8876_BTE_ENABLE<<4);//90h
+			ramAccessPrepare();
+			
+			while(data_count--)
+			{
+				uint8_t data = *pData++;
+				for(int8_t bit=8-bpp; bit>=0; bit-=bpp)
+				{
+					memcpy(&buf[n], &palette[((data>>bit)&level_mask)*3], pixel_bytes);
+					n += pixel_bytes;
+					if(n > sizeof(buf)-pixel_bytes)
+					{
+						hal_spi_write(buf, n);
+						n = 0;
+					}
+				}
+			}
+			hal_spi_write(buf, n);
+		}
+		check2dBusy();
+		y += count;
+	}
+}
+
+/**
+ * @brief	Send one glyph of a packed font to the canvas rotated by 90 degrees in counter clockwise direction.
+ * @note	Parameters are the same as bfcp_DrawGlyph(), coordinates are before rotation and transformed by rotateCcw90().<br>
+ *			BTE does not follow the write direction of MACR, so the glyph is read column by column from its right
+ *			edge and streamed into a single BTE window of the rotated size. A 1bpp column is packed into color
+ *			expansion bits, the window width is rounded up to 8 pixels and the padding is dropped by chroma key.
+ *			Empty rows above Top and below Top+Rows are not sent.
+ */
+void Ra8876_Lite::bfcp_DrawGlyphRotated(uint16_t x, uint16_t y0, const BFCP_GLYPH *pGlyph, const uint8_t *palette, uint8_t pixel_bytes, uint32_t lnOffset)
+{
+	uint8_t bpp = _bfcpFont.Bpp;
+	uint8_t level_mask = (1<<bpp)-1;
+	uint8_t pixels_per_byte = 8/bpp;
+	uint16_t width = (uint16_t)pGlyph->Pitch*8/bpp;
+	uint16_t rows = pGlyph->Rows;
+	uint16_t rx = x+width-1, ry = y0+pGlyph->Top;
+	bool rle = (_bfcpFont.Flags & BFCP_FLAG_RLE_ROWS) != 0;
+	GLYPH_STREAM s;
+	
+	if(width == 0 || rows == 0)
+		return;
+	
+	rotateCcw90(&rx, &ry);	//top left corner of the rotated glyph
+	s.palette = palette;	//level 0 is the chroma key
+	s.pixel_bytes = pixel_bytes;
+	s.bpp = bpp;
+	s.expand = (bpp == 1);
+	
+	bte_DestinationMemoryStartAddr(canvasAddress_from_lnOffset(lnOffset));
+	bte_DestinationImageWidth(_canvasWidth);
+	bte_DestinationWindowStartXY(rx, ry);
+	if(bpp == 1)
+	{
+		bte_WindowSize((rows+7)&~7, width);
+		lcdRegDataWrite(RA8876_BTE_CTRL1,RA8876_BTE_ROP_BUS_WIDTH8<<4|RA8876_BTE_MPU_WRITE_COLOR_EXPANSION_WITH_CHROMA);//91h
+	}
+	else
+	{
+		bte_WindowSize(rows, width);
+		lcdRegDataWrite(RA8876_BTE_CTRL1,RA8876_BTE_MPU_WRITE_WITH_CHROMA);//91h
+	}
+	lcdRegDataWrite(RA8876_BTE_CTRL0,RA8876_BTE_ENABLE<<4);//90h
+	ramAccessPrepare();
+	
+	for(uint16_t sx = width; sx-- > 0;)
+	{
+		const uint8_t *pData = pGlyph->pData;
+		uint8_t col = sx/pixels_per_byte;
+		uint8_t shift = 8-bpp-(sx%pixels_per_byte)*bpp;
+		uint8_t skip = 0, count = rle ? 0 : rows;
+		
+		for(uint16_t r=0; r<rows; r++)
+		{
+			uint8_t level = 0;
+			
+			//walk the list of runs again for each column, only pointer arithmetic per row
+			if(skip == 0 && count == 0)
+			{
+				skip = pData[0];
+				count = pData[1];
+				pData += 2;
+			}
+			if(skip)
+			{
+				skip--;
+			}
+			else
+			{
+				level = (pData[col]>>shift)&level_mask;
+				pData += pGlyph->Pitch;
+				count--;
+			}
+			glyph_StreamLevel(&s, level);
+		}
+		glyph_StreamLineEnd(&s, false);
+	}
+	glyph_StreamLineEnd(&s, true);
+	check2dBusy();
+}
+
+/**
+ * @brief	Measure or draw a string with the packed font in _bfcpFont.
+ * @param	*str16 is a string of 2-byte characters, or 0 if str8 is used
+ * @param	*str8 is a UTF-8 string, or 0 if str16 is used
+ * @param	rotate_ccw90 is a boolean flag to rotate the string in counter clockwise 90 degrees
+ * @param	draw is false to measure the string only
+ * @return	Width of the string in pixels including kerning
+ * @note	With a solid background color the string box is filled by one bteSolidFill() first, then every glyph
+ *			is drawn with chroma key so that kerned glyphs can overlap without erasing each other.
+ */
+uint16_t Ra8876_Lite::bfcp_String(uint16_t x0, uint16_t y0, const uint16_t *str16, const char *str8, Color color, Color bg, bool rotate_ccw90, uint32_t lnOffset, bool draw)
+{
+	BFCP_GLYPH glyph;
+	uint16_t x = x0, prev_code = 0;
+	bool prev_kern = false;
+	uint8_t palette[16*3];
+	uint8_t pixel_bytes = 0;
+	
+	if(draw)
+	{
+		Color mask;
+		uint8_t levels = 1<<_bfcpFont.Bpp;
+		
+		if(bg != mask.Transparent)
+		{
+			uint16_t width = bfcp_String(x0, y0, str16, str8, color, bg, rotate_ccw90, lnOffset, false);
+			if(rotate_ccw90)
+			{
+				uint16_t rx = x0+width-1, ry = y0;
+				rotateCcw90(&rx, &ry);
+				bteSolidFill(canvasAddress_from_lnOffset(lnOffset), rx, ry, _bfcpFont.FontHeight, width, bg);
+			}
+			else
+				bteSolidFill(canvasAddress_from_lnOffset(lnOffset), x0, y0, width, _bfcpFont.FontHeight, bg);
+		}
+		
+		//antialiased levels are blended with bg, which is black for Transparent as in bfc_GetColorBasedPixel()
+		for(uint8_t v=1; v<levels; v++)
+			pixel_bytes = bfcp_ColorBytes(bfc_GetColorBasedPixel(v, _bfcpFont.Bpp, color, bg), &palette[v*3]);
+		
+		//chroma key must not match any level, or those pixels would be dropped
+		Color key = bfc_ChromaKey(_bfcpFont.Bpp, color, bg);
+		bfcp_ColorBytes(key, &palette[0]);
+		setForegroundColor(color);
+		setBackgroundColor(key);
+	}
+	
+	for(;;)
+	{
+		uint16_t ch;
+		
+		if(str16)
+			ch = *str16++;
+		else
+			ch = (*str8 != '\0') ? utf8DecodeBmp(&str8) : 0;
+		
+		if(ch == 0)
+			break;
+		
+		USHORT index = BfcpFindGlyph(&_bfcpFont, ch);
+		if(index == BFCP_NO_GLYPH)
+			index = _bfcpFont.DefaultGlyph;
+		if(BfcpGetGlyph(&_bfcpFont, index, &glyph) < 0)
+			continue;
+		
+		if(prev_kern)
+			x += BfcpGetKerning(&_bfcpFont, prev_code, glyph.Code);
+		
+		if(draw && rotate_ccw90)
+			bfcp_DrawGlyphRotated(x, y0, &glyph, palette, pixel_bytes, lnOffset);
+		else if(draw)
+			bfcp_DrawGlyph(x, y0, &glyph, palette, pixel_bytes, lnOffset);
+		
+		x += glyph.Advance;
+		prev_code = glyph.Code;
+		prev_kern = (glyph.Flags & BFCP_GLYPH_KERN) != 0;
+	}
+	
+	return x - x0;
+}
+
+/**
+ * @brief	Put a character with a packed font.
+ * @param	x0 is the x-coordinate of top left corner of the character
+ * @param	y0 is the y-coordinate of top left corner of the character
+ * @param	*pFont points to a packed font array converted by extras/bfcpack
+ * @param	ch is the character in Unicode
+ * @param	color is the font color
+ * @param	bg is the background color, or Transparent to keep the canvas
+ * @param	rotate_ccw90 is a boolean flag to rotate the character in counter clockwise 90 degrees
+ * @param	lnOffset is the Canvas Address offset in line number
+ * @return	Advance width of the character in pixels
+ */
+uint16_t Ra8876_Lite::putBfcPackedChar(uint16_t x0, uint16_t y0, const uint8_t *pFont, const uint16_t ch, Color color, Color bg, bool rotate_ccw90, uint32_t lnOffset)
+{
+	uint16_t str[2] = {ch, 0};
+	
+	return putBfcPackedString(x0, y0, pFont, str, color, bg, rotate_ccw90, lnOffset);
+}
+
+/**
+ * @brief	Put a Unicode string with a packed font.
+ * @param	*str is a pointer to an array of 2-byte characters
+ * @return	Width of the string in pixels
+ * @note	Refer to putBfcPackedChar() for other parameters.<br>
+ *			Characters not in the font are drawn with the default character chosen by bfcpack (-d option).<br>
+ *			Example to use <br>
+ *			//bfcpack -b 1 -s 0x20-0x7E Lucida_Sans_Unicode16h_rowrowBig.c lucida16.c
+ *			extern const unsigned char lucida16[];
+ *			ra8876lite.putBfcPackedString(10, 10, lucida16, "Hello World", color.White, color.Transparent);
+ */
+uint16_t Ra8876_Lite::putBfcPackedString(uint16_t x0, uint16_t y0, const uint8_t *pFont, const uint16_t *str, Color color, Color bg, bool rotate_ccw90, uint32_t lnOffset)
+{
+	if(str == 0 || !bfcp_Open(pFont))
+		return 0;
+	
+	return bfcp_String(x0, y0, str, 0, color, bg, rotate_ccw90, lnOffset, true);
+}
+
+/**
+ * @brief	Put a UTF-8 string with a packed font.
+ * @note	Refer to putBfcPackedString(uint16_t, uint16_t, const uint8_t*, const uint16_t*, ...) for details.
+ */
+uint16_t Ra8876_Lite::putBfcPackedString(uint16_t x0, uint16_t y0, const uint8_t *pFont, const char *str, Color color, Color bg, bool rotate_ccw90, uint32_t lnOffset)
+{
+	if(str == 0 || !bfcp_Open(pFont))
+		return 0;
+	
+	return bfcp_String(x0, y0, 0, str, color, bg, rotate_ccw90, lnOffset, true);
+}
+
+/**
+ * @brief	Return width of a Unicode string in pixels with a packed font, kerning included.
+ */
+uint16_t Ra8876_Lite::getBfcPackedStringWidth(const uint8_t *pFont, const uint16_t *str)
+{
+	Color color;
+	
+	if(str == 0 || !bfcp_Open(pFont))
+		return 0;
+	
+	return bfcp_String(0, 0, str, 0, color, color, false, CANVAS_OFFSET, false);
+}
+
+/**
+ * @brief	Return width of a UTF-8 string in pixels with a packed font, kerning included.
+ */
+uint16_t Ra8876_Lite::getBfcPackedStringWidth(const uint8_t *pFont, const char *str)
+{
+	Color color;
+	
+	if(str == 0 || !bfcp_Open(pFont))
+		return 0;
+	
+	return bfcp_String(0, 0, 0, str, color, color, false, CANVAS_OFFSET, false);
+}
+
+/**
+ * @brief	Return font height in pixels of a packed font, 0 if pFont is not valid.
+ */
+uint16_t Ra8876_Lite::getBfcPackedFontHeight(const uint8_t *pFont)
+{
+	if(!bfcp_Open(pFont))
+		return 0;
+	
+	return _bfcpFont.FontHeight;
+}
+#endif	//#if defined (LOAD_BFC_FONT)
+
+//**************************************************************//
+/*These 8 bits determine prescaler value for Timer 0 and 1.*/
+/*Time base is 鈥淐ore_Freq / (Prescaler + 1)鈥�*/
+//**************************************************************//
+void Ra8876_Lite::pwm_Prescaler(uint8_t prescaler)
+{
+  lcdRegDataWrite(RA8876_PSCLR,prescaler);//84h
+}
+//**************************************************************//
+//**************************************************************//
+void Ra8876_Lite::pwm_ClockMuxReg(uint8_t pwm1_clk_div, uint8_t pwm0_clk_div, uint8_t xpwm1_ctrl, uint8_t xpwm0_ctrl)
+{
+  lcdRegDataWrite(RA8876_PMUXR,pwm1_clk_div<<6|pwm0_clk_div<<4|xpwm1_ctrl<<2|xpwm0_ctrl);//85h
+}
+//**************************************************************//
+//**************************************************************//
+void Ra8876_Lite::pwm_Configuration(uint8_t pwm1_inverter,uint8_t pwm1_auto_reload,uint8_t pwm1_start,uint8_t 
+                       pwm0_dead_zone, uint8_t pwm0_inverter, uint8_t pwm0_auto_reload,uint8_t pwm0_start)
+ {
+  lcdRegDataWrite(RA8876_PCFGR,pwm1_inverter<<6|pwm1_auto_reload<<5|pwm1_start<<4|pwm0_dead_zone<<3|
+                  pwm0_inverter<<2|pwm0_auto_reload<<1|pwm0_start);//86h                
+ }   
+//**************************************************************//
+//**************************************************************//
+void Ra8876_Lite::pwm0_Duty(uint16_t duty)
+{
+  lcdRegDataWrite(RA8876_TCMPB0L,duty);//88h 
+  lcdRegDataWrite(RA8876_TCMPB0H,duty>>8);//89h 
+}
+//**************************************************************//
+//**************************************************************//
+void Ra8876_Lite::pwm0_ClocksPerPeriod(uint16_t clocks_per_period)
+{
+  lcdRegDataWrite(RA8876_TCNTB0L,clocks_per_period);//8ah
+  lcdRegDataWrite(RA8876_TCNTB0H,clocks_per_period>>8);//8bh
+}
+//**************************************************************//
+//**************************************************************//
+void Ra8876_Lite::pwm1_Duty(uint16_t duty)
+{
+  lcdRegDataWrite(RA8876_TCMPB1L,duty);//8ch 
+  lcdRegDataWrite(RA8876_TCMPB1H,duty>>8);//8dh
+}
+//**************************************************************//
+//**************************************************************//
+void Ra8876_Lite::pwm1_ClocksPerPeriod(uint16_t clocks_per_period)
+{
+  lcdRegDataWrite(RA8876_TCNTB1L,clocks_per_period);//8eh
+  lcdRegDataWrite(RA8876_TCNTB1F,clocks_per_period>>8);//8fh
+}
+
+/**
+ * @brief Portal for SDRAM memory write
+ */
+void Ra8876_Lite:: ramAccessPrepare(void)
+{
+  lcdRegWrite(RA8876_MRWDP); //04h
+}
+
+/**
+ * @brief Set foreground color
+ * @param color is an object composed of 4 components: red, green, blue, alpha
+ * @note  Example to use:<br>
+ *        Ra8876_Lite ra8876lite;<br>
+ *        Color color;<br>
+ *        ra8876lite.setForegroundColor(color.Red);   //set red as the foreground color<br>
+ *        delay(1000);<br>
+ *        ra8876lite.setForegroundColor(color.Green); <br>
+ *        delay(1000);<br>
+ *        ra8876lite.setForegroundColor(color.Blue); <br>
+ *        No foreground transparency is supported for RA8876 therefore alpha is always = 255<br>
+ *        MSB for each component is used <br>
+ *        Example, color.r[7:5] is used for component red in 8BPP<br>
+ *        color.g[7:5] used for component green in 16BPP.
+ */
+void Ra8876_Lite::setForegroundColor(Color color)
+{
+  uint8_t _mode = getColorMode();
+
+  switch(_mode)
+  {
+    case COLOR_8BPP_RGB332:   //RGB in 3:3:2
+          lcdRegDataWrite(RA8876_FGCR,(color.r&0xE0)); //d2h[7:5]
+          lcdRegDataWrite(RA8876_FGCG,(color.g&0xE0)); //d3h[7:5]
+          lcdRegDataWrite(RA8876_FGCB,(color.b&0xC0)); //d4h[7:6]
+          break;
+    case COLOR_24BPP_RGB888:  //RGB in 8:8:8
+          lcdRegDataWrite(RA8876_FGCR,color.r); //d2h[7:0]
+          lcdRegDataWrite(RA8876_FGCG,color.g); //d3h[7:0]
+          lcdRegDataWrite(RA8876_FGCB,color.b); //d4h[7:0]
+          break;
+    default:  //RGB in 5:6:5
+          lcdRegDataWrite(RA8876_FGCR,(color.r&0xF8));//d2h[7:3]
+          lcdRegDataWrite(RA8876_FGCG,(color.g&0xFC));//d3h[7:2]
+          lcdRegDataWrite(RA8876_FGCB,(color.b&0xF8));//d4h[7:3]
+  } 
+}
+
+/**
+ * @brief Set background color
+ * @param color is an object composed of 4 components: red, green, blue, alpha
+ * @note  Example to use:<br>
+ *        Ra8876_Lite ra8876lite;<br>
+ *        Color bg;<br>
+ *        ra8876lite.setBackgroundColor(bg.Red);   //set red as the background color<br>
+ *        delay(1000);<br>
+ *        ra8876lite.setBackgroundColor(bg.Green); <br>
+ *        delay(1000);<br>
+ *        ra8876lite.setBackgroundColor(bg.Blue); <br>
+ *        No background transparency is supported for RA8876 therefore alpha is always = 255<br>
+ *        MSB for each component is used <br>
+ *        Example, color.r[7:5] is used for component red in 8BPP<br>
+ *        color.g[7:5] used for component green in 16BPP.
+ */
+void Ra8876_Lite::setBackgroundColor(Color color)
+{
+  uint8_t _mode = getColorMode();
+
+  switch(_mode)
+  {
+    case COLOR_8BPP_RGB332:   //RGB in 3:3:2
+          lcdRegDataWrite(RA8876_BGCR,(color.r&0xE0)); //d5h[7:5]
+          lcdRegDataWrite(RA8876_BGCG,(color.g&0xE0)); //d6h[7:5]
+          lcdRegDataWrite(RA8876_BGCB,(color.b&0xC0)); //d7h[7:6]
+          break;
+    case COLOR_24BPP_RGB888:  //RGB in 8:8:8
+          lcdRegDataWrite(RA8876_BGCR,color.r); //d5h[7:0]
+          lcdRegDataWrite(RA8876_BGCG,color.g); //d6h[7:0]
+          lcdRegDataWrite(RA8876_BGCB,color.b); //d7h[7:0]
+          break;
+    default:  //RGB in 5:6:5
+          lcdRegDataWrite(RA8876_BGCR,(color.r&0xF8));//d5h[7:3]
+          lcdRegDataWrite(RA8876_BGCG,(color.g&0xFC));//d6h[7:2]
+          lcdRegDataWrite(RA8876_BGCB,(color.b&0xF8));//d7h[7:3]
+  }    
+}
+
+/**
+ * @brief 	Set graphic mode ON or OFF
+ * @param	on is a boolean flag to set <br>
+ *			'true' or '1' for Graphic Mode
+ *			'false' or '0' for Text Mode
+ */
+ void Ra8876_Lite::graphicMode(bool on)
+ {
+  if(on)
+   lcdRegDataWrite(RA8876_ICR,RA8876_GRAPHIC_MODE<<2|RA8876_MEMORY_SELECT_IMAGE);//03h  //switch to graphic mode
+  else
+   lcdRegDataWrite(RA8876_ICR,RA8876_TEXT_MODE<<2|RA8876_MEMORY_SELECT_IMAGE);//03h  //switch back to text mode
+ }
+
+
+ /**
+ * @brief Put pixel at (x,y) with color object of components (r,g,b,a)
+ * @param x,y indicate the pixel coordinates
+ * @param color in r,g,b components
+ * @param lnOffset is the canvas start address represented in line number
+ */
+void Ra8876_Lite::putPixel(uint16_t x, uint16_t y, Color color, uint32_t lnOffset)
+{
+	setPixelCursor(x,y,lnOffset);
+	ramAccessPrepare(); 
+  
+  switch(_colorMode)
+  {
+    case COLOR_8BPP_RGB332:
+          lcdDataWrite((color.r&0xE0) | (color.g&0xE0)>>3 | (color.b&0xC0)>>6);
+        break;
+    case COLOR_24BPP_RGB888:
+          lcdDataWrite(color.b);
+          lcdDataWrite(color.g);
+          lcdDataWrite(color.r);
+        break;
+	case COLOR_6BPP_ARGB2222:
+		  lcdDataWrite((color.a&0x06)<<5 | (color.r&0xC0)>>2 | (color.g&0xC0)>>4 | (color.b&0xC0)>>6);
+		break;
+    case COLOR_12BPP_ARGB4444:
+          lcdDataWrite((color.g&0xF0) | (color.b&0xF0)>>4);
+          lcdDataWrite((color.a&0x0F)<<4 | (color.r&0xF0)>>4);
+        break;
+    default:  //case COLOR_16BPP_RGB565:
+          lcdDataWrite((color.g&0x1C)<<3 | (color.b&0xF8)>>3);
+          lcdDataWrite((color.r&0xF8) | (color.g&0xE0)>>5);
+  }
+}
+
+/**
+ * @brief Set cursor position and active window before data write to SDRAM (Canvas).
+ * @param x,y is the top left corner coordinates.
+ * @param width, height indicate the dimension in pixels.
+ * @param lnOffset indicates the Canvas Address offset in line number.
+ * @note  Coordinates (x,y) are relative to the Canvas Start Address. 
+ *		  This function is required before writing pixels to SDRAM.
+ */
+void Ra8876_Lite:: putPicture_set_frame(uint16_t x,uint16_t y,uint16_t width, uint16_t height, uint32_t lnOffset)
+{	
+	activeWindowXY(x,y);
+	activeWindowWH(width,height);
+	setPixelCursor(x,y, lnOffset);
+	
+	ramAccessPrepare();
+}
+
+/**
+ * @brief	This function converts line number to physical address for Canvas.
+ * @param	lnOffset indicates line offset position.
+ * @return	Canvas Address or -1 if lnOffset out-of-range.
+ *			
+ */
+int32_t Ra8876_Lite::canvasAddress_from_lnOffset(uint32_t lnOffset)
+{
+	int32_t _canvasAddress = -1;
+	
+	uint8_t bpp = getColorDepth();
+	
+	if(lnOffset <= (uint32_t)(MEM_SIZE_MAX/(_canvasWidth*bpp)-1))
+	{
+		_canvasAddress = lnOffset*_canvasWidth*bpp;
+	}
+	
+	return _canvasAddress;
+}
+
+/**
+ * @brief Draw picture from a static 8-bit data array from Flash.
+ * @param x,y is the top left corner coordinates. Max x,y = 8192.
+ * @param width, height indicate the dimension in pixels.
+ * @param *data is a void pointer to a static array of 8-bit or 16-bit data.
+ * @note  Data cast please refer to the note section of function canvasWrite(args).
+ * @param rotate_ccw90 is a boolean flag to rotate a single character in counter clockwise 90 degrees.
+ * @param lnOffset indicates line offset position.
+ * @note  Default value of lnOffset = CANVAS_OFFSET which is the starting address of the Main Display Window.
+ *		  One may override this parameter with a non-display line number (e.g. lnOffset = 721) to 
+ *		  write an image to some off-screen area. This can avoid a "snail-like" pixel rastering to be 
+ *		  visible. This is particularly important for slow MCUs like Arduino or mbed as we are using
+ * 		  only a slow SPI bus (4MHz in some case!) with these platforms. After rendering is completed,
+ *		  a 2D function bteMemoryCopyWithROP(args) can be used to copy the data from non-display region
+ *		  to the Main Display Window with a single instruction. 
+ *		  It is also important to notice that coordinates x,y are relative to Canvas Starting Address 
+ *		  thus y is relative to lnOffset. For example, setting y=10 with lnOffset = 721 will draw 
+ *		  data starting from the line 731.
+ *		  
+ */
+void Ra8876_Lite:: putPicture(	uint16_t x, uint16_t y,
+								uint16_t width, uint16_t height, 
+								const void* data, 
+								bool rotate_ccw90,
+								uint32_t lnOffset)
+{
+	uint16_t _x=x, _y=y, _width=width, _height=height;
+	uint8_t MACR;
+/*	
+	int32_t _canvasAddress = canvasAddress_from_lnOffset(lnOffset);
+	if(_canvasAddress<0) return;
+	
+	canvasImageStartAddress(_canvasAddress);
+*/
+	///Important::need to set RA8876_MACR prior to putPicture_set_frame() otherwise it doesn't work!
+	///Change the host to Memory write direction 
+	if(rotate_ccw90){
+		_width = height; _height = width;
+		_x = y; _y = x;
+		MACR = lcdRegDataRead(RA8876_MACR); //read REG[02h]
+		lcdRegDataWrite(RA8876_MACR, MACR|0x06);  		
+	}	
+	//coordinates (x,y) is relative to the canvas address with max x,y=8192
+	putPicture_set_frame(_x,_y,_width,_height,lnOffset);
+	
+	size_t _length = (size_t)width*height*getColorDepth();	//bpp=1 for 8BPP, =2 for 16BPP, and =3 for 24BPP
+	hal_spi_write((const uint8_t*)data, _length);			//push data via SPI port with different data length for each BPP
+
+	if(rotate_ccw90)
+	{
+		lcdRegDataWrite(RA8876_MACR, MACR);  
+	}
+	
+	//Active window restore
+	activeWindowXY(ACTIVE_WINDOW_STARTX,ACTIVE_WINDOW_STARTY);
+	activeWindowWH(_canvasWidth,_canvasHeight);
+	canvasImageStartAddress(CANVAS_OFFSET);
+}
+
+#if defined (LOAD_SD_LIBRARY)
+/**
+ * @brief Draw picture from a RAiO binary file. A file system with SD.h is assumed here.
+ * @param x,y is the top left corner coordinates. Max x,y = 8192.
+ * @param width, height indicate the dimension in pixels.
+ * @param *pFilename is a pointer to the filename.
+ * @param rotate_ccw90 is a boolean flag to rotate a single character in counter clockwise 90 degrees.
+ * @param lnOffset indicates Canvas Address offset in line number.
+ * @note  This is a blocking function as we are reading and writing from an external media (SD card) to SDRAM pixel-by-pixel.
+ */
+void Ra8876_Lite::putPicture(	uint16_t x, uint16_t y,
+								uint16_t width, uint16_t height, 
+								const char *pFilename, 
+								bool rotate_ccw90,
+								uint32_t lnOffset)
+{
+	uint16_t _x=x, _y=y, _width=width, _height=height;
+	uint8_t MACR;
+	
+	File gfxFile = SD.open(pFilename);
+	
+	if(!gfxFile) return;
+			
+	int32_t _canvasAddress = canvasAddress_from_lnOffset(lnOffset);
+	if(_canvasAddress<0) return;
+	
+	canvasImageStartAddress(_canvasAddress);
+	///Important::need to set RA8876_MACR prior to putPicture_set_frame() otherwise it doesn't work!
+	///Change the host to Memory write direction 
+	if(rotate_ccw90){
+		_width = height; _height = width;
+		_x = y; _y = x;
+		MACR = lcdRegDataRead(RA8876_MACR); //read REG[02h]
+		lcdRegDataWrite(RA8876_MACR, MACR|0x06);  	///Change to bottom->top, left->right scanning	
+	}
+	//coordinates (x,y) is relative to the canvas address with max x,y=8192
+	putPicture_set_frame(_x,_y,_width,_height,lnOffset);
+			
+	uint16_t _ln = width*getColorDepth();
+	uint8_t lnBuffer[_ln];	//Mind its size for MCU with low SRAM(e.g. Arduino M0). A picture of 1280 pixels (say) width in 24BPP needs
+							//1280*3 bytes for this array. Just in case this module is not working, adjust the line buffer size by reducing _ln
+	while(gfxFile.available())
+	{
+		gfxFile.read((uint8_t *)lnBuffer, _ln);
+		hal_spi_write(lnBuffer, _ln);
+	}
+	
+	if(rotate_ccw90)
+	{
+		lcdRegDataWrite(RA8876_MACR, MACR);  	//restore left->right, top->bottom scanning
+	}
+	/*
+	//This is less efficient
+	uint8_t bpp = getColorDepth();
+	switch(bpp)
+	{
+		case 1:
+			while(gfxFile.available()){
+			lcdDataWrite((uint8_t)gfxFile.read());	}
+			break;
+		case 2:
+			while(gfxFile.available()){
+			lcdDataWrite((uint8_t)gfxFile.read());lcdDataWrite((uint8_t)gfxFile.read()); }
+			break;
+		case 3:
+			while(gfxFile.available()){
+			lcdDataWrite((uint8_t)gfxFile.read());lcdDataWrite((uint8_t)gfxFile.read());lcdDataWrite((uint8_t)gfxFile.read());}
+			break;
+	}
+	*/
+	gfxFile.close();
+	
+	//Active Window restore
+	activeWindowXY(ACTIVE_WINDOW_STARTX,ACTIVE_WINDOW_STARTY);
+	activeWindowWH(_canvasWidth,_canvasHeight);
+	canvasImageStartAddress(CANVAS_OFFSET);
+}
+#endif
+
+/**
+ * @brief	Return the number of packet bytes readable at rd->p, refilling the buffer from file when it is empty.
+ * @param	*rd is the packet data source
+ * @return	Bytes available from rd->p to rd->end, 0 at the end of data
+ */
+uint32_t Ra8876_Lite::rle_Available(RLE_READER *rd)
+{
+#if defined (LOAD_SD_LIBRARY)
+	if(rd->p == rd->end && rd->file != NULL && rd->remain)
+	{
+		uint32_t n = (rd->remain < rd->bufSize) ? rd->remain : rd->bufSize;
+		int got = ((File *)rd->file)->read(rd->buf, n);
+		if(got <= 0)
+		{
+			rd->remain = 0;
+			return 0;
+		}
+		rd->p = rd->buf;
+		rd->end = rd->buf + got;
+		rd->remain -= got;
+	}
+#endif
+	return (uint32_t)(rd->end - rd->p);
+}
+
+/**
+ * @brief	Read one byte of packet data
+ * @return	Byte value, or -1 at the end of data
+ */
+int Ra8876_Lite::rle_ReadByte(RLE_READER *rd)
+{
+	if(rle_Available(rd) == 0)
+		return -1;
+	return *rd->p++;
+}
+
+/**
+ * @brief	Convert the bytes of one pixel in the current color mode back to a color, the inverse of a memory write.
+ * @param	*px points to 1, 2 or 3 bytes of a pixel
+ */
+Color Ra8876_Lite::rle_PixelColor(const uint8_t *px)
+{
+	switch(_colorMode)
+	{
+		case COLOR_8BPP_RGB332:
+			return Color(px[0]&0xE0, (px[0]&0x1C)<<3, (px[0]&0x03)<<6);
+		case COLOR_24BPP_RGB888:
+			return Color(px[2], px[1], px[0]);
+		default:	//case COLOR_16BPP_RGB565:
+			return Color(px[1]&0xF8, (px[1]&0x07)<<5 | (px[0]&0xE0)>>3, (px[0]&0x1F)<<3);
+	}
+}
+
+/**
+ * @brief	Draw a run of pixels of the foreground color by BTE solid fill and advance the decoder position.
+ * @param	x,y is the top left corner of the image
+ * @param	width is the image width
+ * @param	*cx,*cy is the decoder position relative to (x,y), updated past the run
+ * @param	count is the run length in pixels, which may wrap over several rows
+ * @note	BTE destination address, image width, operation and color are set by the caller.
+ *			A run is at most three rectangles: the rest of the current row, a block of full rows and the head of the last row.
+ */
+void Ra8876_Lite::rle_Fill(uint16_t x, uint16_t y, uint16_t width, uint16_t *cx, uint16_t *cy, uint32_t count)
+{
+	uint16_t len, rows;
+
+	while(count)
+	{
+		if(*cx == 0 && count >= width)
+		{
+			rows = count / width;
+			len = width;
+		}
+		else
+		{
+			rows = 1;
+			len = (count < (uint32_t)(width - *cx)) ? count : width - *cx;
+		}
+
+		bte_DestinationWindowStartXY(x + *cx, y + *cy);
+		bte_WindowSize(len, rows);
+		lcdRegDataWrite(RA8876_BTE_CTRL0,RA8876_BTE_ENABLE<<4);//90h
+		check2dBusy();
+
+		count -= (uint32_t)len * rows;
+		*cx += len;
+		*cy += rows - 1;
+		if(*cx == width)
+		{
+			*cx = 0;
+			(*cy)++;
+		}
+	}
+}
+
+/**
+ * @brief	Decode the packets of a run-length compressed image to the canvas.
+ * @param	x,y is the top left corner coordinates
+ * @param	*pImage is the image header decoded by RleOpen()
+ * @param	*rd is the packet data source
+ * @param	lnOffset is the Canvas Address offset in line number
+ * @return	true if all pixels are drawn, false on a color depth mismatch or truncated data
+ * @note	The active window is set to the image so streamed pixels wrap at the right edge like putPicture().
+ *			A run of RLEI_FILL_MIN_BYTES or more becomes BTE solid fills and the memory write cursor is moved
+ *			only when pixels are streamed again after a fill. Shorter runs are expanded and gathered with literals
+ *			into bursts of RLE_BURST_SIZE bytes, so small packets do not each pay for a chip select and a command byte.
+ */
+bool Ra8876_Lite::rle_Draw(uint16_t x, uint16_t y, const RLE_IMAGE *pImage, RLE_READER *rd, uint32_t lnOffset)
+{
+	uint8_t bpp = getColorDepth();
+	uint16_t width = pImage->Width;
+	uint32_t total = (uint32_t)pImage->Width*pImage->Height, done = 0, count, n;
+	uint16_t cx = 0, cy = 0;
+	bool streaming = true;
+	int h, lo, hi;
+	uint8_t px[3], last[3] = {0, 0, 0}, i;
+	bool fgSet = false;
+	uint8_t burst[RLE_BURST_SIZE];	//short runs and literals are gathered into one SPI burst
+	uint16_t queued = 0;
+
+	if(pImage->Bpp != bpp)
+	{
+		printf("RLE image has %d bytes per pixel, canvas has %d\n", pImage->Bpp, bpp);
+		return false;
+	}
+
+	int32_t _canvasAddress = canvasAddress_from_lnOffset(lnOffset);
+	if(_canvasAddress<0) return false;
+
+	//BTE registers are set once for all runs of the image, they must be written before memory write is prepared
+	bte_DestinationMemoryStartAddr(_canvasAddress);
+	bte_DestinationImageWidth(_canvasWidth);
+	lcdRegDataWrite(RA8876_BTE_CTRL1,RA8876_BTE_SOLID_FILL);//91h
+
+	putPicture_set_frame(x,y,pImage->Width,pImage->Height,lnOffset);
+
+	while(done < total)
+	{
+		h = rle_ReadByte(rd);
+		if(h < 0) break;
+		count = h & RLEI_COUNT_MASK;
+		if(count == 0)
+		{
+			lo = rle_ReadByte(rd);
+			hi = rle_ReadByte(rd);
+			if(lo < 0 || hi < 0) break;
+			count = lo | (uint32_t)hi<<8;
+		}
+		if(count > total - done)
+			count = total - done;
+
+		if(h & RLEI_RUN)
+		{
+			for(i = 0; i < bpp; i++)
+			{
+				int b = rle_ReadByte(rd);
+				if(b < 0) break;
+				px[i] = b;
+			}
+			if(i < bpp) break;
+
+			if(count*bpp >= RLEI_FILL_MIN_BYTES)
+			{
+				if(queued)
+				{
+					hal_spi_write(burst, queued);
+					queued = 0;
+				}
+				if(streaming) checkWriteFifoEmpty();	//pixels in FIFO land before BTE writes over the same memory
+				if(!fgSet || memcmp(px, last, bpp) != 0)
+				{
+					setForegroundColor(rle_PixelColor(px));
+					memcpy(last, px, bpp);
+					fgSet = true;
+				}
+				rle_Fill(x, y, width, &cx, &cy, count);
+				done += count;
+				streaming = false;
+				continue;
+			}
+		}
+
+		if(!streaming)
+		{
+			lcdRegDataWrite(RA8876_CURH0,x+cx); //5fh
+			lcdRegDataWrite(RA8876_CURH1,(x+cx)>>8);//60h
+			lcdRegDataWrite(RA8876_CURV0,y+cy);//61h
+			lcdRegDataWrite(RA8876_CURV1,(y+cy)>>8);//62h
+			ramAccessPrepare();
+			streaming = true;
+		}
+
+		if(h & RLEI_RUN)
+		{
+			for(n = 0; n < count; n++)
+			{
+				if(queued + bpp > sizeof(burst))
+				{
+					hal_spi_write(burst, queued);
+					queued = 0;
+				}
+				memcpy(burst + queued, px, bpp);
+				queued += bpp;
+			}
+		}
+		else
+		{
+			uint32_t left = count*bpp;
+			while(left)
+			{
+				n = rle_Available(rd);
+				if(n == 0) break;
+				if(n > left) n = left;
+				if(queued + n > sizeof(burst))
+				{
+					if(queued)
+					{
+						hal_spi_write(burst, queued);
+						queued = 0;
+					}
+					if(n >= sizeof(burst))	//long literal goes straight from the image data
+					{
+						hal_spi_write(rd->p, n);
+						rd->p += n;
+						left -= n;
+						continue;
+					}
+				}
+				memcpy(burst + queued, rd->p, n);
+				queued += n;
+				rd->p += n;
+				left -= n;
+			}
+			if(left) break;
+		}
+
+		done += count;
+		cx += count % width;
+		cy += count / width;
+		if(cx >= width)
+		{
+			cx -= width;
+			cy++;
+		}
+	}
+
+	if(queued)
+		hal_spi_write(burst, queued);
+
+	//Active window restore
+	activeWindowXY(ACTIVE_WINDOW_STARTX,ACTIVE_WINDOW_STARTY);
+	activeWindowWH(_canvasWidth,_canvasHeight);
+	canvasImageStartAddress(CANVAS_OFFSET);
+
+	return done == total;
+}
+
+/**
+ * @brief	Draw a run-length compressed image from a static array, e.g. a *.c file converted by extras/rlepack.
+ * @param	x,y is the top left corner coordinates
+ * @param	*data points to the image array in the format of src/rle/rleImage.h
+ * @param	lnOffset indicates Canvas Address offset in line number
+ * @return	true on success, false if data is not an RLE image of the current color depth or is truncated
+ * @note	Width and height are stored in the image. Flat UI art with long runs of one color takes a fraction of
+ *			the SPI bytes of putPicture(), as each long run is a BTE solid fill of a few register writes.
+ *			Example:<br>
+ *			extern const unsigned char rle_menuL[];<br>
+ *			ra8876lite.putRlePicture(0, 0, rle_menuL);<br>
+ */
+bool Ra8876_Lite::putRlePicture(uint16_t x, uint16_t y, const uint8_t *data, uint32_t lnOffset)
+{
+	RLE_IMAGE image;
+	RLE_READER rd;
+
+	if(RleOpen(data, &image) < 0)
+	{
+		printf("Not an RLE image\n");
+		return false;
+	}
+
+	rd.p = data + RLEI_HEADER_SIZE;
+	rd.end = rd.p + image.DataSize;
+	rd.file = NULL;
+	rd.buf = NULL;
+	rd.bufSize = 0;
+	rd.remain = 0;
+
+	return rle_Draw(x, y, &image, &rd, lnOffset);
+}
+
+#if defined (LOAD_SD_LIBRARY)
+/**
+ * @brief	Draw a run-length compressed image from a file on SD card converted by extras/rlepack.
+ * @param	x,y is the top left corner coordinates
+ * @param	*pFilename is a pointer to the filename
+ * @param	lnOffset indicates Canvas Address offset in line number
+ * @return	true on success, false if the file cannot be opened, is not an RLE image of the current color depth or is truncated
+ * @note	The file is read in blocks of RLE_SD_BUFFER_SIZE bytes. Only the compressed size is read from SD card.
+ */
+bool Ra8876_Lite::putRlePicture(uint16_t x, uint16_t y, const char *pFilename, uint32_t lnOffset)
+{
+	RLE_IMAGE image;
+	RLE_READER rd;
+	uint8_t buf[RLE_SD_BUFFER_SIZE];
+	bool ok;
+
+	File gfxFile = SD.open(pFilename);
+	if(!gfxFile) return false;
+
+	if(gfxFile.read(buf, RLEI_HEADER_SIZE) != RLEI_HEADER_SIZE || RleOpen(buf, &image) < 0)
+	{
+		printf("%s is not an RLE image\n", pFilename);
+		gfxFile.close();
+		return false;
+	}
+
+	rd.p = buf;
+	rd.end = buf;
+	rd.file = &gfxFile;
+	rd.buf = buf;
+	rd.bufSize = RLE_SD_BUFFER_SIZE;
+	rd.remain = image.DataSize;
+
+	ok = rle_Draw(x, y, &image, &rd, lnOffset);
+	gfxFile.close();
+	return ok;
+}
+#endif
+
+#if defined (LOAD_SD_LIBRARY)
+/**
+ * @note	Read callback of the JPEG decoder for a file on SD card
+ */
+static int img_ReadFile(void *user, uint8_t *buf, int size)
+{
+	return ((File *)user)->read(buf, size);
+}
+#endif
+
+/**
+ * @brief	Parse the headers of a JPEG image into the decoder shared by all JPEG functions.
+ * @param	*data,size is the image in memory, or NULL to read it by read(user)
+ * @param	*pName names the image in error messages
+ * @return	The decoder, or NULL if the image is not a baseline JPEG
+ * @note	The decoder takes about 5KB of RAM. It is static so that it stays off the stack of small MCUs.
+ */
+JPEG_DEC* Ra8876_Lite::jpg_Open(const uint8_t *data, uint32_t size, JPEG_READ_FN read, void *user, const char *pName)
+{
+	static JPEG_DEC dec;
+	int ret = JpegOpen(&dec, data, size, read, user);
+
+	if(ret == JPEG_ERR_UNSUPPORTED)
+	{
+		printf("%s is not a baseline JPEG, convert it by jpegtran -optimize\n", pName);
+		return NULL;
+	}
+	if(ret != JPEG_OK)
+	{
+		printf("%s is not a JPEG image\n", pName);
+		return NULL;
+	}
+	return &dec;
+}
+
+/**
+ * @brief	Draw callback of the JPEG and GIF decoders, write a strip of decoded pixels to SDRAM.
+ * @param	*user is an IMAGE_TARGET
+ * @param	x,y,w,h is the strip rectangle relative to the top left corner of the decoded image
+ * @param	*pixels holds w*h pixels in the current color depth
+ * @return	0 to continue decoding
+ * @note	A canvas target is an active window block write like putPicture(). Any other image, e.g. a BITMAP of
+ *			a width that is not a valid canvas width, is written by BTE MPU write.
+ *			BTE destination address, image width and operation (ROP12 or chroma key) are set by the caller.
+ */
+int Ra8876_Lite::img_DrawStrip(void *user, uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint8_t *pixels)
+{
+	IMAGE_TARGET *target = (IMAGE_TARGET *)user;
+	Ra8876_Lite *lcd = target->lcd;
+
+	lcd->checkWriteFifoEmpty();	//previous strip lands before the window is moved
+	if(target->imageWidth)
+	{
+		lcd->check2dBusy();
+		if(target->key)	//the key of a GIF frame is known once its palette is converted
+		{
+			lcd->setBackgroundColor(lcd->rle_PixelColor(target->key));
+			target->key = NULL;
+		}
+		lcd->bte_DestinationWindowStartXY(target->x + x, target->y + y);
+		lcd->bte_WindowSize(w, h);
+		lcd->lcdRegDataWrite(RA8876_BTE_CTRL0,RA8876_BTE_ENABLE<<4);//90h
+		lcd->ramAccessPrepare();
+	}
+	else
+		lcd->putPicture_set_frame(target->x + x, target->y + y, w, h, target->addr);
+	lcd->hal_spi_write(pixels, (uint32_t)w*h*lcd->getColorDepth());
+	return 0;
+}
+
+/**
+ * @brief	Decode an opened JPEG image to a target strip by strip.
+ * @param	*dec is a decoder returned by jpg_Open()
+ * @param	*target is the destination, a canvas if target->imageWidth is 0
+ * @param	scale is 0, 1, 2 or 3 to scale the picture by 1/1, 1/2, 1/4 or 1/8
+ * @return	true if the whole image is drawn, false on corrupted data
+ * @note	The strip buffer of JPEG_STRIP_SIZE bytes doubles as the MCU row buffer of the decoder,
+ *			so a strip is as many MCUs side by side as fit in it and each strip is one block write.
+ */
+bool Ra8876_Lite::jpg_Draw(JPEG_DEC *dec, IMAGE_TARGET *target, uint8_t scale)
+{
+	static uint8_t strip[JPEG_STRIP_SIZE];
+	int ret;
+
+	target->lcd = this;
+	target->key = NULL;
+	if(target->imageWidth)
+	{
+		bte_DestinationMemoryStartAddr(target->addr);
+		bte_DestinationImageWidth(target->imageWidth);
+		lcdRegDataWrite(RA8876_BTE_CTRL1,RA8876_BTE_ROP_CODE_12<<4|RA8876_BTE_MPU_WRITE_WITH_ROP);//91h
+	}
+
+	ret = JpegDecode(dec, scale, getColorDepth(), strip, sizeof(strip), img_DrawStrip, target);
+	checkWriteFifoEmpty();
+
+	if(target->imageWidth)
+		check2dBusy();
+	else
+	{
+		//Active window restore
+		activeWindowXY(ACTIVE_WINDOW_STARTX,ACTIVE_WINDOW_STARTY);
+		activeWindowWH(_canvasWidth,_canvasHeight);
+		canvasImageStartAddress(CANVAS_OFFSET);
+	}
+
+	if(ret != JPEG_OK)
+		printf("JPEG decoding stopped (%d)\n", ret);
+	return ret == JPEG_OK;
+}
+
+/**
+ * @brief	Get the dimension of a JPEG image in memory without decoding it.
+ * @param	*data,size is the JPEG file in memory
+ * @param	*width,*height return the full size dimension, see JPEG_SCALED() for a scaled one
+ * @return	true on success, false if data is not a baseline JPEG
+ */
+bool Ra8876_Lite::getJpegSize(const uint8_t *data, uint32_t size, uint16_t *width, uint16_t *height)
+{
+	JPEG_DEC *dec = jpg_Open(data, size, NULL, NULL, "Image");
+
+	if(dec == NULL) return false;
+	*width = dec->width;
+	*height = dec->height;
+	return true;
+}
+
+/**
+ * @brief	Decode a baseline JPEG image from a static array to the canvas.
+ * @param	x,y is the top left corner coordinates
+ * @param	*data,size is the JPEG file in memory, e.g. converted to a C array
+ * @param	scale is 0, 1, 2 or 3 to draw the picture at 1/1, 1/2, 1/4 or 1/8 of its size
+ * @param	lnOffset indicates Canvas Address offset in line number
+ * @return	true on success, false if data is not a baseline JPEG or is corrupted
+ * @note	The picture is decoded in strips of JPEG_STRIP_SIZE bytes, each written by one block write.
+ *			Progressive files are not supported, convert them by "jpegtran -optimize in.jpg > out.jpg".<br>
+ *			Example:<br>
+ *			ra8876lite.putJpeg(0, 0, kiss_jpg, sizeof(kiss_jpg), 1);	//half size
+ */
+bool Ra8876_Lite::putJpeg(uint16_t x, uint16_t y, const uint8_t *data, uint32_t size, uint8_t scale, uint32_t lnOffset)
+{
+	IMAGE_TARGET target;
+	JPEG_DEC *dec = jpg_Open(data, size, NULL, NULL, "Image");
+
+	if(dec == NULL) return false;
+	if(canvasAddress_from_lnOffset(lnOffset)<0) return false;
+
+	target.x = x;
+	target.y = y;
+	target.addr = lnOffset;
+	target.imageWidth = 0;
+	return jpg_Draw(dec, &target, scale);
+}
+
+/**
+ * @brief	Decode a baseline JPEG image from a static array to any image in SDRAM by BTE MPU write.
+ * @param	des_addr is the start address of the destination image, e.g. BITMAP::getAddress()
+ * @param	des_image_width is the destination image width, e.g. BITMAP::getWidth()
+ * @param	des_x,des_y is the top left corner in the destination image
+ * @param	*data,size is the JPEG file in memory
+ * @param	scale is 0, 1, 2 or 3 to draw the picture at 1/1, 1/2, 1/4 or 1/8 of its size
+ * @return	true on success, false if data is not a baseline JPEG or is corrupted
+ */
+bool Ra8876_Lite::bteJpeg(uint32_t des_addr, uint16_t des_image_width, uint16_t des_x, uint16_t des_y, const uint8_t *data, uint32_t size, uint8_t scale)
+{
+	IMAGE_TARGET target;
+	JPEG_DEC *dec = jpg_Open(data, size, NULL, NULL, "Image");
+
+	if(dec == NULL) return false;
+
+	target.x = des_x;
+	target.y = des_y;
+	target.addr = des_addr;
+	target.imageWidth = des_image_width;
+	return jpg_Draw(dec, &target, scale);
+}
+
+#if defined (LOAD_SD_LIBRARY)
+/**
+ * @brief	Get the dimension of a JPEG file on SD card without decoding it.
+ * @param	*pFilename is a pointer to the filename
+ * @param	*width,*height return the full size dimension, see JPEG_SCALED() for a scaled one
+ * @return	true on success, false if the file cannot be opened or is not a baseline JPEG
+ */
+bool Ra8876_Lite::getJpegSize(const char *pFilename, uint16_t *width, uint16_t *height)
+{
+	File gfxFile = SD.open(pFilename);
+	if(!gfxFile) return false;
+
+	JPEG_DEC *dec = jpg_Open(NULL, 0, img_ReadFile, &gfxFile, pFilename);
+	gfxFile.close();
+
+	if(dec == NULL) return false;
+	*width = dec->width;
+	*height = dec->height;
+	return true;
+}
+
+/**
+ * @brief	Decode a baseline JPEG file on SD card to the canvas.
+ * @param	x,y is the top left corner coordinates
+ * @param	*pFilename is a pointer to the filename
+ * @param	scale is 0, 1, 2 or 3 to draw the picture at 1/1, 1/2, 1/4 or 1/8 of its size
+ * @param	lnOffset indicates Canvas Address offset in line number
+ * @return	true on success, false if the file cannot be opened, is not a baseline JPEG or is corrupted
+ * @note	Only the compressed file is read from SD card, in blocks of JPEG_INBUF_SIZE bytes.
+ *			This is typically 5 to 20 times less than the RAiO *.bin file of the same picture.
+ */
+bool Ra8876_Lite::putJpeg(uint16_t x, uint16_t y, const char *pFilename, uint8_t scale, uint32_t lnOffset)
+{
+	IMAGE_TARGET target;
+	JPEG_DEC *dec;
+	bool ok;
+
+	if(canvasAddress_from_lnOffset(lnOffset)<0) return false;
+
+	File gfxFile = SD.open(pFilename);
+	if(!gfxFile) return false;
+
+	dec = jpg_Open(NULL, 0, img_ReadFile, &gfxFile, pFilename);
+	if(dec == NULL)
+	{
+		gfxFile.close();
+		return false;
+	}
+
+	target.x = x;
+	target.y = y;
+	target.addr = lnOffset;
+	target.imageWidth = 0;
+	ok = jpg_Draw(dec, &target, scale);
+	gfxFile.close();
+	return ok;
+}
+
+/**
+ * @brief	Decode a baseline JPEG file on SD card to any image in SDRAM by BTE MPU write.
+ * @param	des_addr is the start address of the destination image, e.g. BITMAP::getAddress()
+ * @param	des_image_width is the destination image width, e.g. BITMAP::getWidth()
+ * @param	des_x,des_y is the top left corner in the destination image
+ * @param	*pFilename is a pointer to the filename
+ * @param	scale is 0, 1, 2 or 3 to draw the picture at 1/1, 1/2, 1/4 or 1/8 of its size
+ * @return	true on success, false if the file cannot be opened, is not a baseline JPEG or is corrupted
+ */
+bool Ra8876_Lite::bteJpeg(uint32_t des_addr, uint16_t des_image_width, uint16_t des_x, uint16_t des_y, const char *pFilename, uint8_t scale)
+{
+	IMAGE_TARGET target;
+	JPEG_DEC *dec;
+	bool ok;
+
+	File gfxFile = SD.open(pFilename);
+	if(!gfxFile) return false;
+
+	dec = jpg_Open(NULL, 0, img_ReadFile, &gfxFile, pFilename);
+	if(dec == NULL)
+	{
+		gfxFile.close();
+		return false;
+	}
+
+	target.x = des_x;
+	target.y = des_y;
+	target.addr = des_addr;
+	target.imageWidth = des_image_width;
+	ok = jpg_Draw(dec, &target, scale);
+	gfxFile.close();
+	return ok;
+}
+#endif
+
+/**
+ * @brief	Parse the header of a GIF image into the decoder shared by all GIF functions.
+ * @param	*data,size is the image in memory, or NULL to read it by read(user)
+ * @param	*pName names the image in error messages
+ * @return	The decoder, or NULL if the image is not a GIF
+ * @note	The decoder takes about 14KB of RAM for its LZW dictionary and palettes. It is static so that it stays
+ *			off the stack of small MCUs.
+ */
+GIF_DEC* Ra8876_Lite::gif_Open(const uint8_t *data, uint32_t size, GIF_READ_FN read, void *user, const char *pName)
+{
+	static GIF_DEC dec;
+
+	if(GifOpen(&dec, data, size, read, user) != GIF_OK)
+	{
+		printf("%s is not a GIF image\n", pName);
+		return NULL;
+	}
+	return &dec;
+}
+
+/**
+ * @brief	Solid fill a rectangle of an image of any width in SDRAM.
+ * @param	des_addr,des_image_width is the destination image
+ * @param	x,y,width,height is the rectangle
+ * @param	color is the fill color
+ */
+void Ra8876_Lite::gif_Fill(uint32_t des_addr, uint16_t des_image_width, uint16_t x, uint16_t y, uint16_t width, uint16_t height, Color color)
+{
+	bte_DestinationMemoryStartAddr(des_addr);
+	bte_DestinationImageWidth(des_image_width);
+	bte_DestinationWindowStartXY(x,y);
+	setForegroundColor(color);
+	bte_WindowSize(width,height);
+	lcdRegDataWrite(RA8876_BTE_CTRL1,RA8876_BTE_SOLID_FILL);//91h
+	lcdRegDataWrite(RA8876_BTE_CTRL0,RA8876_BTE_ENABLE<<4);//90h
+	check2dBusy();
+}
+
+/**
+ * @brief	Decode all frames of an opened GIF image into SDRAM, one full logical screen per frame.
+ * @param	*dec is a decoder returned by gif_Open()
+ * @param	*anim returns the frame table
+ * @param	sdram_addr,sdram_size is the SDRAM area for the frames
+ * @return	Number of frames decoded, 0 on error
+ * @note	Frame k starts as a BTE memory copy of the screen left by the disposal of the frames before it, then its
+ *			sub-rectangle is decoded over it by BTE MPU write, with chroma key if it has transparent pixels.
+ *			Disposal to background is a BTE solid fill of the frame rectangle in the next frame. Disposal to previous
+ *			starts the next frame from the same screen as this one. A frame that covers the whole screen without
+ *			transparency skips the copy.
+ */
+int Ra8876_Lite::gif_Load(GIF_DEC *dec, GIF_ANIM *anim, uint32_t sdram_addr, uint32_t sdram_size)
+{
+	static uint8_t strip[GIF_STRIP_SIZE];
+	GIF_FRAME *f = &dec->frame;
+	IMAGE_TARGET target;
+	uint8_t bpp = getColorDepth();
+	uint16_t w = dec->width, h = dec->height;
+	int32_t base = -1;				//frame the next frame starts from, -1 for the background
+	uint16_t fill[4] = {0, 0, 0, 0};	//rectangle restored to background in the next frame, none if width is 0
+	uint32_t slot;
+	Color bg(0, 0, 0);
+	int ret;
+
+	if(sdram_addr >= CGRAM_START_ADDR || sdram_size > CGRAM_START_ADDR - sdram_addr)
+	{
+		printf("GIF frames at 0x%lx overlap CGRAM\n", (unsigned long)sdram_addr);
+		anim->numFrames = 0;
+		return 0;
+	}
+
+	if(dec->globalColors && dec->background < dec->globalColors)
+		bg = Color(dec->globalPalette[3*dec->background], dec->globalPalette[3*dec->background+1], dec->globalPalette[3*dec->background+2]);
+
+	anim->width = w;
+	anim->height = h;
+	anim->addr = sdram_addr;
+	anim->frameSize = ((uint32_t)w*h*bpp + 3) & ~3UL;	//frames start at a 32-bit boundary
+	anim->numFrames = 0;
+	gifRewind(anim);
+
+	target.lcd = this;
+	target.x = 0;
+	target.y = 0;
+	target.imageWidth = w;
+
+	while((ret = GifNextFrame(dec)) == 1)
+	{
+		if(anim->numFrames == GIF_MAX_FRAMES || (uint32_t)(anim->numFrames + 1)*anim->frameSize > sdram_size)
+		{
+			printf("Only %d GIF frames fit in SDRAM\n", anim->numFrames);
+			break;
+		}
+		slot = sdram_addr + anim->numFrames*anim->frameSize;
+
+		if(f->x != 0 || f->y != 0 || f->w < w || f->h < h || f->transparent >= 0)
+		{
+			if(base < 0)
+				gif_Fill(slot, w, 0, 0, w, h, bg);
+			else
+			{
+				uint32_t from = sdram_addr + base*anim->frameSize;
+				bteMemoryCopyWithROP(from, w, 0, 0, from, w, 0, 0, slot, w, 0, 0, w, h, RA8876_BTE_ROP_CODE_12);
+				if(fill[2])
+					gif_Fill(slot, w, fill[0], fill[1], fill[2], fill[3], bg);
+			}
+		}
+
+		bte_DestinationMemoryStartAddr(slot);
+		bte_DestinationImageWidth(w);
+		if(f->transparent >= 0)
+			lcdRegDataWrite(RA8876_BTE_CTRL1,RA8876_BTE_MPU_WRITE_WITH_CHROMA);//91h
+		else
+			lcdRegDataWrite(RA8876_BTE_CTRL1,RA8876_BTE_ROP_CODE_12<<4|RA8876_BTE_MPU_WRITE_WITH_ROP);//91h
+		target.addr = slot;
+		target.key = (f->transparent >= 0) ? f->key : NULL;
+		ret = GifDecodeFrame(dec, bpp, strip, sizeof(strip), img_DrawStrip, &target);
+		checkWriteFifoEmpty();
+		check2dBusy();
+
+		anim->delay[anim->numFrames] = (f->delay < 2) ? 100 : f->delay*10;	//as browsers do for 0 and 10ms
+		switch(f->disposal)
+		{
+			case GIF_DISPOSE_BACKGROUND:
+				base = anim->numFrames;
+				fill[0] = f->x;
+				fill[1] = f->y;
+				fill[2] = (f->x >= w) ? 0 : (f->x + f->w > w ? w - f->x : f->w);
+				fill[3] = (f->y >= h) ? 0 : (f->y + f->h > h ? h - f->y : f->h);
+				if(fill[3] == 0) fill[2] = 0;
+				break;
+			case GIF_DISPOSE_PREVIOUS:
+				break;
+			default:
+				base = anim->numFrames;
+				fill[2] = 0;
+				break;
+		}
+		anim->numFrames++;
+
+		if(ret != GIF_OK)
+		{
+			printf("GIF decoding stopped at frame %d (%d)\n", anim->numFrames, ret);
+			break;
+		}
+	}
+	if(ret < 0 && anim->numFrames == 0)
+		printf("GIF decoding stopped (%d)\n", ret);
+
+	anim->loopCount = dec->loopCount;
+	return anim->numFrames;
+}
+
+/**
+ * @brief	Decode an animated GIF from a static array into SDRAM for playback by gifUpdate() or gifPlay().
+ * @param	*anim returns the frame table, with a delay for each frame
+ * @param	*data,size is the GIF file in memory
+ * @param	sdram_addr is the SDRAM address for the frames, an area used by nothing else
+ * @param	sdram_size is the size of the area, frames that do not fit are dropped
+ * @return	Number of frames in SDRAM, 0 on error
+ * @note	Each frame takes width*height*bpp bytes rounded up to 4, at most GIF_MAX_FRAMES frames are kept.
+ *			Decoding happens once here. Playback is a BTE memory copy per frame with no decoding at all.<br>
+ *			The area is not allocated here. With Allegro BITMAPs in SDRAM take it from mmu->mem_malloc(), so that
+ *			neither overwrites the other. An area that reaches CGRAM_START_ADDR is rejected.<br>
+ *			Example:<br>
+ *			static GIF_ANIM anim;<br>
+ *			int32_t addr = mmu->mem_malloc(8l*1024*1024);<br>
+ *			if(addr>=0) ra8876lite.gifLoad(&anim, bruce_gif, sizeof(bruce_gif), addr, 8l*1024*1024);<br>
+ *			ra8876lite.irqEventSet(RA8876_VSYNC_IRQ_ENABLE, 1);<br>
+ *			while(1) ra8876lite.gifUpdate(&anim, 100, 100);
+ */
+int Ra8876_Lite::gifLoad(GIF_ANIM *anim, const uint8_t *data, uint32_t size, uint32_t sdram_addr, uint32_t sdram_size)
+{
+	GIF_DEC *dec = gif_Open(data, size, NULL, NULL, "Image");
+
+	anim->numFrames = 0;
+	if(dec == NULL) return 0;
+	return gif_Load(dec, anim, sdram_addr, sdram_size);
+}
+
+#if defined (LOAD_SD_LIBRARY)
+/**
+ * @brief	Decode an animated GIF file on SD card into SDRAM for playback by gifUpdate() or gifPlay().
+ * @param	*anim returns the frame table, with a delay for each frame
+ * @param	*pFilename is a pointer to the filename
+ * @param	sdram_addr is the SDRAM address for the frames, an area used by nothing else
+ * @param	sdram_size is the size of the area, frames that do not fit are dropped
+ * @return	Number of frames in SDRAM, 0 on error
+ * @note	Same as the gifLoad() above for the SDRAM area.
+ * @note	The file is read once, in blocks of GIF_INBUF_SIZE bytes. Playback does not touch the SD card.
+ */
+int Ra8876_Lite::gifLoad(GIF_ANIM *anim, const char *pFilename, uint32_t sdram_addr, uint32_t sdram_size)
+{
+	GIF_DEC *dec;
+	int n;
+
+	anim->numFrames = 0;
+	File gfxFile = SD.open(pFilename);
+	if(!gfxFile) return 0;
+
+	dec = gif_Open(NULL, 0, img_ReadFile, &gfxFile, pFilename);
+	n = dec ? gif_Load(dec, anim, sdram_addr, sdram_size) : 0;
+	gfxFile.close();
+	return n;
+}
+#endif
+
+/**
+ * @brief	Copy a frame decoded by gifLoad() to the canvas.
+ * @param	*anim is the animation
+ * @param	frame is the frame number
+ * @param	x,y is the top left corner coordinates
+ * @param	lnOffset indicates Canvas Address offset in line number
+ * @note	One BTE memory copy with ROP12, clipped to the canvas width.
+ */
+void Ra8876_Lite::gifShowFrame(const GIF_ANIM *anim, uint16_t frame, uint16_t x, uint16_t y, uint32_t lnOffset)
+{
+	uint32_t from = anim->addr + frame*anim->frameSize;
+	uint16_t w = anim->width;
+
+	if(frame >= anim->numFrames || x >= _canvasWidth) return;
+	int32_t _canvasAddress = canvasAddress_from_lnOffset(lnOffset);
+	if(_canvasAddress<0) return;
+
+	if(x + w > _canvasWidth)
+		w = _canvasWidth - x;
+	bteMemoryCopyWithROP(from, anim->width, 0, 0, from, anim->width, 0, 0, _canvasAddress, _canvasWidth, x, y, w, anim->height, RA8876_BTE_ROP_CODE_12);
+}
+
+/**
+ * @brief	Restart an animation from its first frame at the next gifUpdate().
+ */
+void Ra8876_Lite::gifRewind(GIF_ANIM *anim)
+{
+	anim->current = 0;
+	anim->loops = 0;
+	anim->playing = 0;
+	anim->vsyncArmed = 0;
+}
+
+/**
+ * @brief	Non-blocking playback, show the next frame of an animation when its time has come.
+ * @param	*anim is an animation decoded by gifLoad()
+ * @param	x,y is the top left corner coordinates
+ * @param	lnOffset indicates Canvas Address offset in line number
+ * @return	true if a frame was shown by this call, false if it is not time yet or the animation has ended
+ * @note	Call it from loop() as often as possible. When a frame is due, the VSYNC flag is reset and the copy is made
+ *			by the first call after the next vsync, so that it lands between two scans. The deadline of the next frame
+ *			is then set from the GIF delay. Nothing blocks: calls before that vsync return false.<br>
+ *			VSYNC interrupt has to be enabled by irqEventSet(RA8876_VSYNC_IRQ_ENABLE, 1), otherwise the frame is
+ *			shown VSYNC_TIMEOUT_MS late and not synced. A late frame is not caught up with a burst, the next deadline is taken from now.
+ *			The animation stops after anim->loopCount plays, or loops for ever if it is 0.
+ */
+bool Ra8876_Lite::gifUpdate(GIF_ANIM *anim, uint16_t x, uint16_t y, uint32_t lnOffset)
+{
+	uint32_t now = millis();
+	uint16_t next;
+
+	if(anim->numFrames == 0 || anim->playing == 2)
+		return false;
+	if(anim->playing == 1 && (int32_t)(now - anim->due) < 0)
+		return false;
+
+	//a frame is due, wait for a vsync after this point without blocking
+	if(!vsync_Fresh(&anim->vsyncArmed, &anim->vsyncArmedAt))
+		return false;
+	now = millis();
+
+	if(anim->playing == 0)
+	{
+		next = 0;
+		anim->playing = 1;
+		anim->due = now;
+	}
+	else
+	{
+		next = anim->current + 1;
+		if(next == anim->numFrames)
+		{
+			anim->loops++;
+			if(anim->loopCount && anim->loops >= anim->loopCount)
+			{
+				anim->playing = 2;
+				return false;
+			}
+			next = 0;
+		}
+	}
+
+	gifShowFrame(anim, next, x, y, lnOffset);
+	anim->current = next;
+	anim->due += anim->delay[next];
+	if((int32_t)(now - anim->due) > 0)
+		anim->due = now + anim->delay[next];
+	return true;
+}
+
+/**
+ * @brief	Blocking playback of an animation decoded by gifLoad().
+ * @param	*anim is the animation
+ * @param	x,y is the top left corner coordinates
+ * @param	loops is the number of times to play it
+ * @param	lnOffset indicates Canvas Address offset in line number
+ */
+void Ra8876_Lite::gifPlay(GIF_ANIM *anim, uint16_t x, uint16_t y, uint16_t loops, uint32_t lnOffset)
+{
+	uint16_t loopCount = anim->loopCount;
+
+	anim->loopCount = loops ? loops : 1;
+	gifRewind(anim);
+	while(anim->numFrames && anim->playing != 2)
+	{
+		if(!gifUpdate(anim, x, y, lnOffset))
+			hal_delayMs(1);
+	}
+	anim->loopCount = loopCount;
+}
+
+/**
+ * @brief	millis() due for a frame of the current loop, computed from frame 0 so that the period does not drift
+ */
+static uint32_t flip_Due(const FLIPBOOK *fb, uint32_t frame)
+{
+	return fb->t0 + frame*1000l/fb->fps;
+}
+
+/**
+ * @brief	Prepare a flipbook of frames stored back to back in serial flash.
+ * @param	*fb is the flipbook to fill in
+ * @param	src_addr is the serial flash address of the first frame, obtained from RAiO Image_AP tool
+ * @param	width,height are the frame dimensions
+ * @param	numFrames is the number of frames
+ * @param	fps is the target frame rate
+ * @param	backLnOffset is the Canvas line offset of the back page, e.g. getLCDHeight() for the lines below the screen
+ * @note	Frames are width*height pixels at the color depth of the canvas, one after another. Change fb->frameBytes
+ *			if there is padding between them, and fb->loopCount to stop after a number of plays (0 loops for ever).
+ */
+void Ra8876_Lite::flipbookInit(FLIPBOOK *fb, uint32_t src_addr, uint16_t width, uint16_t height, uint16_t numFrames, uint16_t fps, uint32_t backLnOffset)
+{
+	fb->src_addr = src_addr;
+	fb->frameBytes = (uint32_t)width*height*getColorDepth();
+	fb->width = width;
+	fb->height = height;
+	fb->numFrames = numFrames;
+	fb->fps = fps ? fps : 1;
+	fb->loopCount = 0;
+	fb->page[0] = MAIN_WINDOW_OFFSET;
+	fb->page[1] = backLnOffset;
+	flipbookRewind(fb);
+}
+
+/**
+ * @brief	Restart a flipbook from its first frame at the next flipbookUpdate().
+ */
+void Ra8876_Lite::flipbookRewind(FLIPBOOK *fb)
+{
+	fb->current = 0;
+	fb->pending = 0;
+	fb->loops = 0;
+	fb->front = 0;
+	fb->playing = 0;
+	fb->shown = 0;
+	fb->dropped = 0;
+	fb->vsyncArmed = 0;
+}
+
+/**
+ * @brief	Start the DMA of a frame into the back page, cropped to the canvas width.
+ */
+void Ra8876_Lite::flip_Load(FLIPBOOK *fb, uint16_t frame, uint16_t x, uint16_t y)
+{
+	uint16_t w = fb->width;
+
+	if(x + w > _canvasWidth)
+		w = _canvasWidth - x;
+	dma_BlockStart(x, fb->page[fb->front^1] + y, w, fb->height, fb->width, fb->src_addr + frame*fb->frameBytes);
+}
+
+/**
+ * @brief	Non-blocking flipbook playback, flip to the next frame when it is loaded and its time has come.
+ * @param	*fb is a flipbook prepared by flipbookInit()
+ * @param	x,y is the top left corner coordinates on the screen
+ * @return	true if a frame was flipped by this call, false if it is not time yet, the DMA is still running or the flipbook has ended
+ * @note	Call it from loop() as often as possible. The first call copies the page shown to the back page, so that
+ *			whatever surrounds the frames is the same on both pages, and starts the DMA of frame 0 into it.
+ *			When the DMA is done and the frame is due, the VSYNC flag is reset and the display start address is switched
+ *			to the back page by the first call after the next vsync. The DMA of the next frame into the other page starts at once. The MCU only moves register writes.<br>
+ *			The frame rate is kept against fb->fps: frames whose time has passed while the previous one was loading
+ *			are skipped and counted in fb->dropped, fb->shown counts the frames flipped.<br>
+ *			VSYNC interrupt has to be enabled by irqEventSet(RA8876_VSYNC_IRQ_ENABLE, 1), otherwise the flip is
+ *			VSYNC_TIMEOUT_MS late and not synced. The core is busy while a DMA runs, draw to the canvas only after a call that returned true,
+ *			and call flipbookStop() to go back to page[0] when playback is over.
+ * @note	A full 1280x720 frame at 16BPP is 1.8MB to DMA, a few full frames per second. Smaller frames keep up with video rates.
+ */
+bool Ra8876_Lite::flipbookUpdate(FLIPBOOK *fb, uint16_t x, uint16_t y)
+{
+	uint32_t now;
+	uint16_t next;
+
+	if(fb->numFrames == 0 || fb->playing == 2 || x >= _canvasWidth)
+		return false;
+
+	if(fb->playing == 0)
+	{
+		int32_t front = canvasAddress_from_lnOffset(fb->page[0]);
+		int32_t back = canvasAddress_from_lnOffset(fb->page[1]);
+		if(front<0 || back<0) return false;
+
+		bteMemoryCopyWithROP(front, _canvasWidth, 0, 0, front, _canvasWidth, 0, 0, back, _canvasWidth, 0, 0, _canvasWidth, getLCDHeight(), RA8876_BTE_ROP_CODE_12);
+		flipbookRewind(fb);
+		flip_Load(fb, 0, x, y);
+		fb->playing = 1;
+		return false;
+	}
+
+	if(check2dBusy(1))	//DMA of the back page is still running
+		return false;
+
+	now = millis();
+	if(fb->shown == 0)
+		fb->t0 = now;
+	if((int32_t)(now - flip_Due(fb, fb->pending)) < 0)
+		return false;
+	if(!vsync_Fresh(&fb->vsyncArmed, &fb->vsyncArmedAt))	//flip at the first vsync after the frame is due
+		return false;
+
+	displayImageStartAddress(canvasAddress_from_lnOffset(fb->page[fb->front^1]));
+	fb->front ^= 1;
+	fb->current = fb->pending;
+	fb->shown++;
+
+	//skip the frames whose time will have passed before they could be loaded
+	next = fb->current + 1;
+	now = millis();
+	for(;;)
+	{
+		if(next >= fb->numFrames)
+		{
+			fb->loops++;
+			if(fb->loopCount && fb->loops >= fb->loopCount)
+			{
+				fb->playing = 2;
+				return true;
+			}
+			fb->t0 = flip_Due(fb, fb->numFrames);
+			next = 0;
+			if((int32_t)(now - flip_Due(fb, fb->numFrames)) >= 0)	//more than one loop late after a stall, restart the clock
+				fb->t0 = now;
+		}
+		if((int32_t)(now - flip_Due(fb, next + 1)) < 0)
+			break;
+		next++;
+		fb->dropped++;
+	}
+	fb->pending = next;
+	flip_Load(fb, next, x, y);
+	return true;
+}
+
+/**
+ * @brief	Stop a flipbook and show page[0] again, with the last frame shown.
+ * @note	Waits for a DMA in progress. If page[1] is shown, it is copied to page[0] before the display is switched back.
+ *			fb->shown and fb->dropped are kept until the next playback starts.
+ */
+void Ra8876_Lite::flipbookStop(FLIPBOOK *fb)
+{
+	int32_t front = canvasAddress_from_lnOffset(fb->page[fb->front]);
+	int32_t home = canvasAddress_from_lnOffset(fb->page[0]);
+
+	check2dBusy();
+	if(fb->front && front>=0 && home>=0)
+	{
+		bteMemoryCopyWithROP(front, _canvasWidth, 0, 0, front, _canvasWidth, 0, 0, home, _canvasWidth, 0, 0, _canvasWidth, getLCDHeight(), RA8876_BTE_ROP_CODE_12);
+		vsyncWait();
+		displayImageStartAddress(home);
+	}
+	fb->front = 0;
+	fb->playing = 0;
+}
+
+/**
+ * @brief	Blocking playback of a flipbook prepared by flipbookInit().
+ * @param	*fb is the flipbook
+ * @param	x,y is the top left corner coordinates on the screen
+ * @param	loops is the number of times to play it
+ * @note	fb->shown and fb->dropped tell how well the frame rate was kept.
+ *			Example:<br>
+ *			FLIPBOOK fb;<br>
+ *			ra8876lite.flipbookInit(&fb, 0x00100000, 320, 240, 120, 24, ra8876lite.getLCDHeight());<br>
+ *			ra8876lite.irqEventSet(RA8876_VSYNC_IRQ_ENABLE, 1);<br>
+ *			ra8876lite.flipbookPlay(&fb, 480, 240);<br>
+ *			printf("%lu shown, %lu dropped\n", fb.shown, fb.dropped);
+ */
+void Ra8876_Lite::flipbookPlay(FLIPBOOK *fb, uint16_t x, uint16_t y, uint16_t loops)
+{
+	uint16_t loopCount = fb->loopCount;
+
+	fb->loopCount = loops ? loops : 1;
+	fb->playing = 0;
+	while(fb->numFrames && x < _canvasWidth && fb->playing != 2)
+	{
+		if(!flipbookUpdate(fb, x, y))
+			hal_delayMs(1);
+	}
+	flipbookStop(fb);
+	fb->loopCount = loopCount;
+}
+
+/**
+ * @brief	Start a transition from the screen to a full screen picture prepared off-screen.
+ * @param	*t is the transition to fill in
+ * @param	type is one of TRANSITION_TYPE
+ * @param	srcLnOffset is the Canvas line offset of the new picture, e.g. getLCDHeight() for the lines below the screen
+ * @param	duration is the time in ms from the first step to the new picture in place
+ * @param	workLnOffset is the Canvas line offset of a work area, not overlapping the screen or the new picture.<br>
+ *			TRANSITION_CROSSFADE and TRANSITION_FADE_OUT keep a copy of the screen there (one screen),
+ *			TRANSITION_DISSOLVE two screens and a 16x16 pattern, other transitions do not use it.
+ * @param	color is the color of TRANSITION_FADE_OUT and TRANSITION_FADE_IN
+ * @return	false if the transition cannot be run with this Canvas
+ * @note	The screen is the page at Canvas line 0. TRANSITION_SLIDE_UP needs the new picture right below the screen
+ *			and TRANSITION_SLIDE_LEFT right of it, it is copied there first if srcLnOffset is elsewhere.
+ *			Run the steps with transitionUpdate().
+ */
+bool Ra8876_Lite::transitionBegin(TRANSITION *t, uint8_t type, uint32_t srcLnOffset, uint16_t duration, uint32_t workLnOffset, Color color)
+{
+	uint16_t w = getLCDWidth(), h = getLCDHeight();
+	int32_t screen = canvasAddress_from_lnOffset(MAIN_WINDOW_OFFSET);
+	int32_t src = canvasAddress_from_lnOffset(srcLnOffset);
+	int32_t work = canvasAddress_from_lnOffset(workLnOffset);
+
+	t->state = 0;
+	if(screen<0 || src<0 || work<0) return false;
+	if(type==TRANSITION_SLIDE_LEFT && _canvasWidth < 2*w) return false;
+	if(type==TRANSITION_DISSOLVE && canvasAddress_from_lnOffset(workLnOffset + 2*h + 16)<0) return false;
+
+	t->type = type;
+	t->duration = duration;
+	t->src = srcLnOffset;
+	t->work = workLnOffset;
+	t->color = color;
+	t->level = 0;
+
+	switch(type)
+	{
+		case TRANSITION_CROSSFADE:
+		case TRANSITION_FADE_OUT:
+			bteMemoryCopyWithROP(screen, _canvasWidth, 0, 0, screen, _canvasWidth, 0, 0, work, _canvasWidth, 0, 0, w, h, RA8876_BTE_ROP_CODE_12);
+			break;
+		case TRANSITION_SLIDE_LEFT:
+			bteMemoryCopyWithROP(src, _canvasWidth, 0, 0, src, _canvasWidth, 0, 0, screen, _canvasWidth, w, 0, w, h, RA8876_BTE_ROP_CODE_12);
+			break;
+		case TRANSITION_SLIDE_UP:
+			if(srcLnOffset != h)
+				bteMemoryCopyWithROP(src, _canvasWidth, 0, 0, src, _canvasWidth, 0, 0, screen, _canvasWidth, 0, h, w, h, RA8876_BTE_ROP_CODE_12);
+			break;
+		case TRANSITION_DISSOLVE:
+			//difference of the two pictures, each step XORs the pixels it reveals onto the screen
+			bteMemoryCopyWithROP(screen, _canvasWidth, 0, 0, src, _canvasWidth, 0, 0, work, _canvasWidth, 0, 0, w, h, RA8876_BTE_ROP_CODE_6);
+			break;
+		default:
+			break;
+	}
 
-	if(rotate_ccw90)
+	t->t0 = t->last = millis();
+	t->state = 1;
+	return true;
+}
+
+/**
+ * @brief	Draw the step of a transition that brings it to a level of progress.
+ * @note	One BTE operation per step, except a dissolve which builds its mask with a pattern fill first.
+ */
+void Ra8876_Lite::tr_Step(TRANSITION *t, uint16_t level)
+{
+	static uint8_t pattern[16*16*3];
+	uint16_t w = getLCDWidth(), h = getLCDHeight();
+	uint32_t screen = canvasAddress_from_lnOffset(MAIN_WINDOW_OFFSET);
+	uint32_t src = canvasAddress_from_lnOffset(t->src);
+	uint32_t work = canvasAddress_from_lnOffset(t->work);
+	uint32_t mask, pat;
+	uint16_t from = t->level;
+	uint8_t bpp, i, j, k, v;
+	uint16_t n;
+
+	switch(t->type)
 	{
-		lcdRegDataWrite(RA8876_MACR, MACR);  
+		case TRANSITION_CROSSFADE:
+			bteMemoryCopyWithOpacity(work, _canvasWidth, 0, 0, src, _canvasWidth, 0, 0, screen, _canvasWidth, 0, 0, w, h, level);
+			break;
+		case TRANSITION_FADE_OUT:
+			bteMemoryCopyWithOpacity(work, _canvasWidth, 0, 0, t->color, screen, _canvasWidth, 0, 0, w, h, level);
+			break;
+		case TRANSITION_FADE_IN:
+			bteMemoryCopyWithOpacity(src, _canvasWidth, 0, 0, t->color, screen, _canvasWidth, 0, 0, w, h, 32-level);
+			break;
+		case TRANSITION_WIPE_RIGHT:
+			bteMemoryCopyWithROP(src, _canvasWidth, from, 0, src, _canvasWidth, from, 0, screen, _canvasWidth, from, 0, level-from, h, RA8876_BTE_ROP_CODE_12);
+			break;
+		case TRANSITION_WIPE_DOWN:
+			bteMemoryCopyWithROP(src, _canvasWidth, 0, from, src, _canvasWidth, 0, from, screen, _canvasWidth, 0, from, w, level-from, RA8876_BTE_ROP_CODE_12);
+			break;
+		case TRANSITION_SLIDE_LEFT:
+			displayWindowStartXY(level&~3, 0);
+			break;
+		case TRANSITION_SLIDE_UP:
+			displayWindowStartXY(0, level&~3);
+			break;
+		case TRANSITION_DISSOLVE:
+			//pixels of a 16x16 ordered dither matrix with a threshold in [from, level) are all ones, others are zeros
+			bpp = getColorDepth();
+			n = 0;
+			for(i=0; i<16; i++)
+			{
+				for(j=0; j<16; j++)
+				{
+					v = 0;
+					for(k=0; k<4; k++)
+						v |= ((i^j)>>k&1)<<(7-2*k) | (i>>k&1)<<(6-2*k);
+					for(k=0; k<bpp; k++)
+						pattern[n++] = (v>=from && v<level) ? 0xff : 0x00;
+				}
+			}
+			//work area holds the difference, then the mask, then the pattern
+			mask = canvasAddress_from_lnOffset(t->work + h);
+			pat = canvasAddress_from_lnOffset(t->work + 2*h);
+			check2dBusy();
+			bte_DestinationMemoryStartAddr(pat);
+			bte_DestinationImageWidth(16);
+			bte_DestinationWindowStartXY(0,0);
+			bte_WindowSize(16,16);
+			lcdRegDataWrite(RA8876_BTE_CTRL1,RA8876_BTE_ROP_CODE_12<<4|RA8876_BTE_MPU_WRITE_WITH_ROP);//91h
+			lcdRegDataWrite(RA8876_BTE_CTRL0,RA8876_BTE_ENABLE<<4);//90h
+			ramAccessPrepare();
+			hal_spi_write(pattern, n);
+			checkWriteFifoEmpty();
+			check2dBusy();
+
+			btePatternFill(1, pat, 16, 0, 0, mask, _canvasWidth, 0, 0, w, h);
+			bteMemoryCopyWithROP(work, _canvasWidth, 0, 0, mask, _canvasWidth, 0, 0, mask, _canvasWidth, 0, 0, w, h, RA8876_BTE_ROP_CODE_8);
+			bteMemoryCopyWithROP(screen, _canvasWidth, 0, 0, mask, _canvasWidth, 0, 0, screen, _canvasWidth, 0, 0, w, h, RA8876_BTE_ROP_CODE_6);
+			break;
 	}
-	
-	//Active window restore
-	activeWindowXY(ACTIVE_WINDOW_STARTX,ACTIVE_WINDOW_STARTY);
-	activeWindowWH(_canvasWidth,_canvasHeight);
-	canvasImageStartAddress(CANVAS_OFFSET);
+	t->level = level;
 }
 
-#if defined (LOAD_SD_LIBRARY)
 /**
- * @brief Draw picture from a RAiO binary file. A file system with SD.h is assumed here.
- * @param x,y is the top left corner coordinates. Max x,y = 8192.
- * @param width, height indicate the dimension in pixels.
- * @param *pFilename is a pointer to the filename.
- * @param rotate_ccw90 is a boolean flag to rotate a single character in counter clockwise 90 degrees.
- * @param lnOffset indicates Canvas Address offset in line number.
- * @note  This is a blocking function as we are reading and writing from an external media (SD card) to SDRAM pixel-by-pixel.
+ * @brief	Non-blocking transition, draw the next step at vsync.
+ * @param	*t is a transition started by transitionBegin()
+ * @return	true while the transition is running, false when the new picture is on the screen
+ * @note	Call it from loop() as often as possible, e.g. while(ra8876lite.transitionUpdate(&t)) { load the next slide }.
+ *			A step is drawn right after a vsync, or after VSYNC_TIMEOUT_MS if VSYNC interrupt is not enabled by
+ *			irqEventSet(RA8876_VSYNC_IRQ_ENABLE, 1). The progress is taken from millis(), so a slow step makes the
+ *			next one larger rather than the transition longer, and a step that would not change the screen is skipped.<br>
+ *			At the end of a slide the new picture is copied to the screen page while it is still shown from the
+ *			lines next to it, then the display window goes back to (0,0) at the next vsync.
  */
-void Ra8876_Lite::putPicture(	uint16_t x, uint16_t y,
-								uint16_t width, uint16_t height, 
-								const char *pFilename, 
-								bool rotate_ccw90,
-								uint32_t lnOffset)
+bool Ra8876_Lite::transitionUpdate(TRANSITION *t)
 {
-	uint16_t _x=x, _y=y, _width=width, _height=height;
-	uint8_t MACR;
-	
-	File gfxFile = SD.open(pFilename);
-	
-	if(!gfxFile) return;
-			
-	int32_t _canvasAddress = canvasAddress_from_lnOffset(lnOffset);
-	if(_canvasAddress<0) return;
-	
-	canvasImageStartAddress(_canvasAddress);
-	///Important::need to set RA8876_MACR prior to putPicture_set_frame() otherwise it doesn't work!
-	///Change the host to Memory write direction 
-	if(rotate_ccw90){
-		_width = height; _height = width;
-		_x = y; _y = x;
-		MACR = lcdRegDataRead(RA8876_MACR); //read REG[02h]
-		lcdRegDataWrite(RA8876_MACR, MACR|0x06);  	///Change to bottom->top, left->right scanning	
+	uint32_t now = millis(), elapsed;
+	uint16_t w = getLCDWidth(), h = getLCDHeight();
+	uint16_t range, level;
+
+	if(t->state==0 || t->state==3)
+		return false;
+	if(!vsyncPoll() && now - t->last < VSYNC_TIMEOUT_MS)
+		return true;
+	t->last = now;
+
+	if(t->state==2)
+	{
+		displayWindowStartXY(MAIN_WINDOW_STARTX, MAIN_WINDOW_STARTY);
+		t->state = 3;
+		return false;
 	}
-	//coordinates (x,y) is relative to the canvas address with max x,y=8192
-	putPicture_set_frame(_x,_y,_width,_height,lnOffset);
-			
-	uint16_t _ln = width*getColorDepth();
-	uint8_t lnBuffer[_ln];	//Mind its size for MCU with low SRAM(e.g. Arduino M0). A picture of 1280 pixels (say) width in 24BPP needs
-							//1280*3 bytes for this array. Just in case this module is not working, adjust the line buffer size by reducing _ln
-	while(gfxFile.available())
+
+	switch(t->type)
 	{
-		gfxFile.read((uint8_t *)lnBuffer, _ln);
-		hal_spi_write(lnBuffer, _ln);
+		case TRANSITION_WIPE_RIGHT:
+		case TRANSITION_SLIDE_LEFT:	range = w;	 break;
+		case TRANSITION_WIPE_DOWN:
+		case TRANSITION_SLIDE_UP:	range = h;	 break;
+		case TRANSITION_DISSOLVE:	range = 256; break;
+		default:					range = 32;	 break;
 	}
-	
-	if(rotate_ccw90)
+	elapsed = now - t->t0;
+	level = (elapsed >= t->duration) ? range : (uint32_t)range*elapsed/t->duration;
+	if(t->type==TRANSITION_SLIDE_LEFT || t->type==TRANSITION_SLIDE_UP)
+		level = (level < range) ? level&~3 : range;	//display window start in multiples of 4
+	if(level != t->level)
+		tr_Step(t, level);
+	if(level < range)
+		return true;
+
+	if(t->type==TRANSITION_SLIDE_LEFT)
 	{
-		lcdRegDataWrite(RA8876_MACR, MACR);  	//restore left->right, top->bottom scanning
+		int32_t screen = canvasAddress_from_lnOffset(MAIN_WINDOW_OFFSET);
+		bteMemoryCopyWithROP(screen, _canvasWidth, w, 0, screen, _canvasWidth, w, 0, screen, _canvasWidth, 0, 0, w, h, RA8876_BTE_ROP_CODE_12);
+		t->state = 2;
+		return true;
 	}
-	/*
-	//This is less efficient
-	uint8_t bpp = getColorDepth();
-	switch(bpp)
+	if(t->type==TRANSITION_SLIDE_UP)
 	{
-		case 1:
-			while(gfxFile.available()){
-			lcdDataWrite((uint8_t)gfxFile.read());	}
-			break;
-		case 2:
-			while(gfxFile.available()){
-			lcdDataWrite((uint8_t)gfxFile.read());lcdDataWrite((uint8_t)gfxFile.read()); }
-			break;
-		case 3:
-			while(gfxFile.available()){
-			lcdDataWrite((uint8_t)gfxFile.read());lcdDataWrite((uint8_t)gfxFile.read());lcdDataWrite((uint8_t)gfxFile.read());}
-			break;
+		int32_t screen = canvasAddress_from_lnOffset(MAIN_WINDOW_OFFSET);
+		bteMemoryCopyWithROP(screen, _canvasWidth, 0, h, screen, _canvasWidth, 0, h, screen, _canvasWidth, 0, 0, w, h, RA8876_BTE_ROP_CODE_12);
+		t->state = 2;
+		return true;
 	}
-	*/
-	gfxFile.close();
-	
-	//Active Window restore
-	activeWindowXY(ACTIVE_WINDOW_STARTX,ACTIVE_WINDOW_STARTY);
-	activeWindowWH(_canvasWidth,_canvasHeight);
-	canvasImageStartAddress(CANVAS_OFFSET);
+	t->state = 3;
+	return false;
 }
-#endif
   
  /**
  * @brief 	Set text mode ON or OFF
@@ -3208,7 +6618,9 @@ void Ra8876_Lite:: setHwTextCursor(uint16_t x, uint16_t y, uint32_t lnOffset)
   */
  void Ra8876_Lite::setHwTextParameter1(FONT_SRC source_select, FONT_HEIGHT size_select, FONT_CODE iso_select)//cch
  {
-   lcdRegDataWrite(RA8876_CCR0,source_select<<6|size_select<<4|iso_select);//cch
+   //FONT_HEIGHT holds the height in pixels, REG[CCh] bit5:4 takes 0, 1, 2 for 16, 24, 32
+   uint8_t size = (size_select>=CHAR_HEIGHT_32) ? RA8876_CHAR_HEIGHT_32 : (size_select>=CHAR_HEIGHT_24) ? RA8876_CHAR_HEIGHT_24 : RA8876_CHAR_HEIGHT_16;
+   lcdRegDataWrite(RA8876_CCR0,source_select<<6|size<<4|(iso_select&0x03));//cch
  }
  
  /**
@@ -3294,152 +6706,466 @@ void Ra8876_Lite::setHwTextParam(Color background_color, uint8_t width_enlarge,
 }
 
 /**
- * @brief	This function prints a single character at a position predefined with setHwTextCursor().
- * @param	*pFont points to a structure HW_FONT defined in hw_font.h.
- * @param	ch is the constant character to be printed in 8-bit width.
- * @note	Example: <br>
- *
-			  ra8876lite.canvasClear(color.Yellow);   	//clear canvas in yellow
-			  //Example to display ASCII from Embedded Character Set of 8x16 pixels starting from 0x00 to 0xff
-			  //character starts from x=100, y=50; auto line feed when cursor meet Active Window boundary
-			  ra8876lite.setHwTextCursor(100,50);  		
-			  ra8876lite.setHwTextColor(color.Blue);  
-			  ra8876lite.setHwTextParam(color.Transparent, 1,1);
-			  for(char ch=0x00; ch<0xff; ch++)
-			  { 
-				ra8876lite.putHwChar(&ICGROM_16, ch);
-			  }  			
+ * @brief	This function prints a single character at a position predefined with setHwTextCursor().
+ * @param	*pFont points to a structure HW_FONT defined in hw_font.h.
+ * @param	ch is the constant character to be printed in 8-bit width.
+ * @note	Example: <br>
+ *
+			  ra8876lite.canvasClear(color.Yellow);   	//clear canvas in yellow
+			  //Example to display ASCII from Embedded Character Set of 8x16 pixels starting from 0x00 to 0xff
+			  //character starts from x=100, y=50; auto line feed when cursor meet Active Window boundary
+			  ra8876lite.setHwTextCursor(100,50);  		
+			  ra8876lite.setHwTextColor(color.Blue);  
+			  ra8876lite.setHwTextParam(color.Transparent, 1,1);
+			  for(char ch=0x00; ch<0xff; ch++)
+			  { 
+				ra8876lite.putHwChar(&ICGROM_16, ch);
+			  }  			
+ */
+void Ra8876_Lite::putHwChar(const HW_FONT *pFont, const char ch)
+{
+	if((uint8_t)ch < pFont->FirstChar || (uint8_t)ch > pFont->LastChar) return;
+
+	hwTextBegin(pFont);
+	hwTextWrite((const uint8_t *)&ch, 1);
+	hwTextEnd();
+}
+
+/**
+ * @brief	This function overloads putHwChar(const HW_FONT *pFont, const char ch) with uint16_t as the second parameter for wide characters such as BIG5.
+ * @note	Example : <br>
+ *
+			  //0x0401 means to start from 04区 01点 displaying ぁあぃい...for 300 characters
+			  //change wch starting value to 0x0501 will display ァアィイ...
+			  //Reference: http://charset.7jp.net/jis0208.html
+			  //print wide characters starting from x=100,y=150 with auto line feed when cursor meets Active Window boundary
+			  ra8876lite.setHwTextCursor(100,150);
+			  ra8876lite.setHwTextColor(color.White);
+			  ra8876lite.setHwTextParam(color.Black, 1,1);
+			  for(wch=0x0401; wch<(0x0401+301); wch++)
+			  {
+				ra8876lite.putHwChar(&XCGROM_JIS_16, wch);     
+			  } 
+ */
+void Ra8876_Lite::putHwChar(const HW_FONT *pFont,const uint16_t ch)
+{
+	if(ch < pFont->FirstChar || ch > pFont->LastChar) return;
+	
+	uint16_t str[2] = {ch, 0};
+	
+	hwTextBegin(pFont);
+	hwTextWrite(str);
+	hwTextEnd();
+}
+
+/**
+ * @brief	Print a string from internal CG RAM or external font ROM.
+ * @param	*pFont points to a structure HW_FONT defined in hw_font.h.
+ * @param	*str pointer to a constant string.
+ * @note	Its text color, the background color, magnification factor, and the cursor position must be set prior to running this.<br>
+ *			Example:<br>
+ *
+			long vsyncTime=0, time_s=0, time_e=0;  
+			String result;
+			
+			time_s=time_e=millis();
+			ra8876lite.vsyncWait();
+			ra8876lite.bteSolidFill(0,random(0,ra8876lite.getCanvasWidth()),random(100,ra8876lite.getCanvasHeight()),random(255),random(255),color);
+			time_e= millis();
+			result = String(float(time_e-time_s), 2) + "ms";
+			ra8876lite.setHwTextColor(color.White);     //set text color white
+			ra8876lite.setHwTextCursor(500,40);         //set cursor prior to running ra8876lite.putHwString()
+			ra8876lite.setHwTextParam(color.Black,2,3); //set background black with magnified font         
+			ra8876lite.putHwString(&ICGROM_16, result);			
+ */
+void Ra8876_Lite:: putHwString(const HW_FONT *pFont, const char *str)
+{ 
+	hwTextBegin(pFont);
+	hwTextWrite((const uint8_t *)str, strlen(str));
+	hwTextEnd();
+}
+
+/**
+ * @brief	Print a UTF-8 string from internal CG RAM or external font ROM.
+ * @param	*pFont points to a structure HW_FONT defined in hw_font.h.
+ * @param	*str pointer to a constant string in UTF-8.
+ * @note	Code points are decoded on the fly with utf8Decode() and written to the text engine in the width the font expects:<br>
+ *			(1) Genitop Unicode ROMs (XCGROM_UNICODE, XCGROM_UNI_JAPANESE) take 2 bytes per character.<br>
+ *			(2) Other fonts take 1 byte per character, good for Internal CGROM ISO 8859-1 and Genitop ASCII/ISO 8859-1 where
+ *			code points U+0000 to U+00FF map directly. Characters beyond U+00FF are printed as '?'.<br>
+ *			Legacy double-byte encodings such as GB2312, BIG5 and JIS cannot be reached from Unicode without a table;
+ *			use putHwString(const HW_FONT *pFont, const uint16_t *str) for them.<br>
+ *			Example:<br>
+ *			ra8876lite.putHwStringUtf8(&ICGROM_16, "Caf\xC3\xA9 cr\xC3\xA8me");	//"Café crème" from JSON or a UTF-8 source file
+ */
+void Ra8876_Lite:: putHwStringUtf8(const HW_FONT *pFont, const char *str)
+{ 
+	hwTextBegin(pFont);
+	hwTextWriteUtf8(pFont, str);
+	hwTextEnd();
+}
+
+/**
+ * @brief	This function overloads putHwString(const HW_FONT *pFont, const char *str) with uint16_t as the second parameter for wide characters such as BIG5.
+ */
+void Ra8876_Lite:: putHwString(const HW_FONT *pFont, const uint16_t *str)
+{ 
+	hwTextBegin(pFont);
+	hwTextWrite(str);
+	hwTextEnd();
+}
+
+/**
+ * @brief	Set up the text engine for a font and open memory write to print characters.
+ * @param	*pFont points to a structure HW_FONT defined in hw_font.h.
+ * @note	Free FIFO credit is cleared here, the first write of a string polls for an empty FIFO.
+ */
+void Ra8876_Lite::hwTextBegin(const HW_FONT *pFont)
+{
+	setHwTextParameter1(pFont->FontSource, (FONT_HEIGHT)pFont->FontHeight, pFont->FontCode);
+  
+	if(pFont->FontSource == GENITOP_FONT)
+	{
+		if(pFont->FontWidth!=0)	//Fixed width
+			genitopCharacterRomParameter(pFont->FontCode, 0);
+		else	//variable width
+			genitopCharacterRomParameter(pFont->FontCode, 1);
+	}
+	
+	_wrFifoCredit = 0;
+	textMode(true);
+	ramAccessPrepare();
+}
+
+/**
+ * @brief	Wait for the text engine to finish the last character and switch back to graphic mode.
+ */
+void Ra8876_Lite::hwTextEnd(void)
+{
+	check2dBusy();
+	textMode(false);
+	_wrFifoCredit = 0;
+}
+
+/**
+ * @brief	Stream character codes to the text engine in bursts sized to the free space in memory write FIFO.
+ * @param	*buf points to character codes, 1 byte per character or 2 bytes (MSB first) per wide character
+ * @param	byte_count is the number of bytes to write
+ * @note	Status Register is read only when the credit runs out. An empty FIFO gives RA8876_WR_FIFO_DEPTH bytes of
+ *			credit, which are sent in a single CS-asserted transaction with hal_spi_write() instead of one
+ *			status read and one 2-byte transaction per character.<br>
+ *			RA8876_WR_FIFO_DEPTH is even, so a 2-byte character never splits across two polls.
+ */
+void Ra8876_Lite::hwTextWrite(const uint8_t *buf, uint32_t byte_count)
+{
+	uint32_t n;
+	
+	while(byte_count)
+	{
+		if(_wrFifoCredit == 0)
+		{
+			checkWriteFifoEmpty();
+			_wrFifoCredit = RA8876_WR_FIFO_DEPTH;
+		}
+		
+		n = (byte_count < _wrFifoCredit) ? byte_count : _wrFifoCredit;
+		hal_spi_write(buf, n);
+		buf += n;
+		byte_count -= n;
+		_wrFifoCredit -= n;
+	}
+}
+
+/**
+ * @brief	This function overloads hwTextWrite(const uint8_t *buf, uint32_t byte_count) for a null-terminated string of wide characters.
+ */
+void Ra8876_Lite::hwTextWrite(const uint16_t *str)
+{
+	uint8_t buf[RA8876_WR_FIFO_DEPTH];
+	uint8_t n = 0;
+	
+	while(*str != 0)
+	{
+		buf[n++] = (uint8_t)(*str>>8);
+		buf[n++] = (uint8_t)*str;
+		str++;
+		if(n == RA8876_WR_FIFO_DEPTH)
+		{
+			hwTextWrite(buf, n);
+			n = 0;
+		}
+	}
+	hwTextWrite(buf, n);
+}
+
+/**
+ * @brief	Decode a UTF-8 string and stream it to the text engine in the character width of the font.
+ * @note	Refer to putHwStringUtf8() for how code points map to font codes.
+ */
+void Ra8876_Lite::hwTextWriteUtf8(const HW_FONT *pFont, const char *str)
+{
+	bool wide = (pFont->FontSource == GENITOP_FONT) && 
+				(pFont->FontCode == XCGROM_UNICODE || pFont->FontCode == XCGROM_UNI_JAPANESE);
+	uint8_t buf[RA8876_WR_FIFO_DEPTH];
+	uint8_t n = 0;
+	uint32_t cp;
+	
+	while(*str != '\0')
+	{
+		cp = utf8Decode(&str);
+		if(wide)
+		{
+			if(cp > 0xFFFF) cp = UTF8_REPLACEMENT_CHAR;
+			buf[n++] = (uint8_t)(cp>>8);
+			buf[n++] = (uint8_t)cp;
+		}
+		else
+		{
+			buf[n++] = (cp > 0xFF) ? '?' : (uint8_t)cp;
+		}
+		
+		if(n > RA8876_WR_FIFO_DEPTH-2)
+		{
+			hwTextWrite(buf, n);
+			n = 0;
+		}
+	}
+	hwTextWrite(buf, n);
+}
+
+/**
+ * @brief	Start a text run to print many strings on the same line with one setup.
+ * @param	*pFont points to a structure HW_FONT defined in hw_font.h.
+ * @param	(x,y) is the cursor position of the first character
+ * @param	lnOffset is the canvas start address represented in line number.
+ * @note	Font, cursor and text mode are set once. Each putHwTextRun() continues from where the last string ended,
+ *			and FIFO credit left over from one string is used by the next one. Background color, magnification and
+ *			text color are set with setHwTextParam() and setHwTextColor() before the run begins.<br>
+ *			No other drawing function may be called until endHwTextRun().<br>
+ *			Example:<br>
+ *
+			ra8876lite.setHwTextParam(color.Black);
+			ra8876lite.setHwTextColor(color.White);
+			ra8876lite.beginHwTextRun(&ICGROM_16, 0, 700);
+			ra8876lite.putHwTextRun("12:00:01 ");
+			ra8876lite.setHwTextRunColor(color.Red);
+			ra8876lite.putHwTextRun("ERROR ");
+			ra8876lite.setHwTextRunColor(color.White);
+			ra8876lite.putHwTextRun(message);
+			ra8876lite.endHwTextRun();
+ */
+void Ra8876_Lite::beginHwTextRun(const HW_FONT *pFont, uint16_t x, uint16_t y, uint32_t lnOffset)
+{
+	setHwTextCursor(x, y, lnOffset);
+	_hwTextRunFont = pFont;
+	hwTextBegin(pFont);
+}
+
+/**
+ * @brief	Print a string in a text run started by beginHwTextRun().
+ * @param	*str pointer to a constant string.
+ */
+void Ra8876_Lite::putHwTextRun(const char *str)
+{
+	if(_hwTextRunFont == 0) return;
+	
+	hwTextWrite((const uint8_t *)str, strlen(str));
+}
+
+/**
+ * @brief	This function overloads putHwTextRun(const char *str) with uint16_t for wide characters such as BIG5.
  */
-void Ra8876_Lite::putHwChar(const HW_FONT *pFont, const char ch)
+void Ra8876_Lite::putHwTextRun(const uint16_t *str)
 {
-	if((uint16_t)ch < pFont->FirstChar || (uint16_t)ch > pFont->LastChar) return;
+	if(_hwTextRunFont == 0) return;
+	
+	hwTextWrite(str);
+}
 
-	setHwTextParameter1(pFont->FontSource, (FONT_HEIGHT)pFont->FontHeight, pFont->FontCode);
+/**
+ * @brief	Print a UTF-8 string in a text run started by beginHwTextRun().
+ * @note	Refer to putHwStringUtf8() for how code points map to font codes.
+ */
+void Ra8876_Lite::putHwTextRunUtf8(const char *str)
+{
+	if(_hwTextRunFont == 0) return;
+	
+	hwTextWriteUtf8(_hwTextRunFont, str);
+}
 
-	if(pFont->FontSource == GENITOP_FONT)
-	{
-		if(pFont->FontWidth!=0)	//Fixed width
-			genitopCharacterRomParameter(pFont->FontCode, 0);
-		else	//variable width
-			genitopCharacterRomParameter(pFont->FontCode, 1);
-	}
+/**
+ * @brief	Change text color within a text run.
+ * @param	text_color is the color of characters printed after this call
+ * @note	Characters still in the FIFO are drawn in the old color first. The cursor is kept by the text engine.
+ */
+void Ra8876_Lite::setHwTextRunColor(Color text_color)
+{
+	if(_hwTextRunFont == 0) return;
 	
-	textMode(true);
-	ramAccessPrepare();
-	checkWriteFifoNotFull();  
-	lcdDataWrite(ch);
+	checkWriteFifoEmpty();
 	check2dBusy();
-	textMode(false);	
+	setForegroundColor(text_color);
+	ramAccessPrepare();
+	_wrFifoCredit = RA8876_WR_FIFO_DEPTH;
 }
 
 /**
- * @brief	This function overloads putHwChar(const HW_FONT *pFont, const char ch) with uint16_t as the second parameter for wide characters such as BIG5.
- * @note	Example : <br>
- *
-			  //0x0401 means to start from 04区 01点 displaying ぁあぃい...for 300 characters
-			  //change wch starting value to 0x0501 will display ァアィイ...
-			  //Reference: http://charset.7jp.net/jis0208.html
-			  //print wide characters starting from x=100,y=150 with auto line feed when cursor meets Active Window boundary
-			  ra8876lite.setHwTextCursor(100,150);
-			  ra8876lite.setHwTextColor(color.White);
-			  ra8876lite.setHwTextParam(color.Black, 1,1);
-			  for(wch=0x0401; wch<(0x0401+301); wch++)
-			  {
-				ra8876lite.putHwChar(&XCGROM_JIS_16, wch);     
-			  } 
+ * @brief	End a text run and switch back to graphic mode.
  */
-void Ra8876_Lite::putHwChar(const HW_FONT *pFont,const uint16_t ch)
+void Ra8876_Lite::endHwTextRun(void)
 {
-	if(ch < pFont->FirstChar || ch > pFont->LastChar) return;
+	if(_hwTextRunFont == 0) return;
 	
-	setHwTextParameter1(pFont->FontSource, (FONT_HEIGHT)pFont->FontHeight, pFont->FontCode);
+	hwTextEnd();
+	_hwTextRunFont = 0;
+}
+
+#if defined (LOAD_BFC_FONT)
+/**
+ * @brief	Render characters of a BFC font into 1bpp cells and write them to CGRAM.
+ * @param	*str16 is a string of 2-byte characters, or 0 if str8 is used
+ * @param	*str8 is a UTF-8 string, or 0 if str16 is used
+ * @note	Refer to cgramLoadBfcChars() for other parameters.
+ */
+const HW_FONT* Ra8876_Lite::bfc_CgramLoad(const BFC_FONT *pFont, const uint16_t *str16, const char *str8, uint8_t first_code)
+{
+	const HW_FONT *pHwFont;
 	
-	if(pFont->FontSource == GENITOP_FONT)
+	if(pFont == 0)
+		return 0;
+	
+	if(pFont->FontHeight <= 16)
+		pHwFont = &CGRAM_16;
+	else if(pFont->FontHeight <= 24)
+		pHwFont = &CGRAM_24;
+	else if(pFont->FontHeight <= 32)
+		pHwFont = &CGRAM_32;
+	else
 	{
-		if(pFont->FontWidth!=0)	//Fixed width
-			genitopCharacterRomParameter(pFont->FontCode, 0);
-		else	//variable width
-			genitopCharacterRomParameter(pFont->FontCode, 1);
+		printf("Font too tall for CGRAM!\n");
+		return 0;
 	}
-	textMode(true);
-	ramAccessPrepare();
-	checkWriteFifoNotFull(); 
-	lcdDataWrite((uint8_t)(ch>>8));
-	lcdDataWrite((uint8_t)ch);
-	check2dBusy();
-	textMode(false);	
+	
+	uint8_t cell[2*32];		//largest cell is 16x32 pixels
+	uint8_t cell_w = pHwFont->FontWidth;
+	uint8_t cell_h = pHwFont->FontHeight;
+	uint8_t row_bytes = (cell_w+7)/8;
+	uint8_t char_bytes = row_bytes*cell_h;
+	uint8_t y_off = (cell_h - pFont->FontHeight)/2;
+	int bpp = GetFontBpp(pFont->FontType);
+	uint16_t code = first_code, count = 0;
+	
+	lcdRegDataWrite(RA8876_CGRAM_STR0,(uint8_t)CGRAM_START_ADDR);//dbh
+	lcdRegDataWrite(RA8876_CGRAM_STR1,(uint8_t)(CGRAM_START_ADDR>>8));//dch
+	lcdRegDataWrite(RA8876_CGRAM_STR2,(uint8_t)(CGRAM_START_ADDR>>16));//ddh
+	lcdRegDataWrite(RA8876_CGRAM_STR3,(uint8_t)(CGRAM_START_ADDR>>24));//deh
+	
+	//CGRAM is written as bytes in linear addressing
+	uint8_t AW_COLOR = lcdRegDataRead(RA8876_AW_COLOR);//5eh
+	lcdRegDataWrite(RA8876_AW_COLOR,RA8876_CANVAS_LINEAR_MODE<<2|RA8876_CANVAS_COLOR_DEPTH_8BPP);
+	
+	for(;;)
+	{
+		uint16_t ch;
+		
+		if(str16)
+			ch = *str16++;
+		else
+			ch = (*str8 != '\0') ? utf8DecodeBmp(&str8) : 0;
+		
+		if(ch == 0)
+			break;
+		
+		if(first_code == 0 && ch > 0xFF)
+		{
+			printf("U+%04X needs a first_code to be stored in CGRAM\n", ch);
+			continue;
+		}
+		if(code > 0xFF)
+			break;
+		
+		const BFC_CHARINFO *pCharInfo = bfc_GetCharInfo(pFont, ch);
+		if(pCharInfo == 0)
+			continue;
+		
+		//center the glyph in its cell, antialiased pixels above half intensity are set
+		int width = pCharInfo->Width;
+		int bytesPerLine = (width * bpp + 7) / 8;
+		uint8_t x_off = (cell_w > width) ? (cell_w - width)/2 : 0;
+		uint8_t threshold = 1<<(bpp-1);
+		
+		memset(cell, 0, char_bytes);
+		for(int y=0; y<pFont->FontHeight; y++)
+		{
+			for(int x=0; x<width && x+x_off<cell_w; x++)
+			{
+				uint8_t data = pCharInfo->p.pData8[y*bytesPerLine + (x*bpp)/8];
+				uint8_t pixel = (uint8_t)(data<<((x*bpp)%8)) >> (8-bpp);
+				
+				if(pixel >= threshold)
+					cell[(y+y_off)*row_bytes + (x+x_off)/8] |= 0x80>>((x+x_off)%8);
+			}
+		}
+		
+		uint32_t addr = CGRAM_START_ADDR + (uint32_t)(first_code ? code : ch)*char_bytes;
+		lcdRegDataWrite(RA8876_CURH0,addr);//5fh
+		lcdRegDataWrite(RA8876_CURH1,addr>>8);//60h
+		lcdRegDataWrite(RA8876_CURV0,addr>>16);//61h
+		lcdRegDataWrite(RA8876_CURV1,addr>>24);//62h
+		ramAccessPrepare();
+		hal_spi_write(cell, char_bytes);
+		
+		code++;
+		count++;
+	}
+	
+	checkWriteFifoEmpty();
+	lcdRegDataWrite(RA8876_AW_COLOR,AW_COLOR);
+	
+	return count ? pHwFont : 0;
 }
 
 /**
- * @brief	Print a string from internal CG RAM or external font ROM.
- * @param	*pFont points to a structure HW_FONT defined in hw_font.h.
- * @param	*str pointer to a constant string.
- * @note	Its text color, the background color, magnification factor, and the cursor position must be set prior to running this.<br>
- *			Example:<br>
- *
-			long vsyncTime=0, time_s=0, time_e=0;  
-			String result;
-			
-			time_s=time_e=millis();
-			ra8876lite.vsyncWait();
-			ra8876lite.bteSolidFill(0,random(0,ra8876lite.getCanvasWidth()),random(100,ra8876lite.getCanvasHeight()),random(255),random(255),color);
-			time_e= millis();
-			result = String(float(time_e-time_s), 2) + "ms";
-			ra8876lite.setHwTextColor(color.White);     //set text color white
-			ra8876lite.setHwTextCursor(500,40);         //set cursor prior to running ra8876lite.putHwString()
-			ra8876lite.setHwTextParam(color.Black,2,3); //set background black with magnified font         
-			ra8876lite.putHwString(&ICGROM_16, result);			
+ * @brief	Store characters of a BFC font in CGRAM as User-defined Characters of the hardware text engine.
+ * @param	*pFont is a pointer to BFC_FONT in MCU's Flash, FontHeight up to 32
+ * @param	*chars is a UTF-8 string of characters to store
+ * @param	first_code is the character code of the first character in CGRAM, the rest follow in sequence.<br>
+ *			0 (default) keeps each character at its own code, for characters up to U+00FF.
+ * @return	CGRAM_16, CGRAM_24 or CGRAM_32 for the cell height fitting FontHeight, 0 if nothing is stored
+ * @note	Each glyph is centered in a half-size cell (8x16, 12x24 or 16x32) and reduced to 1bpp.
+ *			Wider glyphs are clipped on the right. From then on putHwString() renders these characters at one byte
+ *			of SPI per character, with hardware enlargement, chroma key and rotation set by setHwTextParam().<br>
+ *			Example to use <br>
+ *			const HW_FONT *pPrice = ra8876lite.cgramLoadBfcChars(&fontLucida_Sans_Unicode16h_rowrowBig, "0123456789.,$");
+ *			ra8876lite.setHwTextColor(color.Yellow);
+ *			ra8876lite.setHwTextParam(color.Transparent, 2, 2);
+ *			ra8876lite.setHwTextCursor(100, 100);
+ *			ra8876lite.putHwString(pPrice, "$12.50");
+ *			//Symbols beyond U+00FF are stored at codes of choice
+ *			const uint16_t symbols[] = {0x20AC, 0x00A5, 0};	//Euro, Yen
+ *			ra8876lite.cgramLoadBfcChars(&fontLucida_Sans_Unicode16h_rowrowBig, symbols, 0x80);
+ *			ra8876lite.putHwString(pPrice, "\x80" "9.90");	//Euro sign then 9.90
  */
-void Ra8876_Lite:: putHwString(const HW_FONT *pFont, const char *str)
-{ 
-  setHwTextParameter1(pFont->FontSource, (FONT_HEIGHT)pFont->FontHeight, pFont->FontCode);
-  
-	if(pFont->FontSource == GENITOP_FONT)
-	{
-		if(pFont->FontWidth!=0)	//Fixed width
-			genitopCharacterRomParameter(pFont->FontCode, 0);
-		else	//variable width
-			genitopCharacterRomParameter(pFont->FontCode, 1);
-	}
+const HW_FONT* Ra8876_Lite::cgramLoadBfcChars(const BFC_FONT *pFont, const char *chars, uint8_t first_code)
+{
+	if(chars == 0)
+		return 0;
 	
-  textMode(true);
-  ramAccessPrepare();
-  while(*str != '\0')
-  {
-	checkWriteFifoNotFull();  
-	lcdDataWrite(*str++);
-  } 
-  check2dBusy();
-  textMode(false);
+	return bfc_CgramLoad(pFont, 0, chars, first_code);
 }
 
 /**
- * @brief	This function overloads putHwString(const HW_FONT *pFont, const char *str) with uint16_t as the second parameter for wide characters such as BIG5.
+ * @brief	Store characters of a BFC font in CGRAM from an array of 2-byte characters.
+ * @note	Refer to cgramLoadBfcChars(const BFC_FONT*, const char*, uint8_t) for details.
  */
-void Ra8876_Lite:: putHwString(const HW_FONT *pFont, const uint16_t *str)
-{ 
-	setHwTextParameter1(pFont->FontSource, (FONT_HEIGHT)pFont->FontHeight, pFont->FontCode);
-  
-	if(pFont->FontSource == GENITOP_FONT)
-	{
-		if(pFont->FontWidth!=0)	//Fixed width
-			genitopCharacterRomParameter(pFont->FontCode, 0);
-		else	//variable width
-			genitopCharacterRomParameter(pFont->FontCode, 1);
-	}
+const HW_FONT* Ra8876_Lite::cgramLoadBfcChars(const BFC_FONT *pFont, const uint16_t *chars, uint8_t first_code)
+{
+	if(chars == 0)
+		return 0;
 	
-  textMode(true);
-  ramAccessPrepare();
-  while(*str != '\0')
-  {
-	  checkWriteFifoNotFull();  
-	  lcdDataWrite((uint8_t)(*str>>8));
-	  lcdDataWrite((uint8_t)*str);
-	  str++;
-  } 
-  check2dBusy();
-  textMode(false);
+	return bfc_CgramLoad(pFont, chars, 0, first_code);
 }
+#endif
 
 /**
  * @brief Draw line function with hardware acceleration  
@@ -4116,7 +7842,7 @@ void Ra8876_Lite:: btePatternFillWithChromaKey( uint8_t p8x8or16x16,
  *			Picture mode can be operated in 8bpp/16bpp/24bpp mode and only has one opacity value(alpha Level) 
  *			for whole picture.
  *			Pixel mode is only operated in 8bpp/16bpp mode and each pixel have its own opacity value.
- *			Only Picture mode is supported yet.
+ *			This function runs Picture mode, the overload with a mode argument runs either.
  */
 void Ra8876_Lite::bteMemoryCopyWithOpacity(    
 								uint32_t s0_addr,
@@ -4152,7 +7878,135 @@ void Ra8876_Lite::bteMemoryCopyWithOpacity(
   check2dBusy();          
 }
 
-/*
+/**
+ * @brief This function blends s0 image with a constant color to a destination in memory with an alpha level
+ * @param s1_color is the color blended in place of a s1 image
+ * @param alpha is the weight of s1_color from 0 to 32, see the function above for the other parameters
+ * @note  S1 is switched to constant color in REG[92h] for this operation only, then back to the canvas color depth.
+ *		  Fading a picture to or from a color needs no image filled with that color.
+ */
+void Ra8876_Lite::bteMemoryCopyWithOpacity(    
+								uint32_t s0_addr,
+                                uint16_t s0_image_width,
+                                uint16_t s0_x, uint16_t s0_y,
+                                Color    s1_color,
+                                uint32_t des_addr,
+                                uint16_t des_image_width,
+                                uint16_t des_x, uint16_t des_y,
+                                uint16_t copy_width, uint16_t copy_height,
+                                uint8_t  alpha)
+{
+  uint8_t depth = getColorDepth()-1;	//RA8876_S0_COLOR_DEPTH_8BPP to RA8876_S0_COLOR_DEPTH_24BPP
+
+  bte_Source0_MemoryStartAddr(s0_addr);
+  bte_Source0_ImageWidth(s0_image_width);
+  bte_Source0_WindowStartXY(s0_x,s0_y);   
+  bte_DestinationMemoryStartAddr(des_addr);
+  bte_DestinationImageWidth(des_image_width);
+  bte_DestinationWindowStartXY(des_x,des_y);
+  bte_WindowSize(copy_width,copy_height);
+
+  lcdRegDataWrite(RA8876_BTE_COLR,depth<<5|RA8876_S1_CONSTANT_COLOR<<2|depth);//92h
+  lcdRegDataWrite(RA8876_S1_RED,s1_color.r);//9dh
+  lcdRegDataWrite(RA8876_S1_GREEN,s1_color.g);//9eh
+  lcdRegDataWrite(RA8876_S1_BLUE,s1_color.b);//9fh
+  lcdRegDataWrite(RA8876_BTE_CTRL1,RA8876_BTE_MEMORY_COPY_WITH_OPACITY);//91h 
+  
+  if(alpha>32) alpha=32;
+  lcdRegDataWrite(RA8876_APB_CTRL, alpha);//b5h
+  
+  lcdRegDataWrite(RA8876_BTE_CTRL0,RA8876_BTE_ENABLE<<4);//90h
+  check2dBusy();
+  lcdRegDataWrite(RA8876_BTE_COLR,depth<<5|depth<<2|depth);//92h
+}
+
+/**
+ * @brief Select Picture mode or Pixel mode opacity for S1 in REG[92h]
+ * @param mode is false for Picture mode with the alpha level of REG[B5h],
+ *        true for Pixel mode with the alpha of each S1 pixel
+ * @return true if Pixel mode is set, false for Picture mode, which is also the fallback at 24BPP
+ * @note  Pixel mode reads S1 in ARGB4444 on a 16BPP canvas, or in ARGB2222 on an 8BPP canvas (COLOR_12BPP_ARGB4444
+ *        and COLOR_6BPP_ARGB2222 data formats). S0 and destination stay at the canvas color depth.
+ */
+bool Ra8876_Lite::bte_OpacityMode(bool mode)
+{
+  uint8_t depth = getColorDepth()-1;	//RA8876_S0_COLOR_DEPTH_8BPP to RA8876_S0_COLOR_DEPTH_24BPP
+
+  if(mode && depth!=RA8876_S0_COLOR_DEPTH_24BPP)
+  {
+    if(depth==RA8876_S0_COLOR_DEPTH_16BPP)
+      lcdRegDataWrite(RA8876_BTE_COLR,depth<<5|RA8876_S1_16BIT_PIXEL_ALPHA_BLENDING<<2|depth);//92h
+    else
+      lcdRegDataWrite(RA8876_BTE_COLR,depth<<5|RA8876_S1_8BIT_PIXEL_ALPHA_BLENDING<<2|depth);//92h
+    return true;
+  }
+  lcdRegDataWrite(RA8876_BTE_COLR,depth<<5|depth<<2|depth);//92h
+  return false;
+}
+
+/**
+ * @brief This function blends s0 & s1 images to a destination in memory, with an alpha level for the whole picture
+ *        or an alpha channel in s1 pixels.
+ * @param alpha is the alpha level of Picture mode from 0 to 32, not used in Pixel mode
+ * @param mode is false for Picture mode, true for Pixel mode
+ * @note  See the function above for the other parameters.<br>
+ *        In Pixel mode s1 is an ARGB4444 image (ARGB2222 at 8BPP), e.g. a sprite or an anti-aliased overlay with
+ *        its own alpha channel, and Output Effect = (S0 image x (1 - s1 alpha)) + (S1 image x s1 alpha).
+ *        Blending such a sprite over a background is this single BTE operation with S0 and destination on the background.
+ *        A 24BPP canvas has no Pixel mode, alpha is used as in Picture mode.
+ */
+void Ra8876_Lite::bteMemoryCopyWithOpacity(    
+								uint32_t s0_addr,
+                                uint16_t s0_image_width,
+                                uint16_t s0_x, uint16_t s0_y,
+                                uint32_t s1_addr,
+                                uint16_t s1_image_width,
+                                uint16_t s1_x, uint16_t s1_y,
+                                uint32_t des_addr,
+                                uint16_t des_image_width,
+                                uint16_t des_x, uint16_t des_y,
+                                uint16_t copy_width, uint16_t copy_height,
+                                uint8_t  alpha,
+                                bool     mode)
+{
+  if(!mode || !bte_OpacityMode(true))
+  {
+    bteMemoryCopyWithOpacity(s0_addr, s0_image_width, s0_x, s0_y, s1_addr, s1_image_width, s1_x, s1_y,
+                             des_addr, des_image_width, des_x, des_y, copy_width, copy_height, alpha);
+    return;
+  }
+
+  bte_Source0_MemoryStartAddr(s0_addr);
+  bte_Source0_ImageWidth(s0_image_width);
+  bte_Source0_WindowStartXY(s0_x,s0_y);   
+  bte_Source1_MemoryStartAddr(s1_addr);
+  bte_Source1_ImageWidth(s1_image_width);
+  bte_Source1_WindowStartXY(s1_x,s1_y);
+  bte_DestinationMemoryStartAddr(des_addr);
+  bte_DestinationImageWidth(des_image_width);
+  bte_DestinationWindowStartXY(des_x,des_y);
+  bte_WindowSize(copy_width,copy_height);     
+  lcdRegDataWrite(RA8876_BTE_CTRL1,RA8876_BTE_MEMORY_COPY_WITH_OPACITY);//91h 
+  lcdRegDataWrite(RA8876_BTE_CTRL0,RA8876_BTE_ENABLE<<4);//90h
+  check2dBusy();
+  bte_OpacityMode(false);
+}
+
+/**
+ * @brief This function blends a picture written by the MCU (S0) with s1 image to a destination in memory
+ * @param s1_addr is the physical address of s1 image in SDRAM
+ * @param s1_image_width is the s1 image width
+ * @param s1_x, s1_y are the upper left corner of s1 image
+ * @param des_addr is the physical address of the destination image in SDRAM
+ * @param des_image_width is the image width of the destination image
+ * @param des_x, des_y are the upper left corner of the destination
+ * @param copy_width, copy_height are the dimensions of the picture
+ * @param alpha is the alpha level of Picture mode from 0 to 32, not used in Pixel mode
+ * @param mode is false for Picture mode, true for Pixel mode with the alpha channel of s1 pixels (ARGB4444, ARGB2222 at 8BPP)
+ * @param data is copy_width*copy_height pixels at the canvas color depth, written in one SPI burst
+ * @note  Output Effect = (S0 image x (1 - alpha)) + (S1 image x alpha).
+ *        In Pixel mode an overlay with its own alpha channel kept in SDRAM as s1 is blended over pictures streamed from the MCU.
+ */
 void Ra8876_Lite::bteMpuWriteWithOpacity( uint32_t s1_addr,
                                           uint16_t s1_image_width,
                                           uint16_t s1_x, uint16_t s1_y,
@@ -4164,9 +8018,28 @@ void Ra8876_Lite::bteMpuWriteWithOpacity( uint32_t s1_addr,
                                           bool     mode,
                                           const uint8_t* data)
 {
-  
+  bte_Source1_MemoryStartAddr(s1_addr);
+  bte_Source1_ImageWidth(s1_image_width);
+  bte_Source1_WindowStartXY(s1_x,s1_y);
+  bte_DestinationMemoryStartAddr(des_addr);
+  bte_DestinationImageWidth(des_image_width);
+  bte_DestinationWindowStartXY(des_x,des_y);
+  bte_WindowSize(copy_width,copy_height);
+  lcdRegDataWrite(RA8876_BTE_CTRL1,RA8876_BTE_MPU_WRITE_WITH_OPACITY);//91h
+
+  if(!bte_OpacityMode(mode))
+  {
+    if(alpha>32) alpha=32;
+    lcdRegDataWrite(RA8876_APB_CTRL, alpha);//b5h
+  }
+
+  lcdRegDataWrite(RA8876_BTE_CTRL0,RA8876_BTE_ENABLE<<4);//90h
+  ramAccessPrepare();
+  hal_spi_write(data, (uint32_t)copy_width*copy_height*getColorDepth());
+  checkWriteFifoEmpty();
+  check2dBusy();
+  if(mode) bte_OpacityMode(false);
 }
-*/
 
 /**
  * @brief This function fills a rectangular area of the SDRAM with a solid color.<br>
@@ -4244,6 +8117,19 @@ void Ra8876_Lite:: setSerialFlash(uint8_t scs_select)
 											uint16_t copy_width,uint16_t copy_height,
 											uint16_t picture_width,
 											uint32_t src_addr)
+ {
+	dma_BlockStart(x0, y0, copy_width, copy_height, picture_width, src_addr);
+	check2dBusy(); 
+ }
+
+/**
+ * @brief 	Start a Block Mode DMA from serial flash and return without waiting for it, see dmaDataBlockTransfer().
+ * @note	The core is busy until the transfer ends, check2dBusy(1) returns false when it is done.
+ */
+ void Ra8876_Lite::dma_BlockStart(	uint16_t x0,uint16_t y0,
+									uint16_t copy_width,uint16_t copy_height,
+									uint16_t picture_width,
+									uint32_t src_addr)
  {	 
  #if defined (BOARD_VERSION_2)
 	//128Mbit Serial Flash on board version 2
@@ -4269,7 +8155,6 @@ void Ra8876_Lite:: setSerialFlash(uint8_t scs_select)
 	lcdRegDataWrite(RA8876_DMA_SSTR2,src_addr>>16);//beh
 	lcdRegDataWrite(RA8876_DMA_SSTR3,src_addr>>24);//bfh  
 	lcdRegDataWrite(RA8876_DMA_CTRL,RA8876_DMA_START);//b6h 
-	check2dBusy(); 
  }
 
  /**
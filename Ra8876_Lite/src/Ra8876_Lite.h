@@ -77,15 +77,40 @@
 #include "Color/Color.h"
 #include "util/printf.h"
 #include "hw_font/hw_font.h"
+#include "util/utf8.h"
+#include "rle/rleImage.h"
+#include "jpeg/jpegDec.h"
+#include "gif/gifDec.h"
+#include "clock/clockPlan.h"
 
 #if defined (LOAD_BFC_FONT)
 	#include "bfc/bfcFontMgr.h"
+	#include "bfc/bfcLayout.h"
+	#include "bfc/bfcPacked.h"
 #endif
 
 #if defined (LOAD_SD_LIBRARY)
 	#include <SD.h>
 #endif	
 
+#define RLE_BURST_SIZE		240	///Bytes of pixels gathered by the RLE image decoder for one SPI burst, a multiple of 1, 2 and 3 bytes per pixel
+
+#define JPEG_STRIP_SIZE		3072	///Bytes of decoded JPEG pixels written per block write, 1536 at least for a 4:2:0 picture in 24BPP
+#define GIF_STRIP_SIZE		3840	///Bytes of decoded GIF rows written per BTE MPU write, at least one row of the widest frame
+#define MEM_READ_BURST_SIZE	16		///Bytes of SDRAM read per SPI burst, each after the Memory Read FIFO is found full. Not above RA8876_RD_FIFO_DEPTH
+
+#if defined (LOAD_SD_LIBRARY)
+	#define RLE_SD_BUFFER_SIZE	512	///Bytes of an RLE image read from SD card at a time, one SD sector
+	#define BMP_CAPTURE_BUFFER_SIZE	1024	///Bytes of a BMP capture written to SD card at a time, a multiple of 512
+#endif
+
+#if defined (LOAD_BFC_FONT) && defined (LOAD_SD_LIBRARY)
+	#define BFC_BIN_NAME_MAX	32	///Max. length of a *.bin font filename kept by the font index cache
+	#define BFC_BIN_GLYPH_BUFFER_SIZE	512	///Bytes of a *.bin glyph read from SD card at a time for a rotated character, whole rows
+	#define BFC_ADVANCE_CACHE_SIZE	64	///Number of entries in the advance width cache of a *.bin font, must be a power of 2
+	#define BFC_ADVANCE_CACHE_FONTS	2	///Number of *.bin fonts with an advance width cache, for text that switches fonts
+#endif
+
 /**
  * @note  More about Canvas : <br>
  * Graphic contents on the LCD(or HDTV) are updated by data in SDRAM which is divided into several image buffers limited by the memory size.<br>
@@ -122,6 +147,9 @@ namespace {
 	const uint16_t ACTIVE_WINDOW_STARTX = 0;	///Default Active window (the area to update) start x with Canvas Start Address as the reference
 	const uint16_t ACTIVE_WINDOW_STARTY = 0;	///Default Active window start y with Canvas Start Address as the reference
 	const uint16_t VSYNC_TIMEOUT_MS		= 50;	///Maximum timeout in millisec in function Ra8876_Lite::vsyncWait()
+	const uint32_t CGRAM_START_ADDR		= MEM_SIZE_MAX-16l*1024l;	///User-defined Characters at the top 16KB of SDRAM, enough for 256 characters of 16x32
+	const uint8_t GRAPHIC_CURSOR_COUNT	= 4;	///Shapes held by the graphic cursor RAM
+	const uint8_t GRAPHIC_CURSOR_SIZE	= 32;	///Width & height of a graphic cursor shape, 256 bytes in 2bpp
 }
 
 
@@ -136,6 +164,97 @@ enum COLOR_MODE {
   COLOR_12BPP_ARGB4444=5  	//12BPP with ARGB of 4bits each, input data format=G[7:4]B[7:4], A[3:0]R[7:4]
   };
 
+/**
+ * @note  Flipbook of frames stored back to back in serial flash, played by Ra8876_Lite::flipbookUpdate().<br>
+ *		  Each frame is loaded by DMA into the page not shown, and the two pages are swapped at vsync.
+ */
+typedef struct FLIPBOOK
+{
+	uint32_t	src_addr;		/* serial flash address of frame 0 */
+	uint32_t	frameBytes;		/* bytes between frames in serial flash */
+	uint16_t	width, height;
+	uint16_t	numFrames;
+	uint16_t	fps;			/* target frame rate */
+	uint16_t	loopCount;		/* 0 to loop forever */
+	uint32_t	page[2];		/* Canvas line offsets of the two pages, page[0] is the one shown before playback */
+
+	/* playback state of Ra8876_Lite::flipbookUpdate() */
+	uint16_t	current;		/* frame shown */
+	uint16_t	pending;		/* frame in the back page, loaded or being loaded by DMA */
+	uint16_t	loops;
+	uint8_t		front;			/* index of the page shown */
+	uint8_t		playing;		/* 0 idle, 1 playing, 2 ended */
+	uint32_t	t0;				/* millis() due for frame 0 of the current loop */
+	uint32_t	shown;			/* frames flipped to the screen */
+	uint32_t	dropped;		/* frames skipped to keep the frame rate */
+	uint8_t		vsyncArmed;		/* the back page is due, waiting for a vsync after vsyncArmedAt */
+	uint32_t	vsyncArmedAt;	/* millis() the VSYNC flag was reset */
+} FLIPBOOK;
+
+/**
+ * @note  Transitions of Ra8876_Lite::transitionBegin() from the screen to a new picture prepared off-screen
+ */
+enum TRANSITION_TYPE {
+  TRANSITION_CROSSFADE=0,	//blend the screen into the new picture
+  TRANSITION_FADE_OUT,		//blend the screen into a color, the new picture is not used
+  TRANSITION_FADE_IN,		//blend a color into the new picture
+  TRANSITION_WIPE_RIGHT,	//reveal the new picture from left to right
+  TRANSITION_WIPE_DOWN,		//reveal the new picture from top to bottom
+  TRANSITION_SLIDE_LEFT,	//push the screen out to the left, needs a Canvas twice as wide as the screen
+  TRANSITION_SLIDE_UP,		//push the screen out to the top
+  TRANSITION_DISSOLVE		//reveal the new picture pixel by pixel in an ordered dither of 16x16 blocks
+  };
+
+typedef struct TRANSITION
+{
+	uint8_t		type;			/* TRANSITION_xxx */
+	uint16_t	duration;		/* in ms */
+	uint32_t	src;			/* Canvas line offset of the new picture, a full screen */
+	uint32_t	work;			/* Canvas line offset of the work area */
+	Color		color;			/* color to fade to or from */
+
+	/* state of Ra8876_Lite::transitionUpdate() */
+	uint32_t	t0;				/* millis() at the start */
+	uint32_t	last;			/* millis() of the last step */
+	uint16_t	level;			/* progress done in alpha, pixels or dissolve threshold */
+	uint8_t		state;			/* 0 idle, 1 running, 2 moving the display window back, 3 done */
+} TRANSITION;
+
+/**
+ * @note  The two picture-in-picture windows shown over the Main Window, PIP1 on top of PIP2
+ */
+enum PIP_ID {
+  PIP1=0,
+  PIP2=1
+  };
+
+/**
+ * @note  2-bit pixels of a graphic cursor shape, the leftmost pixel of a byte in bit[7:6]
+ */
+enum CURSOR_PIXEL {
+  CURSOR_COLOR0=0,			//color0 of Ra8876_Lite::cursorColor()
+  CURSOR_COLOR1=1,			//color1 of Ra8876_Lite::cursorColor()
+  CURSOR_TRANSPARENT=2,		//the screen below
+  CURSOR_INVERT=3			//the screen below inverted
+  };
+
+/**
+ * @note  Picture-in-picture window of Ra8876_Lite::pipCreate(). Changes are kept here and written to REG[10h], REG[11h]
+ *		  and REG[2Ah]-[3Bh] at vsync by Ra8876_Lite::pipUpdate().
+ */
+typedef struct PIP_WINDOW
+{
+	uint32_t	addr;			/* SDRAM address of the source image, a multiple of 4 */
+	uint16_t	image_width;	/* width of the source image in pixels, a multiple of 4 */
+	uint16_t	src_x, src_y;	/* upper left of the window in the source image, src_x a multiple of 4 */
+	uint16_t	x, y;			/* upper left of the window on the screen, x a multiple of 4 */
+	uint16_t	width, height;	/* size of the window, width a multiple of 4 */
+	COLOR_MODE	mode;			/* COLOR_8BPP_RGB332, COLOR_16BPP_RGB565 or COLOR_24BPP_RGB888 */
+	uint8_t		created;
+	uint8_t		enabled;
+	uint8_t		dirty;			/* window changed since the last pipUpdate() */
+} PIP_WINDOW;
+
 /**
  * @note  RA8876 class for Arduino/mbed
  */
@@ -147,12 +266,41 @@ class Ra8876_Lite
   SPIClass *_SPI;
   bool _initialised = false;
   COLOR_MODE _colorMode;
+  CLOCK_PLAN _clock;        ///clocks of RA8876 planned for lcd
   //This irq flagto be set in isr() function in main.
   volatile bool _irqEventTrigger = false;
    
   ///@note Canvas width & height, and they can be larger than the LCD dimensions
   uint16_t _canvasWidth;
   uint16_t _canvasHeight;
+
+  ///@note PIP1 & PIP2 as they are or will be after the next pipUpdate()
+  PIP_WINDOW _pip[2];
+  bool _pipPending;
+
+  ///@note Hot spot of each graphic cursor shape, the point cursorMove() places at (x,y)
+  uint8_t _cursorHot[GRAPHIC_CURSOR_COUNT][2];
+  uint8_t _cursorIndex;
+
+  ///@note Bytes known free in memory write FIFO without a status read, and the font of a text run in progress
+  uint8_t _wrFifoCredit;
+  const HW_FONT *_hwTextRunFont;
+
+#if defined (LOAD_BFC_FONT)
+  ///@note Range index of the last BFC font in use, rebuilt only when a different font is passed in
+  BFC_FONT_INDEX _bfcIndex;
+  ///@note Header of the last packed font in use, decoded again only when a different font is passed in
+  BFCP_FONT _bfcpFont;
+  const uint8_t *_bfcpKey;
+#if defined (LOAD_SD_LIBRARY)
+  BFC_FONT_INDEX _bfcBinIndex;
+  char _bfcBinName[BFC_BIN_NAME_MAX];
+  ///@note Advance width caches of the last *.bin fonts in use, _bfcAdvanceFont is the one of _bfcBinIndex
+  char _bfcAdvanceName[BFC_ADVANCE_CACHE_FONTS][BFC_BIN_NAME_MAX];
+  BFC_GLYPH _bfcAdvanceCache[BFC_ADVANCE_CACHE_FONTS][BFC_ADVANCE_CACHE_SIZE];
+  uint8_t _bfcAdvanceFont, _bfcAdvanceNext;
+#endif
+#endif
     
   void     hal_bsp_init(void);
   void     hal_gpio_write(uint8_t pin, bool level);
@@ -175,6 +323,11 @@ class Ra8876_Lite
   void 		lcdDataWrite16bpp(uint16_t data); 
   
   bool     ra8876PllInitial (uint16_t pclk);  
+  bool     ra8876PclkDividers(uint16_t pclk, CLOCK_PLL *pll);
+  bool     ra8876ClockPlan(CLOCK_PLAN *plan);
+  void     lcd_Load(const LCDParam *timing, MonitorInfo *edid, bool automatic);
+  bool     edidTimingSupported(const DetailedTiming *dt);
+  void     lcd_Timing(bool on);
   bool     ra8876SdramInitial(void);  
   
   /**
@@ -205,10 +358,50 @@ class Ra8876_Lite
   void 		putPicture_set_frame(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint32_t lnOffset=CANVAS_OFFSET);
   int32_t 	canvasAddress_from_lnOffset(uint32_t lnOffset);
   
+  /* Run-length compressed image decoder */
+  uint32_t	rle_Available(RLE_READER *rd);
+  int		rle_ReadByte(RLE_READER *rd);
+  Color		rle_PixelColor(const uint8_t *px);
+  void		rle_Fill(uint16_t x, uint16_t y, uint16_t width, uint16_t *cx, uint16_t *cy, uint32_t count);
+  bool		rle_Draw(uint16_t x, uint16_t y, const RLE_IMAGE *pImage, RLE_READER *rd, uint32_t lnOffset);
+
+  /* JPEG and GIF decoders, strips go to the canvas by active window block write or to any image by BTE MPU write */
+  typedef struct IMAGE_TARGET
+  {
+	Ra8876_Lite	*lcd;
+	uint16_t	x, y;
+	uint32_t	addr;		///BTE destination address, or the line offset of a canvas target
+	uint16_t	imageWidth;	///BTE destination image width, 0 for a canvas target
+	const uint8_t *key;		///Pixel set as chroma key before the first strip, NULL if none
+  } IMAGE_TARGET;
+  static int img_DrawStrip(void *user, uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint8_t *pixels);
+  JPEG_DEC*	jpg_Open(const uint8_t *data, uint32_t size, JPEG_READ_FN read, void *user, const char *pName);
+  bool		jpg_Draw(JPEG_DEC *dec, IMAGE_TARGET *target, uint8_t scale);
+  GIF_DEC*	gif_Open(const uint8_t *data, uint32_t size, GIF_READ_FN read, void *user, const char *pName);
+  int		gif_Load(GIF_DEC *dec, GIF_ANIM *anim, uint32_t sdram_addr, uint32_t sdram_size);
+  void		gif_Fill(uint32_t des_addr, uint16_t des_image_width, uint16_t x, uint16_t y, uint16_t width, uint16_t height, Color color);
+  void		flip_Load(FLIPBOOK *fb, uint16_t frame, uint16_t x, uint16_t y);
+  void		tr_Step(TRANSITION *t, uint16_t level);
+  void		dma_BlockStart(uint16_t x0, uint16_t y0, uint16_t copy_width, uint16_t copy_height, uint16_t picture_width, uint32_t src_addr);
+  void		mem_ReadFrame(uint32_t addr, uint16_t image_width, uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+  void		mem_ReadRestore(void);
+  void		mem_ReadBurst(uint8_t *buf, uint32_t byte_count);
+  bool		vsync_Fresh(uint8_t *armed, uint32_t *armedAt);
+  
   /* Display Window (Main Window) setup */
   void displayImageStartAddress(uint32_t addr);
   void displayImageWidth(uint16_t width);
   void displayWindowStartXY(uint16_t x0,uint16_t y0);
+
+  /* Picture-in-picture windows */
+  uint8_t	pip_ColorDepth(COLOR_MODE mode);
+  void		pip_Pend(void);
+  void		pip_ControlWrite(uint8_t select);
+  void		pip_WindowWrite(uint8_t pip);
+
+  /* Graphic cursor */
+  void		cursor_Select(uint8_t index);
+  bool		cursor_Load(uint8_t index, const uint8_t *shape, const uint8_t *image, const uint8_t *mask, uint8_t hot_x, uint8_t hot_y);
   
   /**
    * @note BTE related functions
@@ -223,10 +416,27 @@ class Ra8876_Lite
   void bte_DestinationImageWidth(uint16_t width);
   void bte_DestinationWindowStartXY(uint16_t x0,uint16_t y0);
   void bte_WindowSize(uint16_t width, uint16_t height);
+  bool bte_OpacityMode(bool mode);
   
   /* BFC font related functions */
 #if defined (LOAD_BFC_FONT)
   Color bfc_GetColorBasedPixel(uint8_t pixel, uint8_t bpp, Color src_color, Color bg);
+  Color bfc_ChromaKey(uint8_t bpp, Color color, Color bg);
+  /* Glyph pixels streamed to an active window block write or a BTE MPU write, see glyph_StreamLevel() */
+  typedef struct GLYPH_STREAM
+  {
+	const uint8_t *palette = NULL;	///Pixel bytes of each level, 3 bytes per level, NULL to blend color with bg for each pixel
+	const uint8_t *key = NULL;		///Pixel bytes of the chroma key sent for level 0, NULL if level 0 is blended as the others
+	Color		color, bg;			///Font and background colors blended by bfc_GetColorBasedPixel() if palette is NULL
+	uint8_t		bpp = 1;
+	uint8_t		pixel_bytes = 0;	///Bytes per pixel of palette and key
+	bool		expand = false;		///true to pack 1bpp levels 8 pixels per byte for a BTE color expansion
+	uint8_t		n = 0, bits = 0, nbits = 0;
+	uint8_t		buf[48];
+  } GLYPH_STREAM;
+  void glyph_StreamLevel(GLYPH_STREAM *s, uint8_t level);
+  void glyph_StreamLineEnd(GLYPH_STREAM *s, bool flush);
+  void bfc_DrawRotated(uint16_t x0, uint16_t y0, const uint8_t *pData, uint16_t width, uint16_t height, int bpp, bool bLittleEndian, Color color, Color bg, uint32_t lnOffset);
   int bfc_DrawChar_RowRowUnpacked(
   uint16_t x0, uint16_t y0, 
   const BFC_FONT *pFont, 
@@ -245,7 +455,32 @@ class Ra8876_Lite
   Color bg, 
   bool rotate_ccw90=false,
   uint32_t lnOffset=CANVAS_OFFSET);
+  int bfc_DrawChar_RowRowUnpacked(
+  uint16_t x0, uint16_t y0, 
+  File &fontFile, 
+  uint16_t ch, 
+  Color color, 
+  Color bg, 
+  bool rotate_ccw90=false,
+  uint32_t lnOffset=CANVAS_OFFSET);
+  bool bfc_BinIndexLoad(File &fontFile, const char *pFilename);
+  bool bfc_BinCharInfoRead(File &fontFile, uint16_t ch, BFC_BIN_CHARINFO *pInfo);
+  void bfc_AdvanceCacheReset(void);
+  void bfc_AdvanceCacheSelect(const char *pFilename);
+  uint16_t bfc_BinCharWidth(File &fontFile, uint16_t ch);
+  uint16_t bfc_LayoutShape(BFC_TEXT_LAYOUT *layout, const char *pFilename, uint16_t line_height, bool ellipsis);
 #endif
+  const BFC_CHARINFO* bfc_GetCharInfo(const BFC_FONT *pFont, uint16_t ch);
+  void bfc_LayoutBegin(BFC_TEXT_LAYOUT *layout, uint16_t box_width, uint16_t box_height, BFC_ALIGN align);
+  void bfc_LayoutCopy(BFC_TEXT_LAYOUT *layout, const uint16_t *str16, const char *str8);
+  uint16_t bfc_LayoutLines(BFC_TEXT_LAYOUT *layout, uint16_t line_height, uint16_t dot_advance);
+  uint16_t bfc_LayoutShape(BFC_TEXT_LAYOUT *layout, const BFC_FONT *pFont, uint16_t line_height, bool ellipsis);
+  bool bfcp_Open(const uint8_t *pFont);
+  uint8_t bfcp_ColorBytes(Color color, uint8_t *buf);
+  void bfcp_DrawGlyph(uint16_t x, uint16_t y0, const BFCP_GLYPH *pGlyph, const uint8_t *palette, uint8_t pixel_bytes, uint32_t lnOffset);
+  void bfcp_DrawGlyphRotated(uint16_t x, uint16_t y0, const BFCP_GLYPH *pGlyph, const uint8_t *palette, uint8_t pixel_bytes, uint32_t lnOffset);
+  uint16_t bfcp_String(uint16_t x0, uint16_t y0, const uint16_t *str16, const char *str8, Color color, Color bg, bool rotate_ccw90, uint32_t lnOffset, bool draw);
+  const HW_FONT* bfc_CgramLoad(const BFC_FONT *pFont, const uint16_t *str16, const char *str8, uint8_t first_code);
 #endif
 
   /* Switch between Text(hardware) vs Graphic mode */
@@ -253,6 +488,11 @@ class Ra8876_Lite
   void setHwTextParameter1(FONT_SRC source_select, FONT_HEIGHT size_select, FONT_CODE iso_select);//cch
   void setHwTextParameter2(uint8_t align, bool chroma_key, uint8_t width_enlarge, uint8_t height_enlarge, bool rotate_ccw90=false);//cdh 
   void genitopCharacterRomParameter(FONT_CODE coding, uint8_t gt_width, GT_FONT_ROM part_no=FONT_ROM_GT21L16T1W, uint8_t scs_select=RA8876_SERIAL_FLASH_SELECT0);//b7h,bbh,ceh,cfh
+  void hwTextBegin(const HW_FONT *pFont);
+  void hwTextEnd(void);
+  void hwTextWrite(const uint8_t *buf, uint32_t byte_count);
+  void hwTextWrite(const uint16_t *str);
+  void hwTextWriteUtf8(const HW_FONT *pFont, const char *str);
   
   /* Pixel-wise rotation */
   void rotateCw90(uint16_t *x, uint16_t *y);
@@ -265,12 +505,18 @@ public:
 
   Ra8876_Lite(uint8_t xnscs, uint8_t xnreset, uint8_t mosi, uint8_t miso, uint8_t sck);
   bool  begin(const LCDParam *timing=&CEA_1280x720p_60Hz, MonitorInfo *edid=NULL, bool automatic = false);
+  bool  reconfigure(const LCDParam *timing, MonitorInfo *edid=NULL, bool automatic = false);
   bool  initialised(void) {return _initialised;}; 
   void  displayOn(bool on);
   
   COLOR_MODE  getColorMode(void);
   uint8_t	  getColorDepth(void);
   
+  /**
+   * @brief  Clocks in use with the SDRAM timing and theoretical fill & copy rates of BTE, see clockPlan.h
+   */
+  const CLOCK_PLAN *getClockPlan(void) {return &_clock;}
+  
   void setForegroundColor(Color color);
   void setBackgroundColor(Color color);
   
@@ -280,6 +526,7 @@ public:
   uint8_t 	irqEventQuery(void);
   void		irqEventFlagReset(uint8_t event);
   void		vsyncWait(void);
+  bool		vsyncPoll(void);
   
  /**
   * @brief   Return monitor width in pixels. <br>
@@ -335,6 +582,12 @@ public:
   void canvasWrite(uint16_t width, uint16_t height, const char *pFilename, uint32_t lnOffset);
   #endif
   void canvasRead (void  *data, uint32_t lnOffset, size_t data_count); 
+  ///Burst readback of a rectangle from any image in SDRAM, saved to SD card as BMP by captureBmp()
+  void canvasRead (void  *data, uint32_t addr, uint16_t image_width, uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+  #if defined (LOAD_SD_LIBRARY)
+  bool captureBmp(const char *pFilename, uint32_t addr, uint16_t image_width, uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+  bool captureScreen(const char *pFilename);
+  #endif
   
   void canvasImageStartAddress(uint32_t addr);
   void canvasImageWidth(uint16_t width, uint16_t height);
@@ -346,6 +599,24 @@ public:
   uint16_t x0=MAIN_WINDOW_STARTX, 
   uint16_t y0=MAIN_WINDOW_STARTY, 
   uint32_t offset=MAIN_WINDOW_OFFSET);
+
+  ///Picture-in-picture windows PIP1 & PIP2 over the Main Window, changes are written at vsync by pipUpdate()
+  bool pipCreate(uint8_t pip, uint32_t addr, uint16_t image_width, uint16_t x, uint16_t y, uint16_t width, uint16_t height, COLOR_MODE mode=COLOR_16BPP_RGB565);
+  void pipMove(uint8_t pip, uint16_t x, uint16_t y);
+  void pipResize(uint8_t pip, uint16_t width, uint16_t height);
+  void pipSource(uint8_t pip, uint32_t addr, uint16_t image_width, uint16_t src_x=0, uint16_t src_y=0);
+  bool pipColorMode(uint8_t pip, COLOR_MODE mode);
+  void pipEnable(uint8_t pip, bool on);
+  bool pipUpdate(bool wait=true);
+  const PIP_WINDOW *getPip(uint8_t pip) {return &_pip[pip&1];}
+
+  ///Graphic cursor of 32x32 pixels over everything on the screen, moved by its position registers only
+  bool cursorLoad(uint8_t index, const uint8_t *shape, uint8_t hot_x=0, uint8_t hot_y=0);
+  bool cursorLoad(uint8_t index, const uint8_t *image, const uint8_t *mask, uint8_t hot_x=0, uint8_t hot_y=0);
+  void cursorSelect(uint8_t index);
+  void cursorColor(Color color0, Color color1);
+  void cursorMove(int16_t x, int16_t y);
+  void cursorEnable(bool on);
   
   /*graphic function*/
   void graphicMode(bool on);
@@ -359,6 +630,42 @@ public:
   void putPicture(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const String& pFilename, bool rotate_ccw90=false, uint32_t lnOffset=CANVAS_OFFSET){
   putPicture(x,y,width,height,pFilename.c_str(), rotate_ccw90, lnOffset);}
   #endif
+  ///Run-length compressed image from extras/rlepack, long runs are drawn by BTE solid fill
+  bool putRlePicture(uint16_t x, uint16_t y, const uint8_t *data, uint32_t lnOffset=CANVAS_OFFSET);
+  #if defined (LOAD_SD_LIBRARY)
+  bool putRlePicture(uint16_t x, uint16_t y, const char *pFilename, uint32_t lnOffset=CANVAS_OFFSET);
+  bool putRlePicture(uint16_t x, uint16_t y, const String& pFilename, uint32_t lnOffset=CANVAS_OFFSET){
+  return putRlePicture(x,y,pFilename.c_str(),lnOffset);}
+  #endif
+  ///Baseline JPEG decoded on the fly at 1/1, 1/2, 1/4 or 1/8 (scale 0 to 3)
+  bool getJpegSize(const uint8_t *data, uint32_t size, uint16_t *width, uint16_t *height);
+  bool putJpeg(uint16_t x, uint16_t y, const uint8_t *data, uint32_t size, uint8_t scale=0, uint32_t lnOffset=CANVAS_OFFSET);
+  bool bteJpeg(uint32_t des_addr, uint16_t des_image_width, uint16_t des_x, uint16_t des_y, const uint8_t *data, uint32_t size, uint8_t scale=0);
+  #if defined (LOAD_SD_LIBRARY)
+  bool getJpegSize(const char *pFilename, uint16_t *width, uint16_t *height);
+  bool putJpeg(uint16_t x, uint16_t y, const char *pFilename, uint8_t scale=0, uint32_t lnOffset=CANVAS_OFFSET);
+  bool putJpeg(uint16_t x, uint16_t y, const String& pFilename, uint8_t scale=0, uint32_t lnOffset=CANVAS_OFFSET){
+  return putJpeg(x,y,pFilename.c_str(),scale,lnOffset);}
+  bool bteJpeg(uint32_t des_addr, uint16_t des_image_width, uint16_t des_x, uint16_t des_y, const char *pFilename, uint8_t scale=0);
+  #endif
+  ///Animated GIF decoded once into SDRAM, each frame is then shown by one BTE memory copy
+  int  gifLoad(GIF_ANIM *anim, const uint8_t *data, uint32_t size, uint32_t sdram_addr, uint32_t sdram_size);
+  #if defined (LOAD_SD_LIBRARY)
+  int  gifLoad(GIF_ANIM *anim, const char *pFilename, uint32_t sdram_addr, uint32_t sdram_size);
+  #endif
+  void gifShowFrame(const GIF_ANIM *anim, uint16_t frame, uint16_t x, uint16_t y, uint32_t lnOffset=CANVAS_OFFSET);
+  void gifRewind(GIF_ANIM *anim);
+  bool gifUpdate(GIF_ANIM *anim, uint16_t x, uint16_t y, uint32_t lnOffset=CANVAS_OFFSET);
+  void gifPlay(GIF_ANIM *anim, uint16_t x, uint16_t y, uint16_t loops=1, uint32_t lnOffset=CANVAS_OFFSET);
+  ///Flipbook video from serial flash, DMA into a back page while the front page is shown
+  void flipbookInit(FLIPBOOK *fb, uint32_t src_addr, uint16_t width, uint16_t height, uint16_t numFrames, uint16_t fps, uint32_t backLnOffset);
+  void flipbookRewind(FLIPBOOK *fb);
+  bool flipbookUpdate(FLIPBOOK *fb, uint16_t x, uint16_t y);
+  void flipbookStop(FLIPBOOK *fb);
+  void flipbookPlay(FLIPBOOK *fb, uint16_t x, uint16_t y, uint16_t loops=1);
+  ///Transition from the screen to a picture prepared off-screen, one step per vsync
+  bool transitionBegin(TRANSITION *t, uint8_t type, uint32_t srcLnOffset, uint16_t duration, uint32_t workLnOffset, Color color=Color());
+  bool transitionUpdate(TRANSITION *t);
  
   /* Hardware text function*/
   void setHwTextColor(Color text_color);
@@ -372,6 +679,23 @@ public:
   void putHwString(const HW_FONT *pFont, const uint16_t *str);
   void putHwString(const HW_FONT *pFont, const String &str) 
   {putHwString(pFont, str.c_str());}
+  void putHwStringUtf8(const HW_FONT *pFont, const char *str);
+  void putHwStringUtf8(const HW_FONT *pFont, const String &str) 
+  {putHwStringUtf8(pFont, str.c_str());}
+  ///Text run: font, cursor and mode set once for many strings printed one after another
+  void beginHwTextRun(const HW_FONT *pFont, uint16_t x, uint16_t y, uint32_t lnOffset=CANVAS_OFFSET);
+  void putHwTextRun(const char *str);
+  void putHwTextRun(const uint16_t *str);
+  void putHwTextRun(const String &str) 
+  {putHwTextRun(str.c_str());}
+  void putHwTextRunUtf8(const char *str);
+  void setHwTextRunColor(Color text_color);
+  void endHwTextRun(void);
+#if defined (LOAD_BFC_FONT)
+  ///User-defined Characters from a BFC font, printed by putHwString() with the returned HW_FONT
+  const HW_FONT* cgramLoadBfcChars(const BFC_FONT *pFont, const char *chars, uint8_t first_code=0);
+  const HW_FONT* cgramLoadBfcChars(const BFC_FONT *pFont, const uint16_t *chars, uint8_t first_code=0);
+#endif
 
 #if defined (LOAD_BFC_FONT)
 	uint16_t putBfcChar  (uint16_t x0,uint16_t y0, const BFC_FONT *pFont, const uint16_t ch, Color color, Color bg, bool rotate_ccw90=false, uint32_t lnOffset=CANVAS_OFFSET);
@@ -385,6 +709,29 @@ public:
 	uint16_t getBfcStringWidth(const BFC_FONT *pFont, const String &str)
 	{uint16_t width = getBfcStringWidth(pFont, str.c_str()); return width;}
 	uint16_t getBfcFontHeight(const BFC_FONT *pFont);
+	///String into any image in SDRAM (e.g. an Allegro BITMAP) with clipping, one BTE window per character
+	uint16_t bteBfcString(uint32_t des_addr, uint16_t des_image_width, int16_t x0, int16_t y0,
+						  uint16_t clip_x1, uint16_t clip_y1, uint16_t clip_x2, uint16_t clip_y2,
+						  const BFC_FONT *pFont, const char *str, Color color, Color bg);
+	
+	///Text layout: shape once with word wrap, alignment and ellipsis, then render in a single pass
+	uint16_t layoutBfcText(BFC_TEXT_LAYOUT *layout, const BFC_FONT *pFont, const uint16_t *str, uint16_t box_width, uint16_t box_height=0, BFC_ALIGN align=BFC_ALIGN_LEFT, uint16_t line_height=0, bool ellipsis=false);
+	uint16_t layoutBfcText(BFC_TEXT_LAYOUT *layout, const BFC_FONT *pFont, const char *str, uint16_t box_width, uint16_t box_height=0, BFC_ALIGN align=BFC_ALIGN_LEFT, uint16_t line_height=0, bool ellipsis=false);
+	uint16_t layoutBfcText(BFC_TEXT_LAYOUT *layout, const BFC_FONT *pFont, const String &str, uint16_t box_width, uint16_t box_height=0, BFC_ALIGN align=BFC_ALIGN_LEFT, uint16_t line_height=0, bool ellipsis=false)
+	{return layoutBfcText(layout, pFont, str.c_str(), box_width, box_height, align, line_height, ellipsis);}
+	uint16_t drawBfcLayout(const BFC_TEXT_LAYOUT *layout, uint16_t x0, uint16_t y0, Color color, Color bg, bool rotate_ccw90=false, uint32_t lnOffset=CANVAS_OFFSET);
+	
+	///Packed fonts converted by extras/bfcpack, glyphs go to RA8876 by BTE without per-pixel decoding
+	uint16_t putBfcPackedChar  (uint16_t x0,uint16_t y0, const uint8_t *pFont, const uint16_t ch, Color color, Color bg, bool rotate_ccw90=false, uint32_t lnOffset=CANVAS_OFFSET);
+	uint16_t putBfcPackedString(uint16_t x0,uint16_t y0, const uint8_t *pFont, const uint16_t *str, Color color, Color bg, bool rotate_ccw90=false, uint32_t lnOffset=CANVAS_OFFSET);
+	uint16_t putBfcPackedString(uint16_t x0,uint16_t y0, const uint8_t *pFont, const char *str, Color color, Color bg, bool rotate_ccw90=false, uint32_t lnOffset=CANVAS_OFFSET);
+	uint16_t putBfcPackedString(uint16_t x0,uint16_t y0, const uint8_t *pFont, const String &str, Color color, Color bg, bool rotate_ccw90=false, uint32_t lnOffset=CANVAS_OFFSET)
+	{return putBfcPackedString(x0, y0, pFont, str.c_str(), color, bg, rotate_ccw90, lnOffset);}
+	uint16_t getBfcPackedStringWidth(const uint8_t *pFont, const uint16_t *str);
+	uint16_t getBfcPackedStringWidth(const uint8_t *pFont, const char *str);
+	uint16_t getBfcPackedStringWidth(const uint8_t *pFont, const String &str)
+	{return getBfcPackedStringWidth(pFont, str.c_str());}
+	uint16_t getBfcPackedFontHeight(const uint8_t *pFont);
 	///If no SD card is available, const data stored in MCU's Flash or ext. Flash is the only option.
 	///For small system (Arduino or mbed) it is not advised.
 	#if defined (LOAD_SD_LIBRARY)
@@ -406,6 +753,11 @@ public:
 	{uint16_t width = getBfcStringWidth(pFilename, str.c_str()); return width;}
 	uint16_t getBfcStringWidth(const char *pFilename, const uint16_t *str);
 	uint16_t getBfcFontHeight(const char *pFilename);
+	
+	uint16_t layoutBfcText(BFC_TEXT_LAYOUT *layout, const char *pFilename, const uint16_t *str, uint16_t box_width, uint16_t box_height=0, BFC_ALIGN align=BFC_ALIGN_LEFT, uint16_t line_height=0, bool ellipsis=false);
+	uint16_t layoutBfcText(BFC_TEXT_LAYOUT *layout, const char *pFilename, const char *str, uint16_t box_width, uint16_t box_height=0, BFC_ALIGN align=BFC_ALIGN_LEFT, uint16_t line_height=0, bool ellipsis=false);
+	uint16_t layoutBfcText(BFC_TEXT_LAYOUT *layout, const char *pFilename, const String &str, uint16_t box_width, uint16_t box_height=0, BFC_ALIGN align=BFC_ALIGN_LEFT, uint16_t line_height=0, bool ellipsis=false)
+	{return layoutBfcText(layout, pFilename, str.c_str(), box_width, box_height, align, line_height, ellipsis);}
 	#endif
 #endif
   
@@ -523,6 +875,16 @@ public:
                                 uint16_t des_x, uint16_t des_y,
                                 uint16_t copy_width, uint16_t copy_height,
                                 uint8_t  alpha);
+
+  void bteMemoryCopyWithOpacity(uint32_t s0_addr,
+                                uint16_t s0_image_width,
+                                uint16_t s0_x, uint16_t s0_y,
+                                Color    s1_color,
+                                uint32_t des_addr,
+                                uint16_t des_image_width,
+                                uint16_t des_x, uint16_t des_y,
+                                uint16_t copy_width, uint16_t copy_height,
+                                uint8_t  alpha);
 								
   void bteMemoryCopyWithOpacity(  uint32_t s0_addr,
                                   uint16_t s0_image_width,
@@ -590,4 +952,4 @@ extern Ra8876_Lite ra8876lite;
 
 #endif
 
-
+
@@ -25,6 +25,9 @@
 #define RA8876_STSR_OP_MODE_INHIBIT (1<<1)  //Operation inhibit
 #define RA8876_STSR_IRQ_ACTIVED     (1<<0)  //interrupt active
 
+#define RA8876_WR_FIFO_DEPTH        16      //Memory write FIFO depth in bytes, free to write without polling once STSR bit6 reads empty
+#define RA8876_RD_FIFO_DEPTH        16      //Memory read FIFO depth in bytes, buffered once STSR bit5 reads full
+
 /*RA8876,8877 register & bit*/
 #define RA8876_SRR  0x00
 #define RA8876_SOFTWARE_RESET  0xD7
@@ -215,6 +218,12 @@
 #define RA8876_PWH1     0x3B
 
 #define RA8876_GTCCR    0x3C
+#define RA8876_GRAPHIC_CURSOR_DISABLE  0
+#define RA8876_GRAPHIC_CURSOR_ENABLE   1
+#define RA8876_SELECT_GRAPHIC_CURSOR1  0
+#define RA8876_SELECT_GRAPHIC_CURSOR2  1
+#define RA8876_SELECT_GRAPHIC_CURSOR3  2
+#define RA8876_SELECT_GRAPHIC_CURSOR4  3
 #define RA8876_BTCR     0x3D
 #define RA8876_CURHS    0x3E
 #define RA8876_CURVS    0x3F
@@ -667,4 +676,4 @@
 
 #endif
 
-
+
@@ -48,6 +48,7 @@ const int SDCARD_CS_PIN = 10;
 const int SDCARD_MOSI_PIN = RA8876_MOSI;
 const int SDCARD_SCK_PIN = RA8876_SCK;
 const int RA8876_XNINTR = 2;
+const int CH703X_IRQ = 6;		//Pin D15 for Teensy 3.2/3.5
 #elif defined (ESP8266)
 const int RA8876_XNSCS = 15;
 const int RA8876_XNRESET = 16;
@@ -58,6 +59,7 @@ const int SDCARD_CS_PIN = 2;
 const int SDCARD_MOSI_PIN = RA8876_MOSI;
 const int SDCARD_SCK_PIN = RA8876_SCK;
 const int RA8876_XNINTR = 0;
+const int CH703X_IRQ = -1;		//no free pin, GPIO5 is SCL of Wire. HPD is polled
 #elif defined (ESP32)
 const int RA8876_XNSCS = 5;
 const int RA8876_XNRESET = 10;
@@ -73,6 +75,7 @@ const int SDCARD_SCK_PIN = 14;	//HSPI SCK
 
 const int CH7035_SDA = 32;
 const int CH7035_SCL = 33;
+const int CH703X_IRQ = -1;		//no free pin, GPIO5 is RA8876_XNSCS. HPD is polled
 #else
 //Arduino Due, M0, or Arduino 101
 const int RA8876_XNSCS = 10;
@@ -84,6 +87,7 @@ const int SDCARD_CS_PIN = 4;
 const int SDCARD_MOSI_PIN = RA8876_MOSI;
 const int SDCARD_SCK_PIN = RA8876_SCK;
 const int RA8876_XNINTR = 3;
+const int CH703X_IRQ = 5;		//Pin D5 for Due, M0/M0 PRO, Curie
 #endif
 
 
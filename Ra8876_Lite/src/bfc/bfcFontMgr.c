@@ -132,4 +132,136 @@ const BFC_CHARINFO* GetCharInfo(const BFC_FONT *pFont, unsigned short ch)
 
 	return pCharInfo;
 }
-
+
+
+
+/**
+ * @brief	Build a font index from a C font for fast character lookup
+ * @param	*pFont is a pointer to BFC_FONT in MCU's Flash
+ * @param	*pIndex points to the index to fill
+ * @return	Number of ranges indexed, or -1 if the font is not valid or it has more than BFC_INDEX_MAX_RANGES ranges.
+ *			In case of -1, pIndex->pKey is set to 0 and GetCharInfo() should be used instead.
+ * @note	The linked list of BFC_FONT_PROP is walked only once here. After that, GetCharInfoIndexed() locates
+ *			a character by binary search in O(log n) with n the number of ranges.
+ */
+int BuildFontIndex(const BFC_FONT *pFont, BFC_FONT_INDEX *pIndex)
+{
+	const BFC_FONT_PROP *pProp;
+	unsigned short n = 0;
+
+	if(pIndex == 0)
+		return -1;
+
+	pIndex->pKey = 0;
+	pIndex->NumRanges = 0;
+	pIndex->LastHit = 0;
+
+	if(pFont == 0 || pFont->p.pProp == 0)
+		return -1;
+
+	for(pProp = pFont->p.pProp; pProp != 0; pProp = pProp->pNextProp)
+	{
+		if(n >= BFC_INDEX_MAX_RANGES)
+		{
+			pIndex->NumRanges = 0;
+			return -1;
+		}
+		pIndex->Ranges[n].FirstChar = pProp->FirstChar;
+		pIndex->Ranges[n].LastChar  = pProp->LastChar;
+		pIndex->Ranges[n].u.pFirstCharInfo = pProp->pFirstCharInfo;
+		n++;
+	}
+
+	pIndex->NumRanges  = n;
+	pIndex->FontType   = pFont->FontType;
+	pIndex->FontHeight = pFont->FontHeight;
+	pIndex->Baseline   = pFont->Baseline;
+	SortFontIndex(pIndex);
+	pIndex->pKey = pFont;
+
+	return n;
+}
+
+/**
+ * @brief	Sort ranges of a font index in ascending order of FirstChar
+ * @param	*pIndex points to the index to sort
+ * @note	BitFontCreator normally writes ranges in ascending order already, so insertion sort finishes in one pass.
+ */
+void SortFontIndex(BFC_FONT_INDEX *pIndex)
+{
+	unsigned short i, j;
+	BFC_RANGE key;
+
+	for(i = 1; i < pIndex->NumRanges; i++)
+	{
+		key = pIndex->Ranges[i];
+		j = i;
+		while(j > 0 && pIndex->Ranges[j-1].FirstChar > key.FirstChar)
+		{
+			pIndex->Ranges[j] = pIndex->Ranges[j-1];
+			j--;
+		}
+		pIndex->Ranges[j] = key;
+	}
+	pIndex->LastHit = 0;
+}
+
+/**
+ * @brief	Find the range holding a character by binary search
+ * @param	*pIndex points to a valid font index
+ * @param	ch is the character to search
+ * @return	Array index of the range in pIndex->Ranges[], or -1 if "ch" is not rendered in this font
+ */
+int FindCharRange(BFC_FONT_INDEX *pIndex, unsigned short ch)
+{
+	const BFC_RANGE *pRange;
+	int lo, hi, mid;
+
+	if(pIndex == 0 || pIndex->NumRanges == 0)
+		return -1;
+
+	// same range as the previous lookup?
+	pRange = &pIndex->Ranges[pIndex->LastHit];
+	if( ch >= pRange->FirstChar && ch <= pRange->LastChar )
+		return pIndex->LastHit;
+
+	lo = 0;
+	hi = pIndex->NumRanges - 1;
+	while(lo <= hi)
+	{
+		mid = (lo + hi) >> 1;
+		pRange = &pIndex->Ranges[mid];
+		if( ch < pRange->FirstChar )
+			hi = mid - 1;
+		else if( ch > pRange->LastChar )
+			lo = mid + 1;
+		else
+		{
+			pIndex->LastHit = (unsigned short)mid;
+			return mid;
+		}
+	}
+
+	return -1;
+}
+
+/**
+ * @brief	Return BFC_CHARINFO pointer of a character from a font index built by BuildFontIndex()
+ * @param	*pIndex points to a valid font index
+ * @param	ch is the character to search
+ * @return	Pointer to BFC_CHARINFO of "ch". If "ch" is not rendered in this font the first character
+ *			in this font is returned as the default one, same as GetCharInfo().
+ */
+const BFC_CHARINFO* GetCharInfoIndexed(BFC_FONT_INDEX *pIndex, unsigned short ch)
+{
+	int i = FindCharRange(pIndex, ch);
+
+	if(i < 0)
+	{
+		if(pIndex == 0 || pIndex->pKey == 0)
+			return 0;
+		return ((const BFC_FONT *)pIndex->pKey)->p.pProp->pFirstCharInfo;
+	}
+
+	return pIndex->Ranges[i].u.pFirstCharInfo + (ch - pIndex->Ranges[i].FirstChar);
+}
@@ -3,6 +3,49 @@
 
 #include "bfcfont.h"
 
+/**
+ * @note	Max. number of character ranges a BFC_FONT_INDEX can hold, 8 bytes each on a 32-bit MCU.
+ *			The bundled fonts have up to 36 ranges (French_Script_MT55hAA4.c), SimHei.bin has 2.<br>
+ *			A font with more ranges than this cannot be indexed. Ra8876_Lite::bfc_GetCharInfo() then falls back
+ *			to GetCharInfo() with a linked list walk of the ranges for every character, and a *.bin font reads its
+ *			range table from the file. Raise it here for such a font.
+ */
+#ifndef BFC_INDEX_MAX_RANGES
+#define BFC_INDEX_MAX_RANGES	48
+#endif
+
+/**
+ * @note	One character range in a font index.<br>
+ *			For a C font (*.c file) u.pFirstCharInfo points to the BFC_CHARINFO of FirstChar.<br>
+ *			For a binary font (*.bin file) u.InfoIndex is the array index of FirstChar in BFC_BIN_CHARINFO[].
+ */
+typedef struct BFC_RANGE
+{
+	USHORT		FirstChar;
+	USHORT		LastChar;
+	union
+	{
+		const BFC_CHARINFO	*pFirstCharInfo;
+		ULONG				InfoIndex;
+	} u;
+} BFC_RANGE;
+
+/**
+ * @note	Font index built once per font with ranges sorted by FirstChar for binary search.<br>
+ *			LastHit remembers the range of the previous lookup because consecutive characters of a string
+ *			usually fall in the same range.
+ */
+typedef struct BFC_FONT_INDEX
+{
+	const void	*pKey;			/* BFC_FONT this index was built from, 0 if not valid */
+	ULONG		FontType;
+	USHORT		FontHeight;
+	USHORT		Baseline;
+	USHORT		NumRanges;
+	USHORT		LastHit;
+	BFC_RANGE	Ranges[BFC_INDEX_MAX_RANGES];
+} BFC_FONT_INDEX;
+
 #if defined(__cplusplus)
 extern "C" {     /* Make sure we have C-declarations in C++ programs */
 #endif
@@ -21,9 +64,17 @@ int   GetFontDataPack(unsigned long FontType);
 int   GetFontHeight(const BFC_FONT *pFont);
 //	get structure BFC_CHARINFO pointer
 const BFC_CHARINFO* GetCharInfo(const BFC_FONT *pFont, unsigned short ch);
+//	build a sorted range index from a C font, return number of ranges or -1 if not possible
+int   BuildFontIndex(const BFC_FONT *pFont, BFC_FONT_INDEX *pIndex);
+//	sort Ranges[] of an index by FirstChar
+void  SortFontIndex(BFC_FONT_INDEX *pIndex);
+//	return array index of the range holding "ch" in Ranges[], or -1 if not found
+int   FindCharRange(BFC_FONT_INDEX *pIndex, unsigned short ch);
+//	get structure BFC_CHARINFO pointer by binary search on an index built with BuildFontIndex()
+const BFC_CHARINFO* GetCharInfoIndexed(BFC_FONT_INDEX *pIndex, unsigned short ch);
 
 #ifdef __cplusplus
 }
 #endif
 #endif	//_BFC_FONT_MGR_H
-
+
@@ -0,0 +1,77 @@
+/**
+ * @file    bfcLayout.h
+ * @license BSD license, all text above and below must be included in any redistribution
+ *
+ * Text layout structures for BitFontCreator fonts.<br>
+ * A string is shaped once by Ra8876_Lite::layoutBfcText() into lines of positioned glyphs with their advance widths,
+ * then Ra8876_Lite::drawBfcLayout() renders all lines in a single pass without measuring the string again.
+ */
+
+#ifndef _BFC_LAYOUT_H
+#define _BFC_LAYOUT_H
+
+#include "bfcfont.h"
+
+#ifndef BFC_LAYOUT_MAX_GLYPHS
+#define BFC_LAYOUT_MAX_GLYPHS	128		/* max. number of glyphs in a layout, characters beyond are truncated */
+#endif
+
+#ifndef BFC_LAYOUT_MAX_LINES
+#define BFC_LAYOUT_MAX_LINES	8		/* max. number of lines in a layout */
+#endif
+
+#define BFC_ELLIPSIS_CHAR		'.'		/* character repeated 3 times for ellipsis */
+
+/**
+ * @note	Horizontal alignment of each line inside the layout box
+ */
+typedef enum {
+	BFC_ALIGN_LEFT = 0,
+	BFC_ALIGN_CENTER,
+	BFC_ALIGN_RIGHT
+} BFC_ALIGN;
+
+/**
+ * @note	A glyph with its advance width fetched once during layout
+ */
+typedef struct BFC_GLYPH
+{
+	USHORT		ch;				/* character code */
+	USHORT		advance;		/* advance width in pixels */
+} BFC_GLYPH;
+
+/**
+ * @note	A line of glyphs. Offsets are relative to the top left corner of the layout box.
+ */
+typedef struct BFC_LINE
+{
+	USHORT		first;			/* index of the first glyph in BFC_TEXT_LAYOUT::glyphs[] */
+	USHORT		count;			/* number of glyphs in this line */
+	short		x;				/* x offset after alignment */
+	short		y;				/* y offset of the line top */
+	USHORT		width;			/* line width in pixels */
+} BFC_LINE;
+
+/**
+ * @note	Result of Ra8876_Lite::layoutBfcText(). Declare it static or global as it takes around 600 bytes.
+ */
+typedef struct BFC_TEXT_LAYOUT
+{
+	const BFC_FONT	*pFont;		/* font in MCU's Flash, or 0 for a *.bin font */
+	const char		*pFilename;	/* *.bin font filename, or 0 for a font in MCU's Flash */
+	USHORT		boxWidth;		/* wrapping width, 0 for no wrapping */
+	USHORT		boxHeight;		/* max. height to fill, 0 for no limit other than BFC_LAYOUT_MAX_LINES */
+	USHORT		fontHeight;		/* FontHeight of the font */
+	USHORT		baseline;		/* Baseline of the font */
+	USHORT		lineHeight;		/* distance between tops of two lines */
+	USHORT		width;			/* width of the widest line */
+	USHORT		height;			/* height of all lines */
+	USHORT		numGlyphs;
+	USHORT		numLines;
+	UCHAR		align;			/* BFC_ALIGN */
+	UCHAR		truncated;		/* 1 if the text did not fit in the box or in the glyph and line buffers */
+	BFC_GLYPH	glyphs[BFC_LAYOUT_MAX_GLYPHS];
+	BFC_LINE	lines[BFC_LAYOUT_MAX_LINES];
+} BFC_TEXT_LAYOUT;
+
+#endif	//_BFC_LAYOUT_H
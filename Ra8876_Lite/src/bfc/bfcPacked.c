@@ -0,0 +1,138 @@
+#include "bfcPacked.h"
+
+/* little endian field readers, the byte array has no alignment guarantee in MCU's Flash */
+#define BFCP_U16(p)		((USHORT)((p)[0] | ((USHORT)(p)[1]<<8)))
+#define BFCP_U32(p)		((ULONG)(p)[0] | ((ULONG)(p)[1]<<8) | ((ULONG)(p)[2]<<16) | ((ULONG)(p)[3]<<24))
+
+/**
+ * @brief	Hash a character code into a slot of the hash table
+ * @param	ch is the character code
+ * @param	hashBits is log2 of the hash table size, 1 to 15
+ * @return	Slot index from 0 to (1<<hashBits)-1
+ * @note	Fibonacci hashing: multiply by 2^16/golden ratio and keep the top bits of the 16-bit product, so
+ *			consecutive code points of a character range spread over the whole table.
+ */
+USHORT BfcpHash(unsigned short ch, UCHAR hashBits)
+{
+	return (USHORT)((((ULONG)ch * 40503UL) & 0xFFFF) >> (16 - hashBits));
+}
+
+/**
+ * @brief	Decode the header of a packed font
+ * @param	*pData points to the packed font array
+ * @param	*pFont is the BFCP_FONT to fill in
+ * @return	0 on success, -1 if the magic number or version does not match
+ */
+int BfcpOpen(const UCHAR *pData, BFCP_FONT *pFont)
+{
+	ULONG hashSize, kernSize;
+
+	if(pData == 0 || BFCP_U32(pData) != BFCP_MAGIC || pData[4] != BFCP_VERSION)
+		return -1;
+
+	pFont->Bpp			= pData[5];
+	pFont->Flags		= pData[6];
+	pFont->HashBits		= pData[7];
+	pFont->FontHeight	= BFCP_U16(pData+8);
+	pFont->Baseline		= BFCP_U16(pData+10);
+	pFont->NumGlyphs	= BFCP_U16(pData+12);
+	pFont->NumKerns		= BFCP_U16(pData+14);
+	pFont->DefaultGlyph	= BFCP_U16(pData+16);
+
+	if(pFont->HashBits == 0 || pFont->HashBits > 15)
+		return -1;
+
+	hashSize = ((2UL << pFont->HashBits) + 3) & ~3UL;
+	kernSize = ((ULONG)pFont->NumKerns * BFCP_KERN_SIZE + 3) & ~3UL;
+
+	pFont->pHash	= pData + BFCP_HEADER_SIZE;
+	pFont->pGlyphs	= pFont->pHash + hashSize;
+	pFont->pKerns	= pFont->pGlyphs + (ULONG)pFont->NumGlyphs * BFCP_GLYPH_SIZE;
+	pFont->pData	= pFont->pKerns + kernSize;
+
+	return 0;
+}
+
+/**
+ * @brief	Find the glyph of a character by hash lookup
+ * @param	*pFont is a font decoded by BfcpOpen()
+ * @param	ch is the character code
+ * @return	Glyph index, or BFCP_NO_GLYPH if the font does not have this character
+ * @note	The table is filled with linear probing and is at least twice the number of glyphs,
+ *			so a lookup takes one or two probes on average regardless of the number of character ranges.
+ */
+USHORT BfcpFindGlyph(const BFCP_FONT *pFont, unsigned short ch)
+{
+	USHORT mask = (USHORT)((1U << pFont->HashBits) - 1);
+	USHORT slot = BfcpHash(ch, pFont->HashBits);
+	USHORT probe, index;
+
+	for(probe = 0; probe <= mask; probe++)
+	{
+		index = BFCP_U16(pFont->pHash + 2*slot);
+		if(index == BFCP_NO_GLYPH)
+			break;
+		if(BFCP_U16(pFont->pGlyphs + (ULONG)index * BFCP_GLYPH_SIZE) == ch)
+			return index;
+		slot = (slot + 1) & mask;
+	}
+
+	return BFCP_NO_GLYPH;
+}
+
+/**
+ * @brief	Decode one entry of the glyph table
+ * @param	*pFont is a font decoded by BfcpOpen()
+ * @param	index is the glyph index from BfcpFindGlyph()
+ * @param	*pGlyph is the BFCP_GLYPH to fill in
+ * @return	0 on success, -1 if index is out of range
+ */
+int BfcpGetGlyph(const BFCP_FONT *pFont, USHORT index, BFCP_GLYPH *pGlyph)
+{
+	const UCHAR *p;
+
+	if(index >= pFont->NumGlyphs)
+		return -1;
+
+	p = pFont->pGlyphs + (ULONG)index * BFCP_GLYPH_SIZE;
+	pGlyph->Code	= BFCP_U16(p);
+	pGlyph->Advance	= BFCP_U16(p+2);
+	pGlyph->pData	= pFont->pData + BFCP_U32(p+4);
+	pGlyph->Pitch	= p[8];
+	pGlyph->Top		= p[9];
+	pGlyph->Rows	= p[10];
+	pGlyph->Flags	= p[11];
+
+	return 0;
+}
+
+/**
+ * @brief	Return the kerning between two characters
+ * @param	*pFont is a font decoded by BfcpOpen()
+ * @param	left, right are the character codes in drawing order
+ * @return	Pixels to add to the advance width of "left", negative to move "right" closer
+ * @note	Binary search on the kerning table. Callers check BFCP_GLYPH_KERN of the left glyph first
+ *			to skip the search for characters without any pair.
+ */
+int BfcpGetKerning(const BFCP_FONT *pFont, unsigned short left, unsigned short right)
+{
+	ULONG key = ((ULONG)left << 16) | right;
+	int lo = 0, hi = (int)pFont->NumKerns - 1, mid;
+	const UCHAR *p;
+	ULONG pair;
+
+	while(lo <= hi)
+	{
+		mid = (lo + hi) >> 1;
+		p = pFont->pKerns + (ULONG)mid * BFCP_KERN_SIZE;
+		pair = ((ULONG)BFCP_U16(p) << 16) | BFCP_U16(p+2);
+		if(pair == key)
+			return (short)BFCP_U16(p+4);
+		if(pair < key)
+			lo = mid + 1;
+		else
+			hi = mid - 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file    bfcPacked.h
+ * @license BSD license, all text above and below must be included in any redistribution
+ *
+ * Packed font format converted from BitFontCreator fonts by the host tool extras/bfcpack.<br>
+ * All multi-byte fields are little endian. A font is a single byte array laid out as:<br>
+ *	BFCP_HEADER		24 bytes<br>
+ *	hash table		(1<<HashBits) x uint16_t glyph index, 0xFFFF for an empty slot, padded to 4 bytes<br>
+ *	glyph table		NumGlyphs x BFCP_GLYPH (12 bytes each)<br>
+ *	kerning table	NumKerns x BFCP_KERN (6 bytes each) sorted by (Left<<16 | Right), padded to 4 bytes<br>
+ *	bitmap data		DataSize bytes<br>
+ *
+ * Each glyph is a strip of FontHeight rows. Empty rows above Top and below Top+Rows are not stored.
+ * A stored row is Pitch bytes with pixels packed MSB first at Bpp bits per pixel, and the strip width is
+ * always a multiple of 8 pixels. For Bpp==1 a glyph is therefore in the exact layout of a BTE color expansion
+ * with 8-bit bus width and is sent to RA8876 without decoding.<br>
+ *
+ * With BFCP_FLAG_RLE_ROWS the bitmap data of a glyph is a list of runs instead of one block:
+ *	[skip][count] followed by count rows, repeated until Rows rows from Top are covered.
+ * skip is the number of empty rows before the run.
+ */
+
+#ifndef _BFC_PACKED_H
+#define _BFC_PACKED_H
+
+#include "bfcfont.h"
+
+#define BFCP_MAGIC				0x50434642UL	/* "BFCP" */
+#define BFCP_VERSION			1
+
+#define BFCP_HEADER_SIZE		24
+#define BFCP_GLYPH_SIZE			12
+#define BFCP_KERN_SIZE			6
+
+#define BFCP_FLAG_RLE_ROWS		0x01	/* glyph data stored as runs of rows, empty rows in between are skipped */
+#define BFCP_GLYPH_KERN			0x01	/* glyph is the left character of at least one kerning pair */
+#define BFCP_NO_GLYPH			0xFFFF
+
+/**
+ * @note	Font header decoded from the byte array by BfcpOpen()
+ */
+typedef struct BFCP_FONT
+{
+	const UCHAR	*pHash;			/* hash table */
+	const UCHAR	*pGlyphs;		/* glyph table */
+	const UCHAR	*pKerns;		/* kerning table */
+	const UCHAR	*pData;			/* bitmap data */
+	UCHAR		Bpp;			/* 1, 2 or 4 */
+	UCHAR		Flags;			/* BFCP_FLAG_xxx */
+	UCHAR		HashBits;
+	USHORT		FontHeight;
+	USHORT		Baseline;
+	USHORT		NumGlyphs;
+	USHORT		NumKerns;
+	USHORT		DefaultGlyph;	/* glyph index drawn for a character not in the font */
+} BFCP_FONT;
+
+/**
+ * @note	One glyph decoded from the glyph table by BfcpGetGlyph()
+ */
+typedef struct BFCP_GLYPH
+{
+	USHORT		Code;			/* character code */
+	USHORT		Advance;		/* advance width in pixels */
+	const UCHAR	*pData;			/* bitmap data or list of runs */
+	UCHAR		Pitch;			/* bytes per stored row */
+	UCHAR		Top;			/* first stored row */
+	UCHAR		Rows;			/* number of rows from Top to the last non-empty row */
+	UCHAR		Flags;			/* BFCP_GLYPH_xxx */
+} BFCP_GLYPH;
+
+#if defined(__cplusplus)
+extern "C" {     /* Make sure we have C-declarations in C++ programs */
+#endif
+
+//	decode the header of a packed font, return 0 on success or -1 if pData is not a packed font
+int   BfcpOpen(const UCHAR *pData, BFCP_FONT *pFont);
+//	return glyph index of "ch" by hash lookup, or BFCP_NO_GLYPH if not found
+USHORT BfcpFindGlyph(const BFCP_FONT *pFont, unsigned short ch);
+//	decode glyph table entry "index", return 0 on success or -1 if index is out of range
+int   BfcpGetGlyph(const BFCP_FONT *pFont, USHORT index, BFCP_GLYPH *pGlyph);
+//	return kerning in pixels to add between "left" and "right", 0 if there is no pair
+int   BfcpGetKerning(const BFCP_FONT *pFont, unsigned short left, unsigned short right);
+//	hash function shared by the host tool and the runtime
+USHORT BfcpHash(unsigned short ch, UCHAR hashBits);
+
+#ifdef __cplusplus
+}
+#endif
+#endif	//_BFC_PACKED_H
@@ -0,0 +1,109 @@
+#include "clockPlan.h"
+
+/**
+ * @brief	Exact pixel clock of a timing whose pclk is rounded to MHz in LcdParam.h
+ * @param	pclkMHz is LCDParam.pclk
+ * @return	pixel clock in kHz, e.g. 74250 for 74 of CEA 1280x720p
+ */
+uint32_t ClockPixelKHz(uint32_t pclkMHz)
+{
+	if(pclkMHz == 25)	return 25200;		/* CEA 640x480p */
+	if(pclkMHz == 74)	return 74250;		/* CEA 1280x720p, 1920x1080i */
+	if(pclkMHz == 148)	return 148500;		/* CEA 1920x1080p */
+	return pclkMHz*1000UL;
+}
+
+/**
+ * @brief	Search the dividers of a PLL for the clock closest to a target
+ * @param	oscKHz is the crystal frequency
+ * @param	targetKHz is the clock wanted
+ * @param	maxKHz is the ceiling, e.g. the max. stable core clock. Pass 0xFFFFFFFF for none
+ * @param	*pll returns the dividers and the clock they make
+ * @return	1 if found, 0 if no divider makes a clock not above maxKHz
+ * @note	Of two clocks as close, the lower one is taken. Of two dividers for the same clock, the one of higher VCO
+ *			frequency is taken for less jitter.
+ */
+int ClockPll(uint32_t oscKHz, uint32_t targetKHz, uint32_t maxKHz, CLOCK_PLL *pll)
+{
+	uint32_t ref, vco, f, err, best = 0xFFFFFFFFUL;
+	uint8_t m, k, n;
+
+	for(m = 0; m < 2; m++)
+	{
+		ref = oscKHz >> m;
+		if(ref < CLOCK_REF_MIN_KHZ || ref > CLOCK_REF_MAX_KHZ)
+			continue;
+
+		for(n = 63; n >= 1; n--)
+		{
+			vco = ref*(n+1);
+			if(vco < CLOCK_VCO_MIN_KHZ || vco > CLOCK_VCO_MAX_KHZ)
+				continue;
+
+			for(k = 0; k < 4; k++)
+			{
+				f = vco >> k;
+				if(f > maxKHz)
+					continue;
+				err = (f > targetKHz)? (f - targetKHz) : (targetKHz - f);
+				if(err < best || (err == best && f < pll->kHz))
+				{
+					best = err;
+					pll->divk = k;
+					pll->divm = m;
+					pll->divn = n;
+					pll->kHz = f;
+				}
+			}
+		}
+	}
+	return best != 0xFFFFFFFFUL;
+}
+
+/**
+ * @brief	Plan SCLK, CCLK and MCLK with the SDRAM timing for a display timing
+ * @param	*req is the display timing and the limits of the board
+ * @param	*plan returns the dividers, SDRAM timing and theoretical rates
+ * @return	CLOCK_OK, CLOCK_ERR_PCLK, CLOCK_ERR_CLOCK or CLOCK_ERR_BANDWIDTH
+ * @note	CCLK and MCLK are the highest the limits allow, independent of the pixel clock. MCLK is kept not below
+ *			CCLK. The rates are upper bounds: SDRAM page misses and refresh cycles are not counted.
+ */
+int ClockPlan(const CLOCK_REQUEST *req, CLOCK_PLAN *plan)
+{
+	uint32_t frame, active, avail;
+
+	if(req->pclkKHz == 0 || !ClockPll(req->oscKHz, req->pclkKHz, req->pclkMaxKHz, &plan->sclk))
+		return CLOCK_ERR_PCLK;
+	plan->pclkErrPpm = (int32_t)(((int64_t)plan->sclk.kHz - (int64_t)req->pclkKHz)*1000000L/(int64_t)req->pclkKHz);
+
+	if(!ClockPll(req->oscKHz, req->coreMaxKHz, req->coreMaxKHz, &plan->cclk) ||
+	   !ClockPll(req->oscKHz, req->sdramMaxKHz, req->sdramMaxKHz, &plan->mclk))
+		return CLOCK_ERR_CLOCK;
+	if(plan->mclk.kHz < plan->cclk.kHz && !ClockPll(req->oscKHz, plan->mclk.kHz, plan->mclk.kHz, &plan->cclk))
+		return CLOCK_ERR_CLOCK;
+
+	/* SDRAM timing of the MCLK made, not of its limit */
+	plan->casLatency = (plan->mclk.kHz <= CLOCK_CAS2_MAX_KHZ)? 2 : 3;
+	plan->autoRefresh = (uint16_t)((uint32_t)CLOCK_REFRESH_MS*plan->mclk.kHz/req->refreshRows);
+
+	/* display refresh reads the active pixels once a frame */
+	frame = (uint32_t)req->htotal*req->vtotal;
+	active = (uint32_t)req->width*req->height;
+	plan->sdramKBps = plan->mclk.kHz*2;
+	plan->displayKBps = (frame == 0)? 0 : (uint32_t)((uint64_t)plan->sclk.kHz*req->bpp*active/frame);
+	if(plan->displayKBps >= plan->sdramKBps || req->bpp == 0)
+	{
+		plan->fillKpps = plan->copyKpps = 0;
+		return CLOCK_ERR_BANDWIDTH;
+	}
+
+	avail = plan->sdramKBps - plan->displayKBps;
+	plan->fillKpps = avail/req->bpp;
+	if(plan->fillKpps > plan->cclk.kHz)
+		plan->fillKpps = plan->cclk.kHz;
+	plan->copyKpps = avail/(2*req->bpp);
+	if(plan->copyKpps > plan->cclk.kHz)
+		plan->copyKpps = plan->cclk.kHz;
+
+	return CLOCK_OK;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file    clockPlan.h
+ * @license BSD license, all text above and below must be included in any redistribution
+ *
+ * Clock planner of RA8876. For a display timing it works out the dividers of the three PLLs,<br>
+ *	SCLK	pixel clock, as close to the exact pixel clock as the dividers can make it
+ *	CCLK	core clock of BTE, DMA and graphic engines, the highest one not above the core limit
+ *	MCLK	SDRAM clock, the highest one not above the SDRAM limit and not below CCLK
+ * with the SDRAM CAS latency and auto refresh period of MCLK, and the theoretical rates of the 2D engine
+ * left by the display refresh.<br>
+ *
+ * Each PLL makes OSC*(PLLDIVN+1)/2^PLLDIVM/2^PLLDIVK, with 100MHz <= OSC*(PLLDIVN+1)/2^PLLDIVM <= 600MHz and
+ * 10MHz <= OSC/2^PLLDIVM <= 40MHz. All functions are pure, so the planner builds and runs on a PC as well.
+ *
+ * Usage:
+ *	CLOCK_REQUEST req = {12000, ClockPixelKHz(74), 148500, 120000, 166000, 1280, 720, 1650, 750, 2, 4096};
+ *	CLOCK_PLAN plan;
+ *	if(ClockPlan(&req, &plan) == CLOCK_OK)
+ *		printf("fill %lu kpixel/s\n", plan.fillKpps);
+ */
+
+#ifndef _CLOCK_PLAN_H
+#define _CLOCK_PLAN_H
+
+#include "stdint.h"
+
+#define CLOCK_VCO_MIN_KHZ		100000UL
+#define CLOCK_VCO_MAX_KHZ		600000UL
+#define CLOCK_REF_MIN_KHZ		10000UL		/* OSC/2^PLLDIVM */
+#define CLOCK_REF_MAX_KHZ		40000UL
+#define CLOCK_CAS2_MAX_KHZ		133000UL	/* CAS latency 2 up to this MCLK, 3 above */
+#define CLOCK_REFRESH_MS		64			/* all rows of SDRAM refreshed in this time */
+
+/* return codes */
+#define CLOCK_OK				0
+#define CLOCK_ERR_PCLK			-1		/* no divider makes the pixel clock */
+#define CLOCK_ERR_CLOCK			-2		/* no divider for CCLK or MCLK under their limits */
+#define CLOCK_ERR_BANDWIDTH		-3		/* display refresh takes all SDRAM bandwidth */
+
+/**
+ * @note	Dividers of a PLL, PLLDIVK and PLLDIVM go to bits [2:1] and [0] of REG[05h]/[07h]/[09h], PLLDIVN to
+ *			REG[06h]/[08h]/[0Ah]
+ */
+typedef struct CLOCK_PLL
+{
+	uint8_t		divk;			/* 0 to 3, output divided by 2^divk */
+	uint8_t		divm;			/* 0 to 1, input divided by 2^divm */
+	uint8_t		divn;			/* 1 to 63, multiplied by divn+1 */
+	uint32_t	kHz;			/* clock made */
+} CLOCK_PLL;
+
+/**
+ * @note	What the planner works from, a display timing and the limits of the board
+ */
+typedef struct CLOCK_REQUEST
+{
+	uint32_t	oscKHz;			/* crystal, 12000 on HDMI shield */
+	uint32_t	pclkKHz;		/* exact pixel clock, see ClockPixelKHz() */
+	uint32_t	pclkMaxKHz;		/* max. SCLK */
+	uint32_t	coreMaxKHz;		/* max. stable CCLK */
+	uint32_t	sdramMaxKHz;	/* max. MCLK of the SDRAM speed grade */
+	uint16_t	width, height;	/* active resolution */
+	uint16_t	htotal, vtotal;	/* active + blanking */
+	uint8_t		bpp;			/* bytes per pixel of the display, 1, 2 or 3 */
+	uint16_t	refreshRows;	/* rows of SDRAM to refresh, 4096 or 8192 for RA8876M */
+} CLOCK_REQUEST;
+
+/**
+ * @note	Clocks and SDRAM timing worked out by ClockPlan()
+ */
+typedef struct CLOCK_PLAN
+{
+	CLOCK_PLL	sclk, cclk, mclk;
+	int32_t		pclkErrPpm;		/* sclk.kHz against the exact pixel clock */
+	uint8_t		casLatency;		/* REG[E1h] */
+	uint16_t	autoRefresh;	/* REG[E2h]/[E3h], MCLK cycles between auto refresh */
+
+	/* theoretical rates, SDRAM of 16-bit bus at one word per MCLK, 2D engine at one pixel per CCLK */
+	uint32_t	sdramKBps;		/* SDRAM peak bandwidth in kB/s */
+	uint32_t	displayKBps;	/* taken by the display refresh */
+	uint32_t	fillKpps;		/* BTE solid fill, pixel written per second x1000 */
+	uint32_t	copyKpps;		/* BTE memory copy, pixel read and written per second x1000 */
+} CLOCK_PLAN;
+
+#if defined(__cplusplus)
+extern "C" {     /* Make sure we have C-declarations in C++ programs */
+#endif
+
+//	exact pixel clock in kHz of a timing with pclk rounded to MHz, e.g. 74250 for 74 of CEA 720p
+uint32_t ClockPixelKHz(uint32_t pclkMHz);
+//	dividers for the clock closest to targetKHz not above maxKHz, return 1 if found, 0 if none
+int   ClockPll(uint32_t oscKHz, uint32_t targetKHz, uint32_t maxKHz, CLOCK_PLL *pll);
+//	plan all clocks of a display timing, return CLOCK_OK or a negative error code
+int   ClockPlan(const CLOCK_REQUEST *req, CLOCK_PLAN *plan);
+
+#ifdef __cplusplus
+}
+#endif
+#endif	//_CLOCK_PLAN_H
@@ -543,37 +543,163 @@ decode_check_sum (const uchar *edid,
     info->checksum = check;
 }
 
-MonitorInfo *
-decode_edid (const uchar *edid)
+/**
+ * @note  CEA-861 video formats of progressive and interlaced scan without pixel repetition.
+ *        Pixel clock in kHz, vertical timing per field for interlaced formats.
+ */
+typedef struct
 {
-    MonitorInfo *info = calloc (1, sizeof (MonitorInfo));
+    uchar		vic;
+    unsigned short	h_addr, h_blank, h_front_porch, h_sync;
+    unsigned short	v_addr, v_blank, v_front_porch, v_sync;
+    unsigned long	pixel_clock;
+    uchar		interlaced;
+    uchar		positive_sync;
+} CeaVideoFormat;
+
+static const CeaVideoFormat cea_formats[] =
+{
+    {  1,  640, 160,  16, 96, 480, 45, 10, 2,  25175, 0, 0 },	/* 640x480p 59.94/60Hz */
+    {  2,  720, 138,  16, 62, 480, 45,  9, 6,  27000, 0, 0 },	/* 720x480p 4:3 */
+    {  3,  720, 138,  16, 62, 480, 45,  9, 6,  27000, 0, 0 },	/* 720x480p 16:9 */
+    {  4, 1280, 370, 110, 40, 720, 30,  5, 5,  74250, 0, 1 },	/* 1280x720p 60Hz */
+    {  5, 1920, 280,  88, 44, 540, 22,  2, 5,  74250, 1, 1 },	/* 1920x1080i 60Hz */
+    { 16, 1920, 280,  88, 44,1080, 45,  4, 5, 148500, 0, 1 },	/* 1920x1080p 60Hz */
+    { 17,  720, 144,  12, 64, 576, 49,  5, 5,  27000, 0, 0 },	/* 720x576p 4:3 */
+    { 18,  720, 144,  12, 64, 576, 49,  5, 5,  27000, 0, 0 },	/* 720x576p 16:9 */
+    { 19, 1280, 700, 440, 40, 720, 30,  5, 5,  74250, 0, 1 },	/* 1280x720p 50Hz */
+    { 20, 1920, 720, 528, 44, 540, 22,  2, 5,  74250, 1, 1 },	/* 1920x1080i 50Hz */
+    { 31, 1920, 720, 528, 44,1080, 45,  4, 5, 148500, 0, 1 },	/* 1920x1080p 50Hz */
+    { 32, 1920, 830, 638, 44,1080, 45,  4, 5,  74250, 0, 1 },	/* 1920x1080p 24Hz */
+    { 33, 1920, 720, 528, 44,1080, 45,  4, 5,  74250, 0, 1 },	/* 1920x1080p 25Hz */
+    { 34, 1920, 280,  88, 44,1080, 45,  4, 5,  74250, 0, 1 },	/* 1920x1080p 30Hz */
+};
 
-    decode_check_sum (edid, info);
-    
-    if (!decode_header (edid))
-	return NULL;
+int
+cea_vic_timing (int vic, DetailedTiming *detailed)
+{
+    unsigned int i;
 
-    if (!decode_vendor_and_product_identification (edid, info))
-	return NULL;
+    for (i = 0; i < sizeof (cea_formats) / sizeof (cea_formats[0]); ++i)
+    {
+	const CeaVideoFormat *f = &cea_formats[i];
+
+	if (f->vic != vic)
+	    continue;
+
+	memset (detailed, 0, sizeof (DetailedTiming));
+	detailed->pixel_clock = f->pixel_clock * 1000;
+	detailed->h_addr = f->h_addr;
+	detailed->h_blank = f->h_blank;
+	detailed->h_front_porch = f->h_front_porch;
+	detailed->h_sync = f->h_sync;
+	detailed->v_addr = f->v_addr;
+	detailed->v_blank = f->v_blank;
+	detailed->v_front_porch = f->v_front_porch;
+	detailed->v_sync = f->v_sync;
+	detailed->interlaced = f->interlaced;
+	detailed->digital_sync = TRUE;
+	detailed->digital.negative_vsync = !f->positive_sync;
+	detailed->digital.negative_hsync = !f->positive_sync;
+	return TRUE;
+    }
+    return FALSE;
+}
 
-    if (!decode_edid_version (edid, info))
-	return NULL;
+int
+decode_cea_extension (const uchar *ext, CeaInfo *cea)
+{
+    int i, d;
+    uchar check = 0;
 
-    if (!decode_display_parameters (edid, info))
-	return NULL;
+    memset (cea, 0, sizeof (CeaInfo));
 
-    if (!decode_color_characteristics (edid, info))
-	return NULL;
+    for (i = 0; i < 128; ++i)
+	check += ext[i];
 
-    if (!decode_established_timings (edid, info))
-	return NULL;
+    if (ext[0] != 0x02 || check != 0)
+	return FALSE;
 
-    if (!decode_standard_timings (edid, info))
+    cea->revision = ext[1];
+    d = ext[2];		/* offset of the first detailed timing */
+    if (d > 127 || (d != 0 && d < 4))
+	return FALSE;
+
+    if (cea->revision >= 2)
+    {
+	cea->underscan = get_bit (ext[3], 7);
+	cea->basic_audio = get_bit (ext[3], 6);
+	cea->ycbcr444 = get_bit (ext[3], 5);
+	cea->ycbcr422 = get_bit (ext[3], 4);
+	cea->n_native_dtds = get_bits (ext[3], 0, 3);
+    }
+
+    /* data block collection from byte 4 up to the first detailed timing, revision 3 and later */
+    for (i = 4; cea->revision >= 3 && i < d; )
+    {
+	int tag = get_bits (ext[i], 5, 7);
+	int len = get_bits (ext[i], 0, 4);
+	const uchar *data = ext + i + 1;
+	int k;
+
+	if (i + 1 + len > d)
+	    break;
+
+	if (tag == 2)		/* video data block */
+	{
+	    for (k = 0; k < len && cea->n_svd < CEA_MAX_SVD; ++k)
+	    {
+		uchar svd = data[k];
+
+		/* bit 7 is the native flag for VIC 1 to 64 only (CEA-861-F) */
+		cea->svd_native[cea->n_svd] = (svd >= 129 && svd <= 192);
+		cea->svd[cea->n_svd] = cea->svd_native[cea->n_svd]? (svd & 0x7F) : svd;
+		cea->n_svd++;
+	    }
+	}
+	else if (tag == 3 && len >= 3)	/* vendor specific data block */
+	{
+	    if (data[0] == 0x03 && data[1] == 0x0C && data[2] == 0x00)
+		cea->hdmi = TRUE;
+	}
+	i += 1 + len;
+    }
+
+    /* detailed timings up to the checksum, a zero pixel clock ends them */
+    for (i = d; d != 0 && i + 18 <= 127 && cea->n_detailed_timings < CEA_MAX_DETAILED; i += 18)
+    {
+	if (ext[i] == 0x00 && ext[i + 1] == 0x00)
+	    break;
+	decode_detailed_timing (ext + i, &(cea->detailed_timings[cea->n_detailed_timings++]));
+    }
+
+    return TRUE;
+}
+
+MonitorInfo *
+decode_edid (const uchar *edid)
+{
+    MonitorInfo *info = calloc (1, sizeof (MonitorInfo));
+
+    if (info == NULL)
 	return NULL;
-    
-    if (!decode_descriptors (edid, info))
+
+    decode_check_sum (edid, info);
+
+    /* free info on a broken block, CH703X::readEdid() is retried on a hot plug */
+    if (!decode_header (edid) ||
+	!decode_vendor_and_product_identification (edid, info) ||
+	!decode_edid_version (edid, info) ||
+	!decode_display_parameters (edid, info) ||
+	!decode_color_characteristics (edid, info) ||
+	!decode_established_timings (edid, info) ||
+	!decode_standard_timings (edid, info) ||
+	!decode_descriptors (edid, info))
+    {
+	free (info);
 	return NULL;
-    
+    }
+
     return info;
 }
 
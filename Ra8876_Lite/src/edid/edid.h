@@ -36,6 +36,7 @@ typedef unsigned char uchar;
 typedef struct MonitorInfo MonitorInfo;
 typedef struct Timing Timing;
 typedef struct DetailedTiming DetailedTiming;
+typedef struct CeaInfo CeaInfo;
 
 /**
  * @note  When no edid information can be fetched from a monitor,
@@ -205,9 +206,38 @@ struct MonitorInfo
     char		dsc_string[14];		/* Unspecified ASCII data */
 };
 
+#define CEA_MAX_SVD		32	/* short video descriptors kept from a CEA-861 extension */
+#define CEA_MAX_DETAILED	6	/* detailed timings fit in a CEA-861 extension */
+
+/**
+ * @note  CEA-861 extension block, the second 128 bytes of EDID of a HDTV or HDMI monitor.
+ */
+struct CeaInfo
+{
+    int			revision;
+    int			underscan;
+    int			basic_audio;
+    int			ycbcr444;
+    int			ycbcr422;
+    int			n_native_dtds;		/* number of native formats among the detailed timings */
+    int			hdmi;			/* HDMI vendor specific data block (IEEE OUI 00-0C-03) found */
+
+    int			n_svd;
+    uchar		svd[CEA_MAX_SVD];	/* VIC of each short video descriptor, in preference order */
+    uchar		svd_native[CEA_MAX_SVD];	/* 1 if the monitor says it is a native format */
+
+    int			n_detailed_timings;
+    DetailedTiming	detailed_timings[CEA_MAX_DETAILED];
+};
+
 MonitorInfo *decode_edid (const uchar *data);
 char *       make_display_name (const char *output_name, const MonitorInfo *info);
 
+/* decode a CEA-861 extension block, return 0 if it is not one or its checksum is wrong */
+int          decode_cea_extension (const uchar *ext, CeaInfo *cea);
+/* timing of a CEA-861 video identification code, v_addr & v_blank per field if interlaced; return 0 for an unknown VIC */
+int          cea_vic_timing (int vic, DetailedTiming *detailed);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,498 @@
+#include "gifDec.h"
+#include <string.h>
+
+/* first row and row step of the 4 passes of an interlaced image */
+static const uint8_t GIF_PASS_START[4] = {0, 4, 2, 1};
+static const uint8_t GIF_PASS_STEP[4]  = {8, 8, 4, 2};
+
+/*----------------------------------------------------------------------------------------------------------*/
+/* input                                                                                                    */
+/*----------------------------------------------------------------------------------------------------------*/
+/* return the number of bytes available at inPtr, refilling the input buffer from the read callback when empty */
+static int32_t gif_Available(GIF_DEC *d)
+{
+	if(d->inPtr == d->inEnd && d->read != 0)
+	{
+		int n = d->read(d->readUser, d->inBuf, GIF_INBUF_SIZE);
+		if(n <= 0)
+			return 0;
+		d->inPtr = d->inBuf;
+		d->inEnd = d->inBuf + n;
+	}
+	return (int32_t)(d->inEnd - d->inPtr);
+}
+
+static int gif_ReadByte(GIF_DEC *d)
+{
+	if(gif_Available(d) == 0)
+		return -1;
+	return *d->inPtr++;
+}
+
+static int32_t gif_ReadU16(GIF_DEC *d)
+{
+	int lo = gif_ReadByte(d);
+	int hi = gif_ReadByte(d);
+
+	if(lo < 0 || hi < 0)
+		return -1;
+	return lo | (hi << 8);
+}
+
+static int gif_Skip(GIF_DEC *d, uint32_t n)
+{
+	int32_t k;
+
+	while(n)
+	{
+		k = gif_Available(d);
+		if(k == 0)
+			return GIF_ERR_FORMAT;
+		if((uint32_t)k > n)
+			k = n;
+		d->inPtr += k;
+		n -= k;
+	}
+	return GIF_OK;
+}
+
+/* skip data sub-blocks up to and including the block terminator */
+static int gif_SkipBlocks(GIF_DEC *d)
+{
+	int n;
+
+	while((n = gif_ReadByte(d)) > 0)
+		if(gif_Skip(d, n) != GIF_OK)
+			return GIF_ERR_FORMAT;
+	return (n == 0) ? GIF_OK : GIF_ERR_FORMAT;
+}
+
+static int gif_ReadPalette(GIF_DEC *d, uint8_t *palette, uint16_t colors)
+{
+	uint16_t i;
+	int c;
+
+	for(i = 0; i < colors*3; i++)
+	{
+		c = gif_ReadByte(d);
+		if(c < 0)
+			return GIF_ERR_FORMAT;
+		palette[i] = c;
+	}
+	return GIF_OK;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+/* headers                                                                                                  */
+/*----------------------------------------------------------------------------------------------------------*/
+/**
+ * @brief	Parse the header, the logical screen descriptor and the global palette.
+ * @param	*dec is the decoder state to fill in
+ * @param	*data points to the whole file in memory, or NULL to read it by read(user)
+ * @param	size is the file size when data is not NULL
+ * @return	GIF_OK or GIF_ERR_FORMAT
+ */
+int GifOpen(GIF_DEC *dec, const uint8_t *data, uint32_t size, GIF_READ_FN read, void *user)
+{
+	uint8_t sig[6];
+	int32_t w, h;
+	int packed, c, i;
+
+	dec->inPtr = data;
+	dec->inEnd = data ? data + size : data;
+	dec->read = data ? 0 : read;
+	dec->readUser = user;
+
+	for(i = 0; i < 6; i++)
+	{
+		c = gif_ReadByte(dec);
+		if(c < 0)
+			return GIF_ERR_FORMAT;
+		sig[i] = c;
+	}
+	if(sig[0] != 'G' || sig[1] != 'I' || sig[2] != 'F' || sig[3] != '8' || (sig[4] != '7' && sig[4] != '9') || sig[5] != 'a')
+		return GIF_ERR_FORMAT;
+
+	w = gif_ReadU16(dec);
+	h = gif_ReadU16(dec);
+	packed = gif_ReadByte(dec);
+	c = gif_ReadByte(dec);
+	if(w <= 0 || h <= 0 || packed < 0 || c < 0 || gif_ReadByte(dec) < 0)
+		return GIF_ERR_FORMAT;
+
+	dec->width = w;
+	dec->height = h;
+	dec->background = c;
+	dec->loopCount = 1;
+	dec->globalColors = (packed & 0x80) ? 2 << (packed & 0x07) : 0;
+	dec->localColors = 0;
+	if(dec->globalColors)
+		return gif_ReadPalette(dec, dec->globalPalette, dec->globalColors);
+	return GIF_OK;
+}
+
+/**
+ * @brief	Parse extension blocks up to the next image descriptor.
+ * @param	*dec is a decoder opened by GifOpen()
+ * @return	1 with dec->frame filled in, 0 at the trailer or the end of file, GIF_ERR_FORMAT on a corrupted block
+ * @note	A Graphic Control Extension applies to the next image only. A NETSCAPE2.0 extension sets dec->loopCount
+ *			to the number of times to play the animation, 0 for ever.
+ */
+int GifNextFrame(GIF_DEC *dec)
+{
+	GIF_FRAME *f = &dec->frame;
+	uint8_t ident[11];
+	int32_t v[4];
+	int c, n, packed, i;
+
+	f->delay = 0;
+	f->disposal = GIF_DISPOSE_NONE;
+	f->transparent = -1;
+
+	for(;;)
+	{
+		c = gif_ReadByte(dec);
+		if(c < 0 || c == 0x3B)	//trailer, a truncated file ends at its last whole frame
+			return 0;
+
+		if(c == 0x2C)	//image descriptor
+		{
+			for(i = 0; i < 4; i++)
+				v[i] = gif_ReadU16(dec);
+			packed = gif_ReadByte(dec);
+			if(v[0] < 0 || v[1] < 0 || v[2] <= 0 || v[3] <= 0 || packed < 0)
+				return GIF_ERR_FORMAT;
+			f->x = v[0];
+			f->y = v[1];
+			f->w = v[2];
+			f->h = v[3];
+			f->interlaced = (packed & 0x40) != 0;
+			dec->localColors = (packed & 0x80) ? 2 << (packed & 0x07) : 0;
+			if(dec->localColors && gif_ReadPalette(dec, dec->localPalette, dec->localColors) != GIF_OK)
+				return GIF_ERR_FORMAT;
+			return 1;
+		}
+
+		if(c != 0x21)
+			return GIF_ERR_FORMAT;
+
+		c = gif_ReadByte(dec);	//extension label
+		n = gif_ReadByte(dec);	//size of the first sub-block
+		if(c < 0 || n < 0)
+			return GIF_ERR_FORMAT;
+
+		if(c == 0xF9 && n == 4)	//graphic control extension
+		{
+			packed = gif_ReadByte(dec);
+			v[0] = gif_ReadU16(dec);
+			v[1] = gif_ReadByte(dec);
+			if(packed < 0 || v[0] < 0 || v[1] < 0)
+				return GIF_ERR_FORMAT;
+			f->disposal = (packed >> 2) & 0x07;
+			f->delay = v[0];
+			f->transparent = (packed & 0x01) ? v[1] : -1;
+			n = 0;
+		}
+		else if(c == 0xFF && n == 11)	//application extension
+		{
+			for(i = 0; i < 11; i++)
+			{
+				c = gif_ReadByte(dec);
+				if(c < 0)
+					return GIF_ERR_FORMAT;
+				ident[i] = c;
+			}
+			n = gif_ReadByte(dec);
+			if(n == 3 && (memcmp(ident, "NETSCAPE2.0", 11) == 0 || memcmp(ident, "ANIMEXTS1.0", 11) == 0))
+			{
+				c = gif_ReadByte(dec);
+				v[0] = gif_ReadU16(dec);
+				if(c < 0 || v[0] < 0)
+					return GIF_ERR_FORMAT;
+				//the count is of repetitions after the first play, 0 to loop for ever
+				dec->loopCount = (v[0] == 0) ? 0 : (v[0] == 0xFFFF ? 0xFFFF : v[0] + 1);
+				n = 0;
+			}
+			if(n < 0)
+				return GIF_ERR_FORMAT;
+		}
+
+		if(gif_Skip(dec, n) != GIF_OK || gif_SkipBlocks(dec) != GIF_OK)
+			return GIF_ERR_FORMAT;
+	}
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+/* pixel output                                                                                             */
+/*----------------------------------------------------------------------------------------------------------*/
+/* rows of a frame gathered in the strip buffer */
+typedef struct GIF_OUT
+{
+	uint8_t		*strip;
+	uint16_t	stripRows;		/* rows that fit in the strip */
+	uint32_t	rowBytes;
+	uint16_t	outW, outH;		/* frame size clipped to the logical screen */
+	uint16_t	n;				/* rows in the strip */
+	uint16_t	y0;				/* frame row of the first row in the strip */
+	uint16_t	y;				/* frame row being decoded */
+	uint16_t	x;				/* pixel in that row */
+	uint16_t	rowsDone;
+	uint8_t		pass;
+	uint8_t		format;
+	uint8_t		stop;
+	GIF_DRAW_FN	draw;
+	void		*user;
+} GIF_OUT;
+
+static void gif_Flush(GIF_DEC *d, GIF_OUT *o)
+{
+	if(o->n && !o->stop)
+	{
+		if(o->draw(o->user, d->frame.x, d->frame.y + o->y0, o->outW, o->n, o->strip))
+			o->stop = 1;
+	}
+	o->n = 0;
+}
+
+/* a row is complete, move to the next one in decoding order and draw the strip when it cannot grow */
+static void gif_EndRow(GIF_DEC *d, GIF_OUT *o)
+{
+	GIF_FRAME *f = &d->frame;
+
+	if(o->y < o->outH)
+		o->n++;
+	o->rowsDone++;
+	o->x = 0;
+
+	if(f->interlaced)
+	{
+		o->y += GIF_PASS_STEP[o->pass];
+		while(o->y >= f->h && o->pass < 3)
+		{
+			o->pass++;
+			o->y = GIF_PASS_START[o->pass];
+		}
+	}
+	else
+		o->y++;
+
+	if(o->n && (o->n == o->stripRows || o->y != o->y0 + o->n || o->y >= o->outH || o->rowsDone == f->h))
+		gif_Flush(d, o);
+	if(o->n == 0)
+		o->y0 = o->y;
+}
+
+/*
+ * Pick the key color of transparent pixels, a pixel value that no opaque palette entry converts to.
+ * A palette has at most 255 opaque entries besides the transparent one, so there is always one even in RGB332.
+ */
+static void gif_PickKey(GIF_DEC *d, uint8_t *colorMap, uint16_t colors, uint8_t format)
+{
+	uint32_t cand;
+	uint16_t i;
+	uint8_t key[3];
+
+	for(cand = 0; cand < 0x1000000; cand++)
+	{
+		key[0] = cand;
+		key[1] = cand >> 8;
+		key[2] = cand >> 16;
+		for(i = 0; i < colors; i++)
+			if(i != d->frame.transparent && memcmp(colorMap + i*format, key, format) == 0)
+				break;
+		if(i == colors)
+			break;
+	}
+	memcpy(d->frame.key, key, 3);
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+/* LZW                                                                                                      */
+/*----------------------------------------------------------------------------------------------------------*/
+/**
+ * @brief	Decode the image found by GifNextFrame() and draw it strip by strip.
+ * @param	*dec is a decoder positioned by GifNextFrame()
+ * @param	format is GIF_OUT_RGB332, GIF_OUT_RGB565 or GIF_OUT_RGB888
+ * @param	*strip is a buffer of stripSize bytes for decoded pixels, reused for each strip
+ * @param	draw is called with each strip, (x,y) being in the logical screen
+ * @param	*user is passed to draw()
+ * @return	GIF_OK, GIF_ERR_FORMAT, GIF_ERR_DATA or GIF_ERR_BUFFER
+ * @note	A strip is as many consecutive rows as fit in the buffer. Rows of an interlaced image come one at a time
+ *			as they are not consecutive. Transparent pixels are set to dec->frame.key.
+ */
+int GifDecodeFrame(GIF_DEC *dec, uint8_t format, uint8_t *strip, uint32_t stripSize, GIF_DRAW_FN draw, void *user)
+{
+	GIF_FRAME *f = &dec->frame;
+	GIF_OUT o;
+	const uint8_t *palette = dec->localColors ? dec->localPalette : dec->globalPalette;
+	uint16_t colors = dec->localColors ? dec->localColors : dec->globalColors;
+	uint8_t colorMap[256*3];
+	uint16_t clear, code, in, next, sp, i;
+	int32_t old = -1;
+	uint32_t bitBuf = 0;
+	uint8_t bitCnt = 0, codeSize, minSize, first = 0, blockLeft = 0, dataEnd = 0;
+	const uint8_t *px;
+	uint8_t *out;
+	int c;
+
+	if(format < GIF_OUT_RGB332 || format > GIF_OUT_RGB888)
+		format = GIF_OUT_RGB565;
+
+	//palette in the output format, entries past the palette are black
+	memset(colorMap, 0, sizeof(colorMap));
+	for(i = 0; i < colors; i++)
+	{
+		uint8_t r = palette[3*i], g = palette[3*i+1], b = palette[3*i+2];
+		out = colorMap + i*format;
+		switch(format)
+		{
+			case GIF_OUT_RGB332:
+				out[0] = (r & 0xE0) | (g & 0xE0) >> 3 | b >> 6;
+				break;
+			case GIF_OUT_RGB888:
+				out[0] = b;
+				out[1] = g;
+				out[2] = r;
+				break;
+			default:	//GIF_OUT_RGB565
+				out[0] = (g & 0x1C) << 3 | b >> 3;
+				out[1] = (r & 0xF8) | g >> 5;
+				break;
+		}
+	}
+	if(f->transparent >= 0)
+	{
+		gif_PickKey(dec, colorMap, 256, format);
+		memcpy(colorMap + f->transparent*format, f->key, format);
+	}
+
+	memset(&o, 0, sizeof(o));
+	o.strip = strip;
+	o.format = format;
+	o.draw = draw;
+	o.user = user;
+	o.outW = (f->x >= dec->width) ? 0 : (f->x + f->w > dec->width ? dec->width - f->x : f->w);
+	o.outH = (f->y >= dec->height) ? 0 : (f->y + f->h > dec->height ? dec->height - f->y : f->h);
+	if(o.outW == 0)
+		o.outH = 0;
+	o.rowBytes = o.outW * format;
+	o.stripRows = o.rowBytes ? ((stripSize / o.rowBytes > 0xFFFF) ? 0xFFFF : stripSize / o.rowBytes) : 1;
+	if(o.stripRows == 0)
+		return GIF_ERR_BUFFER;
+	o.y0 = o.y = 0;
+
+	c = gif_ReadByte(dec);
+	if(c < 2 || c > 11)
+		return GIF_ERR_FORMAT;
+	minSize = c;
+	clear = 1 << minSize;
+	codeSize = minSize + 1;
+	next = clear + 2;
+
+	while(!o.stop)
+	{
+		while(bitCnt < codeSize)
+		{
+			if(blockLeft == 0)
+			{
+				c = gif_ReadByte(dec);
+				if(c <= 0)
+				{
+					dataEnd = 1;	//block terminator before the end of information code
+					break;
+				}
+				blockLeft = c;
+			}
+			c = gif_ReadByte(dec);
+			if(c < 0)
+				return GIF_ERR_DATA;
+			blockLeft--;
+			bitBuf |= (uint32_t)c << bitCnt;
+			bitCnt += 8;
+		}
+		if(bitCnt < codeSize)
+			break;
+
+		code = bitBuf & ((1 << codeSize) - 1);
+		bitBuf >>= codeSize;
+		bitCnt -= codeSize;
+
+		if(code == clear)
+		{
+			codeSize = minSize + 1;
+			next = clear + 2;
+			old = -1;
+			continue;
+		}
+		if(code == clear + 1)	//end of information
+			break;
+
+		if(old < 0)
+		{
+			if(code > clear)
+				return GIF_ERR_DATA;
+			first = code;
+			sp = 0;
+			dec->stack[sp++] = first;
+		}
+		else
+		{
+			in = code;
+			sp = 0;
+			if(code >= next)	//the code being defined, KwKwK
+			{
+				if(code > next)
+					return GIF_ERR_DATA;
+				dec->stack[sp++] = first;
+				code = old;
+			}
+			while(code > clear && sp < GIF_LZW_SIZE - 1)
+			{
+				dec->stack[sp++] = dec->suffix[code];
+				code = dec->prefix[code];
+			}
+			first = code;
+			dec->stack[sp++] = first;
+
+			if(next < GIF_LZW_SIZE)
+			{
+				dec->prefix[next] = old;
+				dec->suffix[next] = first;
+				next++;
+				if(next == (1 << codeSize) && codeSize < 12)
+					codeSize++;
+			}
+			code = in;
+		}
+		old = code;
+
+		//the string comes out of the stack backwards
+		while(sp && o.rowsDone < f->h)
+		{
+			c = dec->stack[--sp];
+			if(o.x < o.outW && o.y < o.outH)
+			{
+				px = colorMap + c*format;
+				out = strip + o.n*o.rowBytes + o.x*format;
+				out[0] = px[0];
+				if(format > 1) out[1] = px[1];
+				if(format > 2) out[2] = px[2];
+			}
+			if(++o.x == f->w)
+			{
+				gif_EndRow(dec, &o);
+				if(o.stop)
+					break;
+			}
+		}
+	}
+
+	//partial strip of a truncated image
+	gif_Flush(dec, &o);
+
+	if(o.stop)
+		return GIF_OK;
+	if(!dataEnd && (gif_Skip(dec, blockLeft) != GIF_OK || gif_SkipBlocks(dec) != GIF_OK))
+		return GIF_ERR_DATA;
+	return (o.rowsDone == f->h) ? GIF_OK : GIF_ERR_DATA;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file    gifDec.h
+ * @license BSD license, all text above and below must be included in any redistribution
+ *
+ * Streaming GIF decoder for MCUs.<br>
+ * The compressed data is read through a small input buffer, LZW codes are expanded one at a time and pixels are
+ * converted to the pixel format of a memory write through the frame palette. Decoded rows are gathered in a strip
+ * buffer given by the caller and handed to a draw callback as one rectangle, clipped to the logical screen.<br>
+ *
+ * Transparent pixels are written as a key color, picked among the values no opaque palette entry maps to, so a
+ * chroma key write (e.g. BTE MPU write with chroma key) leaves the pixels underneath untouched.<br>
+ *
+ * Usage:
+ *	static GIF_DEC dec;		//about 14KB, keep it off the stack of small MCUs
+ *	uint8_t strip[480*2*4];
+ *	if(GifOpen(&dec, data, size, NULL, NULL) == GIF_OK)
+ *		while(GifNextFrame(&dec) == 1)
+ *			GifDecodeFrame(&dec, GIF_OUT_RGB565, strip, sizeof(strip), draw, user);
+ */
+
+#ifndef _GIF_DEC_H
+#define _GIF_DEC_H
+
+#include "stdint.h"
+
+#define GIF_INBUF_SIZE		512		/* bytes read from the source at a time, one SD sector */
+#define GIF_MAX_FRAMES		64		/* frames of an animation kept in SDRAM by GIF_ANIM */
+#define GIF_LZW_SIZE		4096	/* 12-bit LZW codes */
+
+/* return codes */
+#define GIF_OK				0
+#define GIF_ERR_FORMAT		-1		/* not a GIF file or a corrupted block */
+#define GIF_ERR_DATA		-2		/* truncated or corrupted LZW data */
+#define GIF_ERR_BUFFER		-3		/* strip buffer smaller than one row */
+
+/* output pixel formats, the value is the number of bytes per pixel */
+#define GIF_OUT_RGB332		1		/* R[7:5]G[7:5]B[7:6] */
+#define GIF_OUT_RGB565		2		/* little endian, G[4:2]B[7:3] then R[7:3]G[7:5] */
+#define GIF_OUT_RGB888		3		/* B, G, R */
+
+/* disposal methods of a Graphic Control Extension */
+#define GIF_DISPOSE_NONE		0	/* not specified, kept like GIF_DISPOSE_KEEP */
+#define GIF_DISPOSE_KEEP		1	/* leave the frame in place */
+#define GIF_DISPOSE_BACKGROUND	2	/* restore the frame rectangle to the background color */
+#define GIF_DISPOSE_PREVIOUS	3	/* restore the frame rectangle to what it was before the frame */
+
+/**
+ * @note	Read callback. Copy up to size bytes of the file to buf and return the number of bytes copied, 0 at the end.
+ */
+typedef int  (*GIF_READ_FN)(void *user, uint8_t *buf, int size);
+
+/**
+ * @note	Draw callback. pixels holds w*h pixels in raster order at the output format, for the rectangle at (x,y)
+ *			of the logical screen. Return 0 to continue, non-zero to stop decoding.
+ */
+typedef int  (*GIF_DRAW_FN)(void *user, uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint8_t *pixels);
+
+/**
+ * @note	Frame descriptor filled in by GifNextFrame()
+ */
+typedef struct GIF_FRAME
+{
+	uint16_t	x, y, w, h;		/* frame rectangle in the logical screen */
+	uint16_t	delay;			/* in 1/100 s */
+	uint8_t		disposal;		/* GIF_DISPOSE_xxx */
+	int16_t		transparent;	/* transparent color index, -1 if none */
+	uint8_t		interlaced;
+	uint8_t		key[3];			/* pixel written for transparent pixels, valid after GifDecodeFrame() */
+} GIF_FRAME;
+
+/**
+ * @note	Decoder state, filled in by GifOpen()
+ */
+typedef struct GIF_DEC
+{
+	/* input */
+	const uint8_t	*inPtr;
+	const uint8_t	*inEnd;
+	GIF_READ_FN		read;
+	void			*readUser;
+	uint8_t			inBuf[GIF_INBUF_SIZE];
+
+	/* logical screen */
+	uint16_t		width, height;
+	uint8_t			background;		/* background color index into the global palette */
+	uint16_t		loopCount;		/* from the NETSCAPE2.0 extension, 0 to loop forever */
+	uint16_t		globalColors;	/* 0 if there is no global palette */
+	uint8_t			globalPalette[256*3];
+
+	/* current frame */
+	GIF_FRAME		frame;
+	uint16_t		localColors;
+	uint8_t			localPalette[256*3];
+
+	/* LZW dictionary */
+	uint16_t		prefix[GIF_LZW_SIZE];
+	uint8_t			suffix[GIF_LZW_SIZE];
+	uint8_t			stack[GIF_LZW_SIZE];
+} GIF_DEC;
+
+/**
+ * @note	Animation decoded once into SDRAM by Ra8876_Lite::gifLoad(), one full logical screen per frame
+ */
+typedef struct GIF_ANIM
+{
+	uint16_t	width, height;
+	uint32_t	addr;			/* SDRAM address of frame 0 */
+	uint32_t	frameSize;		/* bytes between frames */
+	uint16_t	numFrames;
+	uint16_t	loopCount;		/* 0 to loop forever */
+	uint16_t	delay[GIF_MAX_FRAMES];	/* in ms */
+
+	/* playback state of Ra8876_Lite::gifUpdate() */
+	uint16_t	current;
+	uint16_t	loops;
+	uint32_t	due;			/* millis() to show the next frame */
+	uint8_t		playing;
+	uint8_t		vsyncArmed;		/* a frame is due, waiting for a vsync after vsyncArmedAt */
+	uint32_t	vsyncArmedAt;	/* millis() the VSYNC flag was reset */
+} GIF_ANIM;
+
+#if defined(__cplusplus)
+extern "C" {     /* Make sure we have C-declarations in C++ programs */
+#endif
+
+//	parse the header and global palette from data[size] in memory, or from the read callback if data is NULL
+int   GifOpen(GIF_DEC *dec, const uint8_t *data, uint32_t size, GIF_READ_FN read, void *user);
+//	parse the blocks up to the next image, return 1 with dec->frame filled in, 0 at the end of file or a negative error code
+int   GifNextFrame(GIF_DEC *dec);
+//	decode the image found by GifNextFrame(), return GIF_OK or a negative error code
+int   GifDecodeFrame(GIF_DEC *dec, uint8_t format, uint8_t *strip, uint32_t stripSize, GIF_DRAW_FN draw, void *user);
+
+#ifdef __cplusplus
+}
+#endif
+#endif	//_GIF_DEC_H
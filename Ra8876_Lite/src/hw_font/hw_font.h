@@ -16,7 +16,8 @@
  *				Users may choose the appropriate product from Genitop Inc and solder it by himself at designator U33/U34.
  *				This option is enumerated by FONT_SRC as GENITOP_FONT below.
  *			(3) User-defined Characters: User can create characters or symbols and then get them stored in SDRAM. 
- *				This mode is not supported by current version. Details can be found under section 14.3 on RA8876 datasheet.
+ *				Ra8876_Lite::cgramLoadBfcChars() stores characters from a BFC font in half-size cells (8x16, 12x24, 16x32).
+ *				Details can be found under section 14.3 on RA8876 datasheet.
  *				This option is enumerated by FONT_SRC as CUSTOM_CGRAM below.
  */
 
@@ -257,5 +258,49 @@ const HW_FONT XCGROM_ARABIA_16 =
 	FONT_CODE::XCGROM_LATIN
 };
 
+/**
+ * @note	User-defined Characters in CGRAM, codes 0x00 - 0xFF in half-size cells.<br>
+ *			Returned by Ra8876_Lite::cgramLoadBfcChars() for the cell height fitting the BFC font.<br>
+ *			Example to use <br>
+ *
+			const HW_FONT *pDigits = ra8876lite.cgramLoadBfcChars(&fontLucida_Sans_Unicode16h_rowrowBig, "0123456789:");
+			ra8876lite.setHwTextCursor(100,100);
+			ra8876lite.setHwTextColor(color.White);
+			ra8876lite.setHwTextParam(color.Black, 4,4);
+			ra8876lite.putHwString(pDigits, "12:45");
+ */
+const HW_FONT CGRAM_16 =
+{
+	"User-defined 8x16",
+	0x00,
+	0xFF,
+	FONT_SRC::CUSTOM_CGRAM,
+	8,
+	16,
+	FONT_CODE::ICGROM_ISO_8859_1
+};
+
+const HW_FONT CGRAM_24 =
+{
+	"User-defined 12x24",
+	0x00,
+	0xFF,
+	FONT_SRC::CUSTOM_CGRAM,
+	12,
+	24,
+	FONT_CODE::ICGROM_ISO_8859_1
+};
+
+const HW_FONT CGRAM_32 =
+{
+	"User-defined 16x32",
+	0x00,
+	0xFF,
+	FONT_SRC::CUSTOM_CGRAM,
+	16,
+	32,
+	FONT_CODE::ICGROM_ISO_8859_1
+};
+
 #endif //_HW_FONT_H
 
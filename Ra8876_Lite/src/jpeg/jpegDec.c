@@ -0,0 +1,749 @@
+#include "jpegDec.h"
+
+/* natural order index of each coefficient in zigzag order, padded so that a corrupted run stays in the array */
+static const uint8_t JPEG_ZIGZAG[64+16] = {
+	 0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+	12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+	35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+	58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+	63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63
+};
+
+/*----------------------------------------------------------------------------------------------------------*/
+/* input                                                                                                    */
+/*----------------------------------------------------------------------------------------------------------*/
+/* return the number of bytes available at inPtr, refilling the input buffer from the read callback when empty */
+static int32_t jpg_Available(JPEG_DEC *d)
+{
+	if(d->inPtr == d->inEnd && d->read != 0)
+	{
+		int n = d->read(d->readUser, d->inBuf, JPEG_INBUF_SIZE);
+		if(n <= 0)
+			return 0;
+		d->inPtr = d->inBuf;
+		d->inEnd = d->inBuf + n;
+	}
+	return (int32_t)(d->inEnd - d->inPtr);
+}
+
+static int jpg_ReadByte(JPEG_DEC *d)
+{
+	if(jpg_Available(d) == 0)
+		return -1;
+	return *d->inPtr++;
+}
+
+static int32_t jpg_ReadU16(JPEG_DEC *d)
+{
+	int hi = jpg_ReadByte(d);
+	int lo = jpg_ReadByte(d);
+
+	if(hi < 0 || lo < 0)
+		return -1;
+	return (hi << 8) | lo;
+}
+
+static int jpg_Skip(JPEG_DEC *d, uint32_t n)
+{
+	int32_t k;
+
+	while(n)
+	{
+		k = jpg_Available(d);
+		if(k == 0)
+			return JPEG_ERR_FORMAT;
+		if((uint32_t)k > n)
+			k = n;
+		d->inPtr += k;
+		n -= k;
+	}
+	return JPEG_OK;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+/* bit reader                                                                                               */
+/*----------------------------------------------------------------------------------------------------------*/
+/*
+ * Top up the bit buffer to more than 24 bits. A stuffed 0xFF00 is one 0xFF data byte. A marker stops the reader,
+ * which then feeds zero bits, so a Huffman decode never runs past the end of a restart interval or of the file.
+ */
+static void jpg_FillBits(JPEG_DEC *d)
+{
+	int c, m;
+
+	while(d->bitCnt <= 24)
+	{
+		c = 0;
+		if(d->marker == 0)
+		{
+			c = jpg_ReadByte(d);
+			if(c < 0)
+			{
+				d->marker = 0xD9;	//end of data is taken as EOI
+				c = 0;
+			}
+			else if(c == 0xFF)
+			{
+				do
+					m = jpg_ReadByte(d);
+				while(m == 0xFF);
+				if(m != 0)
+				{
+					d->marker = (m < 0) ? 0xD9 : m;
+					c = 0;
+				}
+			}
+		}
+		d->bitBuf |= (uint32_t)c << (24 - d->bitCnt);
+		d->bitCnt += 8;
+	}
+}
+
+static int32_t jpg_GetBits(JPEG_DEC *d, uint8_t n)
+{
+	int32_t v;
+
+	if(n == 0)
+		return 0;
+	if(d->bitCnt < n)
+		jpg_FillBits(d);
+	v = d->bitBuf >> (32 - n);
+	d->bitBuf <<= n;
+	d->bitCnt -= n;
+	return v;
+}
+
+/* convert n received bits to a signed coefficient, F.2.2.1 of ITU T.81 */
+static int32_t jpg_Extend(int32_t v, uint8_t n)
+{
+	return (v < (1L << (n - 1))) ? v - (1L << n) + 1 : v;
+}
+
+static int jpg_Decode(JPEG_DEC *d, const JPEG_HUFF *h)
+{
+	uint16_t look;
+	uint8_t len;
+	int32_t code;
+
+	if(d->bitCnt < 16)
+		jpg_FillBits(d);
+
+	look = h->look[d->bitBuf >> 24];
+	if(look)
+	{
+		len = look >> 8;
+		d->bitBuf <<= len;
+		d->bitCnt -= len;
+		return look & 0xFF;
+	}
+
+	for(len = 9; len <= 16; len++)
+	{
+		code = d->bitBuf >> (32 - len);
+		if(code <= h->maxcode[len])
+		{
+			d->bitBuf <<= len;
+			d->bitCnt -= len;
+			return h->values[h->valptr[len] + code - h->mincode[len]];
+		}
+	}
+	return -1;
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+/* headers                                                                                                  */
+/*----------------------------------------------------------------------------------------------------------*/
+/* generate canonical codes from the number of codes of each length, C.2 of ITU T.81 */
+static int jpg_BuildHuff(JPEG_HUFF *h, const uint8_t *counts)
+{
+	uint32_t code = 0, c, n;
+	uint16_t k = 0, i;
+	uint8_t len;
+
+	for(i = 0; i < 256; i++)
+		h->look[i] = 0;
+
+	for(len = 1; len <= 16; len++)
+	{
+		if(code + counts[len-1] > (1UL << len))	/* more codes than the code space, checked before look[] is filled */
+			return JPEG_ERR_FORMAT;
+		h->valptr[len] = k;
+		h->mincode[len] = code;
+		h->maxcode[len] = counts[len-1] ? (int32_t)(code + counts[len-1] - 1) : -1;
+		if(len <= 8)
+		{
+			for(i = 0; i < counts[len-1]; i++)
+			{
+				c = (code + i) << (8 - len);
+				for(n = 1UL << (8 - len); n; n--)
+					h->look[c++] = ((uint16_t)len << 8) | h->values[k + i];
+			}
+		}
+		code += counts[len-1];
+		k += counts[len-1];
+		code <<= 1;
+	}
+	h->maxcode[17] = 0x7FFFFFFFL;
+
+	return JPEG_OK;
+}
+
+static int jpg_ParseDHT(JPEG_DEC *d)
+{
+	int32_t len = jpg_ReadU16(d) - 2;
+	uint8_t counts[16];
+	uint16_t total, i;
+	int c;
+	JPEG_HUFF *h;
+
+	while(len > 0)
+	{
+		c = jpg_ReadByte(d);
+		if(c < 0) return JPEG_ERR_FORMAT;
+		if((c & 0x0F) > 1) return JPEG_ERR_UNSUPPORTED;
+		h = (c >> 4) ? &d->ac[c & 1] : &d->dc[c & 1];
+
+		for(i = 0, total = 0; i < 16; i++)
+		{
+			c = jpg_ReadByte(d);
+			if(c < 0) return JPEG_ERR_FORMAT;
+			counts[i] = c;
+			total += c;
+		}
+		if(total > 256) return JPEG_ERR_FORMAT;
+		for(i = 0; i < total; i++)
+		{
+			c = jpg_ReadByte(d);
+			if(c < 0) return JPEG_ERR_FORMAT;
+			h->values[i] = c;
+		}
+		if(jpg_BuildHuff(h, counts) != JPEG_OK)
+			return JPEG_ERR_FORMAT;
+		len -= 17 + total;
+	}
+	return (len == 0) ? JPEG_OK : JPEG_ERR_FORMAT;
+}
+
+static int jpg_ParseDQT(JPEG_DEC *d)
+{
+	int32_t len = jpg_ReadU16(d) - 2;
+	uint8_t precision, i;
+	int32_t v;
+	int c;
+
+	while(len > 0)
+	{
+		c = jpg_ReadByte(d);
+		if(c < 0) return JPEG_ERR_FORMAT;
+		if((c & 0x0F) > 3) return JPEG_ERR_FORMAT;
+		precision = c >> 4;
+		for(i = 0; i < 64; i++)
+		{
+			v = precision ? jpg_ReadU16(d) : jpg_ReadByte(d);
+			if(v < 0) return JPEG_ERR_FORMAT;
+			d->qt[c & 0x0F][i] = v;
+		}
+		len -= 1 + (precision ? 128 : 64);
+	}
+	return (len == 0) ? JPEG_OK : JPEG_ERR_FORMAT;
+}
+
+static int jpg_ParseSOF(JPEG_DEC *d)
+{
+	int32_t len = jpg_ReadU16(d);
+	int c, hv, tq;
+	uint8_t i;
+	JPEG_COMP *p;
+
+	if(len < 8 || jpg_ReadByte(d) != 8)
+		return JPEG_ERR_UNSUPPORTED;	//12-bit samples
+	d->height = jpg_ReadU16(d);
+	d->width = jpg_ReadU16(d);
+	c = jpg_ReadByte(d);
+	if(d->width == 0 || d->height == 0)
+		return JPEG_ERR_UNSUPPORTED;	//height from a DNL marker
+	if(c != 1 && c != 3)
+		return JPEG_ERR_UNSUPPORTED;	//CMYK
+	if(len != 8 + 3*c)
+		return JPEG_ERR_FORMAT;
+	d->numComp = c;
+	d->hmax = d->vmax = 1;
+
+	for(i = 0; i < d->numComp; i++)
+	{
+		p = &d->comp[i];
+		p->id = jpg_ReadByte(d);
+		hv = jpg_ReadByte(d);
+		tq = jpg_ReadByte(d);
+		if(tq < 0 || tq > 3)
+			return JPEG_ERR_FORMAT;
+		p->h = hv >> 4;
+		p->v = hv & 0x0F;
+		p->tq = tq;
+		if(p->h < 1 || p->h > 2 || p->v < 1 || p->v > 2)
+			return JPEG_ERR_UNSUPPORTED;
+		if(p->h > d->hmax) d->hmax = p->h;
+		if(p->v > d->vmax) d->vmax = p->v;
+	}
+	//a single component scan is not interleaved, its MCU is one block whatever the sampling factors
+	if(d->numComp == 1)
+		d->comp[0].h = d->comp[0].v = d->hmax = d->vmax = 1;
+
+	d->mcusX = (d->width + 8*d->hmax - 1) / (8*d->hmax);
+	d->mcusY = (d->height + 8*d->vmax - 1) / (8*d->vmax);
+	return JPEG_OK;
+}
+
+static int jpg_ParseSOS(JPEG_DEC *d)
+{
+	int32_t len = jpg_ReadU16(d);
+	int ns = jpg_ReadByte(d), id, t;
+	uint8_t i, k;
+
+	if(d->numComp == 0)
+		return JPEG_ERR_FORMAT;	//no frame header
+	if(ns != d->numComp)
+		return JPEG_ERR_UNSUPPORTED;	//non-interleaved scans of a color image
+	if(len != 6 + 2*ns)
+		return JPEG_ERR_FORMAT;
+
+	for(i = 0; i < ns; i++)
+	{
+		id = jpg_ReadByte(d);
+		t = jpg_ReadByte(d);
+		for(k = 0; k < d->numComp && d->comp[k].id != id; k++)
+			;
+		if(k == d->numComp || t < 0 || (t >> 4) > 1 || (t & 0x0F) > 1)
+			return JPEG_ERR_FORMAT;
+		d->comp[k].td = t >> 4;
+		d->comp[k].ta = t & 0x0F;
+		d->comp[k].pred = 0;
+	}
+	return jpg_Skip(d, 3);	//spectral selection and successive approximation, fixed for baseline
+}
+
+/**
+ * @brief	Parse the headers of a JPEG file up to the start of the first scan.
+ * @param	*dec is the decoder state to fill in
+ * @param	*data, size is a JPEG file in memory, or NULL to read the file through read()
+ * @param	read is the read callback used when data is NULL
+ * @param	*user is passed to read()
+ * @return	JPEG_OK, JPEG_ERR_FORMAT or JPEG_ERR_UNSUPPORTED
+ * @note	Image size is available in dec->width and dec->height after this call.
+ */
+int JpegOpen(JPEG_DEC *dec, const uint8_t *data, uint32_t size, JPEG_READ_FN read, void *user)
+{
+	int c, ret;
+
+	dec->inPtr = data;
+	dec->inEnd = data ? data + size : data;
+	dec->read = data ? 0 : read;
+	dec->readUser = user;
+	dec->bitBuf = 0;
+	dec->bitCnt = 0;
+	dec->marker = 0;
+	dec->numComp = 0;
+	dec->restartInterval = 0;
+
+	if(jpg_ReadByte(dec) != 0xFF || jpg_ReadByte(dec) != 0xD8)
+		return JPEG_ERR_FORMAT;
+
+	for(;;)
+	{
+		c = jpg_ReadByte(dec);
+		if(c != 0xFF)
+			return JPEG_ERR_FORMAT;
+		do
+			c = jpg_ReadByte(dec);
+		while(c == 0xFF);
+
+		switch(c)
+		{
+			case 0xC0:	//baseline
+			case 0xC1:	//extended sequential, Huffman
+				ret = jpg_ParseSOF(dec);
+				break;
+			case 0xC4:
+				ret = jpg_ParseDHT(dec);
+				break;
+			case 0xDB:
+				ret = jpg_ParseDQT(dec);
+				break;
+			case 0xDD:
+				ret = (jpg_ReadU16(dec) == 4) ? JPEG_OK : JPEG_ERR_FORMAT;
+				dec->restartInterval = jpg_ReadU16(dec);
+				break;
+			case 0xDA:
+				return jpg_ParseSOS(dec);
+			case 0xC2: case 0xC3: case 0xC5: case 0xC6: case 0xC7:
+			case 0xC9: case 0xCA: case 0xCB: case 0xCD: case 0xCE: case 0xCF:
+				return JPEG_ERR_UNSUPPORTED;	//progressive, lossless, hierarchical or arithmetic
+			case 0xD9:
+			case -1:
+				return JPEG_ERR_FORMAT;
+			default:	//APPn, COM and others
+				ret = jpg_ReadU16(dec);
+				ret = (ret < 2) ? JPEG_ERR_FORMAT : jpg_Skip(dec, ret - 2);
+				break;
+		}
+		if(ret != JPEG_OK)
+			return ret;
+	}
+}
+
+/*----------------------------------------------------------------------------------------------------------*/
+/* block decoding                                                                                           */
+/*----------------------------------------------------------------------------------------------------------*/
+/*
+ * Decode the coefficients of one 8x8 block into coef[] in natural order, dequantized.
+ * With dcOnly the AC coefficients are parsed but not stored. *last is the zigzag index of the last non-zero AC.
+ */
+static int jpg_DecodeBlock(JPEG_DEC *d, JPEG_COMP *c, int32_t *coef, uint8_t dcOnly, uint8_t *last)
+{
+	const JPEG_HUFF *ac = &d->ac[c->ta];
+	const uint16_t *q = d->qt[c->tq];
+	int rs;
+	uint8_t k, r, s;
+
+	for(k = 0; k < 64; k++)
+		coef[k] = 0;
+
+	rs = jpg_Decode(d, &d->dc[c->td]);
+	if(rs < 0 || rs > 11)
+		return JPEG_ERR_DATA;
+	if(rs)
+		c->pred += jpg_Extend(jpg_GetBits(d, rs), rs);
+	coef[0] = (int32_t)c->pred * q[0];
+
+	*last = 0;
+	for(k = 1; k < 64; k++)
+	{
+		rs = jpg_Decode(d, ac);
+		if(rs < 0)
+			return JPEG_ERR_DATA;
+		r = rs >> 4;
+		s = rs & 0x0F;
+		if(s == 0)
+		{
+			if(r != 15)
+				break;	//end of block
+			k += 15;
+			continue;
+		}
+		k += r;
+		if(k > 63)
+			return JPEG_ERR_DATA;
+		if(dcOnly)
+			jpg_GetBits(d, s);
+		else
+		{
+			coef[JPEG_ZIGZAG[k]] = jpg_Extend(jpg_GetBits(d, s), s) * q[k];
+			*last = k;
+		}
+	}
+	return JPEG_OK;
+}
+
+static uint8_t jpg_Clamp(int32_t v)
+{
+	return (v < 0) ? 0 : (v > 255) ? 255 : (uint8_t)v;
+}
+
+/* 12-bit fixed point constants of the Loeffler-Ligtenberg-Moschytz IDCT, the same factorization as IJG jidctint */
+#define JPEG_FIX(x)		((int32_t)((x) * 4096 + 0.5))
+
+/*
+ * One dimensional 8 point IDCT of in[0], in[step], ... in[7*step] to out[0], out[step], ...
+ * bias is added before the result is shifted down by shift bits.
+ */
+static void jpg_Idct8(const int32_t *in, int32_t *out, uint8_t step, int32_t bias, uint8_t shift)
+{
+	int32_t p1, p2, p3, p4, p5, t0, t1, t2, t3, x0, x1, x2, x3;
+
+	//even part
+	p1 = (in[2*step] + in[6*step]) * JPEG_FIX(0.541196100);
+	t2 = p1 + in[6*step] * JPEG_FIX(-1.847759065);
+	t3 = p1 + in[2*step] * JPEG_FIX(0.765366865);
+	t0 = (in[0] + in[4*step]) * 4096;
+	t1 = (in[0] - in[4*step]) * 4096;
+	x0 = t0 + t3 + bias;
+	x3 = t0 - t3 + bias;
+	x1 = t1 + t2 + bias;
+	x2 = t1 - t2 + bias;
+
+	//odd part
+	t0 = in[7*step];
+	t1 = in[5*step];
+	t2 = in[3*step];
+	t3 = in[step];
+	p3 = t0 + t2;
+	p4 = t1 + t3;
+	p1 = t0 + t3;
+	p2 = t1 + t2;
+	p5 = (p3 + p4) * JPEG_FIX(1.175875602);
+	t0 *= JPEG_FIX(0.298631336);
+	t1 *= JPEG_FIX(2.053119869);
+	t2 *= JPEG_FIX(3.072711026);
+	t3 *= JPEG_FIX(1.501321110);
+	p1 = p5 + p1 * JPEG_FIX(-0.899976223);
+	p2 = p5 + p2 * JPEG_FIX(-2.562915447);
+	p3 *= JPEG_FIX(-1.961570560);
+	p4 *= JPEG_FIX(-0.390180644);
+	t3 += p1 + p4;
+	t2 += p2 + p3;
+	t1 += p2 + p4;
+	t0 += p1 + p3;
+
+	out[0]		= (x0 + t3) >> shift;
+	out[7*step]	= (x0 - t3) >> shift;
+	out[step]	= (x1 + t2) >> shift;
+	out[6*step]	= (x1 - t2) >> shift;
+	out[2*step]	= (x2 + t1) >> shift;
+	out[5*step]	= (x2 - t1) >> shift;
+	out[3*step]	= (x3 + t0) >> shift;
+	out[4*step]	= (x3 - t0) >> shift;
+}
+
+/*
+ * Inverse transform one block and store it at (8>>sx)x(8>>sy) samples into a component plane of stride pitch.
+ * Columns keep 2 extra bits of precision for the row pass, which also adds the level shift of 128.
+ */
+static void jpg_IdctBlock(int32_t *coef, uint8_t last, uint8_t sx, uint8_t sy, uint8_t *plane, uint8_t pitch)
+{
+	int32_t tmp[64];
+	uint8_t pix[64];
+	uint8_t w = 8 >> sx, h = 8 >> sy, x, y, i, j;
+	uint16_t sum;
+
+	if((sx == 3 && sy == 3) || last == 0)
+	{
+		//flat block, the IDCT of a lone DC coefficient is DC/8 everywhere
+		uint8_t v = jpg_Clamp(((coef[0] + 4) >> 3) + 128);
+		for(y = 0; y < h; y++)
+			for(x = 0; x < w; x++)
+				plane[y*pitch + x] = v;
+		return;
+	}
+
+	for(i = 0; i < 8; i++)
+		jpg_Idct8(coef + i, tmp + i, 8, 512, 10);
+	for(i = 0; i < 8; i++)
+	{
+		int32_t row[8];
+		jpg_Idct8(tmp + 8*i, row, 1, 65536L + (128L << 17), 17);
+		for(j = 0; j < 8; j++)
+			pix[8*i + j] = jpg_Clamp(row[j]);
+	}
+
+	if(sx == 0 && sy == 0)
+	{
+		for(y = 0; y < 8; y++)
+			for(x = 0; x < 8; x++)
+				plane[y*pitch + x] = pix[8*y + x];
+		return;
+	}
+
+	//box filter of (1<<sx) x (1<<sy) pixels
+	for(y = 0; y < h; y++)
+	{
+		for(x = 0; x < w; x++)
+		{
+			sum = 0;
+			for(i = 0; i < (1 << sy); i++)
+				for(j = 0; j < (1 << sx); j++)
+					sum += pix[((y << sy) + i)*8 + (x << sx) + j];
+			plane[y*pitch + x] = (sum + ((1 << (sx + sy)) >> 1)) >> (sx + sy);
+		}
+	}
+}
+
+/* find the RSTn marker ending a restart interval and reset the bit reader and DC predictors */
+static int jpg_Restart(JPEG_DEC *d)
+{
+	int c;
+	uint8_t i;
+
+	d->bitBuf = 0;
+	d->bitCnt = 0;
+	while(d->marker == 0)
+	{
+		c = jpg_ReadByte(d);
+		if(c < 0)
+			return JPEG_ERR_DATA;
+		if(c != 0xFF)
+			continue;
+		do
+			c = jpg_ReadByte(d);
+		while(c == 0xFF);
+		if(c < 0)
+			return JPEG_ERR_DATA;
+		d->marker = c;
+	}
+	if(d->marker < 0xD0 || d->marker > 0xD7)
+		return JPEG_ERR_DATA;
+
+	d->marker = 0;
+	for(i = 0; i < d->numComp; i++)
+		d->comp[i].pred = 0;
+	return JPEG_OK;
+}
+
+/*
+ * Convert the component planes of one MCU to output pixels at (ox,0) of a strip of stride stripW,
+ * clipped to w x h pixels.
+ */
+static void jpg_ColorConvert(JPEG_DEC *d, uint8_t format,
+							 uint8_t *strip, uint16_t stripW, uint16_t ox, uint8_t w, uint8_t h)
+{
+	uint8_t pw[3], hs[3], vs[3], x, y, i;
+	int32_t yy, cb, cr, r, g, b;
+	uint8_t *out;
+
+	for(i = 0; i < d->numComp; i++)
+	{
+		pw[i] = d->comp[i].h * (8 >> d->comp[i].sx);
+		hs[i] = d->comp[i].hs;
+		vs[i] = d->comp[i].vs;
+	}
+
+	for(y = 0; y < h; y++)
+	{
+		out = strip + ((uint32_t)y*stripW + ox)*format;
+		for(x = 0; x < w; x++)
+		{
+			yy = d->planes[0][(y >> vs[0])*pw[0] + (x >> hs[0])];
+			if(d->numComp == 3)
+			{
+				cb = d->planes[1][(y >> vs[1])*pw[1] + (x >> hs[1])] - 128;
+				cr = d->planes[2][(y >> vs[2])*pw[2] + (x >> hs[2])] - 128;
+				//ITU-R BT.601 full range as in JFIF, 16-bit fixed point
+				r = jpg_Clamp(yy + ((91881L*cr + 32768L) >> 16));
+				g = jpg_Clamp(yy + ((-22554L*cb - 46802L*cr + 32768L) >> 16));
+				b = jpg_Clamp(yy + ((116130L*cb + 32768L) >> 16));
+			}
+			else
+				r = g = b = yy;
+
+			switch(format)
+			{
+				case JPEG_OUT_RGB332:
+					*out++ = (r & 0xE0) | (g & 0xE0) >> 3 | b >> 6;
+					break;
+				case JPEG_OUT_RGB888:
+					*out++ = b;
+					*out++ = g;
+					*out++ = r;
+					break;
+				default:	//JPEG_OUT_RGB565
+					*out++ = (g & 0x1C) << 3 | b >> 3;
+					*out++ = (r & 0xF8) | g >> 5;
+					break;
+			}
+		}
+	}
+}
+
+/**
+ * @brief	Decode the scan opened by JpegOpen() and draw it strip by strip.
+ * @param	*dec is a decoder opened by JpegOpen()
+ * @param	scale is 0, 1, 2 or 3 to scale the image by 1/1, 1/2, 1/4 or 1/8
+ * @param	format is JPEG_OUT_RGB332, JPEG_OUT_RGB565 or JPEG_OUT_RGB888
+ * @param	*strip is a buffer of stripSize bytes for decoded pixels, reused for each strip
+ * @param	draw is called with each strip, (x,y) being relative to the top left corner of the scaled image
+ * @param	*user is passed to draw()
+ * @return	JPEG_OK, JPEG_ERR_DATA or JPEG_ERR_BUFFER
+ * @note	A strip is as many MCUs side by side as fit in the buffer, up to a full MCU row.
+ *			One MCU takes (8*hmax>>scale)*(8*vmax>>scale)*format bytes, 1536 bytes at most for 4:2:0 in RGB888.
+ */
+int JpegDecode(JPEG_DEC *dec, uint8_t scale, uint8_t format, uint8_t *strip, uint32_t stripSize, JPEG_DRAW_FN draw, void *user)
+{
+	int32_t coef[64];
+	uint16_t outW, outH, mcuW, mcuH, stripMcus, stripW, rowH, mx0, my, n, i, restartsLeft;
+	uint8_t c, bx, by, last, pitch, bw, bh;
+	JPEG_COMP *p;
+	int ret;
+
+	if(scale > 3)
+		scale = 3;
+	if(format < JPEG_OUT_RGB332 || format > JPEG_OUT_RGB888)
+		format = JPEG_OUT_RGB565;
+
+	outW = JPEG_SCALED(dec->width, scale);
+	outH = JPEG_SCALED(dec->height, scale);
+	mcuW = (8*dec->hmax) >> scale;
+	mcuH = (8*dec->vmax) >> scale;
+
+	/*
+	 * A subsampled component already has half the resolution, so it is reduced by one step less than the
+	 * luma and not replicated at all once scale > 0. Reducing it by the full scale then replicating it would
+	 * average the chroma over twice the area and smear colored edges.
+	 */
+	for(c = 0; c < dec->numComp; c++)
+	{
+		p = &dec->comp[c];
+		p->hs = (p->h < dec->hmax);
+		p->vs = (p->v < dec->vmax);
+		p->sx = scale;
+		p->sy = scale;
+		if(scale && p->hs) { p->sx--; p->hs = 0; }
+		if(scale && p->vs) { p->sy--; p->vs = 0; }
+	}
+
+	stripMcus = stripSize / ((uint32_t)mcuW*mcuH*format);
+	if(stripMcus == 0)
+		return JPEG_ERR_BUFFER;
+	if(stripMcus > dec->mcusX)
+		stripMcus = dec->mcusX;
+
+	restartsLeft = dec->restartInterval;
+	for(my = 0; my < dec->mcusY; my++)
+	{
+		rowH = (outH - my*mcuH < mcuH) ? outH - my*mcuH : mcuH;
+		for(mx0 = 0; mx0 < dec->mcusX; mx0 += n)
+		{
+			n = (dec->mcusX - mx0 < stripMcus) ? dec->mcusX - mx0 : stripMcus;
+			stripW = (outW - mx0*mcuW < n*mcuW) ? outW - mx0*mcuW : n*mcuW;
+
+			for(i = 0; i < n; i++)
+			{
+				if(dec->restartInterval)
+				{
+					if(restartsLeft == 0)
+					{
+						ret = jpg_Restart(dec);
+						if(ret != JPEG_OK)
+							return ret;
+						restartsLeft = dec->restartInterval;
+					}
+					restartsLeft--;
+				}
+
+				for(c = 0; c < dec->numComp; c++)
+				{
+					p = &dec->comp[c];
+					bw = 8 >> p->sx;
+					bh = 8 >> p->sy;
+					pitch = p->h * bw;
+					for(by = 0; by < p->v; by++)
+					{
+						for(bx = 0; bx < p->h; bx++)
+						{
+							ret = jpg_DecodeBlock(dec, p, coef, p->sx == 3 && p->sy == 3, &last);
+							if(ret != JPEG_OK)
+								return ret;
+							jpg_IdctBlock(coef, last, p->sx, p->sy, &dec->planes[c][by*bh*pitch + bx*bw], pitch);
+						}
+					}
+				}
+
+				if(i*mcuW < stripW)
+					jpg_ColorConvert(dec, format, strip, stripW, i*mcuW,
+									 (stripW - i*mcuW < mcuW) ? stripW - i*mcuW : mcuW, rowH);
+			}
+
+			if(draw(user, mx0*mcuW, my*mcuH, stripW, rowH, strip))
+				return JPEG_OK;
+		}
+	}
+	return JPEG_OK;
+}
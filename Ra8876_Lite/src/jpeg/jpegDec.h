@@ -0,0 +1,126 @@
+/**
+ * @file    jpegDec.h
+ * @license BSD license, all text above and below must be included in any redistribution
+ *
+ * Streaming baseline JPEG decoder for MCUs with a few KB of RAM.<br>
+ * The compressed data is read through a small input buffer and decoded one MCU (minimum coded unit, 8x8 to 16x16
+ * pixels) at a time. Decoded MCUs are converted to the pixel format of a memory write and gathered side by side in
+ * a strip buffer given by the caller. Each full strip is handed to a draw callback as one rectangle, so a strip
+ * buffer of one MCU row draws an image with one block write per MCU row.<br>
+ *
+ * Supported: baseline and extended sequential Huffman (SOF0/SOF1), 8-bit samples, grayscale or YCbCr with
+ * 4:4:4, 4:2:2, 4:4:0 and 4:2:0 subsampling, restart markers.<br>
+ * Not supported: progressive (SOF2), arithmetic coding, 12-bit samples, CMYK. A progressive file is converted
+ * to baseline without loss of quality by "jpegtran -optimize in.jpg > out.jpg".<br>
+ *
+ * Images are scaled down at decode time by 1/2, 1/4 or 1/8. Each 8x8 luma block is reduced to 4x4, 2x2 or 1x1
+ * before color conversion, subsampled chroma blocks by one step less. At 1/8 only the DC coefficient of luma blocks is used and their IDCT is skipped.
+ *
+ * Usage:
+ *	static JPEG_DEC dec;	//about 5KB, keep it off the stack of small MCUs
+ *	uint8_t strip[16*16*2*8];
+ *	if(JpegOpen(&dec, data, size, NULL, NULL) == JPEG_OK)
+ *		JpegDecode(&dec, 0, JPEG_OUT_RGB565, strip, sizeof(strip), draw, user);
+ */
+
+#ifndef _JPEG_DEC_H
+#define _JPEG_DEC_H
+
+#include "stdint.h"
+
+#define JPEG_INBUF_SIZE		512		/* bytes read from the source at a time, one SD sector */
+
+/* return codes */
+#define JPEG_OK				0
+#define JPEG_ERR_FORMAT		-1		/* not a JPEG file or a corrupted header */
+#define JPEG_ERR_UNSUPPORTED -2		/* progressive, arithmetic, 12-bit or CMYK */
+#define JPEG_ERR_DATA		-3		/* truncated or corrupted entropy coded data */
+#define JPEG_ERR_BUFFER		-4		/* strip buffer smaller than one MCU */
+
+/* output pixel formats, the value is the number of bytes per pixel */
+#define JPEG_OUT_RGB332		1		/* R[7:5]G[7:5]B[7:6] */
+#define JPEG_OUT_RGB565		2		/* little endian, G[4:2]B[7:3] then R[7:3]G[7:5] */
+#define JPEG_OUT_RGB888		3		/* B, G, R */
+
+/* image dimension after scaling, scale is 0 to 3 for 1/1 to 1/8 */
+#define JPEG_SCALED(v, scale)	(((v) + (1 << (scale)) - 1) >> (scale))
+
+/**
+ * @note	Read callback. Copy up to size bytes of compressed data to buf and return the number of bytes copied, 0 at the end.
+ */
+typedef int  (*JPEG_READ_FN)(void *user, uint8_t *buf, int size);
+
+/**
+ * @note	Draw callback. pixels holds w*h pixels in raster order at the output format, for the rectangle at (x,y)
+ *			of the scaled image. Return 0 to continue, non-zero to stop decoding.
+ */
+typedef int  (*JPEG_DRAW_FN)(void *user, uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint8_t *pixels);
+
+/**
+ * @note	Huffman table in canonical form with an 8-bit lookahead for short codes
+ */
+typedef struct JPEG_HUFF
+{
+	uint16_t	look[256];		/* (code length<<8 | symbol) of codes up to 8 bits, 0 for a longer code */
+	int32_t		maxcode[18];	/* largest code of each length, -1 if none, maxcode[17] is a sentinel */
+	int16_t		valptr[17];		/* index into values[] of the first code of each length */
+	uint16_t	mincode[17];	/* first code of each length */
+	uint8_t		values[256];
+} JPEG_HUFF;
+
+typedef struct JPEG_COMP
+{
+	uint8_t		id;
+	uint8_t		h, v;			/* sampling factors */
+	uint8_t		tq;				/* quantization table */
+	uint8_t		td, ta;			/* DC and AC Huffman tables */
+	int16_t		pred;			/* DC predictor */
+	uint8_t		sx, sy;			/* block reduction, an 8x8 block becomes (8>>sx)x(8>>sy) samples */
+	uint8_t		hs, vs;			/* sample replication to the output pixels, 0 or 1 */
+} JPEG_COMP;
+
+/**
+ * @note	Decoder state, filled in by JpegOpen()
+ */
+typedef struct JPEG_DEC
+{
+	/* input */
+	const uint8_t	*inPtr;
+	const uint8_t	*inEnd;
+	JPEG_READ_FN	read;
+	void			*readUser;
+	uint8_t			inBuf[JPEG_INBUF_SIZE];
+	uint32_t		bitBuf;			/* bits left aligned at bit 31 */
+	int8_t			bitCnt;
+	uint8_t			marker;			/* marker met in entropy coded data, 0 if none */
+
+	/* tables */
+	uint16_t		qt[4][64];		/* in zigzag order */
+	JPEG_HUFF		dc[2];
+	JPEG_HUFF		ac[2];
+
+	/* frame */
+	uint16_t		width, height;
+	uint8_t			numComp;
+	uint8_t			hmax, vmax;
+	JPEG_COMP		comp[3];
+	uint16_t		mcusX, mcusY;
+	uint16_t		restartInterval;
+
+	/* component samples of one MCU */
+	uint8_t			planes[3][256];
+} JPEG_DEC;
+
+#if defined(__cplusplus)
+extern "C" {     /* Make sure we have C-declarations in C++ programs */
+#endif
+
+//	parse the headers up to the first scan from data[size] in memory, or from the read callback if data is NULL
+int   JpegOpen(JPEG_DEC *dec, const uint8_t *data, uint32_t size, JPEG_READ_FN read, void *user);
+//	decode the scan opened by JpegOpen() at scale 0 to 3 (1/1 to 1/8), return JPEG_OK or a negative error code
+int   JpegDecode(JPEG_DEC *dec, uint8_t scale, uint8_t format, uint8_t *strip, uint32_t stripSize, JPEG_DRAW_FN draw, void *user);
+
+#ifdef __cplusplus
+}
+#endif
+#endif	//_JPEG_DEC_H
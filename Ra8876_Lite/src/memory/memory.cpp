@@ -11,7 +11,7 @@
 void Memory::mem_init(void)
 {
 	mem_block_size = (uint16_t)ra8876lite.getCanvasWidth()*MEM_BLOCK_LN_NUM;
-	mem_alloc_tbl_size = (MEM_SIZE_MAX/mem_block_size);
+	mem_alloc_tbl_size = (CGRAM_START_ADDR/mem_block_size);	//the top 16KB from CGRAM_START_ADDR is kept for user-defined characters
 	
 	memory_tbl = new uint16_t[mem_alloc_tbl_size];
 
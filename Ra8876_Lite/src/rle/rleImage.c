@@ -0,0 +1,28 @@
+#include "rleImage.h"
+
+/* little endian field readers, the byte array has no alignment guarantee in MCU's Flash */
+#define RLEI_U16(p)		((uint16_t)((p)[0] | ((uint16_t)(p)[1]<<8)))
+#define RLEI_U32(p)		((uint32_t)(p)[0] | ((uint32_t)(p)[1]<<8) | ((uint32_t)(p)[2]<<16) | ((uint32_t)(p)[3]<<24))
+
+/**
+ * @brief	Decode the header of a run-length compressed image
+ * @param	*pData points to the image array, or to the first RLEI_HEADER_SIZE bytes read from a file
+ * @param	*pImage is the RLE_IMAGE to fill in
+ * @return	0 on success, -1 if the magic number or version does not match or the image is empty
+ */
+int RleOpen(const uint8_t *pData, RLE_IMAGE *pImage)
+{
+	if(pData == 0 || RLEI_U32(pData) != RLEI_MAGIC || pData[4] != RLEI_VERSION)
+		return -1;
+
+	pImage->Bpp			= pData[5];
+	pImage->Flags		= pData[6];
+	pImage->Width		= RLEI_U16(pData+8);
+	pImage->Height		= RLEI_U16(pData+10);
+	pImage->DataSize	= RLEI_U32(pData+12);
+
+	if(pImage->Bpp == 0 || pImage->Bpp > 3 || pImage->Width == 0 || pImage->Height == 0)
+		return -1;
+
+	return 0;
+}
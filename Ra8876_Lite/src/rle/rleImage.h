@@ -0,0 +1,72 @@
+/**
+ * @file    rleImage.h
+ * @license BSD license, all text above and below must be included in any redistribution
+ *
+ * Run-length compressed image converted from a RAiO *.bin picture by the host tool extras/rlepack.<br>
+ * All multi-byte fields are little endian. An image is a single byte array laid out as:<br>
+ *	RLEI header		16 bytes<br>
+ *	packet data		DataSize bytes<br>
+ *
+ * Pixels are stored in the byte order of a memory write at the image color depth (1, 2 or 3 bytes per pixel),
+ * the same as a RAiO *.bin file. Packets follow each other in raster order and may wrap over the end of a row:
+ *	[h] or [0x00|0x80][count16]		packet header, count from h&0x7F or from the 16-bit field when h&0x7F is 0
+ *	h&0x80 = 0 (literal)			count pixels follow
+ *	h&0x80 = 1 (run)				one pixel follows, repeated count times
+ *
+ * Ra8876_Lite::putRlePicture() turns a run of RLEI_FILL_MIN_BYTES or longer into BTE solid fills and streams
+ * everything else through the active window, so the encoder is free to code short runs for a smaller file.
+ */
+
+#ifndef _RLE_IMAGE_H
+#define _RLE_IMAGE_H
+
+#include "stdint.h"
+
+#define RLEI_MAGIC				0x49454C52UL	/* "RLEI" */
+#define RLEI_VERSION			1
+
+#define RLEI_HEADER_SIZE		16
+#define RLEI_RUN				0x80			/* packet header flag of a run */
+#define RLEI_COUNT_MASK			0x7F
+#define RLEI_COUNT_MAX			65535			/* longest packet, counts above 127 take the 16-bit field */
+
+/* A BTE solid fill costs about as many SPI bytes as 64 bytes of pixel data, shorter runs are streamed */
+#define RLEI_FILL_MIN_BYTES		64
+
+/**
+ * @note	Image header decoded by RleOpen()
+ */
+typedef struct RLE_IMAGE
+{
+	uint8_t		Bpp;			/* bytes per pixel, 1, 2 or 3 */
+	uint8_t		Flags;			/* reserved, 0 */
+	uint16_t	Width;
+	uint16_t	Height;
+	uint32_t	DataSize;		/* bytes of packet data after the header */
+} RLE_IMAGE;
+
+/**
+ * @note	Source of packet data for the decoder. An image in memory is one block from p to end.
+ *			An image on SD card refills buf from file until remain bytes have been read.
+ */
+typedef struct RLE_READER
+{
+	const uint8_t	*p;			/* next byte to read */
+	const uint8_t	*end;		/* end of the bytes available */
+	void			*file;		/* File* of an image on SD card, NULL for an image in memory */
+	uint8_t			*buf;		/* refill buffer for file */
+	uint16_t		bufSize;
+	uint32_t		remain;		/* bytes in file not read into buf yet */
+} RLE_READER;
+
+#if defined(__cplusplus)
+extern "C" {     /* Make sure we have C-declarations in C++ programs */
+#endif
+
+//	decode the header of an image, return 0 on success or -1 if pData is not an RLE image
+int   RleOpen(const uint8_t *pData, RLE_IMAGE *pImage);
+
+#ifdef __cplusplus
+}
+#endif
+#endif	//_RLE_IMAGE_H
@@ -0,0 +1,93 @@
+/**
+ * @file    utf8.h
+ * @license BSD license, all text above and below must be included in any redistribution
+ *
+ * UTF-8 decoder to feed code points straight into glyph lookup without converting a string to UTF-16 first.
+ *
+ * Usage:
+ *	const char *str = "Caf\xC3\xA9";
+ *	while(*str != '\0')
+ *	{
+ *		uint16_t ch = utf8DecodeBmp(&str);	//str advances by 1 to 4 bytes
+ *		...
+ *	}
+ */
+
+#ifndef _UTF8_H
+#define _UTF8_H
+
+#include "stdint.h"
+
+/**
+ * @note	Sequence length indexed by (lead byte >> 3). 0 marks a continuation byte or an invalid lead byte.
+ */
+static const uint8_t UTF8_SEQ_LEN[32] = {
+	1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,	/* 00h-7Fh ASCII */
+	0,0,0,0,0,0,0,0,					/* 80h-BFh continuation */
+	2,2,2,2,							/* C0h-DFh */
+	3,3,								/* E0h-EFh */
+	4,									/* F0h-F7h */
+	0									/* F8h-FFh invalid */
+};
+
+/* payload bits of the lead byte and smallest code point allowed for each sequence length, to reject overlong forms */
+static const uint8_t  UTF8_LEAD_MASK[5] = {0x00, 0x7F, 0x1F, 0x0F, 0x07};
+static const uint32_t UTF8_MIN_CP[5]    = {0xFFFFFFFF, 0x00, 0x80, 0x800, 0x10000};
+
+#define UTF8_REPLACEMENT_CHAR	0xFFFD
+
+/**
+ * @brief	Decode one character from a UTF-8 string.
+ * @param	**pStr points to the string pointer, which is advanced past the character decoded
+ * @return	Code point of the character
+ * @note	ASCII takes a single compare. Other lengths come from a table lookup, and the continuation bytes are
+ *			folded in a loop that also stops at the null terminator.<br>
+ *			An invalid sequence (stray continuation byte, truncated or overlong sequence, surrogate) consumes one byte
+ *			and returns that byte as an ISO 8859-1 code point, so legacy 8-bit strings keep printing as before.
+ */
+static inline uint32_t utf8Decode(const char **pStr)
+{
+	const uint8_t *s = (const uint8_t *)*pStr;
+	uint32_t cp = s[0];
+	uint8_t len, i;
+
+	if(cp < 0x80)
+	{
+		*pStr += 1;
+		return cp;
+	}
+
+	len = UTF8_SEQ_LEN[cp >> 3];
+	cp &= UTF8_LEAD_MASK[len];
+	for(i = 1; i < len; i++)
+	{
+		if((s[i] & 0xC0) != 0x80)
+		{
+			len = 0;
+			break;
+		}
+		cp = (cp << 6) | (s[i] & 0x3F);
+	}
+
+	if(len == 0 || cp < UTF8_MIN_CP[len] || (cp - 0xD800) < 0x800 || cp > 0x10FFFF)
+	{
+		*pStr += 1;
+		return s[0];
+	}
+
+	*pStr += len;
+	return cp;
+}
+
+/**
+ * @brief	Decode one character from a UTF-8 string for 16-bit character codes (Basic Multilingual Plane).
+ * @return	Code point of the character, or UTF8_REPLACEMENT_CHAR if it is beyond U+FFFF
+ */
+static inline uint16_t utf8DecodeBmp(const char **pStr)
+{
+	uint32_t cp = utf8Decode(pStr);
+
+	return (cp > 0xFFFF) ? UTF8_REPLACEMENT_CHAR : (uint16_t)cp;
+}
+
+#endif	//_UTF8_H